@@ -44,6 +44,9 @@ final ArgParser _argParser = new ArgParser(allowTrailingOptions: true)
       help: 'Whether kernel constant evaluation will be enabled.',
       defaultsTo: true)
   ..addFlag('gen-bytecode', help: 'Generate bytecode', defaultsTo: false)
+  ..addFlag('bytecode-superinstructions',
+      help: 'Fuse frequent bytecode sequences into superinstructions',
+      defaultsTo: false)
   ..addFlag('drop-ast',
       help: 'Drop AST for members with bytecode', defaultsTo: false);
 
@@ -81,6 +84,8 @@ Future<int> compile(List<String> arguments) async {
   final bool aot = options['aot'];
   final bool tfa = options['tfa'];
   final bool genBytecode = options['gen-bytecode'];
+  final bool emitBytecodeSuperinstructions =
+      options['bytecode-superinstructions'];
   final bool dropAST = options['drop-ast'];
   final bool enableAsserts = options['enable-asserts'];
   final bool enableConstantEvaluation = options['enable-constant-evaluation'];
@@ -113,6 +118,7 @@ Future<int> compile(List<String> arguments) async {
       useGlobalTypeFlowAnalysis: tfa,
       environmentDefines: environmentDefines,
       genBytecode: genBytecode,
+      emitBytecodeSuperinstructions: emitBytecodeSuperinstructions,
       dropAST: dropAST,
       enableAsserts: enableAsserts,
       enableConstantEvaluation: enableConstantEvaluation);
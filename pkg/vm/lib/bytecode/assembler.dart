@@ -38,6 +38,7 @@ class Label {
 class BytecodeAssembler {
   static const int kBitsPerInt = 64;
   static const int kLog2BytesPerBytecode = 2;
+  static const int kBytesPerBytecode = 1 << kLog2BytesPerBytecode;
 
   // TODO(alexmarkov): figure out more efficient storage for generated bytecode.
   final List<int> bytecode = new List<int>();
@@ -45,17 +46,35 @@ class BytecodeAssembler {
   final Uint8List _encodeBufferOut;
   final ExceptionsTable exceptionsTable = new ExceptionsTable();
 
-  BytecodeAssembler._(this._encodeBufferIn, this._encodeBufferOut);
+  /// Whether frequent instruction sequences are fused into superinstructions
+  /// (see SUPERINSTRUCTIONS in runtime/vm/constants_kbc.h).
+  final bool fuseInstructions;
 
-  factory BytecodeAssembler() {
+  // Last emitted instruction if it can be fused with the next one, or null
+  // if the current offset was observed (e.g. by binding a label or recording
+  // a try block boundary), so that code must not be moved across it.
+  int _lastInstruction;
+
+  BytecodeAssembler._(
+      this._encodeBufferIn, this._encodeBufferOut, this.fuseInstructions);
+
+  factory BytecodeAssembler({bool fuseInstructions: false}) {
     final buf = new Uint32List(1);
-    return new BytecodeAssembler._(buf, new Uint8List.view(buf.buffer));
+    return new BytecodeAssembler._(
+        buf, new Uint8List.view(buf.buffer), fuseInstructions);
   }
 
   int get offset => bytecode.length;
-  int get offsetInWords => bytecode.length >> kLog2BytesPerBytecode;
+
+  /// Current offset in words. Instructions emitted after the current offset
+  /// is observed are never fused with preceding instructions.
+  int get offsetInWords {
+    _lastInstruction = null;
+    return bytecode.length >> kLog2BytesPerBytecode;
+  }
 
   void bind(Label label) {
+    _lastInstruction = null;
     final List<int> jumps = label.bind(offset);
     for (int jumpOffset in jumps) {
       patchJump(jumpOffset, label.jumpOperand(jumpOffset));
@@ -65,8 +84,28 @@ class BytecodeAssembler {
   void emitWord(int word) {
     _encodeBufferIn[0] = word; // TODO(alexmarkov): Which endianness to use?
     bytecode.addAll(_encodeBufferOut);
+    _lastInstruction = word;
+  }
+
+  /// Returns opcode of the last emitted instruction if it can be fused with
+  /// the next one.
+  Opcode _fusionCandidate() {
+    if (!fuseInstructions || _lastInstruction == null) {
+      return null;
+    }
+    return Opcode.values[_lastInstruction & 0xFF];
   }
 
+  /// Removes the last emitted instruction and returns it.
+  int _removeLastInstruction() {
+    final int instr = _lastInstruction;
+    bytecode.length -= kBytesPerBytecode;
+    _lastInstruction = null;
+    return instr;
+  }
+
+  static int _decodeX(int instr) => (instr << 32) >> 48;
+
   int _getOpcodeAt(int pos) {
     return bytecode[pos]; // TODO(alexmarkov): Take endianness into account.
   }
@@ -98,7 +137,7 @@ class BytecodeAssembler {
   int _uint8(int v) => _unsigned(v, 8);
   int _uint16(int v) => _unsigned(v, 16);
 
-//  int _int8(int v) => _signed(v, 8);
+  int _int8(int v) => _signed(v, 8);
   int _int16(int v) => _signed(v, 16);
   int _int24(int v) => _signed(v, 24);
 
@@ -110,6 +149,9 @@ class BytecodeAssembler {
   int _encodeAD(Opcode opcode, int ra, int rd) =>
       _uint8(opcode.index) | (_uint8(ra) << 8) | (_uint16(rd) << 16);
 
+  int _encodeXD(Opcode opcode, int rx, int rd) =>
+      _uint8(opcode.index) | (_int8(rx) << 8) | (_uint16(rd) << 16);
+
 // TODO(alexmarkov) This format is currently unused. Restore it if needed, or
 // remove it once bytecode instruction set is finalized.
 //
@@ -142,6 +184,11 @@ class BytecodeAssembler {
 
   void emitBytecode0(Opcode opcode) {
     assert(BytecodeFormats[opcode].encoding == Encoding.k0);
+    if (opcode == Opcode.kAddInt && _fusionCandidate() == Opcode.kPush) {
+      final int rx = _decodeX(_removeLastInstruction());
+      emitWord(_encodeX(Opcode.kAddIntLocal, rx));
+      return;
+    }
     emitWord(_encode0(opcode));
   }
 
@@ -175,13 +222,44 @@ class BytecodeAssembler {
   }
 
   void emitJumpIfTrue(Label label) {
+    final Opcode fused = _fusedIntCompareAndJump(_fusionCandidate(), true);
+    if (fused != null) {
+      _removeLastInstruction();
+      emitWord(_encodeT(fused, label.jumpOperand(offset)));
+      return;
+    }
     emitWord(_encodeT(Opcode.kJumpIfTrue, label.jumpOperand(offset)));
   }
 
   void emitJumpIfFalse(Label label) {
+    final Opcode fused = _fusedIntCompareAndJump(_fusionCandidate(), false);
+    if (fused != null) {
+      _removeLastInstruction();
+      emitWord(_encodeT(fused, label.jumpOperand(offset)));
+      return;
+    }
     emitWord(_encodeT(Opcode.kJumpIfFalse, label.jumpOperand(offset)));
   }
 
+  /// Returns superinstruction which replaces int comparison [compare]
+  /// followed by JumpIfTrue (if [jumpIfTrue]) or JumpIfFalse.
+  static Opcode _fusedIntCompareAndJump(Opcode compare, bool jumpIfTrue) {
+    switch (compare) {
+      case Opcode.kCompareIntEq:
+        return jumpIfTrue ? Opcode.kJumpIfEqInt : Opcode.kJumpIfNeInt;
+      case Opcode.kCompareIntGt:
+        return jumpIfTrue ? Opcode.kJumpIfGtInt : Opcode.kJumpIfLeInt;
+      case Opcode.kCompareIntLt:
+        return jumpIfTrue ? Opcode.kJumpIfLtInt : Opcode.kJumpIfGeInt;
+      case Opcode.kCompareIntGe:
+        return jumpIfTrue ? Opcode.kJumpIfGeInt : Opcode.kJumpIfLtInt;
+      case Opcode.kCompareIntLe:
+        return jumpIfTrue ? Opcode.kJumpIfLeInt : Opcode.kJumpIfGtInt;
+      default:
+        return null;
+    }
+  }
+
   void emitJumpIfNull(Label label) {
     emitWord(_encodeT(Opcode.kJumpIfNull, label.jumpOperand(offset)));
   }
@@ -285,6 +363,14 @@ class BytecodeAssembler {
   }
 
   void emitLoadFieldTOS(int rd) {
+    if (_fusionCandidate() == Opcode.kPush) {
+      final int rx = _decodeX(_lastInstruction);
+      if (-128 <= rx && rx < 128) {
+        _removeLastInstruction();
+        emitWord(_encodeXD(Opcode.kLoadFieldLocal, rx, rd));
+        return;
+      }
+    }
     emitWord(_encodeD(Opcode.kLoadFieldTOS, rd));
   }
 
@@ -349,6 +435,11 @@ class BytecodeAssembler {
   }
 
   void emitAssertBoolean(int ra) {
+    // Result of int comparison is always a bool, so the check can be omitted
+    // allowing comparison to be fused with the subsequent conditional jump.
+    if (_fusedIntCompareAndJump(_fusionCandidate(), true) != null) {
+      return;
+    }
     emitWord(_encodeA(Opcode.kAssertBoolean, ra));
   }
 
@@ -106,6 +106,16 @@ enum Opcode {
   kCompareIntLt,
   kCompareIntGe,
   kCompareIntLe,
+
+  // Superinstructions.
+  kJumpIfEqInt,
+  kJumpIfNeInt,
+  kJumpIfLtInt,
+  kJumpIfLeInt,
+  kJumpIfGtInt,
+  kJumpIfGeInt,
+  kLoadFieldLocal,
+  kAddIntLocal,
 }
 
 enum Encoding {
@@ -279,6 +289,22 @@ const Map<Opcode, Format> BytecodeFormats = const {
       Encoding.k0, const [Operand.none, Operand.none, Operand.none]),
   Opcode.kCompareIntLe: const Format(
       Encoding.k0, const [Operand.none, Operand.none, Operand.none]),
+  Opcode.kJumpIfEqInt: const Format(
+      Encoding.kT, const [Operand.tgt, Operand.none, Operand.none]),
+  Opcode.kJumpIfNeInt: const Format(
+      Encoding.kT, const [Operand.tgt, Operand.none, Operand.none]),
+  Opcode.kJumpIfLtInt: const Format(
+      Encoding.kT, const [Operand.tgt, Operand.none, Operand.none]),
+  Opcode.kJumpIfLeInt: const Format(
+      Encoding.kT, const [Operand.tgt, Operand.none, Operand.none]),
+  Opcode.kJumpIfGtInt: const Format(
+      Encoding.kT, const [Operand.tgt, Operand.none, Operand.none]),
+  Opcode.kJumpIfGeInt: const Format(
+      Encoding.kT, const [Operand.tgt, Operand.none, Operand.none]),
+  Opcode.kLoadFieldLocal: const Format(
+      Encoding.kAD, const [Operand.xeg, Operand.lit, Operand.none]),
+  Opcode.kAddIntLocal: const Format(
+      Encoding.kX, const [Operand.xeg, Operand.none, Operand.none]),
 };
 
 // Should match constant in runtime/vm/stack_frame_dbc.h.
@@ -59,7 +59,11 @@ class BytecodeDisassembler {
       case Encoding.kA:
         return [_unsigned(word, 8, 8)];
       case Encoding.kAD:
-        return [_unsigned(word, 8, 8), _unsigned(word, 16, 16)];
+        // An x-register in the A operand is a signed 8-bit local.
+        final int a = (format.operands[0] == Operand.xeg)
+            ? _signed(word, 8, 8)
+            : _unsigned(word, 8, 8);
+        return [a, _unsigned(word, 16, 16)];
       case Encoding.kAX:
         return [_unsigned(word, 8, 8), _signed(word, 16, 16)];
       case Encoding.kD:
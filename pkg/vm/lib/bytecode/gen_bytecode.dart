@@ -39,6 +39,7 @@ const String symbolForTypeCast = ' in type cast';
 void generateBytecode(Component component,
     {bool dropAST: false,
     bool omitSourcePositions: false,
+    bool emitSuperinstructions: false,
     Map<String, String> environmentDefines,
     ErrorReporter errorReporter}) {
   final coreTypes = new CoreTypes(component);
@@ -51,7 +52,8 @@ void generateBytecode(Component component,
       new VmConstantsBackend(environmentDefines, coreTypes);
   final errorReporter = new ForwardConstantEvaluationErrors(typeEnvironment);
   new BytecodeGenerator(component, coreTypes, hierarchy, typeEnvironment,
-          constantsBackend, omitSourcePositions, errorReporter)
+          constantsBackend, omitSourcePositions, emitSuperinstructions,
+          errorReporter)
       .visitComponent(component);
   if (dropAST) {
     new DropAST().visitComponent(component);
@@ -65,6 +67,7 @@ class BytecodeGenerator extends RecursiveVisitor<Null> {
   final TypeEnvironment typeEnvironment;
   final ConstantsBackend constantsBackend;
   final bool omitSourcePositions;
+  final bool emitSuperinstructions;
   final ErrorReporter errorReporter;
   final BytecodeMetadataRepository metadata = new BytecodeMetadataRepository();
   final RecognizedMethods recognizedMethods;
@@ -101,6 +104,7 @@ class BytecodeGenerator extends RecursiveVisitor<Null> {
       this.typeEnvironment,
       this.constantsBackend,
       this.omitSourcePositions,
+      this.emitSuperinstructions,
       this.errorReporter)
       : recognizedMethods = new RecognizedMethods(typeEnvironment) {
     component.addMetadataRepository(metadata);
@@ -715,7 +719,7 @@ class BytecodeGenerator extends RecursiveVisitor<Null> {
     nullableFields = const <Reference>[];
     cp = new ConstantPool();
     constantEmitter = new ConstantEmitter(cp);
-    asm = new BytecodeAssembler();
+    asm = new BytecodeAssembler(fuseInstructions: emitSuperinstructions);
     savedAssemblers = <BytecodeAssembler>[];
 
     locals.enterScope(node);
@@ -1122,7 +1126,7 @@ class BytecodeGenerator extends RecursiveVisitor<Null> {
 
   void _pushAssemblerState() {
     savedAssemblers.add(asm);
-    asm = new BytecodeAssembler();
+    asm = new BytecodeAssembler(fuseInstructions: emitSuperinstructions);
   }
 
   void _popAssemblerState() {
@@ -48,6 +48,7 @@ Future<Component> compileToKernel(Uri source, CompilerOptions options,
     bool useGlobalTypeFlowAnalysis: false,
     Map<String, String> environmentDefines,
     bool genBytecode: false,
+    bool emitBytecodeSuperinstructions: false,
     bool dropAST: false,
     bool enableAsserts: false,
     bool enableConstantEvaluation: true}) async {
@@ -74,7 +75,9 @@ Future<Component> compileToKernel(Uri source, CompilerOptions options,
   if (genBytecode && !errorDetector.hasCompilationErrors && component != null) {
     await runWithFrontEndCompilerContext(source, options, component, () {
       generateBytecode(component,
-          dropAST: dropAST, environmentDefines: environmentDefines);
+          dropAST: dropAST,
+          emitSuperinstructions: emitBytecodeSuperinstructions,
+          environmentDefines: environmentDefines);
     });
   }
 
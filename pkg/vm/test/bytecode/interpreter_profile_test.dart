@@ -0,0 +1,146 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:front_end/src/api_unstable/vm.dart'
+    show CompilerOptions, DiagnosticMessage;
+import 'package:json_rpc_2/json_rpc_2.dart' as json_rpc;
+import 'package:kernel/ast.dart';
+import 'package:kernel/binary/limited_ast_to_binary.dart';
+import 'package:path/path.dart' as p;
+import 'package:test/test.dart';
+import 'package:vm/bytecode/gen_bytecode.dart' show generateBytecode;
+import 'package:vm/kernel_front_end.dart' show runWithFrontEndCompilerContext;
+import 'package:web_socket_channel/io.dart';
+
+import '../common_test_utils.dart';
+
+final String pkgVmDir = Platform.script.resolve('../..').toFilePath();
+
+Future compileToBytecode(Uri source, File dill) async {
+  Component component = await compileTestCaseToKernelProgram(source);
+
+  final options = new CompilerOptions()
+    ..onDiagnostic = (DiagnosticMessage message) {
+      fail("Compilation error: ${message.plainTextFormatted.join('\n')}");
+    };
+
+  await runWithFrontEndCompilerContext(source, options, component, () {
+    generateBytecode(component);
+  });
+
+  final sink = dill.openWrite();
+  new LimitedBinaryPrinter(sink, (lib) => lib.importUri.scheme != 'dart',
+          false /* excludeUriToSource */)
+      .writeComponentFile(component);
+  await sink.close();
+}
+
+// Returns the invocation counts of the functions in [profile] by name.
+Map<String, int> invocationsByName(Map profile) {
+  final result = <String, int>{};
+  for (Map entry in profile['functions']) {
+    result[entry['function']['name']] = int.parse('${entry['invocations']}');
+  }
+  return result;
+}
+
+int totalBytecodes(Map profile) => int.parse('${profile['totalBytecodes']}');
+
+main() {
+  test('interpreter profile', () async {
+    final source = new Uri.file(
+        pkgVmDir + '/testcases/interpreter_profile/interpreter_profile.dart');
+    final tempDir = Directory.systemTemp.createTempSync('interpreter_profile');
+    final dill = new File(p.join(tempDir.path, 'interpreter_profile.dill'));
+    await compileToBytecode(source, dill);
+
+    final vm = await Process.start(Platform.resolvedExecutable, <String>[
+      '--enable-interpreter',
+      '--compilation-counter-threshold=-1',
+      '--interpreter-profile',
+      '--enable-vm-service=0', // Note: use 0 to avoid port collisions.
+      '--pause-isolates-on-exit',
+      dill.path
+    ]);
+    final observatoryPortRegExp =
+        new RegExp("Observatory listening on http://127.0.0.1:\([0-9]*\)/");
+    final portCompleter = new Completer<int>();
+    vm.stdout
+        .transform(utf8.decoder)
+        .transform(new LineSplitter())
+        .listen((String line) {
+      print("vm stdout: $line");
+      final match = observatoryPortRegExp.firstMatch(line);
+      if (match != null && !portCompleter.isCompleted) {
+        portCompleter.complete(int.parse(match.group(1)));
+      }
+    });
+    vm.stderr
+        .transform(utf8.decoder)
+        .transform(new LineSplitter())
+        .listen((String line) {
+      print("vm stderr: $line");
+    });
+    final port = await portCompleter.future;
+
+    final socket = new IOWebSocketChannel.connect('ws://127.0.0.1:$port/ws');
+    final rpc = new json_rpc.Peer(socket.cast<String>());
+    rpc.listen();
+    try {
+      final vmInfo = await rpc.sendRequest('getVM');
+      String isolateId = vmInfo['isolates'].first['id'];
+      for (var isolate in vmInfo['isolates']) {
+        if (isolate['name'].contains(r'$main')) {
+          isolateId = isolate['id'];
+        }
+      }
+
+      // Wait until main has returned.
+      while (true) {
+        final isolate =
+            await rpc.sendRequest('getIsolate', {'isolateId': isolateId});
+        final pauseEvent = isolate['pauseEvent'];
+        if (pauseEvent != null && pauseEvent['kind'] == 'PauseExit') {
+          break;
+        }
+        await new Future.delayed(const Duration(milliseconds: 50));
+      }
+
+      var profile = await rpc.sendRequest(
+          '_getInterpreterProfile', {'isolateId': isolateId, 'limit': '2'});
+      expect(profile['type'], equals('_InterpreterProfile'));
+      expect(totalBytecodes(profile), greaterThan(0));
+      int sum = 0;
+      for (Map entry in profile['bytecodes']) {
+        expect(entry['name'], new isInstanceOf<String>());
+        final count = int.parse('${entry['count']}');
+        expect(count, greaterThan(0));
+        sum += count;
+      }
+      expect(sum, equals(totalBytecodes(profile)));
+      // The two most frequently invoked functions.
+      expect(invocationsByName(profile), equals({'work': 1000, 'twice': 2}));
+
+      // Counters are reported once more, and then cleared.
+      profile = await rpc.sendRequest('_getInterpreterProfile',
+          {'isolateId': isolateId, 'reset': 'true'});
+      expect(totalBytecodes(profile), greaterThan(0));
+      expect(invocationsByName(profile)['work'], equals(1000));
+      profile = await rpc
+          .sendRequest('_getInterpreterProfile', {'isolateId': isolateId});
+      expect(totalBytecodes(profile), equals(0));
+      expect(profile['bytecodes'], isEmpty);
+      expect(profile['functions'], isEmpty);
+    } finally {
+      await rpc.close();
+      vm.kill();
+      await vm.exitCode;
+      tempDir.deleteSync(recursive: true);
+    }
+  });
+}
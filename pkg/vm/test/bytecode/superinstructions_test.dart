@@ -0,0 +1,111 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+import 'dart:async';
+import 'dart:io';
+
+import 'package:front_end/src/api_unstable/vm.dart'
+    show CompilerOptions, DiagnosticMessage;
+import 'package:kernel/ast.dart';
+import 'package:kernel/binary/limited_ast_to_binary.dart';
+import 'package:path/path.dart' as p;
+import 'package:test/test.dart';
+import 'package:vm/bytecode/gen_bytecode.dart' show generateBytecode;
+import 'package:vm/kernel_front_end.dart' show runWithFrontEndCompilerContext;
+
+import '../common_test_utils.dart';
+
+final String pkgVmDir = Platform.script.resolve('../..').toFilePath();
+
+const List<String> superinstructions = const <String>[
+  'JumpIfEqInt',
+  'JumpIfNeInt',
+  'JumpIfLtInt',
+  'JumpIfLeInt',
+  'JumpIfGtInt',
+  'JumpIfGeInt',
+  'LoadFieldLocal',
+  'AddIntLocal',
+];
+
+// Compiles [source] to bytecode and writes the libraries of the test case to
+// [dill]. Returns the disassembled bytecode.
+Future<String> compileToBytecode(
+    Uri source, File dill, bool emitSuperinstructions) async {
+  Component component = await compileTestCaseToKernelProgram(source);
+
+  final options = new CompilerOptions()
+    ..onDiagnostic = (DiagnosticMessage message) {
+      fail("Compilation error: ${message.plainTextFormatted.join('\n')}");
+    };
+
+  await runWithFrontEndCompilerContext(source, options, component, () {
+    generateBytecode(component,
+        omitSourcePositions: true,
+        emitSuperinstructions: emitSuperinstructions);
+  });
+
+  final sink = dill.openWrite();
+  new LimitedBinaryPrinter(sink, (lib) => lib.importUri.scheme != 'dart',
+          false /* excludeUriToSource */)
+      .writeComponentFile(component);
+  await sink.close();
+
+  return kernelLibraryToString(component.mainMethod.enclosingLibrary);
+}
+
+Future<String> run(File dill, List<String> vmOptions) async {
+  final args = <String>[]..addAll(vmOptions)..add(dill.path);
+  final result = await Process.run(Platform.resolvedExecutable, args);
+  expect(result.exitCode, equals(0),
+      reason: "Running ${dill.path} with $vmOptions failed:\n${result.stderr}");
+  return result.stdout;
+}
+
+main() {
+  final source = new Uri.file(
+      pkgVmDir + '/testcases/superinstructions/superinstructions.dart');
+  Directory tempDir;
+  File unfused;
+  File fused;
+
+  setUpAll(() async {
+    tempDir = Directory.systemTemp.createTempSync('superinstructions');
+    unfused = new File(p.join(tempDir.path, 'unfused.dill'));
+    fused = new File(p.join(tempDir.path, 'fused.dill'));
+
+    final unfusedBytecode = await compileToBytecode(source, unfused, false);
+    final fusedBytecode = await compileToBytecode(source, fused, true);
+    for (String opcode in superinstructions) {
+      expect(unfusedBytecode, isNot(contains('  $opcode ')),
+          reason: 'Unexpected $opcode without superinstructions');
+      expect(fusedBytecode, contains('  $opcode '),
+          reason: 'Test case does not exercise $opcode');
+    }
+  });
+
+  tearDownAll(() {
+    tempDir.deleteSync(recursive: true);
+  });
+
+  group('superinstructions', () {
+    // The interpreter executes bytecode with and without superinstructions,
+    // and the bytecode flow graph builder compiles both. All must agree with
+    // code compiled from the AST.
+    const interpret = const <String>[
+      '--enable-interpreter',
+      '--compilation-counter-threshold=-1',
+    ];
+    const compile = const <String>['--use-bytecode-compiler'];
+
+    test('execute', () async {
+      final expected = await run(unfused, const <String>[]);
+      expect(expected, isNotEmpty);
+      expect(await run(unfused, interpret), equals(expected));
+      expect(await run(fused, interpret), equals(expected));
+      expect(await run(unfused, compile), equals(expected));
+      expect(await run(fused, compile), equals(expected));
+    });
+  });
+}
@@ -0,0 +1,19 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Calls functions a known number of times, so that the interpreter profile
+// can be checked once the isolate pauses on exit.
+
+int work(int i) => i * 2 + 1;
+
+int twice(int x) => x + x;
+
+main() {
+  int sum = 0;
+  for (int i = 0; i < 1000; i++) {
+    sum += work(i);
+  }
+  sum = twice(twice(sum));
+  print('sum = $sum');
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Exercises every superinstruction. Each function prints its results, so
+// that runs of fused and unfused bytecode can be compared.
+
+const values = const <int>[
+  0,
+  1,
+  -1,
+  2,
+  0x3fffffff,
+  0x40000000,
+  0x3fffffffffffffff,
+  0x4000000000000000,
+  0x7fffffffffffffff,
+  -0x7fffffffffffffff - 1,
+];
+
+// JumpIfNeInt, JumpIfEqInt, JumpIfGeInt, JumpIfLeInt, JumpIfGtInt and
+// JumpIfLtInt, in that order.
+String compare(int a, int b) {
+  String result = '';
+  if (a == b) {
+    result += '==';
+  }
+  if (a != b) {
+    result += '!=';
+  }
+  if (a < b) {
+    result += '<';
+  }
+  if (a > b) {
+    result += '>';
+  }
+  if (a <= b) {
+    result += '<=';
+  }
+  if (a >= b) {
+    result += '>=';
+  }
+  return result;
+}
+
+// The fused jumps as loop conditions.
+int countUp(int from, int to) {
+  int steps = 0;
+  for (int i = from; i < to; i++) {
+    steps++;
+  }
+  int j = to;
+  while (j >= from) {
+    j--;
+    steps++;
+  }
+  return steps;
+}
+
+// AddIntLocal, including wrap-around on overflow.
+int add(int a, int b) {
+  int sum = a + b;
+  return sum + a;
+}
+
+// LoadFieldLocal loads the context of a closure in its prologue.
+int Function(int) adder(int offset) => (int value) => value + offset;
+
+main() {
+  for (int a in values) {
+    for (int b in values) {
+      print('compare($a, $b) = ${compare(a, b)}');
+      print('add($a, $b) = ${add(a, b)}');
+    }
+  }
+  print('countUp(-3, 5) = ${countUp(-3, 5)}');
+  print('countUp(5, -3) = ${countUp(5, -3)}');
+  for (int a in values) {
+    print('adder($a) = ${adder(a)(3)} ${adder(4)(a)}');
+  }
+}
@@ -76,7 +76,8 @@ DFE::DFE()
       use_incremental_compiler_(false),
       frontend_filename_(NULL),
       application_kernel_buffer_(NULL),
-      application_kernel_buffer_size_(0) {}
+      application_kernel_buffer_size_(0),
+      application_kernel_mapping_(NULL) {}
 
 DFE::~DFE() {
   if (frontend_filename_ != NULL) {
@@ -84,11 +85,23 @@ DFE::~DFE() {
   }
   frontend_filename_ = NULL;
 
-  free(application_kernel_buffer_);
+  if (application_kernel_mapping_ != NULL) {
+    delete application_kernel_mapping_;
+    application_kernel_mapping_ = NULL;
+  } else {
+    free(application_kernel_buffer_);
+  }
   application_kernel_buffer_ = NULL;
   application_kernel_buffer_size_ = 0;
 }
 
+void DFE::set_application_kernel_mapping(MappedMemory* mapping) {
+  ASSERT(application_kernel_buffer_ == NULL);
+  application_kernel_mapping_ = mapping;
+  application_kernel_buffer_ = reinterpret_cast<uint8_t*>(mapping->address());
+  application_kernel_buffer_size_ = mapping->size();
+}
+
 void DFE::Init() {
   if (platform_strong_dill == NULL) {
     return;
@@ -243,6 +256,42 @@ void DFE::ReadScript(const char* script_uri,
                      Dart_Timeline_Event_Duration, 0, NULL, NULL);
 }
 
+MappedMemory* DFE::MapScript(const char* script_uri) const {
+#if defined(HOST_OS_LINUX) || defined(HOST_OS_MACOS) ||                        \
+    defined(HOST_OS_ANDROID)
+  int64_t start = Dart_TimelineGetMicros();
+  File* file =
+      reinterpret_cast<File*>(DartUtils::OpenFileUri(script_uri, false));
+  if (file == NULL) {
+    return NULL;
+  }
+  RefCntReleaseScope<File> rs(file);
+  const int64_t length = file->Length();
+  if ((length <= 0) || (length > kIntptrMax)) {
+    return NULL;
+  }
+  MappedMemory* mapping = file->Map(File::kReadOnly, 0, length);
+  if (mapping == NULL) {
+    return NULL;
+  }
+  const uint8_t* buffer = reinterpret_cast<const uint8_t*>(mapping->address());
+  if ((DartUtils::SniffForMagicNumber(buffer, mapping->size()) !=
+       DartUtils::kKernelMagicNumber) ||
+      !Dart_IsKernel(buffer, mapping->size())) {
+    delete mapping;
+    return NULL;
+  }
+  int64_t end = Dart_TimelineGetMicros();
+  Dart_TimelineEvent("DFE::MapScript", start, end,
+                     Dart_Timeline_Event_Duration, 0, NULL, NULL);
+  return mapping;
+#else
+  // File::Map is not implemented on Fuchsia and copies the file on Windows,
+  // so the script is read instead.
+  return NULL;
+#endif
+}
+
 // Attempts to treat [buffer] as a in-memory kernel byte representation.
 // If successful, returns [true] and places [buffer] into [kernel_ir], byte size
 // into [kernel_ir_size].
@@ -13,6 +13,8 @@
 namespace dart {
 namespace bin {
 
+class MappedMemory;
+
 class DFE {
  public:
   DFE();
@@ -49,6 +51,9 @@ class DFE {
     application_kernel_buffer_ = buffer;
     application_kernel_buffer_size_ = size;
   }
+  // Same as above for a dill file mapped with MapScript. Takes ownership of
+  // [mapping].
+  void set_application_kernel_mapping(MappedMemory* mapping);
   void application_kernel_buffer(const uint8_t** buffer, intptr_t* size) const {
     *buffer = application_kernel_buffer_;
     *size = application_kernel_buffer_size_;
@@ -78,6 +83,15 @@ class DFE {
                   uint8_t** kernel_buffer,
                   intptr_t* kernel_buffer_size) const;
 
+  // Maps the script kernel file read-only if specified 'script_uri' is a
+  // kernel file, so that the VM can load it without copying it into memory.
+  // Returns NULL if the file can't be mapped or is not a single kernel file
+  // (kernel list files need to be concatenated, use ReadScript for those),
+  // and always on Fuchsia and Windows, where files are not mapped.
+  // The caller is responsible for deleting the returned mapping, which must
+  // outlive the isolate loaded from it.
+  MappedMemory* MapScript(const char* script_uri) const;
+
   static bool KernelServiceDillAvailable();
 
   // Tries to read [script_uri] as a Kernel IR file.
@@ -108,6 +122,7 @@ class DFE {
   // Kernel binary specified on the cmd line.
   uint8_t* application_kernel_buffer_;
   intptr_t application_kernel_buffer_size_;
+  MappedMemory* application_kernel_mapping_;
 
   DISALLOW_COPY_AND_ASSIGN(DFE);
 };
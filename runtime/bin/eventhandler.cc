@@ -6,57 +6,149 @@
 
 #include "bin/builtin.h"
 #include "bin/dartutils.h"
+#include "bin/io_uring.h"
 #include "bin/lockers.h"
 #include "bin/socket.h"
 #include "bin/thread.h"
 
 #include "include/dart_api.h"
+#include "platform/utils.h"
 
 namespace dart {
 namespace bin {
 
+static const intptr_t kTimeoutQueueInitialCapacity = 16;
+
+TimeoutQueue::TimeoutQueue()
+    : heap_(NULL),
+      heap_length_(0),
+      heap_capacity_(0),
+      timeouts_(&SamePort, kTimeoutQueueInitialCapacity) {}
+
+TimeoutQueue::~TimeoutQueue() {
+  for (intptr_t i = 0; i < heap_length_; i++) {
+    delete heap_[i];
+  }
+  free(heap_);
+}
+
+bool TimeoutQueue::SamePort(void* key1, void* key2) {
+  return *reinterpret_cast<Dart_Port*>(key1) ==
+         *reinterpret_cast<Dart_Port*>(key2);
+}
+
+uint32_t TimeoutQueue::PortHash(Dart_Port port) {
+  const uint64_t value = static_cast<uint64_t>(port);
+  return dart::Utils::WordHash(
+      static_cast<intptr_t>(value ^ (value >> kBitsPerInt32)));
+}
+
 void TimeoutQueue::UpdateTimeout(Dart_Port port, int64_t timeout) {
-  // Find port if present.
-  Timeout* last = NULL;
-  Timeout* current = timeouts_;
-  while (current != NULL) {
-    if (current->port() == port) {
-      // Found.
-      if (timeout < 0) {
-        // Remove from list and delete existing.
-        if (last != NULL) {
-          last->set_next(current->next());
-        } else {
-          timeouts_ = current->next();
-        }
-        delete current;
-      } else {
-        // Update timeout.
-        current->set_timeout(timeout);
-      }
-      break;
+  const uint32_t hash = PortHash(port);
+  SimpleHashMap::Entry* entry = timeouts_.Lookup(&port, hash, timeout >= 0);
+  if (entry == NULL) {
+    // Removing a timeout that is not present.
+    return;
+  }
+  Timeout* current = reinterpret_cast<Timeout*>(entry->value);
+  if (timeout < 0) {
+    ASSERT(current != NULL);
+    timeouts_.Remove(&port, hash);
+    Remove(current);
+    delete current;
+  } else if (current == NULL) {
+    current = new Timeout(port, timeout);
+    entry->key = current->port_address();
+    entry->value = current;
+    Insert(current);
+  } else {
+    const int64_t old_timeout = current->timeout();
+    current->set_timeout(timeout);
+    if (timeout < old_timeout) {
+      SiftUp(current->heap_index());
+    } else {
+      SiftDown(current->heap_index());
     }
-    last = current;
-    current = current->next();
   }
-  if (current == NULL && timeout >= 0) {
-    // Not found, create a new.
-    timeouts_ = new Timeout(port, timeout, timeouts_);
+}
+
+void TimeoutQueue::Insert(Timeout* timeout) {
+  if (heap_length_ == heap_capacity_) {
+    heap_capacity_ = (heap_capacity_ == 0) ? kTimeoutQueueInitialCapacity
+                                           : (heap_capacity_ * 2);
+    heap_ = reinterpret_cast<Timeout**>(
+        realloc(heap_, heap_capacity_ * sizeof(Timeout*)));
+    if (heap_ == NULL) {
+      OUT_OF_MEMORY();
+    }
+  }
+  SetAt(heap_length_++, timeout);
+  SiftUp(timeout->heap_index());
+}
+
+void TimeoutQueue::Remove(Timeout* timeout) {
+  const intptr_t index = timeout->heap_index();
+  ASSERT(heap_[index] == timeout);
+  Timeout* last = heap_[--heap_length_];
+  if (last != timeout) {
+    SetAt(index, last);
+    SiftUp(index);
+    SiftDown(last->heap_index());
+  }
+  timeout->set_heap_index(-1);
+}
+
+void TimeoutQueue::SetAt(intptr_t index, Timeout* timeout) {
+  heap_[index] = timeout;
+  timeout->set_heap_index(index);
+}
+
+void TimeoutQueue::SiftUp(intptr_t index) {
+  Timeout* timeout = heap_[index];
+  while (index > 0) {
+    const intptr_t parent = (index - 1) / 2;
+    if (heap_[parent]->timeout() <= timeout->timeout()) {
+      break;
+    }
+    SetAt(index, heap_[parent]);
+    index = parent;
   }
-  // Clear and find next timeout.
-  next_timeout_ = NULL;
-  current = timeouts_;
-  while (current != NULL) {
-    if ((next_timeout_ == NULL) ||
-        (current->timeout() < next_timeout_->timeout())) {
-      next_timeout_ = current;
+  SetAt(index, timeout);
+}
+
+void TimeoutQueue::SiftDown(intptr_t index) {
+  Timeout* timeout = heap_[index];
+  while (true) {
+    intptr_t child = 2 * index + 1;
+    if (child >= heap_length_) {
+      break;
     }
-    current = current->next();
+    if ((child + 1 < heap_length_) &&
+        (heap_[child + 1]->timeout() < heap_[child]->timeout())) {
+      child++;
+    }
+    if (timeout->timeout() <= heap_[child]->timeout()) {
+      break;
+    }
+    SetAt(index, heap_[child]);
+    index = child;
   }
+  SetAt(index, timeout);
 }
 
 static EventHandler* event_handler = NULL;
 static Monitor* shutdown_monitor = NULL;
+static intptr_t event_handler_thread_count = 1;
+
+void EventHandler::set_thread_count(intptr_t count) {
+  ASSERT(event_handler == NULL);
+  ASSERT(count > 0);
+  event_handler_thread_count = count;
+}
+
+intptr_t EventHandler::thread_count() {
+  return event_handler_thread_count;
+}
 
 void EventHandler::Start() {
   // Initialize global socket registry.
@@ -95,6 +187,9 @@ void EventHandler::Stop() {
 
   // Destroy the global socket registry.
   ListeningSocketRegistry::Cleanup();
+
+  // Stop the io_uring completion thread, if any.
+  IOUring::Cleanup();
 }
 
 EventHandlerImplementation* EventHandler::delegate() {
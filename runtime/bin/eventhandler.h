@@ -56,14 +56,18 @@ enum MessageFlags {
 #define TOKEN_COUNT(data) (data & ((1 << kCloseCommand) - 1))
 // clang-format on
 
+// Timeouts keyed by port, ordered by a binary min-heap on the timeout. A
+// hash map from port to heap entry makes updating or cancelling the timeout
+// of a port O(log n).
 class TimeoutQueue {
  private:
   class Timeout {
    public:
-    Timeout(Dart_Port port, int64_t timeout, Timeout* next)
-        : port_(port), timeout_(timeout), next_(next) {}
+    Timeout(Dart_Port port, int64_t timeout)
+        : port_(port), timeout_(timeout), heap_index_(-1) {}
 
     Dart_Port port() const { return port_; }
+    Dart_Port* port_address() { return &port_; }
 
     int64_t timeout() const { return timeout_; }
     void set_timeout(int64_t timeout) {
@@ -71,42 +75,50 @@ class TimeoutQueue {
       timeout_ = timeout;
     }
 
-    Timeout* next() const { return next_; }
-    void set_next(Timeout* next) { next_ = next; }
+    intptr_t heap_index() const { return heap_index_; }
+    void set_heap_index(intptr_t index) { heap_index_ = index; }
 
    private:
     Dart_Port port_;
     int64_t timeout_;
-    Timeout* next_;
+    intptr_t heap_index_;
   };
 
  public:
-  TimeoutQueue() : next_timeout_(NULL), timeouts_(NULL) {}
+  TimeoutQueue();
+  ~TimeoutQueue();
 
-  ~TimeoutQueue() {
-    while (HasTimeout())
-      RemoveCurrent();
-  }
-
-  bool HasTimeout() const { return next_timeout_ != NULL; }
+  bool HasTimeout() const { return heap_length_ > 0; }
 
   int64_t CurrentTimeout() const {
-    ASSERT(next_timeout_ != NULL);
-    return next_timeout_->timeout();
+    ASSERT(HasTimeout());
+    return heap_[0]->timeout();
   }
 
   Dart_Port CurrentPort() const {
-    ASSERT(next_timeout_ != NULL);
-    return next_timeout_->port();
+    ASSERT(HasTimeout());
+    return heap_[0]->port();
   }
 
   void RemoveCurrent() { UpdateTimeout(CurrentPort(), -1); }
 
+  // Sets the timeout for [port], or removes it if [timeout] is negative.
   void UpdateTimeout(Dart_Port port, int64_t timeout);
 
  private:
-  Timeout* next_timeout_;
-  Timeout* timeouts_;
+  static bool SamePort(void* key1, void* key2);
+  static uint32_t PortHash(Dart_Port port);
+
+  void Insert(Timeout* timeout);
+  void Remove(Timeout* timeout);
+  void SetAt(intptr_t index, Timeout* timeout);
+  void SiftUp(intptr_t index);
+  void SiftDown(intptr_t index);
+
+  Timeout** heap_;
+  intptr_t heap_length_;
+  intptr_t heap_capacity_;
+  SimpleHashMap timeouts_;
 
   DISALLOW_COPY_AND_ASSIGN(TimeoutQueue);
 };
@@ -641,6 +653,12 @@ class EventHandler {
 
   static EventHandlerImplementation* delegate();
 
+  // Number of threads polling for I/O events. Must be set before Start. The
+  // Linux implementation spreads descriptors over this many epoll instances,
+  // other implementations always use a single thread.
+  static void set_thread_count(intptr_t count);
+  static intptr_t thread_count();
+
   static void SendFromNative(intptr_t id, Dart_Port port, int64_t data);
 
  private:
@@ -24,6 +24,7 @@
 #include "bin/log.h"
 #include "bin/socket.h"
 #include "bin/thread.h"
+#include "platform/atomic.h"
 #include "platform/utils.h"
 
 namespace dart {
@@ -69,7 +70,12 @@ static void AddToEpollInstance(intptr_t epoll_fd_, DescriptorInfo* di) {
 }
 
 EventHandlerImplementation::EventHandlerImplementation()
-    : socket_map_(&SimpleHashMap::SamePointerValue, 16) {
+    : socket_map_(&SimpleHashMap::SamePointerValue, 16),
+      handler_(NULL),
+      primary_(this),
+      shards_(NULL),
+      shard_count_(1),
+      running_shards_(0) {
   intptr_t result;
   result = NO_RETRY_EXPECTED(pipe(interrupt_fds_));
   if (result != 0) {
@@ -126,6 +132,14 @@ static void DeleteDescriptorInfo(void* info) {
 }
 
 EventHandlerImplementation::~EventHandlerImplementation() {
+  if (shards_ != NULL) {
+    ASSERT(shards_[0] == this);
+    for (intptr_t i = 1; i < shard_count_; i++) {
+      delete shards_[i];
+    }
+    delete[] shards_;
+    shards_ = NULL;
+  }
   socket_map_.Clear(DeleteDescriptorInfo);
   VOID_TEMP_FAILURE_RETRY(close(epoll_fd_));
   VOID_TEMP_FAILURE_RETRY(close(timer_fd_));
@@ -384,8 +398,8 @@ void EventHandlerImplementation::Poll(uword args) {
   ThreadSignalBlocker signal_blocker(SIGPROF);
   static const intptr_t kMaxEvents = 16;
   struct epoll_event events[kMaxEvents];
-  EventHandler* handler = reinterpret_cast<EventHandler*>(args);
-  EventHandlerImplementation* handler_impl = &handler->delegate_;
+  EventHandlerImplementation* handler_impl =
+      reinterpret_cast<EventHandlerImplementation*>(args);
   ASSERT(handler_impl != NULL);
 
   while (!handler_impl->shutdown_) {
@@ -400,26 +414,74 @@ void EventHandlerImplementation::Poll(uword args) {
       handler_impl->HandleEvents(events, result);
     }
   }
-  DEBUG_ASSERT(ReferenceCounted<Socket>::instances() == 0);
-  handler->NotifyShutdownDone();
+  handler_impl->primary_->NotifyShardDone();
 }
 
-void EventHandlerImplementation::Start(EventHandler* handler) {
+void EventHandlerImplementation::NotifyShardDone() {
+  ASSERT(primary_ == this);
+  if (AtomicOperations::FetchAndDecrement(&running_shards_) == 1) {
+    // This was the last running shard.
+    DEBUG_ASSERT(ReferenceCounted<Socket>::instances() == 0);
+    handler_->NotifyShutdownDone();
+  }
+}
+
+void EventHandlerImplementation::StartShard() {
   int result = Thread::Start(&EventHandlerImplementation::Poll,
-                             reinterpret_cast<uword>(handler));
+                             reinterpret_cast<uword>(this));
   if (result != 0) {
     FATAL1("Failed to start event handler thread %d", result);
   }
 }
 
+void EventHandlerImplementation::Start(EventHandler* handler) {
+  ASSERT(primary_ == this);
+  handler_ = handler;
+  shard_count_ = EventHandler::thread_count();
+  running_shards_ = shard_count_;
+  if (shard_count_ == 1) {
+    StartShard();
+    return;
+  }
+  shards_ = new EventHandlerImplementation*[shard_count_];
+  shards_[0] = this;
+  for (intptr_t i = 1; i < shard_count_; i++) {
+    EventHandlerImplementation* shard = new EventHandlerImplementation();
+    shard->handler_ = handler;
+    shard->primary_ = this;
+    shards_[i] = shard;
+  }
+  for (intptr_t i = 0; i < shard_count_; i++) {
+    shards_[i]->StartShard();
+  }
+}
+
 void EventHandlerImplementation::Shutdown() {
-  SendData(kShutdownId, 0, 0);
+  if (shards_ == NULL) {
+    WakeupHandler(kShutdownId, 0, 0);
+    return;
+  }
+  for (intptr_t i = 0; i < shard_count_; i++) {
+    shards_[i]->WakeupHandler(kShutdownId, 0, 0);
+  }
+}
+
+EventHandlerImplementation* EventHandlerImplementation::ShardFor(intptr_t id) {
+  // Timers are only handled by the primary shard.
+  if ((shards_ == NULL) || (id == kTimerId) || (id == kShutdownId)) {
+    return this;
+  }
+  // The id is the address of the Socket, which stays the same from the
+  // socket's registration until it is freed, whereas its descriptor is
+  // cleared by the shard that closes it. Sockets shared between isolates
+  // use a single Socket and hence a single shard.
+  return shards_[dart::Utils::WordHash(id) % shard_count_];
 }
 
 void EventHandlerImplementation::SendData(intptr_t id,
                                           Dart_Port dart_port,
                                           int64_t data) {
-  WakeupHandler(id, dart_port, data);
+  ShardFor(id)->WakeupHandler(id, dart_port, data);
 }
 
 void* EventHandlerImplementation::GetHashmapKeyFromFd(intptr_t fd) {
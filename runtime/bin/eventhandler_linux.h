@@ -73,6 +73,14 @@ class EventHandlerImplementation {
   void Shutdown();
 
  private:
+  // Returns the shard which handles events for the given socket. All
+  // commands for a socket go to the same shard, which owns its
+  // DescriptorInfo. Does not access the socket, which may be closed
+  // concurrently.
+  EventHandlerImplementation* ShardFor(intptr_t id);
+  void StartShard();
+  void NotifyShardDone();
+
   void HandleEvents(struct epoll_event* events, int size);
   static void Poll(uword args);
   void WakeupHandler(intptr_t id, Dart_Port dart_port, int64_t data);
@@ -90,6 +98,15 @@ class EventHandlerImplementation {
   int epoll_fd_;
   int timer_fd_;
 
+  // Each shard runs its own Poll thread with its own epoll instance and
+  // interrupt pipe. The first shard is the EventHandler's delegate; it owns
+  // the other shards and the timers.
+  EventHandler* handler_;
+  EventHandlerImplementation* primary_;
+  EventHandlerImplementation** shards_;
+  intptr_t shard_count_;
+  intptr_t running_shards_;
+
   DISALLOW_COPY_AND_ASSIGN(EventHandlerImplementation);
 };
 
@@ -79,5 +79,49 @@ VM_UNIT_TEST_CASE(CircularLinkedList) {
   list.Remove(4242);
 }
 
+VM_UNIT_TEST_CASE(TimeoutQueue) {
+  TimeoutQueue queue;
+  EXPECT(!queue.HasTimeout());
+
+  // Test: Removing a timeout that was never added is ignored.
+  queue.UpdateTimeout(1, -1);
+  EXPECT(!queue.HasTimeout());
+
+  // Test: Timeouts are returned in order regardless of insertion order.
+  for (intptr_t i = 1; i <= 100; i++) {
+    queue.UpdateTimeout(i, ((i * 37) % 100) + 1000);
+  }
+  int64_t last = 0;
+  for (intptr_t i = 1; i <= 50; i++) {
+    EXPECT(queue.HasTimeout());
+    EXPECT(queue.CurrentTimeout() >= last);
+    last = queue.CurrentTimeout();
+    queue.RemoveCurrent();
+  }
+
+  // Test: Updating a timeout moves it in both directions.
+  queue.UpdateTimeout(4242, 1);
+  EXPECT_EQ(4242, queue.CurrentPort());
+  EXPECT_EQ(1, queue.CurrentTimeout());
+  queue.UpdateTimeout(4242, 5000);
+  EXPECT(queue.CurrentPort() != 4242);
+  queue.UpdateTimeout(4242, 0);
+  EXPECT_EQ(4242, queue.CurrentPort());
+
+  // Test: Cancelling the current timeout exposes the next one.
+  queue.UpdateTimeout(4242, -1);
+  EXPECT(queue.HasTimeout());
+  EXPECT(queue.CurrentPort() != 4242);
+  EXPECT(queue.CurrentTimeout() >= last);
+
+  // Test: Removing all timeouts empties the queue.
+  intptr_t count = 0;
+  while (queue.HasTimeout()) {
+    queue.RemoveCurrent();
+    count++;
+  }
+  EXPECT_EQ(50, count);
+}
+
 }  // namespace bin
 }  // namespace dart
@@ -9,6 +9,7 @@
 #include "bin/builtin.h"
 #include "bin/dartutils.h"
 #include "bin/io_buffer.h"
+#include "bin/metrics.h"
 #include "bin/namespace.h"
 #include "bin/typed_data_utils.h"
 #include "bin/utils.h"
@@ -154,6 +155,7 @@ void FUNCTION_NAME(File_ReadByte)(Dart_NativeArguments args) {
   ASSERT(file != NULL);
   uint8_t buffer;
   int64_t bytes_read = file->Read(reinterpret_cast<void*>(&buffer), 1);
+  IOMetrics::Add(IOMetrics::kFileBytesRead, bytes_read);
   if (bytes_read == 1) {
     Dart_SetIntegerReturnValue(args, buffer);
   } else if (bytes_read == 0) {
@@ -171,6 +173,7 @@ void FUNCTION_NAME(File_WriteByte)(Dart_NativeArguments args) {
     uint8_t buffer = static_cast<uint8_t>(byte & 0xff);
     bool success = file->WriteFully(reinterpret_cast<void*>(&buffer), 1);
     if (success) {
+      IOMetrics::Add(IOMetrics::kFileBytesWritten, 1);
       Dart_SetIntegerReturnValue(args, 1);
     } else {
       Dart_SetReturnValue(args, DartUtils::NewDartOSError());
@@ -202,6 +205,7 @@ void FUNCTION_NAME(File_Read)(Dart_NativeArguments args) {
     Dart_SetReturnValue(args, DartUtils::NewDartOSError());
     return;
   }
+  IOMetrics::Add(IOMetrics::kFileBytesRead, bytes_read);
   if (bytes_read < length) {
     const int kNumArgs = 3;
     Dart_Handle dart_args[kNumArgs];
@@ -239,6 +243,7 @@ void FUNCTION_NAME(File_ReadInto)(Dart_NativeArguments args) {
   uint8_t* buffer = Dart_ScopeAllocate(length);
   int64_t bytes_read = file->Read(reinterpret_cast<void*>(buffer), length);
   if (bytes_read >= 0) {
+    IOMetrics::Add(IOMetrics::kFileBytesRead, bytes_read);
     result = Dart_ListSetAsBytes(buffer_obj, start, buffer, bytes_read);
     if (Dart_IsError(result)) {
       Dart_SetReturnValue(args, result);
@@ -286,6 +291,7 @@ void FUNCTION_NAME(File_WriteFrom)(Dart_NativeArguments args) {
   if (!success) {
     Dart_SetReturnValue(args, DartUtils::NewDartOSError());
   } else {
+    IOMetrics::Add(IOMetrics::kFileBytesWritten, length);
     Dart_SetReturnValue(args, Dart_Null());
   }
 }
@@ -1186,6 +1192,7 @@ CObject* File::ReadByteRequest(const CObjectArray& request) {
   if (bytes_read < 0) {
     return CObject::NewOSError();
   }
+  IOMetrics::Add(IOMetrics::kFileBytesRead, bytes_read);
   if (bytes_read == 0) {
     return new CObjectIntptr(CObject::NewIntptr(-1));
   }
@@ -1206,9 +1213,11 @@ CObject* File::WriteByteRequest(const CObjectArray& request) {
   }
   const int64_t byte = CObjectInt32OrInt64ToInt64(request[1]);
   uint8_t buffer = static_cast<uint8_t>(byte & 0xff);
-  return file->WriteFully(reinterpret_cast<void*>(&buffer), 1)
-             ? new CObjectInt64(CObject::NewInt64(1))
-             : CObject::NewOSError();
+  if (!file->WriteFully(reinterpret_cast<void*>(&buffer), 1)) {
+    return CObject::NewOSError();
+  }
+  IOMetrics::Add(IOMetrics::kFileBytesWritten, 1);
+  return new CObjectInt64(CObject::NewInt64(1));
 }
 
 CObject* File::ReadRequest(const CObjectArray& request) {
@@ -1234,6 +1243,7 @@ CObject* File::ReadRequest(const CObjectArray& request) {
     CObject::FreeIOBufferData(io_buffer);
     return CObject::NewOSError();
   }
+  IOMetrics::Add(IOMetrics::kFileBytesRead, bytes_read);
   CObjectExternalUint8Array* external_array =
       new CObjectExternalUint8Array(io_buffer);
   external_array->SetLength(bytes_read);
@@ -1266,6 +1276,7 @@ CObject* File::ReadIntoRequest(const CObjectArray& request) {
     CObject::FreeIOBufferData(io_buffer);
     return CObject::NewOSError();
   }
+  IOMetrics::Add(IOMetrics::kFileBytesRead, bytes_read);
   CObjectExternalUint8Array* external_array =
       new CObjectExternalUint8Array(io_buffer);
   external_array->SetLength(bytes_read);
@@ -1276,6 +1287,44 @@ CObject* File::ReadIntoRequest(const CObjectArray& request) {
   return result;
 }
 
+CObject* File::ReadAtRequest(const CObjectArray& request) {
+  if ((request.Length() < 1) || !request[0]->IsIntptr()) {
+    return CObject::IllegalArgumentError();
+  }
+  File* file = CObjectToFilePointer(request[0]);
+  RefCntReleaseScope<File> rs(file);
+  if ((request.Length() != 3) || !request[1]->IsInt32OrInt64() ||
+      !request[2]->IsInt32OrInt64()) {
+    return CObject::IllegalArgumentError();
+  }
+  if (file->IsClosed()) {
+    return CObject::FileClosedError();
+  }
+  const int64_t position = CObjectInt32OrInt64ToInt64(request[1]);
+  const int64_t length = CObjectInt32OrInt64ToInt64(request[2]);
+  if ((position < 0) || (length < 0)) {
+    return CObject::IllegalArgumentError();
+  }
+  Dart_CObject* io_buffer = CObject::NewIOBuffer(length);
+  if (io_buffer == NULL) {
+    return CObject::NewOSError();
+  }
+  uint8_t* data = io_buffer->value.as_external_typed_data.data;
+  const int64_t bytes_read = file->ReadAt(data, length, position);
+  if (bytes_read < 0) {
+    CObject::FreeIOBufferData(io_buffer);
+    return CObject::NewOSError();
+  }
+  IOMetrics::Add(IOMetrics::kFileBytesRead, bytes_read);
+  CObjectExternalUint8Array* external_array =
+      new CObjectExternalUint8Array(io_buffer);
+  external_array->SetLength(bytes_read);
+  CObjectArray* result = new CObjectArray(CObject::NewArray(2));
+  result->SetAt(0, new CObjectIntptr(CObject::NewInt32(0)));
+  result->SetAt(1, external_array);
+  return result;
+}
+
 static int SizeInBytes(Dart_TypedData_Type type) {
   switch (type) {
     case Dart_TypedData_kInt8:
@@ -1337,9 +1386,11 @@ CObject* File::WriteFromRequest(const CObjectArray& request) {
     }
     start = 0;
   }
-  return file->WriteFully(reinterpret_cast<void*>(buffer_start), length)
-             ? new CObjectInt64(CObject::NewInt64(length))
-             : CObject::NewOSError();
+  if (!file->WriteFully(reinterpret_cast<void*>(buffer_start), length)) {
+    return CObject::NewOSError();
+  }
+  IOMetrics::Add(IOMetrics::kFileBytesWritten, length);
+  return new CObjectInt64(CObject::NewInt64(length));
 }
 
 CObject* File::CreateLinkRequest(const CObjectArray& request) {
@@ -108,6 +108,11 @@ class File : public ReferenceCounted<File> {
   int64_t Read(void* buffer, int64_t num_bytes);
   int64_t Write(const void* buffer, int64_t num_bytes);
 
+  // Reads up to num_bytes at the given position without using the file
+  // position, so that several reads can be in flight at the same time. On
+  // Windows the file position is changed. Returns the number of bytes read.
+  int64_t ReadAt(void* buffer, int64_t num_bytes, int64_t position);
+
   // ReadFully and WriteFully do attempt to transfer num_bytes to/from
   // the buffer. In the event of short accesses they will loop internally until
   // the whole buffer has been transferred or an error occurs. If an error
@@ -254,6 +259,7 @@ class File : public ReferenceCounted<File> {
   static CObject* WriteByteRequest(const CObjectArray& request);
   static CObject* ReadRequest(const CObjectArray& request);
   static CObject* ReadIntoRequest(const CObjectArray& request);
+  static CObject* ReadAtRequest(const CObjectArray& request);
   static CObject* WriteFromRequest(const CObjectArray& request);
   static CObject* CreateLinkRequest(const CObjectArray& request);
   static CObject* DeleteLinkRequest(const CObjectArray& request);
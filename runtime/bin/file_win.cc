@@ -124,6 +124,21 @@ int64_t File::Read(void* buffer, int64_t num_bytes) {
   return read(handle_->fd(), buffer, num_bytes);
 }
 
+int64_t File::ReadAt(void* buffer, int64_t num_bytes, int64_t position) {
+  int fd = handle_->fd();
+  ASSERT(fd >= 0);
+  HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+  OVERLAPPED overlapped;
+  ZeroMemory(&overlapped, sizeof(overlapped));
+  overlapped.Offset = static_cast<DWORD>(position & 0xFFFFFFFF);
+  overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+  DWORD read = 0;
+  if (!ReadFile(handle, buffer, num_bytes, &read, &overlapped)) {
+    return (GetLastError() == ERROR_HANDLE_EOF) ? 0 : -1;
+  }
+  return read;
+}
+
 int64_t File::Write(const void* buffer, int64_t num_bytes) {
   int fd = handle_->fd();
   ASSERT(fd >= 0);
@@ -6,6 +6,9 @@
 
 #include "bin/dartutils.h"
 #include "bin/io_buffer.h"
+#include "bin/lockers.h"
+#include "bin/thread.h"
+#include "platform/allocation.h"
 
 #include "include/dart_api.h"
 
@@ -17,6 +20,104 @@ const int kZLibFlagAcceptAnyHeader = 32;
 
 static const int kFilterPointerNativeField = 0;
 
+// Keeps the zlib state of ended streams so that new filters with the same
+// parameters can reset and reuse it instead of allocating and initializing
+// new state, which for deflate is several hundred KB per stream. Streams
+// from all isolates share the pool.
+class ZLibStreamPool : public AllStatic {
+ public:
+  // Returns a reset stream matching the parameters, or NULL if there is none.
+  static z_stream* Take(bool deflate,
+                        int level,
+                        int window_bits,
+                        int mem_level,
+                        int strategy) {
+    MutexLocker ml(mutex_);
+    Entry** link = &entries_;
+    while (*link != NULL) {
+      Entry* entry = *link;
+      if ((entry->deflate == deflate) && (entry->level == level) &&
+          (entry->window_bits == window_bits) &&
+          (entry->mem_level == mem_level) && (entry->strategy == strategy)) {
+        *link = entry->next;
+        count_--;
+        z_stream* stream = entry->stream;
+        delete entry;
+        return stream;
+      }
+      link = &entry->next;
+    }
+    return NULL;
+  }
+
+  // Takes ownership of [stream]. It is reset and pooled, or freed if the
+  // pool is full.
+  static void Give(z_stream* stream,
+                   bool deflate,
+                   int level,
+                   int window_bits,
+                   int mem_level,
+                   int strategy) {
+    int result = deflate ? deflateReset(stream) : inflateReset(stream);
+    if (result == Z_OK) {
+      MutexLocker ml(mutex_);
+      if (count_ < kMaxPooledStreams) {
+        Entry* entry = new Entry();
+        entry->stream = stream;
+        entry->deflate = deflate;
+        entry->level = level;
+        entry->window_bits = window_bits;
+        entry->mem_level = mem_level;
+        entry->strategy = strategy;
+        entry->next = entries_;
+        entries_ = entry;
+        count_++;
+        return;
+      }
+    }
+    if (deflate) {
+      deflateEnd(stream);
+    } else {
+      inflateEnd(stream);
+    }
+    delete stream;
+  }
+
+ private:
+  static const intptr_t kMaxPooledStreams = 8;
+
+  struct Entry {
+    z_stream* stream;
+    bool deflate;
+    int level;
+    int window_bits;
+    int mem_level;
+    int strategy;
+    Entry* next;
+  };
+
+  static Mutex* mutex_;
+  static Entry* entries_;
+  static intptr_t count_;
+
+  DISALLOW_ALLOCATION();
+  DISALLOW_IMPLICIT_CONSTRUCTORS(ZLibStreamPool);
+};
+
+Mutex* ZLibStreamPool::mutex_ = new Mutex();
+ZLibStreamPool::Entry* ZLibStreamPool::entries_ = NULL;
+intptr_t ZLibStreamPool::count_ = 0;
+
+static z_stream* NewZLibStream() {
+  z_stream* stream = new z_stream();
+  stream->next_in = Z_NULL;
+  stream->avail_in = 0;
+  stream->zalloc = Z_NULL;
+  stream->zfree = Z_NULL;
+  stream->opaque = Z_NULL;
+  return stream;
+}
+
 static Dart_Handle GetFilter(Dart_Handle filter_obj, Filter** filter) {
   ASSERT(filter != NULL);
   Filter* result;
@@ -224,6 +325,115 @@ void FUNCTION_NAME(Filter_Process)(Dart_NativeArguments args) {
   }
 }
 
+// Copies the bytes [start, start + length) of [list] to [dest].
+static Dart_Handle CopyBytes(Dart_Handle list,
+                             intptr_t start,
+                             intptr_t length,
+                             uint8_t* dest) {
+  Dart_TypedData_Type type;
+  uint8_t* data = NULL;
+  intptr_t data_length;
+  Dart_Handle result = Dart_TypedDataAcquireData(
+      list, &type, reinterpret_cast<void**>(&data), &data_length);
+  if (Dart_IsError(result)) {
+    return Dart_ListGetAsBytes(list, start, dest, length);
+  }
+  if ((type != Dart_TypedData_kUint8) && (type != Dart_TypedData_kInt8)) {
+    Dart_TypedDataReleaseData(list);
+    return Dart_NewApiError("Invalid argument passed to Filter_ProcessChunks");
+  }
+  memmove(dest, data + start, length);
+  Dart_TypedDataReleaseData(list);
+  return Dart_Null();
+}
+
+void FUNCTION_NAME(Filter_ProcessChunks)(Dart_NativeArguments args) {
+  Dart_Handle filter_obj = Dart_GetNativeArgument(args, 0);
+  Dart_Handle chunks_obj = Dart_GetNativeArgument(args, 1);
+
+  Filter* filter = NULL;
+  Dart_Handle err = GetFilter(filter_obj, &filter);
+  if (Dart_IsError(err)) {
+    Dart_PropagateError(err);
+  }
+
+  intptr_t count;
+  err = Dart_ListLength(chunks_obj, &count);
+  if (Dart_IsError(err)) {
+    Dart_PropagateError(err);
+  }
+  intptr_t total_length = 0;
+  for (intptr_t i = 0; i < count; i++) {
+    intptr_t length;
+    err = Dart_ListLength(Dart_ListGetAt(chunks_obj, i), &length);
+    if (Dart_IsError(err)) {
+      Dart_PropagateError(err);
+    }
+    total_length += length;
+  }
+
+  // The chunks are handed to the filter as one buffer.
+  uint8_t* buffer = new uint8_t[total_length];
+  intptr_t offset = 0;
+  for (intptr_t i = 0; i < count; i++) {
+    Dart_Handle chunk = Dart_ListGetAt(chunks_obj, i);
+    intptr_t length;
+    err = Dart_ListLength(chunk, &length);
+    if (!Dart_IsError(err)) {
+      err = CopyBytes(chunk, 0, length, buffer + offset);
+    }
+    if (Dart_IsError(err)) {
+      delete[] buffer;
+      Dart_PropagateError(err);
+    }
+    offset += length;
+  }
+  // Process will take ownership of buffer, if successful.
+  if (!filter->Process(buffer, total_length)) {
+    delete[] buffer;
+    Dart_ThrowException(DartUtils::NewInternalError(
+        "Call to Process while still processing data"));
+  }
+}
+
+void FUNCTION_NAME(Filter_ProcessedInto)(Dart_NativeArguments args) {
+  Dart_Handle filter_obj = Dart_GetNativeArgument(args, 0);
+  Dart_Handle buffer_obj = Dart_GetNativeArgument(args, 1);
+  intptr_t start = DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 2));
+  intptr_t end = DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 3));
+  bool flush = DartUtils::GetBooleanValue(Dart_GetNativeArgument(args, 4));
+  bool finish = DartUtils::GetBooleanValue(Dart_GetNativeArgument(args, 5));
+
+  Filter* filter = NULL;
+  Dart_Handle err = GetFilter(filter_obj, &filter);
+  if (Dart_IsError(err)) {
+    Dart_PropagateError(err);
+  }
+
+  Dart_TypedData_Type type;
+  uint8_t* buffer = NULL;
+  intptr_t length;
+  err = Dart_TypedDataAcquireData(buffer_obj, &type,
+                                  reinterpret_cast<void**>(&buffer), &length);
+  if (Dart_IsError(err)) {
+    Dart_PropagateError(err);
+  }
+  if ((type != Dart_TypedData_kUint8) || (start < 0) || (start > end) ||
+      (end > length)) {
+    Dart_TypedDataReleaseData(buffer_obj);
+    Dart_ThrowException(DartUtils::NewInternalError(
+        "Invalid argument passed to Filter_ProcessedInto"));
+  }
+  // The filter writes directly into the Dart buffer.
+  intptr_t written =
+      filter->Processed(buffer + start, end - start, flush, finish);
+  Dart_TypedDataReleaseData(buffer_obj);
+  if (written < 0) {
+    Dart_ThrowException(DartUtils::NewInternalError("Filter error, bad data"));
+  }
+  Dart_SetIntegerReturnValue(args, written);
+}
+
 void FUNCTION_NAME(Filter_Processed)(Dart_NativeArguments args) {
   Dart_Handle filter_obj = Dart_GetNativeArgument(args, 0);
   Dart_Handle flush_obj = Dart_GetNativeArgument(args, 1);
@@ -286,29 +496,57 @@ Dart_Handle Filter::GetFilterNativeField(Dart_Handle filter,
 ZLibDeflateFilter::~ZLibDeflateFilter() {
   delete[] dictionary_;
   delete[] current_buffer_;
-  if (initialized()) {
-    deflateEnd(&stream_);
-  }
+  ReleaseStream();
 }
 
-bool ZLibDeflateFilter::Init() {
-  int window_bits = window_bits_;
+int ZLibDeflateFilter::WindowBits() const {
   if (raw_) {
-    window_bits = -window_bits;
+    return -window_bits_;
   } else if (gzip_) {
-    window_bits += kZLibFlagUseGZipHeader;
+    return window_bits_ + kZLibFlagUseGZipHeader;
+  }
+  return window_bits_;
+}
+
+bool ZLibDeflateFilter::CanPoolStream() const {
+  // A dictionary is part of the stream state, and not restored by a reset.
+  return dictionary_length_ == 0;
+}
+
+void ZLibDeflateFilter::ReleaseStream() {
+  if (stream_ == NULL) {
+    return;
+  }
+  if (CanPoolStream()) {
+    ZLibStreamPool::Give(stream_, true, level_, WindowBits(), mem_level_,
+                         strategy_);
+  } else {
+    deflateEnd(stream_);
+    delete stream_;
   }
-  stream_.next_in = Z_NULL;
-  stream_.zalloc = Z_NULL;
-  stream_.zfree = Z_NULL;
-  stream_.opaque = Z_NULL;
-  int result = deflateInit2(&stream_, level_, Z_DEFLATED, window_bits,
+  stream_ = NULL;
+}
+
+bool ZLibDeflateFilter::Init() {
+  int window_bits = WindowBits();
+  if (CanPoolStream()) {
+    stream_ = ZLibStreamPool::Take(true, level_, window_bits, mem_level_,
+                                   strategy_);
+    if (stream_ != NULL) {
+      set_initialized(true);
+      return true;
+    }
+  }
+  z_stream* stream = NewZLibStream();
+  int result = deflateInit2(stream, level_, Z_DEFLATED, window_bits,
                             mem_level_, strategy_);
   if (result != Z_OK) {
+    delete stream;
     return false;
   }
+  stream_ = stream;
   if ((dictionary_ != NULL) && !gzip_ && !raw_) {
-    result = deflateSetDictionary(&stream_, dictionary_, dictionary_length_);
+    result = deflateSetDictionary(stream_, dictionary_, dictionary_length_);
     delete[] dictionary_;
     dictionary_ = NULL;
     if (result != Z_OK) {
@@ -323,8 +561,11 @@ bool ZLibDeflateFilter::Process(uint8_t* data, intptr_t length) {
   if (current_buffer_ != NULL) {
     return false;
   }
-  stream_.avail_in = length;
-  stream_.next_in = current_buffer_ = data;
+  current_buffer_ = data;
+  if (stream_ != NULL) {
+    stream_->avail_in = length;
+    stream_->next_in = data;
+  }
   return true;
 }
 
@@ -332,15 +573,22 @@ intptr_t ZLibDeflateFilter::Processed(uint8_t* buffer,
                                       intptr_t length,
                                       bool flush,
                                       bool end) {
-  stream_.avail_out = length;
-  stream_.next_out = buffer;
+  if (stream_ == NULL) {
+    // The stream has ended.
+    delete[] current_buffer_;
+    current_buffer_ = NULL;
+    return 0;
+  }
+  stream_->avail_out = length;
+  stream_->next_out = buffer;
   bool error = false;
-  switch (
-      deflate(&stream_, end ? Z_FINISH : flush ? Z_SYNC_FLUSH : Z_NO_FLUSH)) {
+  int result;
+  switch (result = deflate(stream_, end ? Z_FINISH
+                                        : flush ? Z_SYNC_FLUSH : Z_NO_FLUSH)) {
     case Z_STREAM_END:
     case Z_BUF_ERROR:
     case Z_OK: {
-      intptr_t processed = length - stream_.avail_out;
+      intptr_t processed = length - stream_->avail_out;
       if (processed == 0) {
         break;
       }
@@ -354,6 +602,10 @@ intptr_t ZLibDeflateFilter::Processed(uint8_t* buffer,
 
   delete[] current_buffer_;
   current_buffer_ = NULL;
+  if ((result == Z_STREAM_END) && end) {
+    // All output has been delivered, let another filter use the state.
+    ReleaseStream();
+  }
   // Either 0 Byte processed or error
   return error ? -1 : 0;
 }
@@ -361,24 +613,46 @@ intptr_t ZLibDeflateFilter::Processed(uint8_t* buffer,
 ZLibInflateFilter::~ZLibInflateFilter() {
   delete[] dictionary_;
   delete[] current_buffer_;
-  if (initialized()) {
-    inflateEnd(&stream_);
+  ReleaseStream();
+}
+
+int ZLibInflateFilter::WindowBits() const {
+  return raw_ ? -window_bits_ : window_bits_ | kZLibFlagAcceptAnyHeader;
+}
+
+bool ZLibInflateFilter::CanPoolStream() const {
+  return dictionary_length_ == 0;
+}
+
+void ZLibInflateFilter::ReleaseStream() {
+  if (stream_ == NULL) {
+    return;
+  }
+  if (CanPoolStream()) {
+    ZLibStreamPool::Give(stream_, false, 0, WindowBits(), 0, 0);
+  } else {
+    inflateEnd(stream_);
+    delete stream_;
   }
+  stream_ = NULL;
 }
 
 bool ZLibInflateFilter::Init() {
-  int window_bits =
-      raw_ ? -window_bits_ : window_bits_ | kZLibFlagAcceptAnyHeader;
-
-  stream_.next_in = Z_NULL;
-  stream_.avail_in = 0;
-  stream_.zalloc = Z_NULL;
-  stream_.zfree = Z_NULL;
-  stream_.opaque = Z_NULL;
-  int result = inflateInit2(&stream_, window_bits);
+  int window_bits = WindowBits();
+  if (CanPoolStream()) {
+    stream_ = ZLibStreamPool::Take(false, 0, window_bits, 0, 0);
+    if (stream_ != NULL) {
+      set_initialized(true);
+      return true;
+    }
+  }
+  z_stream* stream = NewZLibStream();
+  int result = inflateInit2(stream, window_bits);
   if (result != Z_OK) {
+    delete stream;
     return false;
   }
+  stream_ = stream;
   set_initialized(true);
   return true;
 }
@@ -387,8 +661,11 @@ bool ZLibInflateFilter::Process(uint8_t* data, intptr_t length) {
   if (current_buffer_ != NULL) {
     return false;
   }
-  stream_.avail_in = length;
-  stream_.next_in = current_buffer_ = data;
+  current_buffer_ = data;
+  if (stream_ != NULL) {
+    stream_->avail_in = length;
+    stream_->next_in = data;
+  }
   return true;
 }
 
@@ -396,16 +673,22 @@ intptr_t ZLibInflateFilter::Processed(uint8_t* buffer,
                                       intptr_t length,
                                       bool flush,
                                       bool end) {
-  stream_.avail_out = length;
-  stream_.next_out = buffer;
+  if (stream_ == NULL) {
+    // The stream has ended.
+    delete[] current_buffer_;
+    current_buffer_ = NULL;
+    return 0;
+  }
+  stream_->avail_out = length;
+  stream_->next_out = buffer;
   bool error = false;
   int v;
-  switch (v = inflate(&stream_,
+  switch (v = inflate(stream_,
                       end ? Z_FINISH : flush ? Z_SYNC_FLUSH : Z_NO_FLUSH)) {
     case Z_STREAM_END:
     case Z_BUF_ERROR:
     case Z_OK: {
-      intptr_t processed = length - stream_.avail_out;
+      intptr_t processed = length - stream_->avail_out;
       if (processed == 0) {
         break;
       }
@@ -417,7 +700,7 @@ intptr_t ZLibInflateFilter::Processed(uint8_t* buffer,
         error = true;
       } else {
         int result =
-            inflateSetDictionary(&stream_, dictionary_, dictionary_length_);
+            inflateSetDictionary(stream_, dictionary_, dictionary_length_);
         delete[] dictionary_;
         dictionary_ = NULL;
         error = result != Z_OK;
@@ -437,6 +720,10 @@ intptr_t ZLibInflateFilter::Processed(uint8_t* buffer,
 
   delete[] current_buffer_;
   current_buffer_ = NULL;
+  if ((v == Z_STREAM_END) && end) {
+    // All output has been delivered, let another filter use the state.
+    ReleaseStream();
+  }
   // Either 0 Byte processed or error
   return error ? -1 : 0;
 }
@@ -15,7 +15,7 @@ namespace bin {
 
 class Filter {
  public:
-  virtual ~Filter() {}
+  virtual ~Filter() { delete[] processed_buffer_; }
 
   virtual bool Init() = 0;
 
@@ -38,15 +38,22 @@ class Filter {
 
   bool initialized() const { return initialized_; }
   void set_initialized(bool value) { initialized_ = value; }
-  uint8_t* processed_buffer() { return processed_buffer_; }
+  // The buffer is only allocated when used, as filters driven through
+  // Filter_ProcessedInto write directly into Dart buffers.
+  uint8_t* processed_buffer() {
+    if (processed_buffer_ == NULL) {
+      processed_buffer_ = new uint8_t[kFilterBufferSize];
+    }
+    return processed_buffer_;
+  }
   intptr_t processed_buffer_size() const { return kFilterBufferSize; }
 
  protected:
-  Filter() : initialized_(false) {}
+  Filter() : processed_buffer_(NULL), initialized_(false) {}
 
  private:
   static const intptr_t kFilterBufferSize = 64 * KB;
-  uint8_t processed_buffer_[kFilterBufferSize];
+  uint8_t* processed_buffer_;
   bool initialized_;
 
   DISALLOW_COPY_AND_ASSIGN(Filter);
@@ -70,7 +77,8 @@ class ZLibDeflateFilter : public Filter {
         dictionary_(dictionary),
         dictionary_length_(dictionary_length),
         raw_(raw),
-        current_buffer_(NULL) {}
+        current_buffer_(NULL),
+        stream_(NULL) {}
   virtual ~ZLibDeflateFilter();
 
   virtual bool Init();
@@ -90,7 +98,12 @@ class ZLibDeflateFilter : public Filter {
   const intptr_t dictionary_length_;
   const bool raw_;
   uint8_t* current_buffer_;
-  z_stream stream_;
+  // NULL once the stream has ended and its state was released.
+  z_stream* stream_;
+
+  int WindowBits() const;
+  bool CanPoolStream() const;
+  void ReleaseStream();
 
   DISALLOW_COPY_AND_ASSIGN(ZLibDeflateFilter);
 };
@@ -105,7 +118,8 @@ class ZLibInflateFilter : public Filter {
         dictionary_(dictionary),
         dictionary_length_(dictionary_length),
         raw_(raw),
-        current_buffer_(NULL) {}
+        current_buffer_(NULL),
+        stream_(NULL) {}
   virtual ~ZLibInflateFilter();
 
   virtual bool Init();
@@ -121,7 +135,12 @@ class ZLibInflateFilter : public Filter {
   const intptr_t dictionary_length_;
   const bool raw_;
   uint8_t* current_buffer_;
-  z_stream stream_;
+  // NULL once the stream has ended and its state was released.
+  z_stream* stream_;
+
+  int WindowBits() const;
+  bool CanPoolStream() const;
+  void ReleaseStream();
 
   DISALLOW_COPY_AND_ASSIGN(ZLibInflateFilter);
 };
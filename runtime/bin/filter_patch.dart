@@ -4,11 +4,17 @@
 
 // part of "common_patch.dart";
 
-class _FilterImpl extends NativeFieldWrapperClass1 implements RawZLibFilter {
+class _FilterImpl extends NativeFieldWrapperClass1
+    implements _NativeZLibFilter {
   void process(List<int> data, int start, int end) native "Filter_Process";
 
   List<int> processed({bool flush: true, bool end: false})
       native "Filter_Processed";
+
+  void _processChunks(List<List<int>> chunks) native "Filter_ProcessChunks";
+
+  int _processedInto(Uint8List buffer, int start, int end, bool flush,
+      bool finish) native "Filter_ProcessedInto";
 }
 
 class _ZLibInflateFilter extends _FilterImpl {
@@ -79,7 +79,9 @@ namespace bin {
   V(Filter_CreateZLibDeflate, 8)                                               \
   V(Filter_CreateZLibInflate, 4)                                               \
   V(Filter_Process, 4)                                                         \
+  V(Filter_ProcessChunks, 2)                                                   \
   V(Filter_Processed, 3)                                                       \
+  V(Filter_ProcessedInto, 6)                                                   \
   V(InternetAddress_Parse, 1)                                                  \
   V(IOService_NewServicePort, 0)                                               \
   V(Namespace_Create, 2)                                                       \
@@ -143,10 +145,14 @@ namespace bin {
   V(Socket_JoinMulticast, 4)                                                   \
   V(Socket_LeaveMulticast, 4)                                                  \
   V(Socket_Read, 2)                                                            \
+  V(Socket_ReadInto, 4)                                                        \
   V(Socket_RecvFrom, 1)                                                        \
+  V(Socket_RecvFromBatch, 2)                                                   \
+  V(Socket_SendFile, 4)                                                        \
   V(Socket_SendTo, 6)                                                          \
   V(Socket_SetOption, 4)                                                       \
   V(Socket_SetSocketId, 3)                                                     \
+  V(Socket_WriteBuffers, 4)                                                    \
   V(Socket_WriteList, 4)                                                       \
   V(Stdin_ReadByte, 1)                                                         \
   V(Stdin_GetEchoMode, 1)                                                      \
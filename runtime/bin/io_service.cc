@@ -10,6 +10,7 @@
 #include "bin/directory.h"
 #include "bin/file.h"
 #include "bin/io_buffer.h"
+#include "bin/io_uring.h"
 #include "bin/secure_socket_filter.h"
 #include "bin/security_context.h"
 #include "bin/socket.h"
@@ -40,6 +41,11 @@ void IOServiceCallback(Dart_Port dest_port_id, Dart_CObject* message) {
     CObjectInt32 request_id(request[2]);
     CObjectArray data(request[3]);
     reply_port_id = reply_port.Value();
+    if (IOUring::SubmitRequest(reply_port_id, message_id.Value(),
+                               request_id.Value(), data)) {
+      // The response is posted when the request completes.
+      return;
+    }
     switch (request_id.Value()) {
       IO_SERVICE_REQUEST_LIST(CASE_REQUEST);
       default:
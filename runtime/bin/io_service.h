@@ -59,7 +59,8 @@ namespace bin {
   V(Directory, ListNext, 39)                                                   \
   V(Directory, ListStop, 40)                                                   \
   V(Directory, Rename, 41)                                                     \
-  V(SSLFilter, ProcessFilter, 42)
+  V(SSLFilter, ProcessFilter, 42)                                              \
+  V(File, ReadAt, 43)
 
 #define DECLARE_REQUEST(type, method, id) k##type##method##Request = id,
 
@@ -60,7 +60,8 @@ namespace bin {
   V(Directory, ListStart, 38)                                                  \
   V(Directory, ListNext, 39)                                                   \
   V(Directory, ListStop, 40)                                                   \
-  V(Directory, Rename, 41)
+  V(Directory, Rename, 41)                                                     \
+  V(File, ReadAt, 43)
 
 #define DECLARE_REQUEST(type, method, id) k##type##method##Request = id,
 
@@ -0,0 +1,54 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_BIN_IO_URING_H_
+#define RUNTIME_BIN_IO_URING_H_
+
+#include "bin/builtin.h"
+#include "bin/dartutils.h"
+#include "platform/globals.h"
+
+namespace dart {
+namespace bin {
+
+// Asynchronous execution of IOService file requests using Linux io_uring.
+//
+// Submitted requests do not block an IOService thread: the kernel performs
+// the I/O and a single completion thread posts the responses. Requests from
+// concurrent IOService threads are submitted to the kernel in batches, and
+// completions are reaped in batches.
+//
+// io_uring is only used when enabled with --enable-io-uring. On other
+// platforms, on kernels without the required io_uring support, or once
+// submitting to the kernel has failed, SubmitRequest returns false and the
+// caller handles the request synchronously.
+class IOUring {
+ public:
+  static void set_enabled(bool enabled) { enabled_ = enabled; }
+
+  // Tries to submit the IOService request [request_id] with arguments [data].
+  // Returns true if the request was submitted. The response is then posted
+  // to [reply_port] as [message_id, response] once the request completes.
+  // Returns false, without consuming any of [data], if the request should be
+  // handled synchronously.
+  static bool SubmitRequest(Dart_Port reply_port,
+                            int32_t message_id,
+                            intptr_t request_id,
+                            const CObjectArray& data);
+
+  // Stops the completion thread and releases the ring. Requests still in
+  // flight are completed first, later ones are handled synchronously.
+  static void Cleanup();
+
+ private:
+  static bool enabled_;
+
+  DISALLOW_ALLOCATION();
+  DISALLOW_IMPLICIT_CONSTRUCTORS(IOUring);
+};
+
+}  // namespace bin
+}  // namespace dart
+
+#endif  // RUNTIME_BIN_IO_URING_H_
@@ -0,0 +1,857 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/globals.h"
+#if defined(HOST_OS_LINUX)
+
+#include "bin/io_uring.h"
+
+#include <errno.h>        // NOLINT
+#include <string.h>       // NOLINT
+#include <sys/mman.h>     // NOLINT
+#include <sys/syscall.h>  // NOLINT
+#include <unistd.h>       // NOLINT
+
+#include "bin/file.h"
+#include "bin/io_buffer.h"
+#if defined(DART_IO_SECURE_SOCKET_DISABLED)
+#include "bin/io_service_no_ssl.h"
+#else
+#include "bin/io_service.h"
+#endif
+#include "bin/lockers.h"
+#include "bin/log.h"
+#include "bin/metrics.h"
+#include "bin/thread.h"
+#include "bin/utils.h"
+#include "platform/growable_array.h"
+#include "platform/signal_blocker.h"
+#include "platform/utils.h"
+
+// The system headers the VM is built against may predate io_uring, so the
+// parts of the kernel interface used here are declared below.
+#if !defined(__NR_io_uring_setup)
+#define __NR_io_uring_setup 425
+#endif
+#if !defined(__NR_io_uring_enter)
+#define __NR_io_uring_enter 426
+#endif
+
+namespace dart {
+namespace bin {
+
+bool IOUring::enabled_ = false;
+
+// Layout of struct io_uring_sqe.
+struct IOUringSQE {
+  uint8_t opcode;
+  uint8_t flags;
+  uint16_t ioprio;
+  int32_t fd;
+  uint64_t off;
+  uint64_t addr;
+  uint32_t len;
+  uint32_t rw_flags;
+  uint64_t user_data;
+  uint64_t pad[3];
+};
+
+// Layout of struct io_uring_cqe.
+struct IOUringCQE {
+  uint64_t user_data;
+  int32_t res;
+  uint32_t flags;
+};
+
+// Layout of struct io_uring_params.
+struct IOUringParams {
+  uint32_t sq_entries;
+  uint32_t cq_entries;
+  uint32_t flags;
+  uint32_t sq_thread_cpu;
+  uint32_t sq_thread_idle;
+  uint32_t features;
+  uint32_t wq_fd;
+  uint32_t resv[3];
+  struct {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t ring_mask;
+    uint32_t ring_entries;
+    uint32_t flags;
+    uint32_t dropped;
+    uint32_t array;
+    uint32_t resv1;
+    uint64_t resv2;
+  } sq_off;
+  struct {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t ring_mask;
+    uint32_t ring_entries;
+    uint32_t overflow;
+    uint32_t cqes;
+    uint32_t flags;
+    uint32_t resv1;
+    uint64_t resv2;
+  } cq_off;
+};
+
+static const uint8_t kIOUringOpNop = 0;
+static const uint8_t kIOUringOpRead = 22;
+static const uint8_t kIOUringOpWrite = 23;
+static const uint32_t kIOUringEnterGetEvents = 1 << 0;
+static const uint32_t kIOUringFeatSingleMmap = 1 << 0;
+// Reads and writes at offset -1 use and update the file position, like
+// read(2) and write(2). Required, since dart:io files are positional.
+static const uint32_t kIOUringFeatRwCurPos = 1 << 3;
+static const off_t kIOUringOffSqRing = 0;
+static const off_t kIOUringOffSqes = 0x10000000;
+
+static const uint32_t kIOUringEntries = 256;
+
+// An IOService request in flight.
+class IOUringOperation {
+ public:
+  enum Kind { kRead, kReadInto, kReadAt, kWriteFrom, kShutdown };
+
+  // [offset] is only used by kReadAt. Other reads and writes use the file
+  // position.
+  IOUringOperation(Kind kind,
+                   Dart_Port reply_port,
+                   int32_t message_id,
+                   File* file,
+                   uint8_t* buffer,
+                   int64_t length,
+                   int64_t offset)
+      : kind_(kind),
+        reply_port_(reply_port),
+        message_id_(message_id),
+        file_(file),
+        buffer_(buffer),
+        length_(length),
+        offset_(offset),
+        written_(0) {}
+
+  ~IOUringOperation() {
+    if (buffer_ != NULL) {
+      IOBuffer::Free(buffer_);
+    }
+    if (file_ != NULL) {
+      // Drop the reference passed in with the request.
+      file_->Release();
+    }
+  }
+
+  // Makes the operation not release its file reference.
+  void DetachFile() { file_ = NULL; }
+
+  Kind kind() const { return kind_; }
+  File* file() const { return file_; }
+  uint8_t* buffer() const { return buffer_; }
+  int64_t length() const { return length_; }
+
+  void PrepareSQE(IOUringSQE* sqe);
+
+  // Performs the rest of the operation with a blocking system call, and
+  // returns its result in the form of a completion queue entry result.
+  int32_t Perform();
+
+  // Posts the response for a completion with the given result and returns
+  // true, or returns false if the rest of a short write has to be submitted.
+  bool Complete(int32_t result);
+
+ private:
+  void PostResponse(Dart_CObject* response);
+  void PostError(int code);
+
+  const Kind kind_;
+  const Dart_Port reply_port_;
+  const int32_t message_id_;
+  File* file_;
+  uint8_t* buffer_;
+  const int64_t length_;
+  const int64_t offset_;
+  // Bytes of a kWriteFrom that have been written so far.
+  int64_t written_;
+
+  DISALLOW_COPY_AND_ASSIGN(IOUringOperation);
+};
+
+void IOUringOperation::PrepareSQE(IOUringSQE* sqe) {
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->user_data = reinterpret_cast<uint64_t>(this);
+  if (kind_ == kShutdown) {
+    sqe->opcode = kIOUringOpNop;
+    sqe->fd = -1;
+    return;
+  }
+  sqe->opcode = (kind_ == kWriteFrom) ? kIOUringOpWrite : kIOUringOpRead;
+  sqe->fd = file_->GetFD();
+  sqe->off = static_cast<uint64_t>((kind_ == kReadAt) ? offset_ : -1);
+  sqe->addr = reinterpret_cast<uint64_t>(buffer_ + written_);
+  sqe->len = static_cast<uint32_t>(length_ - written_);
+}
+
+int32_t IOUringOperation::Perform() {
+  ASSERT(kind_ != kShutdown);
+  const int fd = file_->GetFD();
+  ssize_t result;
+  if (kind_ == kWriteFrom) {
+    result =
+        TEMP_FAILURE_RETRY(write(fd, buffer_ + written_, length_ - written_));
+  } else if (kind_ == kReadAt) {
+    result = TEMP_FAILURE_RETRY(pread(fd, buffer_, length_, offset_));
+  } else {
+    result = TEMP_FAILURE_RETRY(read(fd, buffer_, length_));
+  }
+  return (result < 0) ? -errno : static_cast<int32_t>(result);
+}
+
+void IOUringOperation::PostResponse(Dart_CObject* response) {
+  Dart_CObject id;
+  id.type = Dart_CObject_kInt32;
+  id.value.as_int32 = message_id_;
+  Dart_CObject* values[] = {&id, response};
+  Dart_CObject result;
+  result.type = Dart_CObject_kArray;
+  result.value.as_array.length = 2;
+  result.value.as_array.values = values;
+  Dart_PostCObject(reply_port_, &result);
+}
+
+void IOUringOperation::PostError(int code) {
+  OSError os_error;
+  os_error.SetCodeAndMessage(OSError::kSystem, code);
+  Dart_CObject kind;
+  kind.type = Dart_CObject_kInt32;
+  kind.value.as_int32 = CObject::kOSError;
+  Dart_CObject error_code;
+  error_code.type = Dart_CObject_kInt32;
+  error_code.value.as_int32 = os_error.code();
+  Dart_CObject message;
+  message.type = Dart_CObject_kString;
+  message.value.as_string = os_error.message();
+  Dart_CObject* values[] = {&kind, &error_code, &message};
+  Dart_CObject error;
+  error.type = Dart_CObject_kArray;
+  error.value.as_array.length = 3;
+  error.value.as_array.values = values;
+  PostResponse(&error);
+}
+
+bool IOUringOperation::Complete(int32_t result) {
+  if (result < 0) {
+    PostError(-result);
+    return true;
+  }
+  if (kind_ == kWriteFrom) {
+    IOMetrics::Add(IOMetrics::kFileBytesWritten, result);
+    // Keep writing after short writes, like File::WriteFully.
+    written_ += result;
+    if (written_ < length_) {
+      return false;
+    }
+    Dart_CObject written;
+    written.type = Dart_CObject_kInt64;
+    written.value.as_int64 = length_;
+    PostResponse(&written);
+    return true;
+  }
+
+  IOMetrics::Add(IOMetrics::kFileBytesRead, result);
+
+  // The response owns the buffer from here on.
+  uint8_t* data = buffer_;
+  buffer_ = NULL;
+  Dart_CObject status;
+  status.type = Dart_CObject_kInt32;
+  status.value.as_int32 = 0;
+  Dart_CObject bytes_read;
+  bytes_read.type = Dart_CObject_kInt64;
+  bytes_read.value.as_int64 = result;
+  Dart_CObject external_array;
+  external_array.type = Dart_CObject_kExternalTypedData;
+  external_array.value.as_external_typed_data.type = Dart_TypedData_kUint8;
+  external_array.value.as_external_typed_data.length = result;
+  external_array.value.as_external_typed_data.data = data;
+  external_array.value.as_external_typed_data.peer = data;
+  external_array.value.as_external_typed_data.callback = IOBuffer::Finalizer;
+  Dart_CObject* values[3];
+  Dart_CObject response;
+  response.type = Dart_CObject_kArray;
+  response.value.as_array.values = values;
+  values[0] = &status;
+  if (kind_ == kReadInto) {
+    values[1] = &bytes_read;
+    values[2] = &external_array;
+    response.value.as_array.length = 3;
+  } else {
+    values[1] = &external_array;
+    response.value.as_array.length = 2;
+  }
+  PostResponse(&response);
+  return true;
+}
+
+// A single io_uring instance shared by all IOService threads, with a thread
+// reaping completions.
+class IOUringInstance {
+ public:
+  // Returns NULL if io_uring is not available.
+  static IOUringInstance* New(uint32_t entries);
+  ~IOUringInstance();
+
+  // Returns false if the submission queue is full, or if submitting to the
+  // kernel has failed and requests have to be handled synchronously.
+  bool Submit(IOUringOperation* operation) { return Enqueue(operation, true); }
+  bool submit_failed() {
+    MutexLocker ml(&submit_mutex_);
+    return submit_failed_;
+  }
+
+  void Start();
+  // Returns false if the completion thread could not be stopped, because
+  // the shutdown operation could not be submitted.
+  bool Shutdown();
+
+ private:
+  IOUringInstance();
+
+  static int Setup(uint32_t entries, IOUringParams* params) {
+    return NO_RETRY_EXPECTED(syscall(__NR_io_uring_setup, entries, params));
+  }
+
+  int Enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+    return syscall(__NR_io_uring_enter, fd_, to_submit, min_complete, flags,
+                   NULL, 0);
+  }
+
+  // Adds [operation] to the submission queue. Unless [count_in_flight] is
+  // false, the operation also takes up one of the completion slots.
+  bool Enqueue(IOUringOperation* operation, bool count_in_flight);
+  // Submits the rest of an operation whose completion has just been reaped.
+  void Resubmit(IOUringOperation* operation);
+
+  // Takes the [count] entries at the end of the submission queue back after
+  // io_uring_enter failed for them, and returns their operations.
+  void Unqueue(uint32_t count, MallocGrowableArray<IOUringOperation*>* ops);
+  // Performs an operation that holds a completion slot on the calling thread,
+  // and completes it.
+  void CompleteSynchronously(IOUringOperation* operation);
+
+  static void Poll(uword args);
+  // Returns false once the shutdown operation has completed.
+  bool ReapCompletions();
+
+  int fd_;
+  void* ring_;
+  size_t ring_size_;
+  IOUringSQE* sqes_;
+  size_t sqes_size_;
+
+  uint32_t* sq_head_;
+  uint32_t* sq_tail_;
+  uint32_t sq_mask_;
+  uint32_t sq_entries_;
+  uint32_t* sq_array_;
+
+  uint32_t* cq_head_;
+  uint32_t* cq_tail_;
+  uint32_t cq_mask_;
+  IOUringCQE* cqes_;
+
+  // Guards the submission queue tail and [unsubmitted_].
+  Mutex submit_mutex_;
+  // Entries added to the submission queue but not yet passed to the kernel.
+  uint32_t unsubmitted_;
+  // Whether some thread is currently passing entries to the kernel.
+  bool submitting_;
+  // Set once io_uring_enter failed with an error other than a temporary
+  // shortage. Nothing is submitted afterwards.
+  bool submit_failed_;
+  // Operations submitted but not completed. Bounded by the completion queue
+  // size so that completions are never dropped.
+  intptr_t in_flight_;
+  uint32_t cq_entries_;
+
+  Monitor shutdown_monitor_;
+  bool stopped_;
+  // Set if the shutdown operation was taken back after a failed submission.
+  bool shutdown_failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(IOUringInstance);
+};
+
+IOUringInstance::IOUringInstance()
+    : fd_(-1),
+      ring_(MAP_FAILED),
+      ring_size_(0),
+      sqes_(reinterpret_cast<IOUringSQE*>(MAP_FAILED)),
+      sqes_size_(0),
+      sq_head_(NULL),
+      sq_tail_(NULL),
+      sq_mask_(0),
+      sq_entries_(0),
+      sq_array_(NULL),
+      cq_head_(NULL),
+      cq_tail_(NULL),
+      cq_mask_(0),
+      cqes_(NULL),
+      unsubmitted_(0),
+      submitting_(false),
+      submit_failed_(false),
+      in_flight_(0),
+      cq_entries_(0),
+      stopped_(false),
+      shutdown_failed_(false) {}
+
+IOUringInstance* IOUringInstance::New(uint32_t entries) {
+  IOUringParams params;
+  memset(&params, 0, sizeof(params));
+  const int fd = Setup(entries, &params);
+  if (fd < 0) {
+    // ENOSYS on kernels without io_uring, EPERM if disabled by a sandbox.
+    return NULL;
+  }
+  IOUringInstance* instance = new IOUringInstance();
+  instance->fd_ = fd;
+  if (((params.features & kIOUringFeatSingleMmap) == 0) ||
+      ((params.features & kIOUringFeatRwCurPos) == 0)) {
+    delete instance;
+    return NULL;
+  }
+
+  // With IORING_FEAT_SINGLE_MMAP the submission and completion rings share
+  // a single mapping.
+  const size_t sq_size = params.sq_off.array + params.sq_entries * 4;
+  const size_t cq_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(IOUringCQE);
+  instance->ring_size_ = (sq_size > cq_size) ? sq_size : cq_size;
+  instance->ring_ =
+      mmap(NULL, instance->ring_size_, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, fd, kIOUringOffSqRing);
+  if (instance->ring_ == MAP_FAILED) {
+    delete instance;
+    return NULL;
+  }
+  instance->sqes_size_ = params.sq_entries * sizeof(IOUringSQE);
+  instance->sqes_ = reinterpret_cast<IOUringSQE*>(
+      mmap(NULL, instance->sqes_size_, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, fd, kIOUringOffSqes));
+  if (instance->sqes_ == MAP_FAILED) {
+    delete instance;
+    return NULL;
+  }
+
+  uint8_t* ring = reinterpret_cast<uint8_t*>(instance->ring_);
+  instance->sq_head_ = reinterpret_cast<uint32_t*>(ring + params.sq_off.head);
+  instance->sq_tail_ = reinterpret_cast<uint32_t*>(ring + params.sq_off.tail);
+  instance->sq_mask_ =
+      *reinterpret_cast<uint32_t*>(ring + params.sq_off.ring_mask);
+  instance->sq_entries_ = params.sq_entries;
+  instance->sq_array_ = reinterpret_cast<uint32_t*>(ring + params.sq_off.array);
+  instance->cq_head_ = reinterpret_cast<uint32_t*>(ring + params.cq_off.head);
+  instance->cq_tail_ = reinterpret_cast<uint32_t*>(ring + params.cq_off.tail);
+  instance->cq_mask_ =
+      *reinterpret_cast<uint32_t*>(ring + params.cq_off.ring_mask);
+  instance->cqes_ = reinterpret_cast<IOUringCQE*>(ring + params.cq_off.cqes);
+  instance->cq_entries_ = params.cq_entries;
+  return instance;
+}
+
+IOUringInstance::~IOUringInstance() {
+  if (sqes_ != MAP_FAILED) {
+    VOID_NO_RETRY_EXPECTED(munmap(sqes_, sqes_size_));
+  }
+  if (ring_ != MAP_FAILED) {
+    VOID_NO_RETRY_EXPECTED(munmap(ring_, ring_size_));
+  }
+  if (fd_ >= 0) {
+    VOID_TEMP_FAILURE_RETRY(close(fd_));
+  }
+}
+
+bool IOUringInstance::Enqueue(IOUringOperation* operation,
+                              bool count_in_flight) {
+  MallocGrowableArray<IOUringOperation*> unqueued;
+  bool unqueued_own = false;
+  {
+    MutexLocker ml(&submit_mutex_);
+    if (submit_failed_) {
+      return false;
+    }
+    const uint32_t tail = *sq_tail_;
+    const uint32_t head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if ((tail - head) == sq_entries_) {
+      return false;
+    }
+    if (count_in_flight) {
+      if ((operation->kind() != IOUringOperation::kShutdown) &&
+          (__atomic_load_n(&in_flight_, __ATOMIC_RELAXED) >=
+           static_cast<intptr_t>(cq_entries_ - 1))) {
+        // Keep one completion slot for the shutdown operation.
+        return false;
+      }
+      __atomic_fetch_add(&in_flight_, 1, __ATOMIC_RELAXED);
+    }
+    const uint32_t index = tail & sq_mask_;
+    operation->PrepareSQE(&sqes_[index]);
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    unsubmitted_++;
+
+    // Only one thread enters the kernel at a time. Entries added by other
+    // threads meanwhile are passed along with the next call, so concurrent
+    // requests are submitted in batches.
+    if (submitting_) {
+      return true;
+    }
+    submitting_ = true;
+    while (unsubmitted_ > 0) {
+      const uint32_t to_submit = unsubmitted_;
+      unsubmitted_ = 0;
+      int result;
+      submit_mutex_.Unlock();
+      result = TEMP_FAILURE_RETRY_NO_SIGNAL_BLOCKER(Enter(to_submit, 0, 0));
+      const int error = errno;
+      submit_mutex_.Lock();
+      if (result >= 0) {
+        unsubmitted_ += to_submit - result;
+      } else if ((error == EAGAIN) || (error == EBUSY)) {
+        // The kernel is short of memory or of completion queue space. Retry
+        // once some of the operations in flight have completed.
+        unsubmitted_ += to_submit;
+        submit_mutex_.Unlock();
+        TimerUtils::Sleep(1);
+        submit_mutex_.Lock();
+      } else {
+        Log::PrintErr("io_uring_enter failed: %d, using IOService threads\n",
+                      error);
+        submit_failed_ = true;
+        Unqueue(to_submit + unsubmitted_, &unqueued);
+        unsubmitted_ = 0;
+        break;
+      }
+    }
+    submitting_ = false;
+  }
+
+  // The operations that were taken back are completed here, except for the
+  // caller's own, which it handles synchronously itself.
+  for (intptr_t i = 0; i < unqueued.length(); i++) {
+    IOUringOperation* unqueued_operation = unqueued[i];
+    if (unqueued_operation == operation) {
+      unqueued_own = true;
+      if (count_in_flight) {
+        __atomic_fetch_sub(&in_flight_, 1, __ATOMIC_RELAXED);
+      }
+    } else if (unqueued_operation->kind() == IOUringOperation::kShutdown) {
+      __atomic_fetch_sub(&in_flight_, 1, __ATOMIC_RELAXED);
+      delete unqueued_operation;
+      MonitorLocker ml(&shutdown_monitor_);
+      shutdown_failed_ = true;
+      ml.Notify();
+    } else {
+      CompleteSynchronously(unqueued_operation);
+    }
+  }
+  return !unqueued_own;
+}
+
+void IOUringInstance::Unqueue(uint32_t count,
+                              MallocGrowableArray<IOUringOperation*>* ops) {
+  // A failed io_uring_enter consumes none of the entries passed to it, so
+  // the unsubmitted entries are still the last ones in the queue.
+  const uint32_t tail = *sq_tail_;
+  for (uint32_t i = tail - count; i != tail; i++) {
+    ops->Add(reinterpret_cast<IOUringOperation*>(
+        sqes_[sq_array_[i & sq_mask_]].user_data));
+  }
+  __atomic_store_n(sq_tail_, tail - count, __ATOMIC_RELEASE);
+}
+
+void IOUringInstance::CompleteSynchronously(IOUringOperation* operation) {
+  while (!operation->Complete(operation->Perform())) {
+  }
+  __atomic_fetch_sub(&in_flight_, 1, __ATOMIC_RELAXED);
+  delete operation;
+}
+
+void IOUringInstance::Resubmit(IOUringOperation* operation) {
+  // The operation keeps the completion slot it already holds, so this cannot
+  // wait for completions. The submission queue is only full until the thread
+  // currently submitting has passed the entries to the kernel.
+  while (!Enqueue(operation, false)) {
+    if (submit_failed()) {
+      CompleteSynchronously(operation);
+      return;
+    }
+    TimerUtils::Sleep(1);
+  }
+}
+
+bool IOUringInstance::ReapCompletions() {
+  bool running = true;
+  uint32_t head = *cq_head_;
+  const uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  while (head != tail) {
+    IOUringCQE* cqe = &cqes_[head & cq_mask_];
+    IOUringOperation* operation =
+        reinterpret_cast<IOUringOperation*>(cqe->user_data);
+    const int32_t result = cqe->res;
+    head++;
+    // Release the completion queue entry before doing any work.
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    if (operation->kind() == IOUringOperation::kShutdown) {
+      running = false;
+    } else if (!operation->Complete(result)) {
+      Resubmit(operation);
+      continue;
+    }
+    __atomic_fetch_sub(&in_flight_, 1, __ATOMIC_RELAXED);
+    delete operation;
+  }
+  return running;
+}
+
+void IOUringInstance::Poll(uword args) {
+  ThreadSignalBlocker signal_blocker(SIGPROF);
+  IOUringInstance* instance = reinterpret_cast<IOUringInstance*>(args);
+  bool running = true;
+  bool wait_failed = false;
+  while (running) {
+    if (wait_failed) {
+      // Completions are still posted to the ring, just without waking us.
+      TimerUtils::Sleep(1);
+    } else {
+      const int result = TEMP_FAILURE_RETRY_NO_SIGNAL_BLOCKER(
+          instance->Enter(0, 1, kIOUringEnterGetEvents));
+      if (result < 0) {
+        if ((errno == EAGAIN) || (errno == EBUSY)) {
+          TimerUtils::Sleep(1);
+        } else {
+          Log::PrintErr("io_uring_enter failed: %d, polling completions\n",
+                        errno);
+          wait_failed = true;
+        }
+      }
+    }
+    running = instance->ReapCompletions();
+  }
+  MonitorLocker ml(&instance->shutdown_monitor_);
+  instance->stopped_ = true;
+  ml.Notify();
+}
+
+void IOUringInstance::Start() {
+  int result = Thread::Start(&IOUringInstance::Poll,
+                             reinterpret_cast<uword>(this));
+  if (result != 0) {
+    FATAL1("Failed to start io_uring thread %d", result);
+  }
+}
+
+bool IOUringInstance::Shutdown() {
+  // The shutdown operation completes after all earlier submissions.
+  IOUringOperation* shutdown = new IOUringOperation(
+      IOUringOperation::kShutdown, ILLEGAL_PORT, 0, NULL, NULL, 0, -1);
+  while (!Submit(shutdown)) {
+    if (submit_failed()) {
+      delete shutdown;
+      return false;
+    }
+    TimerUtils::Sleep(1);
+  }
+  MonitorLocker ml(&shutdown_monitor_);
+  while (!stopped_ && !shutdown_failed_) {
+    ml.Wait(Monitor::kNoTimeout);
+  }
+  return stopped_;
+}
+
+enum IOUringState {
+  kUninitialized,
+  kInitialized,
+  // Terminal, requests arriving after Cleanup are handled synchronously.
+  kShutDown,
+};
+
+static Monitor* io_uring_monitor = new Monitor();
+static IOUringInstance* io_uring_instance = NULL;
+static IOUringState io_uring_state = kUninitialized;
+// The number of IOUringScopes using the instance. Cleanup waits for them.
+static intptr_t io_uring_users = 0;
+
+// Keeps the shared instance alive while a request is submitted to it.
+class IOUringScope {
+ public:
+  IOUringScope() : instance_(NULL) {
+    MonitorLocker ml(io_uring_monitor);
+    if (io_uring_state == kUninitialized) {
+      io_uring_state = kInitialized;
+      io_uring_instance = IOUringInstance::New(kIOUringEntries);
+      if (io_uring_instance != NULL) {
+        io_uring_instance->Start();
+      }
+    }
+    if ((io_uring_state == kInitialized) && (io_uring_instance != NULL)) {
+      instance_ = io_uring_instance;
+      io_uring_users++;
+    }
+  }
+
+  ~IOUringScope() {
+    if (instance_ != NULL) {
+      MonitorLocker ml(io_uring_monitor);
+      if (--io_uring_users == 0) {
+        ml.NotifyAll();
+      }
+    }
+  }
+
+  // NULL if io_uring is not available or has been shut down.
+  IOUringInstance* instance() const { return instance_; }
+
+ private:
+  IOUringInstance* instance_;
+
+  DISALLOW_COPY_AND_ASSIGN(IOUringScope);
+};
+
+static int64_t CObjectToInt64(CObject* cobject) {
+  if (cobject->IsInt32()) {
+    CObjectInt32 value(cobject);
+    return value.Value();
+  }
+  CObjectInt64 value(cobject);
+  return value.Value();
+}
+
+bool IOUring::SubmitRequest(Dart_Port reply_port,
+                            int32_t message_id,
+                            intptr_t request_id,
+                            const CObjectArray& data) {
+  if (!enabled_) {
+    return false;
+  }
+  IOUringOperation::Kind kind;
+  switch (request_id) {
+    case IOService::kFileReadRequest:
+      kind = IOUringOperation::kRead;
+      break;
+    case IOService::kFileReadIntoRequest:
+      kind = IOUringOperation::kReadInto;
+      break;
+    case IOService::kFileReadAtRequest:
+      kind = IOUringOperation::kReadAt;
+      break;
+    case IOService::kFileWriteFromRequest:
+      kind = IOUringOperation::kWriteFrom;
+      break;
+    default:
+      return false;
+  }
+
+  // Anything unusual is left to the synchronous path, which also takes care
+  // of reporting argument errors.
+  if ((data.Length() < 1) || !data[0]->IsIntptr()) {
+    return false;
+  }
+  int64_t length;
+  int64_t offset = -1;
+  uint8_t* source = NULL;
+  if (kind == IOUringOperation::kWriteFrom) {
+    if ((data.Length() != 4) || !data[1]->IsTypedData() ||
+        !data[2]->IsInt32OrInt64() || !data[3]->IsInt32OrInt64()) {
+      return false;
+    }
+    CObjectTypedData typed_data(data[1]);
+    if ((typed_data.Type() != Dart_TypedData_kUint8) &&
+        (typed_data.Type() != Dart_TypedData_kInt8) &&
+        (typed_data.Type() != Dart_TypedData_kUint8Clamped)) {
+      return false;
+    }
+    const int64_t start = CObjectToInt64(data[2]);
+    const int64_t end = CObjectToInt64(data[3]);
+    if ((start < 0) || (end < start) || (end > typed_data.Length())) {
+      return false;
+    }
+    length = end - start;
+    source = typed_data.Buffer() + start;
+  } else if (kind == IOUringOperation::kReadAt) {
+    if ((data.Length() != 3) || !data[1]->IsInt32OrInt64() ||
+        !data[2]->IsInt32OrInt64()) {
+      return false;
+    }
+    offset = CObjectToInt64(data[1]);
+    length = CObjectToInt64(data[2]);
+    if (offset < 0) {
+      return false;
+    }
+  } else {
+    if ((data.Length() != 2) || !data[1]->IsInt32OrInt64()) {
+      return false;
+    }
+    length = CObjectToInt64(data[1]);
+  }
+  if ((length <= 0) || (length > kMaxInt32)) {
+    return false;
+  }
+
+  CObjectIntptr file_pointer(data[0]);
+  File* file = reinterpret_cast<File*>(file_pointer.Value());
+  if (file->IsClosed()) {
+    return false;
+  }
+  IOUringScope scope;
+  IOUringInstance* instance = scope.instance();
+  if (instance == NULL) {
+    enabled_ = false;
+    return false;
+  }
+
+  uint8_t* buffer = IOBuffer::Allocate(static_cast<intptr_t>(length));
+  if (buffer == NULL) {
+    return false;
+  }
+  if (source != NULL) {
+    // The request data is only valid for the duration of the IOService
+    // callback.
+    memmove(buffer, source, length);
+  }
+  IOUringOperation* operation = new IOUringOperation(
+      kind, reply_port, message_id, file, buffer, length, offset);
+  if (!instance->Submit(operation)) {
+    // The caller still owns the file reference.
+    operation->DetachFile();
+    delete operation;
+    if (instance->submit_failed()) {
+      enabled_ = false;
+    }
+    return false;
+  }
+  return true;
+}
+
+void IOUring::Cleanup() {
+  MonitorLocker ml(io_uring_monitor);
+  io_uring_state = kShutDown;
+  while (io_uring_users > 0) {
+    ml.Wait(Monitor::kNoTimeout);
+  }
+  if (io_uring_instance != NULL) {
+    if (io_uring_instance->Shutdown()) {
+      delete io_uring_instance;
+    }
+    // Otherwise the completion thread may still be waiting in the kernel,
+    // and the instance is leaked.
+    io_uring_instance = NULL;
+  }
+}
+
+}  // namespace bin
+}  // namespace dart
+
+#endif  // defined(HOST_OS_LINUX)
@@ -0,0 +1,27 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/globals.h"
+#if !defined(HOST_OS_LINUX)
+
+#include "bin/io_uring.h"
+
+namespace dart {
+namespace bin {
+
+bool IOUring::enabled_ = false;
+
+bool IOUring::SubmitRequest(Dart_Port reply_port,
+                            int32_t message_id,
+                            intptr_t request_id,
+                            const CObjectArray& data) {
+  return false;
+}
+
+void IOUring::Cleanup() {}
+
+}  // namespace bin
+}  // namespace dart
+
+#endif  // !defined(HOST_OS_LINUX)
@@ -3,6 +3,7 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "bin/isolate_data.h"
+#include "bin/file.h"
 #include "bin/snapshot_utils.h"
 #include "platform/growable_array.h"
 
@@ -22,7 +23,8 @@ IsolateData::IsolateData(const char* url,
       resolved_packages_config_(NULL),
       kernel_buffer_(NULL),
       kernel_buffer_size_(0),
-      owns_kernel_buffer_(false) {
+      owns_kernel_buffer_(false),
+      kernel_buffer_mapping_(NULL) {
   if (package_root != NULL) {
     ASSERT(packages_file == NULL);
     this->package_root = strdup(package_root);
@@ -34,6 +36,14 @@ IsolateData::IsolateData(const char* url,
 void IsolateData::OnIsolateShutdown() {
 }
 
+void IsolateData::set_kernel_buffer(MappedMemory* mapping) {
+  ASSERT(kernel_buffer_ == NULL);
+  kernel_buffer_mapping_ = mapping;
+  kernel_buffer_ = reinterpret_cast<uint8_t*>(mapping->address());
+  kernel_buffer_size_ = mapping->size();
+  owns_kernel_buffer_ = false;
+}
+
 IsolateData::~IsolateData() {
   free(script_url);
   script_url = NULL;
@@ -47,6 +57,8 @@ IsolateData::~IsolateData() {
     ASSERT(kernel_buffer_ != NULL);
     free(kernel_buffer_);
   }
+  delete kernel_buffer_mapping_;
+  kernel_buffer_mapping_ = NULL;
   kernel_buffer_ = NULL;
   kernel_buffer_size_ = 0;
   delete app_snapshot_;
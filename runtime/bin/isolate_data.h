@@ -24,6 +24,7 @@ namespace bin {
 class AppSnapshot;
 class EventHandler;
 class Loader;
+class MappedMemory;
 
 // Data associated with every isolate in the standalone VM
 // embedding. This is used to free external resources for each isolate
@@ -48,6 +49,9 @@ class IsolateData {
     kernel_buffer_size_ = size;
     owns_kernel_buffer_ = take_ownership;
   }
+  // Uses a kernel file mapped by DFE::MapScript as the kernel buffer. Takes
+  // ownership of [mapping], which is unmapped when the isolate is deleted.
+  void set_kernel_buffer(MappedMemory* mapping);
 
   void UpdatePackagesFile(const char* packages_file_) {
     if (packages_file != NULL) {
@@ -94,6 +98,7 @@ class IsolateData {
   uint8_t* kernel_buffer_;
   intptr_t kernel_buffer_size_;
   bool owns_kernel_buffer_;
+  MappedMemory* kernel_buffer_mapping_;
 
   DISALLOW_COPY_AND_ASSIGN(IsolateData);
 };
@@ -24,6 +24,7 @@
 #include "bin/loader.h"
 #include "bin/log.h"
 #include "bin/main_options.h"
+#include "bin/metrics.h"
 #include "bin/platform.h"
 #include "bin/process.h"
 #include "bin/snapshot_utils.h"
@@ -532,6 +533,7 @@ static Dart_Isolate CreateIsolateAndSetupHelper(bool is_main_isolate,
   ASSERT(script_uri != NULL);
   uint8_t* kernel_buffer = NULL;
   intptr_t kernel_buffer_size = 0;
+  MappedMemory* kernel_mapping = NULL;
   AppSnapshot* app_snapshot = NULL;
 
 #if defined(DART_PRECOMPILED_RUNTIME)
@@ -565,13 +567,21 @@ static Dart_Isolate CreateIsolateAndSetupHelper(bool is_main_isolate,
     }
   }
   if (!isolate_run_app_snapshot) {
-    dfe.ReadScript(script_uri, &kernel_buffer, &kernel_buffer_size);
+    kernel_mapping = dfe.MapScript(script_uri);
+    if (kernel_mapping != NULL) {
+      kernel_buffer = reinterpret_cast<uint8_t*>(kernel_mapping->address());
+      kernel_buffer_size = kernel_mapping->size();
+    } else {
+      dfe.ReadScript(script_uri, &kernel_buffer, &kernel_buffer_size);
+    }
   }
 #endif  // !defined(DART_PRECOMPILED_RUNTIME)
 
   IsolateData* isolate_data =
       new IsolateData(script_uri, package_root, packages_config, app_snapshot);
-  if (kernel_buffer != NULL) {
+  if (kernel_mapping != NULL) {
+    isolate_data->set_kernel_buffer(kernel_mapping);
+  } else if (kernel_buffer != NULL) {
     isolate_data->set_kernel_buffer(kernel_buffer, kernel_buffer_size,
                                     true /*take ownership*/);
   }
@@ -799,6 +809,7 @@ bool RunMainIsolate(const char* script_name, CommandLineOptions* dart_options) {
     Log::PrintErr("%s\n", error);
     free(error);
     error = NULL;
+    MetricsWriter::Stop();
     Process::TerminateExitCodeHandler();
     error = Dart_Cleanup();
     if (error != NULL) {
@@ -1073,15 +1084,22 @@ void main(int argc, char** argv) {
 // they might affect how the platform is loaded.
 #if !defined(DART_PRECOMPILED_RUNTIME)
   dfe.Init();
-  uint8_t* application_kernel_buffer = NULL;
-  intptr_t application_kernel_buffer_size = 0;
-  dfe.ReadScript(script_name, &application_kernel_buffer,
-                 &application_kernel_buffer_size);
-  if (application_kernel_buffer != NULL) {
-    // Since we loaded the script anyway, save it.
-    dfe.set_application_kernel_buffer(application_kernel_buffer,
-                                      application_kernel_buffer_size);
+  MappedMemory* application_kernel_mapping = dfe.MapScript(script_name);
+  if (application_kernel_mapping != NULL) {
+    // Since we mapped the script anyway, save it.
+    dfe.set_application_kernel_mapping(application_kernel_mapping);
     Options::dfe()->set_use_dfe();
+  } else {
+    uint8_t* application_kernel_buffer = NULL;
+    intptr_t application_kernel_buffer_size = 0;
+    dfe.ReadScript(script_name, &application_kernel_buffer,
+                   &application_kernel_buffer_size);
+    if (application_kernel_buffer != NULL) {
+      // Since we loaded the script anyway, save it.
+      dfe.set_application_kernel_buffer(application_kernel_buffer,
+                                        application_kernel_buffer_size);
+      Options::dfe()->set_use_dfe();
+    }
   }
 #endif
 
@@ -1120,11 +1138,17 @@ void main(int argc, char** argv) {
   Dart_SetFileModifiedCallback(&FileModifiedCallback);
   Dart_SetEmbedderInformationCallback(&EmbedderInformationCallback);
 
+  if (Options::metrics_filename() != NULL) {
+    MetricsWriter::Start(Options::metrics_filename());
+  }
+
   // Run the main isolate until we aren't told to restart.
   while (RunMainIsolate(script_name, &dart_options)) {
     Log::PrintErr("Restarting VM\n");
   }
 
+  MetricsWriter::Stop();
+
   // Terminate process exit-code handler.
   Process::TerminateExitCodeHandler();
 
@@ -8,6 +8,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "bin/eventhandler.h"
+#include "bin/io_uring.h"
 #include "bin/log.h"
 #include "bin/options.h"
 #include "bin/platform.h"
@@ -66,6 +68,17 @@ ENUM_OPTIONS_LIST(ENUM_OPTION_DEFINITION)
 CB_OPTIONS_LIST(CB_OPTION_DEFINITION)
 #undef CB_OPTION_DEFINITION
 
+DEFINE_STRING_OPTION_CB(event_handler_threads, {
+  char* end;
+  const intptr_t count = strtol(value, &end, 10);
+  if ((*end != '\0') || (count <= 0)) {
+    Log::PrintErr("Invalid value for option event_handler_threads: %s\n",
+                  value);
+    return false;
+  }
+  EventHandler::set_thread_count(count);
+});
+
 #if !defined(DART_PRECOMPILED_RUNTIME)
 DFE* Options::dfe_ = NULL;
 
@@ -199,6 +212,9 @@ void Options::PrintUsage() {
 "--root-certs-cache=<path>\n"
 "  The path to a cache directory containing the trusted root certificates to\n"
 "  use for secure socket connections.\n"
+"--write-metrics=<path>\n"
+"  Every 10 seconds and when the VM shuts down, writes the metrics of the\n"
+"  VM, its isolates and dart:io to <path> in the Prometheus text format.\n"
 #if defined(HOST_OS_LINUX) || \
     defined(HOST_OS_ANDROID) || \
     defined(HOST_OS_FUCHSIA)
@@ -206,6 +222,18 @@ void Options::PrintUsage() {
 "  The path to a directory that dart:io calls will treat as the root of the\n"
 "  filesystem.\n"
 #endif  // defined(HOST_OS_LINUX) || defined(HOST_OS_ANDROID)
+#if defined(HOST_OS_LINUX)
+"--event-handler-threads=<count>\n"
+"  The number of threads polling for socket events (default 1). Every\n"
+"  socket is assigned to one of the threads when it is created.\n"
+"--enable-io-uring\n"
+"  Submits asynchronous file reads and writes to io_uring instead of\n"
+"  performing them on IOService threads. Off by default.\n"
+"--reuse-port-for-shared\n"
+"  Gives every ServerSocket bound with `shared: true` its own SO_REUSEPORT\n"
+"  socket, so that the kernel distributes incoming connections between\n"
+"  them.\n"
+#endif  // defined(HOST_OS_LINUX)
 "\n"
 "The following options are only used for VM development and may\n"
 "be changed in any future version:\n");
@@ -389,6 +417,10 @@ int Options::ParseArguments(int argc,
 
   Socket::set_short_socket_read(Options::short_socket_read());
   Socket::set_short_socket_write(Options::short_socket_write());
+  IOUring::set_enabled(Options::io_uring_enabled());
+#if defined(HOST_OS_LINUX) || defined(HOST_OS_ANDROID)
+  Socket::set_reuse_port_for_shared(Options::reuse_port_for_shared());
+#endif  // defined(HOST_OS_LINUX) || defined(HOST_OS_ANDROID)
 #if !defined(DART_IO_SECURE_SOCKET_DISABLED)
   SSLCertContext::set_root_certs_file(Options::root_certs_file());
   SSLCertContext::set_root_certs_cache(Options::root_certs_cache());
@@ -28,6 +28,7 @@ namespace bin {
   V(load_compilation_trace, load_compilation_trace_filename)                   \
   V(root_certs_file, root_certs_file)                                          \
   V(root_certs_cache, root_certs_cache)                                        \
+  V(write_metrics, metrics_filename)                                           \
   V(namespace, namespc)
 
 // As STRING_OPTIONS_LIST but for boolean valued options. The default value is
@@ -40,6 +41,8 @@ namespace bin {
   V(trace_loading, trace_loading)                                              \
   V(short_socket_read, short_socket_read)                                      \
   V(short_socket_write, short_socket_write)                                    \
+  V(enable_io_uring, io_uring_enabled)                                         \
+  V(reuse_port_for_shared, reuse_port_for_shared)                              \
   V(disable_exit, exit_disabled)                                               \
   V(preview_dart_2, nop_option)
 
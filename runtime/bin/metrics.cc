@@ -0,0 +1,126 @@
+// Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "bin/metrics.h"
+
+#include "bin/file.h"
+#include "bin/lockers.h"
+#include "bin/log.h"
+#include "bin/thread.h"
+#include "include/dart_tools_api.h"
+#include "platform/text_buffer.h"
+#include "platform/utils.h"
+
+namespace dart {
+namespace bin {
+
+int64_t IOMetrics::counters_[IOMetrics::kNumCounters] = {0};
+
+const char* MetricsWriter::path_ = NULL;
+char* MetricsWriter::temp_path_ = NULL;
+Monitor* MetricsWriter::monitor_ = NULL;
+bool MetricsWriter::running_ = false;
+bool MetricsWriter::thread_done_ = false;
+
+static const int64_t kWritePeriodMillis = 10 * 1000;
+
+static void AppendToBuffer(Dart_StreamConsumer_State state,
+                           const char* stream_name,
+                           const uint8_t* buffer,
+                           intptr_t buffer_length,
+                           void* stream_callback_data) {
+  if ((state == Dart_StreamConsumer_kData) && (buffer_length > 0)) {
+    TextBuffer* text = reinterpret_cast<TextBuffer*>(stream_callback_data);
+    text->AddRaw(buffer, buffer_length);
+  }
+}
+
+static void PrintIOCounter(TextBuffer* text,
+                           const char* name,
+                           const char* help,
+                           IOMetrics::Counter counter) {
+  text->Printf("# HELP %s %s\n", name, help);
+  text->Printf("# TYPE %s counter\n", name);
+  text->Printf("%s %" Pd64 "\n", name, IOMetrics::Get(counter));
+}
+
+void MetricsWriter::WriteFile() {
+  TextBuffer text(4 * KB);
+  Dart_WriteMetrics(AppendToBuffer, &text);
+  PrintIOCounter(&text, "dart_io_file_read_bytes",
+                 "Bytes read from files by dart:io",
+                 IOMetrics::kFileBytesRead);
+  PrintIOCounter(&text, "dart_io_file_written_bytes",
+                 "Bytes written to files by dart:io",
+                 IOMetrics::kFileBytesWritten);
+  PrintIOCounter(&text, "dart_io_socket_read_bytes",
+                 "Bytes read from sockets by dart:io",
+                 IOMetrics::kSocketBytesRead);
+  PrintIOCounter(&text, "dart_io_socket_written_bytes",
+                 "Bytes written to sockets by dart:io",
+                 IOMetrics::kSocketBytesWritten);
+
+  File* file = File::Open(NULL, temp_path_, File::kWriteTruncate);
+  bool success = false;
+  if (file != NULL) {
+    success = file->WriteFully(text.buf(), text.length());
+    file->Release();
+  }
+  if (!success || !File::Rename(NULL, temp_path_, path_)) {
+    Log::PrintErr("Failed to write metrics to %s\n", path_);
+  }
+}
+
+void MetricsWriter::ThreadMain(uword parameters) {
+  monitor_->Enter();
+  while (running_) {
+    monitor_->Wait(kWritePeriodMillis);
+    // Write outside of the monitor, so that Stop does not wait for more than
+    // the write in progress.
+    monitor_->Exit();
+    WriteFile();
+    monitor_->Enter();
+  }
+  thread_done_ = true;
+  monitor_->Notify();
+  monitor_->Exit();
+}
+
+void MetricsWriter::Start(const char* path) {
+  ASSERT(monitor_ == NULL);
+  path_ = path;
+  const char* kTempFormat = "%s.tmp";
+  intptr_t len = Utils::SNPrint(NULL, 0, kTempFormat, path) + 1;
+  temp_path_ = reinterpret_cast<char*>(malloc(len));
+  Utils::SNPrint(temp_path_, len, kTempFormat, path);
+  monitor_ = new Monitor();
+  running_ = true;
+  thread_done_ = false;
+  int result = Thread::Start(ThreadMain, 0);
+  if (result != 0) {
+    FATAL1("Failed to start the metrics writer thread %d", result);
+  }
+}
+
+void MetricsWriter::Stop() {
+  if (monitor_ == NULL) {
+    return;
+  }
+  {
+    // The thread writes the file once more when it wakes up.
+    MonitorLocker ml(monitor_);
+    running_ = false;
+    ml.Notify();
+    while (!thread_done_) {
+      ml.Wait();
+    }
+  }
+  delete monitor_;
+  monitor_ = NULL;
+  free(temp_path_);
+  temp_path_ = NULL;
+}
+
+}  // namespace bin
+}  // namespace dart
@@ -0,0 +1,74 @@
+// Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_BIN_METRICS_H_
+#define RUNTIME_BIN_METRICS_H_
+
+#include "platform/atomic.h"
+#include "platform/globals.h"
+
+namespace dart {
+namespace bin {
+
+class Monitor;
+
+// Counts the bytes that dart:io transfers through files and sockets.
+class IOMetrics {
+ public:
+  enum Counter {
+    kFileBytesRead,
+    kFileBytesWritten,
+    kSocketBytesRead,
+    kSocketBytesWritten,
+    kNumCounters,
+  };
+
+  // May be called on any thread. Non-positive counts, as returned by failed
+  // reads and writes, are ignored.
+  static void Add(Counter counter, int64_t bytes) {
+    if (bytes > 0) {
+      AtomicOperations::IncrementInt64By(&counters_[counter], bytes);
+    }
+  }
+
+  static int64_t Get(Counter counter) {
+    return AtomicOperations::LoadRelaxed(&counters_[counter]);
+  }
+
+ private:
+  static int64_t counters_[kNumCounters];
+
+  DISALLOW_ALLOCATION();
+  DISALLOW_IMPLICIT_CONSTRUCTORS(IOMetrics);
+};
+
+// Writes the metrics of the VM (see Dart_WriteMetrics) together with the
+// IOMetrics to a file in the Prometheus text format, every few seconds and
+// once more on shutdown. The file is replaced by a rename, so a reader such as
+// the textfile collector of the Prometheus node exporter never sees a
+// partially written file.
+class MetricsWriter {
+ public:
+  static void Start(const char* path);
+  // Must be called before Dart_Cleanup.
+  static void Stop();
+
+ private:
+  static void ThreadMain(uword parameters);
+  static void WriteFile();
+
+  static const char* path_;
+  static char* temp_path_;
+  static Monitor* monitor_;
+  static bool running_;
+  static bool thread_done_;
+
+  DISALLOW_ALLOCATION();
+  DISALLOW_IMPLICIT_CONSTRUCTORS(MetricsWriter);
+};
+
+}  // namespace bin
+}  // namespace dart
+
+#endif  // RUNTIME_BIN_METRICS_H_
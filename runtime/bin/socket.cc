@@ -6,9 +6,11 @@
 
 #include "bin/dartutils.h"
 #include "bin/eventhandler.h"
+#include "bin/file.h"
 #include "bin/io_buffer.h"
 #include "bin/isolate_data.h"
 #include "bin/lockers.h"
+#include "bin/metrics.h"
 #include "bin/process.h"
 #include "bin/thread.h"
 #include "bin/utils.h"
@@ -27,6 +29,7 @@ ListeningSocketRegistry* globalTcpListeningSocketRegistry = NULL;
 
 bool Socket::short_socket_read_ = false;
 bool Socket::short_socket_write_ = false;
+bool Socket::reuse_port_for_shared_ = false;
 
 void ListeningSocketRegistry::Initialize() {
   ASSERT(globalTcpListeningSocketRegistry == NULL);
@@ -125,6 +128,14 @@ Dart_Handle ListeningSocketRegistry::CreateBindListen(Dart_Handle socket_object,
           return DartUtils::NewDartOSError(&os_error);
         }
 
+        if (os_socket_same_addr->reuse_port) {
+          // Give this binding its own socket on the same (address, port),
+          // so the kernel distributes incoming connections between the
+          // sockets instead of waking every isolate for each of them.
+          return CreateBindListenReusePort(socket_object, addr, port, backlog,
+                                           v6_only, first_os_socket);
+        }
+
         // This socket creation is the exact same as the one which originally
         // created the socket. We therefore increment the refcount and reuse
         // the file descriptor.
@@ -143,7 +154,9 @@ Dart_Handle ListeningSocketRegistry::CreateBindListen(Dart_Handle socket_object,
   }
 
   // There is no socket listening on that (address, port), so we create new one.
-  intptr_t fd = ServerSocket::CreateBindListen(addr, backlog, v6_only);
+  const bool reuse_port = shared && Socket::reuse_port_for_shared();
+  intptr_t fd =
+      ServerSocket::CreateBindListen(addr, backlog, v6_only, reuse_port);
   if (fd == -5) {
     OSError os_error(-1, "Invalid host", OSError::kUnknown);
     return DartUtils::NewDartOSError(&os_error);
@@ -178,8 +191,8 @@ Dart_Handle ListeningSocketRegistry::CreateBindListen(Dart_Handle socket_object,
   }
 
   Socket* socketfd = new Socket(fd);
-  OSSocket* os_socket =
-      new OSSocket(addr, allocated_port, v6_only, shared, socketfd);
+  OSSocket* os_socket = new OSSocket(addr, allocated_port, v6_only, shared,
+                                     reuse_port, socketfd);
   os_socket->ref_count = 1;
   os_socket->next = first_os_socket;
 
@@ -193,6 +206,38 @@ Dart_Handle ListeningSocketRegistry::CreateBindListen(Dart_Handle socket_object,
   return Dart_True();
 }
 
+Dart_Handle ListeningSocketRegistry::CreateBindListenReusePort(
+    Dart_Handle socket_object,
+    RawAddr addr,
+    intptr_t port,
+    intptr_t backlog,
+    bool v6_only,
+    OSSocket* first_os_socket) {
+  ASSERT(!mutex_->TryLock());
+  ASSERT(port > 0);
+  intptr_t fd = ServerSocket::CreateBindListen(addr, backlog, v6_only, true);
+  if (fd < 0) {
+    OSError error;
+    return DartUtils::NewDartOSError(&error);
+  }
+  if (!ServerSocket::StartAccept(fd)) {
+    OSError os_error(-1, "Failed to start accept", OSError::kUnknown);
+    return DartUtils::NewDartOSError(&os_error);
+  }
+
+  Socket* socketfd = new Socket(fd);
+  OSSocket* os_socket = new OSSocket(addr, port, v6_only, true, true, socketfd);
+  os_socket->ref_count = 1;
+  os_socket->next = first_os_socket;
+
+  InsertByPort(port, os_socket);
+  InsertByFd(socketfd, os_socket);
+
+  Socket::ReuseSocketIdNativeField(socket_object, socketfd,
+                                   Socket::kFinalizerListening);
+  return Dart_True();
+}
+
 bool ListeningSocketRegistry::CloseOneSafe(OSSocket* os_socket,
                                            bool update_hash_maps) {
   ASSERT(!mutex_->TryLock());
@@ -341,6 +386,7 @@ void FUNCTION_NAME(Socket_Read)(Dart_NativeArguments args) {
     ASSERT(buffer != NULL);
     intptr_t bytes_read =
         SocketBase::Read(socket->fd(), buffer, length, SocketBase::kAsync);
+    IOMetrics::Add(IOMetrics::kSocketBytesRead, bytes_read);
     if (bytes_read == length) {
       Dart_SetReturnValue(args, result);
     } else if (bytes_read > 0) {
@@ -370,20 +416,71 @@ void FUNCTION_NAME(Socket_Read)(Dart_NativeArguments args) {
   }
 }
 
-void FUNCTION_NAME(Socket_RecvFrom)(Dart_NativeArguments args) {
-  // TODO(sgjesse): Use a MTU value here. Only the loopback adapter can
-  // handle 64k datagrams.
-  const int kReceiveBufferLen = 65536;
+void FUNCTION_NAME(Socket_ReadInto)(Dart_NativeArguments args) {
   Socket* socket =
       Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
+  Dart_Handle buffer_obj = Dart_GetNativeArgument(args, 1);
+  intptr_t offset = DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 2));
+  intptr_t length = DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 3));
+  if (Socket::short_socket_read()) {
+    length = (length + 1) / 2;
+  }
+  Dart_TypedData_Type type;
+  uint8_t* buffer = NULL;
+  intptr_t len;
+  Dart_Handle result = Dart_TypedDataAcquireData(
+      buffer_obj, &type, reinterpret_cast<void**>(&buffer), &len);
+  if (Dart_IsError(result)) {
+    Dart_PropagateError(result);
+  }
+  ASSERT((type == Dart_TypedData_kUint8) || (type == Dart_TypedData_kInt8));
+  ASSERT((offset >= 0) && (length >= 0) && ((offset + length) <= len));
+  // Read directly into the caller's buffer, so that no external typed data
+  // is allocated for the data.
+  intptr_t bytes_read = SocketBase::Read(socket->fd(), buffer + offset, length,
+                                         SocketBase::kAsync);
+  if (bytes_read >= 0) {
+    IOMetrics::Add(IOMetrics::kSocketBytesRead, bytes_read);
+    Dart_TypedDataReleaseData(buffer_obj);
+    Dart_SetIntegerReturnValue(args, bytes_read);
+  } else {
+    // Extract OSError before we release data, as it may override the error.
+    OSError os_error;
+    Dart_TypedDataReleaseData(buffer_obj);
+    Dart_SetReturnValue(args, DartUtils::NewDartOSError(&os_error));
+  }
+}
 
-  // Ensure that a receive buffer for the UDP socket exists.
+// TODO(sgjesse): Use a MTU value here. Only the loopback adapter can
+// handle 64k datagrams.
+static const int kReceiveBufferLen = 65536;
+
+// Ensures that the receive buffer for the UDP socket exists and has room for
+// [slots] datagrams of kReceiveBufferLen bytes. The buffer only grows, up to
+// SocketBase::kMaxDatagramBatch slots.
+static uint8_t* GetUdpReceiveBuffer(Socket* socket, intptr_t slots) {
   ASSERT(socket != NULL);
+  ASSERT((slots > 0) && (slots <= SocketBase::kMaxDatagramBatch));
   uint8_t* recv_buffer = socket->udp_receive_buffer();
-  if (recv_buffer == NULL) {
-    recv_buffer = reinterpret_cast<uint8_t*>(malloc(kReceiveBufferLen));
+  if ((recv_buffer == NULL) || (socket->udp_receive_buffer_slots() < slots)) {
+    free(recv_buffer);
+    recv_buffer =
+        reinterpret_cast<uint8_t*>(malloc(slots * kReceiveBufferLen));
+    if (recv_buffer == NULL) {
+      OUT_OF_MEMORY();
+    }
     socket->set_udp_receive_buffer(recv_buffer);
+    socket->set_udp_receive_buffer_slots(slots);
   }
+  return recv_buffer;
+}
+
+void FUNCTION_NAME(Socket_RecvFrom)(Dart_NativeArguments args) {
+  Socket* socket =
+      Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
+
+  // Ensure that a receive buffer for the UDP socket exists.
+  uint8_t* recv_buffer = GetUdpReceiveBuffer(socket, 1);
 
   // Read data into the buffer.
   RawAddr addr;
@@ -398,6 +495,7 @@ void FUNCTION_NAME(Socket_RecvFrom)(Dart_NativeArguments args) {
     Dart_SetReturnValue(args, DartUtils::NewDartOSError());
     return;
   }
+  IOMetrics::Add(IOMetrics::kSocketBytesRead, bytes_read);
 
   // Datagram data read. Copy into buffer of the exact size,
   ASSERT(bytes_read > 0);
@@ -448,6 +546,81 @@ void FUNCTION_NAME(Socket_RecvFrom)(Dart_NativeArguments args) {
   Dart_SetReturnValue(args, result);
 }
 
+void FUNCTION_NAME(Socket_RecvFromBatch)(Dart_NativeArguments args) {
+  Socket* socket =
+      Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
+  int64_t count = DartUtils::GetInt64ValueCheckRange(
+      Dart_GetNativeArgument(args, 1), 1, SocketBase::kMaxDatagramBatch);
+  uint8_t* recv_buffer = GetUdpReceiveBuffer(socket, count);
+
+  RawAddr addrs[SocketBase::kMaxDatagramBatch];
+  intptr_t lengths[SocketBase::kMaxDatagramBatch];
+  const intptr_t received =
+      SocketBase::RecvFromBatch(socket->fd(), recv_buffer, kReceiveBufferLen,
+                                count, lengths, addrs, SocketBase::kAsync);
+  if (received == 0) {
+    Dart_SetReturnValue(args, Dart_Null());
+    return;
+  }
+  if (received < 0) {
+    ASSERT(received == -1);
+    Dart_SetReturnValue(args, DartUtils::NewDartOSError());
+    return;
+  }
+
+  // Copy the datagrams back to back into a single buffer.
+  intptr_t total_length = 0;
+  for (intptr_t i = 0; i < received; i++) {
+    total_length += lengths[i];
+  }
+  IOMetrics::Add(IOMetrics::kSocketBytesRead, total_length);
+  uint8_t* data_buffer = NULL;
+  Dart_Handle data = IOBuffer::Allocate(total_length, &data_buffer);
+  if (Dart_IsNull(data)) {
+    Dart_SetReturnValue(args, DartUtils::NewDartOSError());
+    return;
+  }
+  if (Dart_IsError(data)) {
+    Dart_PropagateError(data);
+  }
+
+  // The result is [data, (length, address, in_addr, port) * received].
+  const intptr_t kValuesPerDatagram = 4;
+  Dart_Handle result = Dart_NewList(1 + received * kValuesPerDatagram);
+  if (Dart_IsError(result)) {
+    Dart_PropagateError(result);
+  }
+  Dart_ListSetAt(result, 0, data);
+  intptr_t offset = 0;
+  for (intptr_t i = 0; i < received; i++) {
+    memmove(data_buffer + offset, recv_buffer + i * kReceiveBufferLen,
+            lengths[i]);
+    offset += lengths[i];
+
+    // Get the port and clear it in the sockaddr structure.
+    RawAddr addr = addrs[i];
+    int port = SocketAddress::GetAddrPort(addr);
+    if (addr.addr.sa_family == AF_INET) {
+      addr.in.sin_port = 0;
+    } else {
+      ASSERT(addr.addr.sa_family == AF_INET6);
+      addr.in6.sin6_port = 0;
+    }
+    char numeric_address[INET6_ADDRSTRLEN];
+    SocketBase::FormatNumericAddress(addr, numeric_address, INET6_ADDRSTRLEN);
+    Dart_Handle address = Dart_NewStringFromCString(numeric_address);
+    if (Dart_IsError(address)) {
+      Dart_PropagateError(address);
+    }
+    const intptr_t base = 1 + i * kValuesPerDatagram;
+    Dart_ListSetAt(result, base, Dart_NewInteger(lengths[i]));
+    Dart_ListSetAt(result, base + 1, address);
+    Dart_ListSetAt(result, base + 2, SocketAddress::ToTypedData(addr));
+    Dart_ListSetAt(result, base + 3, Dart_NewInteger(port));
+  }
+  Dart_SetReturnValue(args, result);
+}
+
 void FUNCTION_NAME(Socket_WriteList)(Dart_NativeArguments args) {
   Socket* socket =
       Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
@@ -475,6 +648,7 @@ void FUNCTION_NAME(Socket_WriteList)(Dart_NativeArguments args) {
   intptr_t bytes_written =
       SocketBase::Write(socket->fd(), buffer, length, SocketBase::kAsync);
   if (bytes_written >= 0) {
+    IOMetrics::Add(IOMetrics::kSocketBytesWritten, bytes_written);
     Dart_TypedDataReleaseData(buffer_obj);
     if (short_write) {
       // If the write was forced 'short', indicate by returning the negative
@@ -491,6 +665,151 @@ void FUNCTION_NAME(Socket_WriteList)(Dart_NativeArguments args) {
   }
 }
 
+void FUNCTION_NAME(Socket_WriteBuffers)(Dart_NativeArguments args) {
+  Socket* socket =
+      Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
+  Dart_Handle buffers_obj = Dart_GetNativeArgument(args, 1);
+  Dart_Handle offsets_obj = Dart_GetNativeArgument(args, 2);
+  Dart_Handle lengths_obj = Dart_GetNativeArgument(args, 3);
+  ASSERT(Dart_IsList(buffers_obj));
+  intptr_t count = 0;
+  Dart_Handle result = Dart_ListLength(buffers_obj, &count);
+  if (Dart_IsError(result)) {
+    Dart_PropagateError(result);
+  }
+  ASSERT((count > 0) && (count <= SocketBase::kMaxWriteBuffers));
+
+  // Look up all list elements before acquiring any of the buffers.
+  Dart_Handle buffer_objs[SocketBase::kMaxWriteBuffers];
+  intptr_t offsets[SocketBase::kMaxWriteBuffers];
+  intptr_t lengths[SocketBase::kMaxWriteBuffers];
+  intptr_t total_length = 0;
+  for (intptr_t i = 0; i < count; i++) {
+    buffer_objs[i] = Dart_ListGetAt(buffers_obj, i);
+    if (Dart_IsError(buffer_objs[i])) {
+      Dart_PropagateError(buffer_objs[i]);
+    }
+    Dart_Handle offset_obj = Dart_ListGetAt(offsets_obj, i);
+    if (Dart_IsError(offset_obj)) {
+      Dart_PropagateError(offset_obj);
+    }
+    Dart_Handle length_obj = Dart_ListGetAt(lengths_obj, i);
+    if (Dart_IsError(length_obj)) {
+      Dart_PropagateError(length_obj);
+    }
+    offsets[i] = DartUtils::GetIntptrValue(offset_obj);
+    lengths[i] = DartUtils::GetIntptrValue(length_obj);
+    total_length += lengths[i];
+  }
+  bool short_write = false;
+  if (Socket::short_socket_write()) {
+    if (total_length > 1) {
+      short_write = true;
+    }
+    // Only write the first half of the data.
+    intptr_t remaining = (total_length + 1) / 2;
+    for (intptr_t i = 0; i < count; i++) {
+      if (lengths[i] >= remaining) {
+        lengths[i] = remaining;
+        count = i + 1;
+        break;
+      }
+      remaining -= lengths[i];
+    }
+  }
+
+  const void* buffers[SocketBase::kMaxWriteBuffers];
+  intptr_t acquired = 0;
+  for (; acquired < count; acquired++) {
+    Dart_TypedData_Type type;
+    uint8_t* buffer = NULL;
+    intptr_t len;
+    result = Dart_TypedDataAcquireData(buffer_objs[acquired], &type,
+                                       reinterpret_cast<void**>(&buffer), &len);
+    if (Dart_IsError(result)) {
+      break;
+    }
+    ASSERT((offsets[acquired] + lengths[acquired]) <= len);
+    buffers[acquired] = buffer + offsets[acquired];
+  }
+  if (acquired < count) {
+    for (intptr_t i = 0; i < acquired; i++) {
+      Dart_TypedDataReleaseData(buffer_objs[i]);
+    }
+    Dart_PropagateError(result);
+  }
+
+  intptr_t bytes_written = SocketBase::WriteV(socket->fd(), buffers, lengths,
+                                              count, SocketBase::kAsync);
+  if (bytes_written < 0) {
+    // Extract OSError before we release data, as it may override the error.
+    OSError os_error;
+    for (intptr_t i = 0; i < count; i++) {
+      Dart_TypedDataReleaseData(buffer_objs[i]);
+    }
+    Dart_SetReturnValue(args, DartUtils::NewDartOSError(&os_error));
+    return;
+  }
+  IOMetrics::Add(IOMetrics::kSocketBytesWritten, bytes_written);
+  for (intptr_t i = 0; i < count; i++) {
+    Dart_TypedDataReleaseData(buffer_objs[i]);
+  }
+  if (short_write) {
+    // If the write was forced 'short', indicate by returning the negative
+    // number of bytes. A forced short write may not trigger a write event.
+    Dart_SetReturnValue(args, Dart_NewInteger(-bytes_written));
+  } else {
+    Dart_SetReturnValue(args, Dart_NewInteger(bytes_written));
+  }
+}
+
+void FUNCTION_NAME(Socket_SendFile)(Dart_NativeArguments args) {
+  Socket* socket =
+      Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
+  // The pointer comes from _RandomAccessFile._pointer(), which retains the
+  // file for us.
+  File* file = reinterpret_cast<File*>(
+      DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 1)));
+  RefCntReleaseScope<File> rs(file);
+  int64_t offset = DartUtils::GetInt64ValueCheckRange(
+      Dart_GetNativeArgument(args, 2), 0, kMaxInt64);
+  intptr_t length = DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 3));
+  ASSERT(length > 0);
+  if (file->IsClosed()) {
+    OSError os_error(-1, "File closed", OSError::kUnknown);
+    Dart_SetReturnValue(args, DartUtils::NewDartOSError(&os_error));
+    return;
+  }
+  bool short_write = false;
+  if (Socket::short_socket_write()) {
+    if (length > 1) {
+      short_write = true;
+    }
+    length = (length + 1) / 2;
+  }
+  intptr_t bytes_sent = SocketBase::SendFile(socket->fd(), file, offset,
+                                             length, SocketBase::kAsync);
+  if (bytes_sent < 0) {
+    Dart_SetReturnValue(args, DartUtils::NewDartOSError());
+    return;
+  }
+  if (bytes_sent > 0) {
+    IOMetrics::Add(IOMetrics::kSocketBytesWritten, bytes_sent);
+  }
+  if ((bytes_sent == 0) && (offset >= file->Length())) {
+    // End of file.
+    Dart_SetReturnValue(args, Dart_Null());
+    return;
+  }
+  if (short_write) {
+    // If the write was forced 'short', indicate by returning the negative
+    // number of bytes. A forced short write may not trigger a write event.
+    Dart_SetReturnValue(args, Dart_NewInteger(-bytes_sent));
+  } else {
+    Dart_SetReturnValue(args, Dart_NewInteger(bytes_sent));
+  }
+}
+
 void FUNCTION_NAME(Socket_SendTo)(Dart_NativeArguments args) {
   Socket* socket =
       Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
@@ -517,6 +836,7 @@ void FUNCTION_NAME(Socket_SendTo)(Dart_NativeArguments args) {
   intptr_t bytes_written = SocketBase::SendTo(socket->fd(), buffer, length,
                                               addr, SocketBase::kAsync);
   if (bytes_written >= 0) {
+    IOMetrics::Add(IOMetrics::kSocketBytesWritten, bytes_written);
     Dart_TypedDataReleaseData(buffer_obj);
     Dart_SetReturnValue(args, Dart_NewInteger(bytes_written));
   } else {
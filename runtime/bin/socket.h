@@ -58,6 +58,13 @@ class Socket : public ReferenceCounted<Socket> {
 
   uint8_t* udp_receive_buffer() const { return udp_receive_buffer_; }
   void set_udp_receive_buffer(uint8_t* buffer) { udp_receive_buffer_ = buffer; }
+  // The number of datagrams the UDP receive buffer has room for.
+  intptr_t udp_receive_buffer_slots() const {
+    return udp_receive_buffer_slots_;
+  }
+  void set_udp_receive_buffer_slots(intptr_t slots) {
+    udp_receive_buffer_slots_ = slots;
+  }
 
   static bool Initialize();
 
@@ -94,6 +101,12 @@ class Socket : public ReferenceCounted<Socket> {
   static void set_short_socket_write(bool short_socket_write) {
     short_socket_write_ = short_socket_write;
   }
+  // Whether listening sockets bound with `shared: true` get their own
+  // SO_REUSEPORT socket instead of sharing a single one.
+  static bool reuse_port_for_shared() { return reuse_port_for_shared_; }
+  static void set_reuse_port_for_shared(bool reuse_port_for_shared) {
+    reuse_port_for_shared_ = reuse_port_for_shared;
+  }
 
   static bool IsSignalSocketFlag(intptr_t flag) {
     return ((flag & (0x1 << kInternalSignalSocket)) != 0);
@@ -110,11 +123,13 @@ class Socket : public ReferenceCounted<Socket> {
 
   static bool short_socket_read_;
   static bool short_socket_write_;
+  static bool reuse_port_for_shared_;
 
   intptr_t fd_;
   Dart_Port isolate_port_;
   Dart_Port port_;
   uint8_t* udp_receive_buffer_;
+  intptr_t udp_receive_buffer_slots_;
 
   friend class ReferenceCounted<Socket>;
   DISALLOW_COPY_AND_ASSIGN(Socket);
@@ -129,6 +144,11 @@ class ServerSocket {
   // Creates a socket which is bound and listens. The port to listen on is
   // specified in the port component of the passed RawAddr structure.
   //
+  // If [reuse_port] is true the socket is created with SO_REUSEPORT, so that
+  // further sockets with SO_REUSEPORT can bind to the same address and the
+  // kernel distributes incoming connections between them. This is only
+  // supported on Linux and Android.
+  //
   // Returns a positive integer if the call is successful. In case of failure
   // it returns:
   //
@@ -136,7 +156,8 @@ class ServerSocket {
   //   -5: invalid bindAddress
   static intptr_t CreateBindListen(const RawAddr& addr,
                                    intptr_t backlog,
-                                   bool v6_only = false);
+                                   bool v6_only = false,
+                                   bool reuse_port = false);
 
   // Start accepting on a newly created listening socket. If it was unable to
   // start accepting incoming sockets, the fd is invalidated.
@@ -192,6 +213,9 @@ class ListeningSocketRegistry {
     int port;
     bool v6_only;
     bool shared;
+    // Whether the socket was created with SO_REUSEPORT. Such sockets are not
+    // shared between isolates; each binding creates its own socket.
+    bool reuse_port;
     int ref_count;
     Socket* socketfd;
 
@@ -203,11 +227,13 @@ class ListeningSocketRegistry {
              int port,
              bool v6_only,
              bool shared,
+             bool reuse_port,
              Socket* socketfd)
         : address(address),
           port(port),
           v6_only(v6_only),
           shared(shared),
+          reuse_port(reuse_port),
           ref_count(0),
           socketfd(socketfd),
           next(NULL) {}
@@ -237,6 +263,15 @@ class ListeningSocketRegistry {
     return reinterpret_cast<void*>(i + 1);
   }
 
+  // Creates another SO_REUSEPORT socket bound to the (address, port) of an
+  // existing one, and adds it to the list starting at [first_os_socket].
+  Dart_Handle CreateBindListenReusePort(Dart_Handle socket_object,
+                                        RawAddr addr,
+                                        intptr_t port,
+                                        intptr_t backlog,
+                                        bool v6_only,
+                                        OSSocket* first_os_socket);
+
   OSSocket* LookupByPort(intptr_t port);
   void InsertByPort(intptr_t port, OSSocket* socket);
   void RemoveByPort(intptr_t port);
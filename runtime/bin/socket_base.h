@@ -31,6 +31,8 @@
 namespace dart {
 namespace bin {
 
+class File;
+
 union RawAddr {
   struct sockaddr_in in;
   struct sockaddr_in6 in6;
@@ -141,6 +143,16 @@ class SocketBase : public AllStatic {
     kAsync,
   };
 
+  // Maximum number of buffers passed to WriteV. Keep in sync with
+  // _NativeSocket.maxWriteBuffers in socket_patch.dart.
+  static const intptr_t kMaxWriteBuffers = 64;
+
+  // Maximum number of datagrams passed to RecvFromBatch. Every datagram
+  // needs a 64KB slot in the receive buffer of the socket, so this bounds that
+  // buffer to 256KB. Keep in sync with _NativeSocket.maxDatagramBatch in
+  // socket_patch.dart.
+  static const intptr_t kMaxDatagramBatch = 4;
+
   // TODO(dart:io): Convert these to instance methods where possible.
   static bool Initialize();
   static intptr_t Available(intptr_t fd);
@@ -152,6 +164,23 @@ class SocketBase : public AllStatic {
                         const void* buffer,
                         intptr_t num_bytes,
                         SocketOpKind sync);
+  // Writes [count] buffers, at most kMaxWriteBuffers, in order. Uses a
+  // single system call where the platform supports vectored writes. Returns
+  // the total number of bytes written.
+  static intptr_t WriteV(intptr_t fd,
+                         const void* const* buffers,
+                         const intptr_t* lengths,
+                         intptr_t count,
+                         SocketOpKind sync);
+  // Sends up to [num_bytes] bytes of [file], starting at [offset], to the
+  // socket. Where the platform supports it the data is not copied through
+  // user space. The file position is not changed. Returns the number of
+  // bytes sent, which is 0 at the end of the file.
+  static intptr_t SendFile(intptr_t fd,
+                           File* file,
+                           int64_t offset,
+                           intptr_t num_bytes,
+                           SocketOpKind sync);
   // Send data on a socket. The port to send to is specified in the port
   // component of the passed RawAddr structure. The RawAddr structure is only
   // used for datagram sockets.
@@ -165,6 +194,17 @@ class SocketBase : public AllStatic {
                            intptr_t num_bytes,
                            RawAddr* addr,
                            SocketOpKind sync);
+  // Receives up to [count] datagrams, with a single system call where the
+  // platform supports it. Datagram i is received at [buffer] + i *
+  // [buffer_size], and its length and sender are stored in [lengths][i] and
+  // [addrs][i]. Returns the number of datagrams received.
+  static intptr_t RecvFromBatch(intptr_t fd,
+                                uint8_t* buffer,
+                                intptr_t buffer_size,
+                                intptr_t count,
+                                intptr_t* lengths,
+                                RawAddr* addrs,
+                                SocketOpKind sync);
   // Returns true if the given error-number is because the system was not able
   // to bind the socket to a specific IP.
   static bool IsBindError(intptr_t error_number);
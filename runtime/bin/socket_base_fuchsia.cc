@@ -27,6 +27,7 @@
 #include "bin/file.h"
 #include "bin/socket_base_fuchsia.h"
 #include "platform/signal_blocker.h"
+#include "platform/utils.h"
 
 // #define SOCKET_LOG_INFO 1
 // #define SOCKET_LOG_ERROR 1
@@ -123,6 +124,23 @@ intptr_t SocketBase::RecvFrom(intptr_t fd,
   return -1;
 }
 
+intptr_t SocketBase::RecvFromBatch(intptr_t fd,
+                                   uint8_t* buffer,
+                                   intptr_t buffer_size,
+                                   intptr_t count,
+                                   intptr_t* lengths,
+                                   RawAddr* addrs,
+                                   SocketOpKind sync) {
+  ASSERT((count > 0) && (count <= kMaxDatagramBatch));
+  // No batched receive on this platform. Receive a single datagram.
+  intptr_t bytes_read = RecvFrom(fd, buffer, buffer_size, &addrs[0], sync);
+  if (bytes_read <= 0) {
+    return bytes_read;
+  }
+  lengths[0] = bytes_read;
+  return 1;
+}
+
 intptr_t SocketBase::Write(intptr_t fd,
                            const void* buffer,
                            intptr_t num_bytes,
@@ -147,6 +165,53 @@ intptr_t SocketBase::Write(intptr_t fd,
   return written_bytes;
 }
 
+intptr_t SocketBase::WriteV(intptr_t fd,
+                            const void* const* buffers,
+                            const intptr_t* lengths,
+                            intptr_t count,
+                            SocketOpKind sync) {
+  ASSERT((count > 0) && (count <= kMaxWriteBuffers));
+  // No vectored write for handles. Write the buffers in turn until one is
+  // not written completely.
+  intptr_t total = 0;
+  for (intptr_t i = 0; i < count; i++) {
+    intptr_t written_bytes = Write(fd, buffers[i], lengths[i], sync);
+    if (written_bytes < 0) {
+      return (total > 0) ? total : written_bytes;
+    }
+    total += written_bytes;
+    if (written_bytes < lengths[i]) {
+      break;
+    }
+  }
+  return total;
+}
+
+intptr_t SocketBase::SendFile(intptr_t fd,
+                              File* file,
+                              int64_t offset,
+                              intptr_t num_bytes,
+                              SocketOpKind sync) {
+  // No sendfile for handles. Read a block at [offset] and write it,
+  // restoring the file position afterwards.
+  const intptr_t kBufferSize = 16 * KB;
+  uint8_t buffer[kBufferSize];
+  const int64_t position = file->Position();
+  if ((position < 0) || !file->SetPosition(offset)) {
+    return -1;
+  }
+  const int64_t read_bytes =
+      file->Read(buffer, Utils::Minimum(num_bytes, kBufferSize));
+  const bool restored = file->SetPosition(position);
+  if ((read_bytes < 0) || !restored) {
+    return -1;
+  }
+  if (read_bytes == 0) {
+    return 0;
+  }
+  return Write(fd, buffer, read_bytes, sync);
+}
+
 intptr_t SocketBase::SendTo(intptr_t fd,
                             const void* buffer,
                             intptr_t num_bytes,
@@ -307,9 +307,18 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
   static const int protocolIPv4 = 1 << 0;
   static const int protocolIPv6 = 1 << 1;
 
+  // Keep in sync with SocketBase::kMaxWriteBuffers in socket_base.h.
+  static const int maxWriteBuffers = 64;
+  // Keep in sync with SocketBase::kMaxDatagramBatch in socket_base.h.
+  static const int maxDatagramBatch = 4;
+
   static const int normalTokenBatchSize = 8;
   static const int listeningTokenBatchSize = 2;
 
+  // Reads of up to this many bytes go straight into the list returned, see
+  // readInto, instead of allocating an external buffer per read.
+  static const int maxReadIntoSize = 64 * 1024;
+
   static const Duration _retryDuration = const Duration(milliseconds: 250);
   static const Duration _retryDurationLoopback =
       const Duration(milliseconds: 25);
@@ -322,6 +331,12 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
   bool isClosedWrite = false;
   Completer closeCompleter = new Completer.sync();
 
+  // Datagrams received with a single native call but not yet returned by
+  // receive, and the number of datagrams to ask for in the next call.
+  List<Datagram> receivedDatagrams;
+  int receivedDatagramIndex = 0;
+  int receiveBatchSize = 1;
+
   // Handlers and receive port for socket events from the event handler.
   final List eventHandlers = new List(eventCount + 1);
   RawReceivePort eventPort;
@@ -635,40 +650,86 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
     if (isClosing || isClosed) return null;
     len = min(available, len == null ? available : len);
     if (len == 0) return null;
+    if (len <= maxReadIntoSize) {
+      var buffer = new Uint8List(len);
+      var bytes = readInto(buffer, 0, len);
+      if (bytes == null) return null;
+      // Copy a short read, so that the result does not keep the unused part
+      // alive. Use RawSocket.readInto to read without allocating.
+      if (bytes < len) return buffer.sublist(0, bytes);
+      return buffer;
+    }
     var result = nativeRead(len);
     if (result is OSError) {
       reportError(result, "Read failed");
       return null;
     }
-    if (result != null) {
-      available -= result.length;
-      // TODO(ricow): Remove when we track internal and pipe uses.
-      assert(resourceInfo != null || isPipe || isInternal || isInternalSignal);
-      if (resourceInfo != null) {
-        resourceInfo.totalRead += result.length;
-      }
+    _didRead(result == null ? 0 : result.length);
+    return result;
+  }
+
+  // Reads at most [bytes] bytes into [buffer] starting at [offset], without
+  // allocating. Returns the number of bytes read, or null if nothing could
+  // be read.
+  int readInto(List<int> buffer, int offset, int bytes) {
+    if (buffer is! Uint8List) throw new ArgumentError();
+    if (offset < 0) throw new RangeError.value(offset);
+    if (bytes <= 0) throw new ArgumentError("Illegal length $bytes");
+    if ((offset + bytes) > buffer.length) {
+      throw new RangeError.value(offset + bytes);
+    }
+    if (isClosing || isClosed) return null;
+    bytes = min(available, bytes);
+    if (bytes == 0) return null;
+    var result = nativeReadInto(buffer, offset, bytes);
+    if (result is OSError) {
+      reportError(result, "Read failed");
+      return null;
     }
+    _didRead(result);
+    return (result > 0) ? result : null;
+  }
+
+  void _didRead(int bytes) {
+    available -= bytes;
     // TODO(ricow): Remove when we track internal and pipe uses.
     assert(resourceInfo != null || isPipe || isInternal || isInternalSignal);
     if (resourceInfo != null) {
+      resourceInfo.totalRead += bytes;
       resourceInfo.didRead();
     }
-    return result;
   }
 
   Datagram receive() {
     if (isClosing || isClosed) return null;
-    var result = nativeRecvFrom();
-    if (result is OSError) {
-      reportError(result, "Receive failed");
-      return null;
+    if (receivedDatagrams == null) {
+      var result = nativeRecvFromBatch(receiveBatchSize);
+      if (result is OSError) {
+        reportError(result, "Receive failed");
+        return null;
+      }
+      if (result != null) {
+        receivedDatagrams = _unpackDatagrams(result);
+        receivedDatagramIndex = 0;
+        // Receive more datagrams per call while the socket is busy.
+        if (receivedDatagrams.length == receiveBatchSize &&
+            receiveBatchSize < maxDatagramBatch) {
+          receiveBatchSize *= 2;
+        }
+      }
     }
-    if (result != null) {
+    Datagram result;
+    if (receivedDatagrams != null) {
+      result = receivedDatagrams[receivedDatagramIndex++];
+      if (receivedDatagramIndex == receivedDatagrams.length) {
+        receivedDatagrams = null;
+      }
       // Read the next available. Available is only for the next datagram, not
       // the sum of all datagrams pending, so we need to call after each
       // receive. If available becomes > 0, the _NativeSocket will continue to
-      // emit read events.
-      available = nativeAvailable();
+      // emit read events. While received datagrams are queued there is no
+      // need to ask.
+      available = (receivedDatagrams != null) ? 1 : nativeAvailable();
       // TODO(ricow): Remove when we track internal and pipe uses.
       assert(resourceInfo != null || isPipe || isInternal || isInternalSignal);
       if (resourceInfo != null) {
@@ -683,6 +744,26 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
     return result;
   }
 
+  // Unpacks the result of Socket_RecvFromBatch. The datagrams are views on
+  // a single buffer.
+  static List<Datagram> _unpackDatagrams(List packed) {
+    Uint8List data = packed[0];
+    int count = (packed.length - 1) ~/ 4;
+    var datagrams = new List<Datagram>(count);
+    int offset = 0;
+    for (int i = 0; i < count; i++) {
+      int base = 1 + i * 4;
+      int length = packed[base];
+      var datagramData = (count == 1)
+          ? data
+          : new Uint8List.view(data.buffer, data.offsetInBytes + offset, length);
+      datagrams[i] = _makeDatagram(
+          datagramData, packed[base + 1], packed[base + 2], packed[base + 3]);
+      offset += length;
+    }
+    return datagrams;
+  }
+
   int write(List<int> buffer, int offset, int bytes) {
     if (buffer is! List) throw new ArgumentError();
     if (offset == null) offset = 0;
@@ -706,6 +787,45 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
         _ensureFastAndSerializableByteData(buffer, offset, offset + bytes);
     var result =
         nativeWrite(bufferAndStart.buffer, bufferAndStart.start, bytes);
+    return _didWrite(result, bytes);
+  }
+
+  // Writes the given buffers in order with a single native call, starting at
+  // [offset] in the first buffer. At most [maxWriteBuffers] buffers are
+  // written. Returns the number of bytes written.
+  int writeBuffers(List<List<int>> buffers, int offset) {
+    if (isClosing || isClosed) return 0;
+    int count = min(buffers.length, maxWriteBuffers);
+    var nativeBuffers = new List(count);
+    var offsets = new List<int>(count);
+    var lengths = new List<int>(count);
+    int bytes = 0;
+    for (int i = 0; i < count; i++) {
+      List<int> buffer = buffers[i];
+      int start = (i == 0) ? offset : 0;
+      _BufferAndStart bufferAndStart =
+          _ensureFastAndSerializableByteData(buffer, start, buffer.length);
+      nativeBuffers[i] = bufferAndStart.buffer;
+      offsets[i] = bufferAndStart.start;
+      lengths[i] = buffer.length - start;
+      bytes += lengths[i];
+    }
+    if (bytes == 0) return 0;
+    var result = nativeWriteBuffers(nativeBuffers, offsets, lengths);
+    return _didWrite(result, bytes);
+  }
+
+  // Sends up to [bytes] bytes of [file], starting at [offset], without
+  // copying them through the heap. Returns the number of bytes sent, or null
+  // at the end of the file.
+  int sendFile(_RandomAccessFile file, int offset, int bytes) {
+    if (isClosing || isClosed) return 0;
+    var result = nativeSendFile(file._pointer(), offset, bytes);
+    if (result == null) return null;
+    return _didWrite(result, bytes);
+  }
+
+  int _didWrite(result, int bytes) {
     if (result is OSError) {
       OSError osError = result;
       scheduleMicrotask(() => reportError(osError, "Write failed"));
@@ -870,7 +990,9 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
           if (isListening) {
             available++;
           } else {
-            available = nativeAvailable();
+            // Datagrams already received in a batch are still available,
+            // even if the batch drained the socket.
+            available = (receivedDatagrams != null) ? 1 : nativeAvailable();
             issueReadEvent();
             continue;
           }
@@ -1119,9 +1241,15 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
   void nativeSetSocketId(int id, int typeFlags) native "Socket_SetSocketId";
   nativeAvailable() native "Socket_Available";
   nativeRead(int len) native "Socket_Read";
+  nativeReadInto(List<int> buffer, int offset, int bytes)
+      native "Socket_ReadInto";
   nativeRecvFrom() native "Socket_RecvFrom";
+  nativeRecvFromBatch(int count) native "Socket_RecvFromBatch";
   nativeWrite(List<int> buffer, int offset, int bytes)
       native "Socket_WriteList";
+  nativeWriteBuffers(List buffers, List<int> offsets, List<int> lengths)
+      native "Socket_WriteBuffers";
+  nativeSendFile(int file, int offset, int bytes) native "Socket_SendFile";
   nativeSendTo(List<int> buffer, int offset, int bytes, List<int> address,
       int port) native "Socket_SendTo";
   nativeCreateConnect(List<int> addr, int port) native "Socket_CreateConnect";
@@ -1335,6 +1463,22 @@ class _RawSocket extends Stream<RawSocketEvent> implements RawSocket {
     }
   }
 
+  int readInto(Uint8List buffer, [int offset = 0, int count]) {
+    if (count == null) count = buffer.length - offset;
+    if (_isMacOSTerminalInput) {
+      var available = this.available();
+      if (available == 0) return null;
+      var bytes = _socket.readInto(buffer, offset, count);
+      if (bytes == null || (bytes < available && bytes < count)) {
+        // See read.
+        scheduleMicrotask(() => _controller.add(RawSocketEvent.readClosed));
+      }
+      return bytes;
+    } else {
+      return _socket.readInto(buffer, offset, count);
+    }
+  }
+
   int write(List<int> buffer, [int offset, int count]) =>
       _socket.write(buffer, offset, count);
 
@@ -1463,24 +1607,53 @@ class Socket {
 }
 
 class _SocketStreamConsumer extends StreamConsumer<List<int>> {
+  // While a write is blocked, data is queued until this many bytes are
+  // pending, so that the queue can be flushed with a single native call.
+  static const int maxPendingBytes = 64 * 1024;
+
   StreamSubscription subscription;
   final _Socket socket;
-  int offset;
-  List<int> buffer;
+  int offset = 0;
+  // Data not yet written. [offset] is the position in the first buffer.
+  final List<List<int>> buffers = <List<int>>[];
+  int pendingBytes = 0;
   bool paused = false;
+  // Set when the stream is done while data is still queued. The stream is
+  // completed once the queue has been written.
+  bool donePending = false;
   Completer streamCompleter;
 
+  // A file being sent with sendfile, and the range still to be sent.
+  _RandomAccessFile file;
+  int fileOffset;
+  int fileEnd;
+
   _SocketStreamConsumer(this.socket);
 
   Future<Socket> addStream(Stream<List<int>> stream) {
     socket._ensureRawSocketSubscription();
     streamCompleter = new Completer<Socket>();
+    if (socket._raw is _RawSocket && stream is _FileStream) {
+      _FileStream fileStream = stream;
+      if (fileStream._path != null) {
+        sendFile(fileStream._path, fileStream._position, fileStream._end);
+        return streamCompleter.future;
+      }
+    }
     if (socket._raw != null) {
       subscription = stream.listen((data) {
         assert(!paused);
-        assert(buffer == null);
-        buffer = data;
-        offset = 0;
+        if (data.length == 0) return;
+        buffers.add(data);
+        pendingBytes += data.length;
+        if (buffers.length > 1) {
+          // A write is blocked. The data is written on the next write event.
+          if (pendingBytes >= maxPendingBytes) {
+            paused = true;
+            subscription.pause();
+          }
+          return;
+        }
         try {
           write();
         } catch (e) {
@@ -1492,7 +1665,11 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
         socket.destroy();
         done(error, stackTrace);
       }, onDone: () {
-        done();
+        if (buffers.isEmpty) {
+          done();
+        } else {
+          donePending = true;
+        }
       }, cancelOnError: true);
     }
     return streamCompleter.future;
@@ -1503,27 +1680,85 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
     return new Future.value(socket);
   }
 
+  // Sends the file range of a stream from File.openRead directly from the
+  // file to the socket, instead of reading it into the heap.
+  void sendFile(String path, int start, int end) {
+    new File(path).open().then((openedFile) {
+      return openedFile.length().then((length) {
+        if (streamCompleter == null) {
+          // The socket was closed or destroyed meanwhile.
+          return openedFile.close();
+        }
+        file = openedFile;
+        fileOffset = start;
+        fileEnd = (end == null) ? length : min(end, length);
+        writeFile();
+      });
+    }).catchError((error, stackTrace) {
+      socket.destroy();
+      done(error, stackTrace);
+    });
+  }
+
+  void writeFile() {
+    if (fileOffset < fileEnd) {
+      int sent = socket._sendFile(file, fileOffset, fileEnd - fileOffset);
+      if (sent != null) {
+        fileOffset += sent;
+        if (fileOffset < fileEnd) {
+          // Continue on the next write event.
+          socket._enableWriteEvent();
+          return;
+        }
+      }
+    }
+    closeFile().then((_) => done(), onError: done);
+  }
+
+  Future closeFile() {
+    if (file == null) return new Future.value();
+    var openedFile = file;
+    file = null;
+    return openedFile.close();
+  }
+
   void write() {
+    if (file != null) {
+      writeFile();
+      return;
+    }
     if (subscription == null) return;
-    assert(buffer != null);
+    assert(buffers.isNotEmpty);
     // Write as much as possible.
-    offset += socket._write(buffer, offset, buffer.length - offset);
-    if (offset < buffer.length) {
-      if (!paused) {
+    int written = socket._writeBuffers(buffers, offset);
+    pendingBytes -= written;
+    int completed = 0;
+    while (completed < buffers.length &&
+        written >= buffers[completed].length - offset) {
+      written -= buffers[completed].length - offset;
+      offset = 0;
+      completed++;
+    }
+    offset += written;
+    buffers.removeRange(0, completed);
+    if (buffers.isNotEmpty) {
+      if (pendingBytes >= maxPendingBytes && !paused) {
         paused = true;
         subscription.pause();
       }
       socket._enableWriteEvent();
-    } else {
-      buffer = null;
-      if (paused) {
-        paused = false;
-        subscription.resume();
-      }
+    } else if (donePending) {
+      donePending = false;
+      done();
+    } else if (paused) {
+      paused = false;
+      subscription.resume();
     }
   }
 
   void done([error, stackTrace]) {
+    donePending = false;
+    closeFile().catchError((_) {});
     if (streamCompleter != null) {
       if (error != null) {
         streamCompleter.completeError(error, stackTrace);
@@ -1535,6 +1770,7 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
   }
 
   void stop() {
+    closeFile().catchError((_) {});
     if (subscription == null) return;
     subscription.cancel();
     subscription = null;
@@ -1662,7 +1898,7 @@ class _Socket extends Stream<List<int>> implements Socket {
     _detachReady = new Completer();
     _sink.close();
     return _detachReady.future.then((_) {
-      assert(_consumer.buffer == null);
+      assert(_consumer.buffers.isEmpty);
       var raw = _raw;
       _raw = null;
       return [raw, _subscription];
@@ -1743,6 +1979,29 @@ class _Socket extends Stream<List<int>> implements Socket {
   int _write(List<int> data, int offset, int length) =>
       _raw.write(data, offset, length);
 
+  int _sendFile(_RandomAccessFile file, int offset, int length) {
+    _RawSocket raw = _raw;
+    return raw._socket.sendFile(file, offset, length);
+  }
+
+  // Writes as much as possible of [buffers], starting at [offset] in the
+  // first buffer. Returns the number of bytes written.
+  int _writeBuffers(List<List<int>> buffers, int offset) {
+    var raw = _raw;
+    if (raw is _RawSocket && buffers.length > 1) {
+      return raw._socket.writeBuffers(buffers, offset);
+    }
+    int written = 0;
+    for (var buffer in buffers) {
+      int length = buffer.length - offset;
+      int bytes = _write(buffer, offset, length);
+      written += bytes;
+      if (bytes < length) break;
+      offset = 0;
+    }
+    return written;
+  }
+
   void _enableWriteEvent() {
     _raw.writeEventsEnabled = true;
   }
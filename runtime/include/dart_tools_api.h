@@ -442,4 +442,78 @@ DART_EXPORT void Dart_SetEmbedderTimelineCallbacks(
     Dart_EmbedderTimelineStartRecording start_recording,
     Dart_EmbedderTimelineStopRecording stop_recording);
 
+/*
+ * ========
+ * Profiler
+ * ========
+ */
+
+/**
+ * Registers a consumer for CPU profiles in the pprof format
+ * (https://github.com/google/pprof).
+ *
+ * While the profiler is enabled, each isolate periodically (see
+ * --pprof_period) and when it shuts down passes a profile of the samples
+ * taken since its previous profile to the consumer, as one stream named
+ * after the isolate. The consumer is called on the isolate's thread.
+ *
+ * \param consumer A Dart_StreamConsumer, or NULL to stop receiving profiles.
+ * \param user_data User data passed into consumer.
+ */
+DART_EXPORT void Dart_SetPprofConsumer(Dart_StreamConsumer consumer,
+                                       void* user_data);
+
+/*
+ * =============
+ * Heap Snapshot
+ * =============
+ */
+
+/**
+ * Writes a snapshot of the current isolate's heap, in the format sent on the
+ * _Graph service stream, passing it to the callback piece by piece as it is
+ * written. At most about a megabyte of the snapshot is buffered, and the
+ * memory used for traversing the heap is limited by
+ * --heap_snapshot_traversal_budget.
+ *
+ * Requires there to be a current isolate. The callback is called on the
+ * isolate's thread while the heap is being iterated, so it must not call
+ * back into the Dart API.
+ *
+ * \param callback Called one or more times with the next piece of the
+ *   snapshot.
+ * \param callback_data Passed as the first argument to callback.
+ *
+ * \return A valid handle if no error occurs during the operation.
+ */
+DART_EXPORT Dart_Handle
+Dart_WriteHeapSnapshot(Dart_StreamingWriteCallback callback,
+                       void* callback_data);
+
+/*
+ * =======
+ * Metrics
+ * =======
+ */
+
+/**
+ * Writes the metrics of the VM and of every isolate to the consumer, as one
+ * stream named "metrics" in the Prometheus text format
+ * (https://prometheus.io/docs/instrumenting/exposition_formats/).
+ *
+ * Besides the metrics listed by the service protocol, these include the
+ * distributions of GC pauses and of compile times, the depth of each
+ * isolate's message queue and the number of open ports. Isolate heap usage
+ * is as of the isolate's last GC or handled message.
+ *
+ * May be called on any thread, whether or not it has entered an isolate.
+ *
+ * \param consumer A Dart_StreamConsumer.
+ * \param user_data User data passed into consumer.
+ *
+ * \return True if a stream was output. Metrics are not kept in PRODUCT mode.
+ */
+DART_EXPORT bool Dart_WriteMetrics(Dart_StreamConsumer consumer,
+                                   void* user_data);
+
 #endif  // RUNTIME_INCLUDE_DART_TOOLS_API_H_
@@ -1558,6 +1558,8 @@ class Isolate extends ServiceObjectOwner implements M.Isolate {
   StreamController _snapshotFetch;
 
   List<ByteData> _chunksInProgress;
+  int _chunkCount;
+  int _nodeCount;
 
   List<Thread> get threads => _threads;
   final List<Thread> _threads = new List<Thread>();
@@ -1579,24 +1581,36 @@ class Isolate extends ServiceObjectOwner implements M.Isolate {
       return;
     }
 
-    // Occasionally these actually arrive out of order.
+    // Occasionally these actually arrive out of order. The chunks are sent
+    // while the snapshot is being written, so only the last one carries the
+    // chunk and node counts.
     var chunkIndex = event.chunkIndex;
-    var chunkCount = event.chunkCount;
     if (_chunksInProgress == null) {
-      _chunksInProgress = new List(chunkCount);
+      _chunksInProgress = <ByteData>[];
+    }
+    if (_chunksInProgress.length <= chunkIndex) {
+      _chunksInProgress.length = chunkIndex + 1;
     }
     _chunksInProgress[chunkIndex] = event.data;
-    _snapshotFetch.add([chunkIndex, chunkCount]);
+    if (event.chunkCount != null) {
+      _chunkCount = event.chunkCount;
+      _nodeCount = event.nodeCount;
+    }
+    _snapshotFetch.add([chunkIndex, _chunkCount]);
 
-    for (var i = 0; i < chunkCount; i++) {
+    if (_chunkCount == null || _chunksInProgress.length < _chunkCount) return;
+    for (var i = 0; i < _chunkCount; i++) {
       if (_chunksInProgress[i] == null) return;
     }
 
     var loadedChunks = _chunksInProgress;
+    var nodeCount = _nodeCount;
     _chunksInProgress = null;
+    _chunkCount = null;
+    _nodeCount = null;
 
     if (_snapshotFetch != null) {
-      _snapshotFetch.add(new RawHeapSnapshot(loadedChunks, event.nodeCount));
+      _snapshotFetch.add(new RawHeapSnapshot(loadedChunks, nodeCount));
       _snapshotFetch.close();
     }
   }
@@ -48,6 +48,19 @@ class AtomicOperations : public AllStatic {
     return *static_cast<volatile T*>(ptr);
   }
 
+  // Performs a load of a word from 'ptr' that no later load or store is
+  // reordered before, i.e. it observes everything written before the store
+  // (or compare-and-swap) that it reads from.
+  template <typename T>
+  static T LoadAcquire(T* ptr);
+
+  // Performs a store of a word to 'ptr', but without any guarantees about
+  // memory order (i.e., no store barriers/fences).
+  template <typename T>
+  static void StoreRelaxed(T* ptr, T value) {
+    *static_cast<volatile T*>(ptr) = value;
+  }
+
   template <typename T>
   static T* CompareAndSwapPointer(T** slot, T* old_value, T* new_value) {
     return reinterpret_cast<T*>(AtomicOperations::CompareAndSwapWord(
@@ -141,6 +141,19 @@ inline uint32_t AtomicOperations::CompareAndSwapUint32(uint32_t* ptr,
 #endif
 }
 
+template <typename T>
+inline T AtomicOperations::LoadAcquire(T* ptr) {
+#if (defined(HOST_ARCH_X64) || defined(HOST_ARCH_IA32))
+  // Loads are not reordered with later loads or stores on x86, only the
+  // compiler has to be kept from doing so.
+  T value = *static_cast<volatile T*>(ptr);
+  _ReadWriteBarrier();
+  return value;
+#else
+#error Unsupported host architecture.
+#endif
+}
+
 }  // namespace dart
 
 #endif  // RUNTIME_PLATFORM_ATOMIC_WIN_H_
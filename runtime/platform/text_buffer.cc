@@ -118,11 +118,18 @@ void TextBuffer::EscapeAndAddCodeUnit(uint32_t codeunit) {
 // Write an incomplete UTF-16 code unit so it can be read by a JSON parser in a
 // string literal.
 void TextBuffer::EscapeAndAddUTF16CodeUnit(uint16_t codeunit) {
-  Printf("\\u%04X", codeunit);
+  static const char kHexDigits[] = "0123456789ABCDEF";
+  char escaped[6] = {'\\',
+                     'u',
+                     kHexDigits[(codeunit >> 12) & 0xF],
+                     kHexDigits[(codeunit >> 8) & 0xF],
+                     kHexDigits[(codeunit >> 4) & 0xF],
+                     kHexDigits[codeunit & 0xF]};
+  AddRaw(reinterpret_cast<uint8_t const*>(escaped), sizeof(escaped));
 }
 
 void TextBuffer::AddString(const char* s) {
-  Printf("%s", s);
+  AddRaw(reinterpret_cast<uint8_t const*>(s), strlen(s));
 }
 
 void TextBuffer::AddEscapedString(const char* s) {
@@ -132,6 +139,11 @@ void TextBuffer::AddEscapedString(const char* s) {
   }
 }
 
+void TextBuffer::Reserve(intptr_t len) {
+  ASSERT(len >= 0);
+  EnsureCapacity(len);
+}
+
 void TextBuffer::EnsureCapacity(intptr_t len) {
   intptr_t remaining = buf_size_ - msg_len_;
   if (remaining <= len) {
@@ -141,6 +153,11 @@ void TextBuffer::EnsureCapacity(intptr_t len) {
     // to send user-controlled data (e.g. values of string variables) to
     // the debugger front-end.
     intptr_t new_size = buf_size_ + len + kBufferSpareCapacity;
+    // Grow at least geometrically, so that appending many small pieces takes
+    // linear time overall.
+    if (new_size < 2 * buf_size_) {
+      new_size = 2 * buf_size_;
+    }
     char* new_buf = reinterpret_cast<char*>(realloc(buf_, new_size));
     if (new_buf == NULL) {
       OUT_OF_MEMORY();
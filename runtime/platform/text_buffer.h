@@ -25,6 +25,9 @@ class TextBuffer : ValueObject {
   void AddEscapedString(const char* s);
   void AddRaw(const uint8_t* buffer, intptr_t buffer_length);
 
+  // Makes room for appending 'len' more characters without reallocating.
+  void Reserve(intptr_t len);
+
   void Clear();
 
   char* buf() { return buf_; }
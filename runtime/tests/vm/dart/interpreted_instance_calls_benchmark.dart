@@ -0,0 +1,65 @@
+// Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Compiled to bytecode by //runtime/bin:gen_interpreted_instance_calls_dill
+// for the InterpretedInstanceCalls benchmark in run_vm_tests.
+
+abstract class Shape {
+  int area();
+}
+
+class A extends Shape {
+  int area() => 1;
+}
+
+class B extends Shape {
+  int area() => 2;
+}
+
+class C extends Shape {
+  int area() => 3;
+}
+
+class D extends Shape {
+  int area() => 4;
+}
+
+class E extends Shape {
+  int area() => 5;
+}
+
+class F extends Shape {
+  int area() => 6;
+}
+
+class G extends Shape {
+  int area() => 7;
+}
+
+class H extends Shape {
+  int area() => 8;
+}
+
+// Calls area() at a megamorphic call site [count] times.
+int benchmark(int count) {
+  var shapes = <Shape>[
+    new A(),
+    new B(),
+    new C(),
+    new D(),
+    new E(),
+    new F(),
+    new G(),
+    new H()
+  ];
+  int sum = 0;
+  for (int i = 0; i < count; i++) {
+    sum += shapes[i & 7].area();
+  }
+  return sum;
+}
+
+main() {
+  print(benchmark(8));
+}
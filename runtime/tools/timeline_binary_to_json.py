@@ -0,0 +1,161 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+# for details. All rights reserved. Use of this source code is governed by a
+# BSD-style license that can be found in the LICENSE file.
+
+# Converts a trace written by the file timeline recorder
+# (--timeline_recorder=file) into the Chrome trace event JSON format, which
+# can be loaded into chrome://tracing or Observatory.
+#
+# The format is described next to TimelineEventBinaryEncoder in
+# runtime/vm/timeline.h.
+
+import json
+import sys
+from optparse import OptionParser
+
+MAGIC = b'DTLB'
+VERSION = 1
+
+STRING_TAG = 1
+EVENT_TAG = 2
+
+HAS_THREAD_CPU_TIME_FLAG = 1
+HAS_ISOLATE_FLAG = 2
+PRE_SERIALIZED_ARGS_FLAG = 4
+
+# Indexed by TimelineEvent::EventType.
+DURATION = 3
+PHASES = [None, 'B', 'E', 'X', 'i', 'b', 'n', 'e', 'C', 's', 't', 'f', 'M']
+ASYNC_OR_FLOW = set([5, 6, 7, 9, 10, 11])
+
+
+class Reader(object):
+  def __init__(self, data):
+    self.data = bytearray(data)
+    self.position = 0
+
+  def AtEnd(self):
+    return self.position >= len(self.data)
+
+  def Bytes(self, length):
+    if self.position + length > len(self.data):
+      raise EOFError()
+    result = self.data[self.position:self.position + length]
+    self.position += length
+    return bytes(result)
+
+  def Unsigned(self):
+    result = 0
+    shift = 0
+    while True:
+      if self.position >= len(self.data):
+        raise EOFError()
+      byte = self.data[self.position]
+      self.position += 1
+      result |= (byte & 0x7F) << shift
+      shift += 7
+      if (byte & 0x80) == 0:
+        return result
+
+  def Signed(self):
+    value = self.Unsigned()
+    return (value >> 1) ^ -(value & 1)
+
+  def String(self):
+    return self.Bytes(self.Unsigned()).decode('utf-8', 'replace')
+
+
+def Convert(data):
+  reader = Reader(data)
+  if reader.Bytes(4) != MAGIC:
+    raise ValueError('Not a binary timeline trace')
+  version = reader.Unsigned()
+  if version != VERSION:
+    raise ValueError('Unsupported trace version %d' % version)
+  pid = reader.Unsigned()
+
+  strings = {}
+  def StringRef():
+    id = reader.Unsigned()
+    if id == 0:
+      return reader.String()
+    return strings[id]
+
+  events = []
+  timestamp = 0
+  try:
+    while not reader.AtEnd():
+      tag = reader.Unsigned()
+      if tag == STRING_TAG:
+        id = reader.Unsigned()
+        strings[id] = reader.String()
+        continue
+      if tag != EVENT_TAG:
+        raise ValueError('Unknown record tag %d at offset %d' %
+                         (tag, reader.position))
+      type = reader.Unsigned()
+      flags = reader.Unsigned()
+      event = {}
+      event['name'] = StringRef()
+      event['cat'] = StringRef()
+      event['tid'] = reader.Unsigned()
+      event['pid'] = pid
+      timestamp += reader.Signed()
+      event['ts'] = timestamp
+      event['ph'] = PHASES[type]
+      if type == DURATION:
+        event['dur'] = reader.Unsigned()
+      elif type in ASYNC_OR_FLOW:
+        event['id'] = '%x' % reader.Unsigned()
+      if PHASES[type] == 'i':
+        event['s'] = 'p'
+      elif PHASES[type] == 'f':
+        event['bp'] = 'e'
+      if flags & HAS_THREAD_CPU_TIME_FLAG:
+        event['tts'] = reader.Signed()
+        if type == DURATION:
+          event['tdur'] = reader.Unsigned()
+      isolate = None
+      if flags & HAS_ISOLATE_FLAG:
+        isolate = reader.Unsigned()
+      args = {}
+      for i in range(reader.Unsigned()):
+        name = StringRef()
+        value = reader.String()
+        if flags & PRE_SERIALIZED_ARGS_FLAG:
+          args.update(json.loads(value))
+        else:
+          args[name] = value
+      if isolate is not None:
+        args['isolateNumber'] = str(isolate)
+      event['args'] = args
+      events.append(event)
+  except EOFError:
+    # The recorder was not shut down cleanly; keep the complete events.
+    sys.stderr.write('Trace is truncated after %d events\n' % len(events))
+  return {'traceEvents': events}
+
+
+def Main():
+  parser = OptionParser(usage='%prog [options] trace.dtl')
+  parser.add_option('--output',
+                    action='store', type='string',
+                    help='output JSON file name (default: stdout)')
+  (options, args) = parser.parse_args()
+  if len(args) != 1:
+    parser.print_help()
+    return 1
+  with open(args[0], 'rb') as f:
+    trace = Convert(f.read())
+  if options.output:
+    with open(options.output, 'w') as f:
+      json.dump(trace, f)
+  else:
+    json.dump(trace, sys.stdout)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(Main())
@@ -5,6 +5,7 @@
 #include "vm/benchmark_test.h"
 
 #include "bin/builtin.h"
+#include "bin/eventhandler.h"
 #include "bin/file.h"
 #include "bin/isolate_data.h"
 #include "bin/process.h"
@@ -15,6 +16,7 @@
 
 #include "vm/clustered_snapshot.h"
 #include "vm/dart_api_impl.h"
+#include "vm/json_stream.h"
 #include "vm/stack_frame.h"
 #include "vm/timer.h"
 
@@ -111,26 +113,24 @@ BENCHMARK(CorelibCompileAll) {
   benchmark->set_score(elapsed_time);
 }
 
-// This file is created by the target //runtime/bin:gen_kernel_bytecode_dill
-// which is depended on by run_vm_tests.
-static char* ComputeGenKernelKernelPath(const char* arg) {
+// Looks for 'dill_name' in the directories above the executable 'arg'.
+static char* ComputeDillPath(const char* arg, const char* dill_name) {
   char buffer[2048];
-  char* gen_kernel_path = strdup(File::GetCanonicalPath(NULL, arg));
-  EXPECT(gen_kernel_path != NULL);
-  const char* compiler_path = "%s%sgen_kernel_bytecode.dill";
+  char* dir_path = strdup(File::GetCanonicalPath(NULL, arg));
+  EXPECT(dir_path != NULL);
   const char* path_separator = File::PathSeparator();
   ASSERT(path_separator != NULL && strlen(path_separator) == 1);
-  char* ptr = strrchr(gen_kernel_path, *path_separator);
+  char* ptr = strrchr(dir_path, *path_separator);
   while (ptr != NULL) {
     *ptr = '\0';
-    Utils::SNPrint(buffer, ARRAY_SIZE(buffer), compiler_path, gen_kernel_path,
-                   path_separator);
+    Utils::SNPrint(buffer, ARRAY_SIZE(buffer), "%s%s%s", dir_path,
+                   path_separator, dill_name);
     if (File::Exists(NULL, buffer)) {
       break;
     }
-    ptr = strrchr(gen_kernel_path, *path_separator);
+    ptr = strrchr(dir_path, *path_separator);
   }
-  free(gen_kernel_path);
+  free(dir_path);
   if (ptr == NULL) {
     return NULL;
   }
@@ -144,7 +144,10 @@ static int64_t GenKernelKernelBenchmark(const char* name,
   bin::Builtin::SetNativeResolver(bin::Builtin::kBuiltinLibrary);
   bin::Builtin::SetNativeResolver(bin::Builtin::kIOLibrary);
   bin::Builtin::SetNativeResolver(bin::Builtin::kCLILibrary);
-  char* dill_path = ComputeGenKernelKernelPath(Benchmark::Executable());
+  // This file is created by the target //runtime/bin:gen_kernel_bytecode_dill
+  // which is depended on by run_vm_tests.
+  char* dill_path =
+      ComputeDillPath(Benchmark::Executable(), "gen_kernel_bytecode.dill");
   File* file = File::Open(NULL, dill_path, File::kRead);
   EXPECT(file != NULL);
   bin::RefCntReleaseScope<File> rs(file);
@@ -215,6 +218,78 @@ BENCHMARK(GenKernelKernelMaxRSS) {
   benchmark->set_score(bin::Process::MaxRSS());
 }
 
+//
+// Measure throughput of interpreted instance calls at a megamorphic call site.
+//
+BENCHMARK(InterpretedInstanceCalls) {
+  const int kNumIterations = 1000000;
+  // This file is created by the target
+  // //runtime/bin:gen_interpreted_instance_calls_dill from
+  // runtime/tests/vm/dart/interpreted_instance_calls_benchmark.dart.
+  char* dill_path = ComputeDillPath(Benchmark::Executable(),
+                                    "interpreted_instance_calls_bytecode.dill");
+  EXPECT(dill_path != NULL);
+  File* file = File::Open(NULL, dill_path, File::kRead);
+  EXPECT(file != NULL);
+  bin::RefCntReleaseScope<File> rs(file);
+  intptr_t kernel_buffer_size = file->Length();
+  uint8_t* kernel_buffer =
+      reinterpret_cast<uint8_t*>(malloc(kernel_buffer_size));
+  EXPECT(kernel_buffer != NULL);
+  bool read_fully = file->ReadFully(kernel_buffer, kernel_buffer_size);
+  EXPECT(read_fully);
+
+  // Keep every function in the interpreter.
+  bool enable_interpreter_orig = FLAG_enable_interpreter;
+  int compilation_counter_threshold_orig = FLAG_compilation_counter_threshold;
+  FLAG_enable_interpreter = true;
+  FLAG_compilation_counter_threshold = -1;
+
+  Dart_Handle lib =
+      Dart_LoadLibraryFromKernel(kernel_buffer, kernel_buffer_size);
+  EXPECT_VALID(lib);
+  Dart_Handle result = Dart_FinalizeLoading(false);
+  EXPECT_VALID(result);
+
+  Dart_Handle args[1];
+  args[0] = Dart_NewInteger(kNumIterations);
+
+  // Warmup first so that the call site is already megamorphic.
+  result = Dart_Invoke(lib, NewString("benchmark"), 1, args);
+  EXPECT_VALID(result);
+
+  {
+    // The benchmark and the call targets ran as bytecode, not compiled code.
+    TransitionNativeToVM transition(thread);
+    const Library& library =
+        Library::Handle(Library::RawCast(Api::UnwrapHandle(lib)));
+    Function& function = Function::Handle(
+        library.LookupLocalFunction(String::Handle(String::New("benchmark"))));
+    EXPECT(!function.IsNull());
+    EXPECT(function.HasBytecode());
+    EXPECT(!function.HasCode());
+    const Class& cls = Class::Handle(
+        library.LookupLocalClass(String::Handle(String::New("H"))));
+    EXPECT(!cls.IsNull());
+    function = cls.LookupDynamicFunction(String::Handle(String::New("area")));
+    EXPECT(!function.IsNull());
+    EXPECT(function.HasBytecode());
+    EXPECT(!function.HasCode());
+  }
+
+  Timer timer(true, "InterpretedInstanceCalls benchmark");
+  timer.Start();
+  result = Dart_Invoke(lib, NewString("benchmark"), 1, args);
+  EXPECT_VALID(result);
+  timer.Stop();
+  FLAG_enable_interpreter = enable_interpreter_orig;
+  FLAG_compilation_counter_threshold = compilation_counter_threshold_orig;
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+  free(dill_path);
+  free(kernel_buffer);
+}
+
 //
 // Measure creation of core isolate from a snapshot.
 //
@@ -233,6 +308,36 @@ BENCHMARK(CorelibIsolateStartup) {
   Dart_EnterIsolate(reinterpret_cast<Dart_Isolate>(isolate));
 }
 
+//
+// Measure registration, update and cancellation of event handler timers, as
+// done for one idle timeout per connection.
+//
+BENCHMARK(EventHandlerTimeoutQueue) {
+  const intptr_t kNumTimeouts = 50000;
+  const intptr_t kNumUpdates = 4;
+  Timer timer(true, "EventHandlerTimeoutQueue");
+  timer.Start();
+  {
+    bin::TimeoutQueue queue;
+    for (intptr_t i = 0; i < kNumTimeouts; i++) {
+      queue.UpdateTimeout(i + 1, (i * 7919) % kNumTimeouts);
+    }
+    for (intptr_t j = 0; j < kNumUpdates; j++) {
+      for (intptr_t i = 0; i < kNumTimeouts; i++) {
+        queue.UpdateTimeout(i + 1, kNumTimeouts + (i * 7919) % kNumTimeouts);
+      }
+    }
+    for (intptr_t i = 0; i < kNumTimeouts; i += 2) {
+      queue.UpdateTimeout(i + 1, -1);
+    }
+    while (queue.HasTimeout()) {
+      queue.RemoveCurrent();
+    }
+  }
+  timer.Stop();
+  benchmark->set_score(timer.TotalElapsedTime());
+}
+
 //
 // Measure invocation of Dart API functions.
 //
@@ -724,6 +829,80 @@ BENCHMARK(LargeMap) {
   benchmark->set_score(elapsed_time);
 }
 
+#if !defined(PRODUCT)
+// Measures the encoding of a getObject response for a large list of mixed
+// elements, each of which is printed as a reference.
+BENCHMARK(ServiceLargeListResponse) {
+  TransitionNativeToVM transition(thread);
+  StackZone zone(thread);
+  HANDLESCOPE(thread);
+  const intptr_t kLength = 10000;
+  const Array& list = Array::Handle(Array::New(kLength));
+  Object& element = Object::Handle();
+  for (intptr_t i = 0; i < kLength; i++) {
+    switch (i % 3) {
+      case 0:
+        element = Smi::New(i);
+        break;
+      case 1:
+        element = Double::New(i * 0.5);
+        break;
+      default:
+        element = String::NewFormatted("element \"%" Pd "\"", i);
+        break;
+    }
+    list.SetAt(i, element);
+  }
+  const intptr_t kLoopCount = 20;
+  intptr_t response_length = 0;
+  Timer timer(true, "Service Large List Response");
+  timer.Start();
+  for (intptr_t i = 0; i < kLoopCount; i++) {
+    JSONStream js;
+    list.PrintJSON(&js, false);
+    response_length += js.buffer()->length();
+  }
+  timer.Stop();
+  EXPECT(response_length > 0);
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+// Measures the encoding of a response made of many small records of numbers
+// and short strings, like those of getCpuSamples and getAllocationProfile.
+BENCHMARK(ServiceRecordsResponse) {
+  const intptr_t kNumRecords = 100000;
+  const intptr_t kLoopCount = 10;
+  intptr_t response_length = 0;
+  Timer timer(true, "Service Records Response");
+  timer.Start();
+  for (intptr_t i = 0; i < kLoopCount; i++) {
+    JSONStream js;
+    {
+      JSONObject jsobj(&js);
+      jsobj.AddProperty("type", "_CpuProfile");
+      JSONArray records(&jsobj, "samples");
+      for (intptr_t j = 0; j < kNumRecords; j++) {
+        JSONObject record(&records);
+        record.AddProperty("tid", j & 0xFF);
+        record.AddProperty64("timestamp", 1550000000000000LL + j * 997);
+        record.AddProperty("vmTag", "Dart");
+        record.AddProperty("percentage", (j % 1000) / 10.0);
+        record.AddProperty("instances", j * 3);
+        JSONArray stack(&record, "stack");
+        stack.AddValue(j % 17);
+        stack.AddValue(j % 101);
+      }
+    }
+    response_length += js.buffer()->length();
+  }
+  timer.Stop();
+  EXPECT(response_length > 0);
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+#endif  // !defined(PRODUCT)
+
 BENCHMARK_MEMORY(InitialRSS) {
   benchmark->set_score(bin::Process::MaxRSS());
 }
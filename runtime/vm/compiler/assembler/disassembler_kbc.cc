@@ -122,7 +122,9 @@ static void FormatA_D(char* buf,
                       Fmt op1,
                       Fmt op2,
                       Fmt op3) {
-  const int32_t a = (op & 0xFF00) >> 8;
+  // An x-register in the A operand is a signed 8-bit FP relative local.
+  const int32_t a = (op1 == Fmtxeg) ? static_cast<int8_t>((op & 0xFF00) >> 8)
+                                    : (op & 0xFF00) >> 8;
   const int32_t bc = op >> 16;
   Apply(&buf, &size, pc, op1, a, ", ");
   Apply(&buf, &size, pc, op2, bc, "");
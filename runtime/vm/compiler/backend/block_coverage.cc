@@ -0,0 +1,204 @@
+// Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#if !defined(DART_PRECOMPILED_RUNTIME)
+
+#include "vm/compiler/backend/block_coverage.h"
+
+#include "vm/bit_vector.h"
+#include "vm/compiler/backend/flow_graph.h"
+#include "vm/compiler/backend/il.h"
+#include "vm/object_store.h"
+
+namespace dart {
+
+// Returns the first source position of an instruction in 'block' that lies
+// within 'function', or kNoSource if there is none.
+static TokenPosition FirstSourcePosition(BlockEntryInstr* block,
+                                         const Function& function) {
+  for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+    TokenPosition pos = it.Current()->token_pos();
+    if (pos.IsReal() && (pos >= function.token_pos()) &&
+        (pos <= function.end_token_pos())) {
+      return pos;
+    }
+  }
+  return TokenPosition::kNoSource;
+}
+
+// Adds the counts of 'from' to those of 'into', an array for the same
+// function. Returns false without changing 'into' if it lacks a block that
+// 'from' counted.
+static bool MergeCounts(const Array& from, const Array& into) {
+  const intptr_t from_count = BlockCoverage::BlockCount(from.Length());
+  const intptr_t into_count = BlockCoverage::BlockCount(into.Length());
+  GrowableArray<intptr_t> targets(from_count);
+  for (intptr_t i = 0; i < from_count; i++) {
+    intptr_t target = -1;
+    if (from.At(BlockCoverage::CountIndex(i)) != Object::null()) {
+      const RawObject* pos = from.At(BlockCoverage::PositionIndex(i));
+      for (intptr_t j = 0; j < into_count; j++) {
+        if (into.At(BlockCoverage::PositionIndex(j)) == pos) {
+          target = j;
+          break;
+        }
+      }
+      if (target < 0) {
+        return false;
+      }
+    }
+    targets.Add(target);
+  }
+  Smi& value = Smi::Handle();
+  for (intptr_t i = 0; i < from_count; i++) {
+    if (targets[i] < 0) {
+      continue;
+    }
+    const intptr_t count_index = BlockCoverage::CountIndex(targets[i]);
+    value ^= from.At(BlockCoverage::CountIndex(i));
+    if (into.At(count_index) != Object::null()) {
+      value = Smi::New(value.Value() +
+                       Smi::Value(Smi::RawCast(into.At(count_index))));
+    }
+    into.SetAt(count_index, value);
+  }
+  return true;
+}
+
+void BlockCoverage::Instrument(FlowGraph* flow_graph) {
+#if !defined(TARGET_ARCH_DBC)
+  Zone* zone = flow_graph->zone();
+  const Function& function = flow_graph->function();
+  if (!function.token_pos().IsReal() || !function.end_token_pos().IsReal()) {
+    return;
+  }
+
+  GrowableArray<BlockEntryInstr*> blocks;
+  GrowableArray<TokenPosition> positions;
+  const GrowableArray<BlockEntryInstr*>& preorder = flow_graph->preorder();
+  for (intptr_t i = 0; i < preorder.length(); i++) {
+    BlockEntryInstr* block = preorder[i];
+    // The OSR entry jumps into the middle of a loop, whose blocks are counted.
+    if (block->IsGraphEntry() || block->IsOsrEntry()) {
+      continue;
+    }
+    const TokenPosition pos = FirstSourcePosition(block, function);
+    if (pos.IsReal()) {
+      blocks.Add(block);
+      positions.Add(pos);
+    }
+  }
+  if (blocks.is_empty()) {
+    return;
+  }
+
+  const Array& counters = Array::ZoneHandle(
+      zone, Array::New(PositionIndex(blocks.length()), Heap::kOld));
+  counters.SetAt(kFunctionIndex, function);
+  Smi& value = Smi::Handle(zone);
+  for (intptr_t i = 0; i < blocks.length(); i++) {
+    value = Smi::New(positions[i].Pos());
+    counters.SetAt(PositionIndex(i), value);
+    value = Smi::New(0);
+    counters.SetAt(CountIndex(i), value);
+    RecordCoverageInstr* record =
+        new (zone) RecordCoverageInstr(counters, CountIndex(i));
+    record->InsertAfter(blocks[i]);
+  }
+#endif  // !defined(TARGET_ARCH_DBC)
+}
+
+void BlockCoverage::RegisterCounters(FlowGraph* flow_graph, bool optimized) {
+  Zone* zone = flow_graph->zone();
+
+  // Collect the arrays and the counters that survived optimization.
+  GrowableArray<const Array*> arrays;
+  GrowableArray<BitVector*> live_counters;
+  for (BlockIterator block_it = flow_graph->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    for (ForwardInstructionIterator it(block_it.Current()); !it.Done();
+         it.Advance()) {
+      RecordCoverageInstr* record = it.Current()->AsRecordCoverage();
+      if (record == NULL) {
+        continue;
+      }
+      intptr_t i = 0;
+      while ((i < arrays.length()) &&
+             (arrays[i]->raw() != record->counters().raw())) {
+        i++;
+      }
+      if (i == arrays.length()) {
+        arrays.Add(&record->counters());
+        live_counters.Add(
+            new (zone) BitVector(zone, record->counters().Length()));
+      }
+      live_counters[i]->Add(record->index());
+    }
+  }
+  if (arrays.is_empty()) {
+    return;
+  }
+
+  const Function& owner = flow_graph->function();
+  const Smi& kind = Smi::Handle(
+      zone, Smi::New(flow_graph->IsCompiledForOsr()
+                         ? kOsrCode
+                         : (optimized ? kOptimizedCode : kUnoptimizedCode)));
+  for (intptr_t i = 0; i < arrays.length(); i++) {
+    const Array& counters = *arrays[i];
+    counters.SetAt(kOwnerIndex, owner);
+    counters.SetAt(kCodeKindIndex, kind);
+    // A block that was removed is not reported as a miss, since it may just
+    // have been proven unreachable.
+    const intptr_t block_count = BlockCount(counters.Length());
+    for (intptr_t block = 0; block < block_count; block++) {
+      if (!live_counters[i]->Contains(CountIndex(block))) {
+        counters.SetAt(CountIndex(block), Object::null_object());
+      }
+    }
+  }
+
+  ObjectStore* object_store = flow_graph->isolate()->object_store();
+  GrowableObjectArray& registry = GrowableObjectArray::Handle(
+      zone, object_store->block_coverage_arrays());
+  if (registry.IsNull()) {
+    registry = GrowableObjectArray::New(Heap::kOld);
+    object_store->set_block_coverage_arrays(registry);
+  }
+
+  // Merge the arrays of the code that is replaced into the new arrays for the
+  // same function, and compact the registry. An array that cannot be merged,
+  // e.g. of a function that is no longer inlined, keeps its counts.
+  Array& previous = Array::Handle(zone);
+  intptr_t kept = 0;
+  for (intptr_t i = 0; i < registry.Length(); i++) {
+    previous ^= registry.At(i);
+    bool merged = false;
+    if ((previous.At(kOwnerIndex) == owner.raw()) &&
+        (previous.At(kCodeKindIndex) == kind.raw())) {
+      for (intptr_t j = 0; j < arrays.length(); j++) {
+        const Array& counters = *arrays[j];
+        if ((counters.At(kFunctionIndex) == previous.At(kFunctionIndex)) &&
+            MergeCounts(previous, counters)) {
+          merged = true;
+          break;
+        }
+      }
+    }
+    if (!merged) {
+      registry.SetAt(kept++, previous);
+    }
+  }
+  for (intptr_t i = kept; i < registry.Length(); i++) {
+    registry.SetAt(i, Object::null_object());
+  }
+  registry.SetLength(kept);
+  for (intptr_t i = 0; i < arrays.length(); i++) {
+    registry.Add(*arrays[i], Heap::kOld);
+  }
+}
+
+}  // namespace dart
+
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
@@ -0,0 +1,72 @@
+// Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_COMPILER_BACKEND_BLOCK_COVERAGE_H_
+#define RUNTIME_VM_COMPILER_BACKEND_BLOCK_COVERAGE_H_
+
+#include "vm/allocation.h"
+
+namespace dart {
+
+class FlowGraph;
+
+// Block coverage counts how often the basic blocks of compiled code are
+// entered, in unoptimized, optimized and precompiled code alike, so that
+// coverage can be collected without keeping or recompiling unoptimized code.
+//
+// Every flow graph built with FLAG_block_coverage gets its own array of
+// counters, laid out as
+//
+//   [function, owner, kind, position_0, count_0, position_1, count_1, ...]
+//
+// where owner is the function whose code contains the counters (which differs
+// from function when it was inlined), kind the CodeKind of that code as a Smi,
+// position_i the source position of the i-th instrumented block and count_i a
+// Smi that is incremented by a RecordCoverage instruction at the start of that
+// block. Counts of blocks that were removed from the graph before code
+// generation are set to null. The arrays are registered in
+// ObjectStore::block_coverage_arrays() once their code is finalized.
+//
+// Recompiling a function replaces the arrays registered for its previous code
+// of the same kind, so that the registry only grows with the code that can be
+// live at the same time. The counts of the previous arrays are merged into the
+// new ones; an increment by replaced code that is still on the stack is lost.
+class BlockCoverage : public AllStatic {
+ public:
+  enum CodeKind {
+    kUnoptimizedCode,
+    kOptimizedCode,
+    kOsrCode,
+  };
+
+  static const intptr_t kFunctionIndex = 0;
+  static const intptr_t kOwnerIndex = 1;
+  static const intptr_t kCodeKindIndex = 2;
+  static const intptr_t kFirstBlockIndex = 3;
+  static const intptr_t kBlockEntrySize = 2;
+
+  static intptr_t BlockCount(intptr_t array_length) {
+    return (array_length - kFirstBlockIndex) / kBlockEntrySize;
+  }
+  static intptr_t PositionIndex(intptr_t block) {
+    return kFirstBlockIndex + block * kBlockEntrySize;
+  }
+  static intptr_t CountIndex(intptr_t block) {
+    return PositionIndex(block) + 1;
+  }
+
+  // Inserts a counter at the start of every block of a freshly built graph
+  // that has a source position within its function. Does nothing on DBC.
+  static void Instrument(FlowGraph* flow_graph);
+
+  // Registers the counter arrays of the RecordCoverage instructions in the
+  // final 'flow_graph', including those of inlined functions, in place of the
+  // arrays of the code it replaces. Must be called on the mutator thread or at
+  // a safepoint.
+  static void RegisterCounters(FlowGraph* flow_graph, bool optimized);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_COMPILER_BACKEND_BLOCK_COVERAGE_H_
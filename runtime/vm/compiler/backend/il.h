@@ -521,6 +521,7 @@ struct InstrAttrs {
   M(RelationalOp, kNoGC)                                                       \
   M(NativeCall, _)                                                             \
   M(DebugStepCheck, _)                                                         \
+  M(RecordCoverage, kNoGC)                                                     \
   M(LoadIndexed, kNoGC)                                                        \
   M(LoadCodeUnits, kNoGC)                                                      \
   M(StoreIndexed, kNoGC)                                                       \
@@ -4256,6 +4257,33 @@ class DebugStepCheckInstr : public TemplateInstruction<0, NoThrow> {
   DISALLOW_COPY_AND_ASSIGN(DebugStepCheckInstr);
 };
 
+// Increments the counter at 'index' in a coverage array of BlockCoverage
+// whenever it is executed. Inserted at the start of basic blocks when
+// FLAG_block_coverage is set.
+class RecordCoverageInstr : public TemplateInstruction<0, NoThrow> {
+ public:
+  RecordCoverageInstr(const Array& counters, intptr_t index)
+      : counters_(counters), index_(index) {
+    ASSERT(counters.IsZoneHandle());
+  }
+
+  DECLARE_INSTRUCTION(RecordCoverage)
+
+  const Array& counters() const { return counters_; }
+  intptr_t index() const { return index_; }
+
+  virtual bool ComputeCanDeoptimize() const { return false; }
+  virtual bool HasUnknownSideEffects() const { return false; }
+
+  PRINT_OPERANDS_TO_SUPPORT
+
+ private:
+  const Array& counters_;
+  const intptr_t index_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecordCoverageInstr);
+};
+
 enum StoreBarrierType { kNoStoreBarrier, kEmitStoreBarrier };
 
 class StoreInstanceFieldInstr : public TemplateDefinition<2, NoThrow> {
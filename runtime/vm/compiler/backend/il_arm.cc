@@ -6765,6 +6765,16 @@ void DebugStepCheckInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   compiler->RecordSafepoint(locs());
 }
 
+void RecordCoverageInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  // The counter is not checked for overflow, like the edge counters.
+  const Register temp = locs()->temp(0).reg();
+  const intptr_t offset = Array::element_offset(index());
+  __ LoadObject(temp, counters());
+  __ LoadFieldFromOffset(kWord, IP, temp, offset);
+  __ add(IP, IP, Operand(Smi::RawValue(1)));
+  __ StoreIntoObjectNoBarrierOffset(temp, offset, IP);
+}
+
 }  // namespace dart
 
 #endif  // defined(TARGET_ARCH_ARM) && !defined(DART_PRECOMPILED_RUNTIME)
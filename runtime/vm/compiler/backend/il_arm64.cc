@@ -6013,6 +6013,16 @@ void DebugStepCheckInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   compiler->RecordSafepoint(locs());
 }
 
+void RecordCoverageInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  // The counter is not checked for overflow, like the edge counters.
+  const Register temp = locs()->temp(0).reg();
+  const intptr_t offset = Array::element_offset(index());
+  __ LoadObject(temp, counters());
+  __ LoadFieldFromOffset(TMP, temp, offset);
+  __ add(TMP, TMP, Operand(Smi::RawValue(1)));
+  __ StoreFieldToOffset(TMP, temp, offset);
+}
+
 }  // namespace dart
 
 #endif  // defined(TARGET_ARCH_ARM64) && !defined(DART_PRECOMPILED_RUNTIME)
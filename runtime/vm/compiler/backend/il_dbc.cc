@@ -156,6 +156,9 @@ FOR_EACH_UNREACHABLE_INSTRUCTION(DEFINE_UNREACHABLE)
 // Only used in AOT compilation.
 DEFINE_UNIMPLEMENTED_EMIT_BRANCH_CODE(CheckedSmiComparison)
 
+// Block coverage counters are not inserted on DBC.
+DEFINE_UNREACHABLE_EMIT_NATIVE_CODE(RecordCoverage)
+
 EMIT_NATIVE_CODE(InstanceOf,
                  3,
                  Location::SameAsFirstInput(),
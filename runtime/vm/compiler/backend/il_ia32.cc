@@ -6182,6 +6182,13 @@ void DebugStepCheckInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   compiler->RecordSafepoint(locs());
 }
 
+void RecordCoverageInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  // The counter is not checked for overflow, like the edge counters.
+  const Register temp = locs()->temp(0).reg();
+  __ LoadObject(temp, counters());
+  __ IncrementSmiField(FieldAddress(temp, Array::element_offset(index())), 1);
+}
+
 }  // namespace dart
 
 #undef __
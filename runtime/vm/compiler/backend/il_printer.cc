@@ -1011,6 +1011,10 @@ void CheckStackOverflowInstr::PrintOperandsTo(BufferFormatter* f) const {
   if (in_loop()) f->Print("depth %" Pd, loop_depth());
 }
 
+void RecordCoverageInstr::PrintOperandsTo(BufferFormatter* f) const {
+  f->Print("counter %" Pd, index());
+}
+
 void TargetEntryInstr::PrintTo(BufferFormatter* f) const {
   if (try_index() != kInvalidTryIndex) {
     f->Print("B%" Pd "[target try_idx %" Pd "]:%" Pd, block_id(), try_index(),
@@ -8,6 +8,7 @@
 
 #include "vm/compiler/aot/aot_call_specializer.h"
 #include "vm/compiler/aot/precompiler.h"
+#include "vm/compiler/backend/block_coverage.h"
 #include "vm/compiler/backend/block_scheduler.h"
 #include "vm/compiler/backend/branch_optimizer.h"
 #include "vm/compiler/backend/flow_graph_compiler.h"
@@ -197,8 +198,9 @@ class GraphInfoCollector : public ValueObject {
       for (ForwardInstructionIterator it(block_it.Current()); !it.Done();
            it.Advance()) {
         Instruction* current = it.Current();
-        // Don't count instructions that won't generate any code.
-        if (current->IsRedefinition()) {
+        // Don't count instructions that won't generate any code, nor coverage
+        // counters, which should not change inlining decisions.
+        if (current->IsRedefinition() || current->IsRecordCoverage()) {
           continue;
         }
         ++instruction_count_;
@@ -982,6 +984,9 @@ class CallSiteInliner : public ValueObject {
             entry_kind == Code::EntryKind::kUnchecked);
         {
           callee_graph = builder.BuildGraph();
+          if (FLAG_block_coverage) {
+            BlockCoverage::Instrument(callee_graph);
+          }
 
           CalleeGraphValidator::Validate(callee_graph);
         }
@@ -826,8 +826,20 @@ void BytecodeFlowGraphBuilder::BuildLoadFieldTOS() {
   }
 
   LoadStackSlots(1);
-  Operand cp_index = DecodeOperandD();
+  BuildLoadField(DecodeOperandD());
+}
 
+void BytecodeFlowGraphBuilder::BuildLoadFieldLocal() {
+  if (is_generating_interpreter()) {
+    UNIMPLEMENTED();  // TODO(alexmarkov): interpreter
+  }
+
+  // A operand is a signed 8-bit local index.
+  LoadLocal(Operand(static_cast<int8_t>(DecodeOperandA().value())));
+  BuildLoadField(DecodeOperandD());
+}
+
+void BytecodeFlowGraphBuilder::BuildLoadField(Operand cp_index) {
   const Field& field = Field::Cast(ConstantAt(cp_index, 1).value());
   ASSERT(Smi::Cast(ConstantAt(cp_index).value()).Value() * kWordSize ==
          field.Offset());
@@ -1281,6 +1293,43 @@ void BytecodeFlowGraphBuilder::BuildCompareIntLe() {
   BuildIntOp(Symbols::LessEqualOperator(), Token::kLTE, 2);
 }
 
+void BytecodeFlowGraphBuilder::BuildJumpIfIntCompare(const String& name,
+                                                     Token::Kind token_kind,
+                                                     bool jump_if_true) {
+  BuildIntOp(name, token_kind, 2);
+  code_ += B->Constant(Bool::Get(jump_if_true));
+  BuildJumpIfStrictCompare(Token::kEQ);
+}
+
+void BytecodeFlowGraphBuilder::BuildJumpIfEqInt() {
+  BuildJumpIfIntCompare(Symbols::EqualOperator(), Token::kEQ, true);
+}
+
+void BytecodeFlowGraphBuilder::BuildJumpIfNeInt() {
+  BuildJumpIfIntCompare(Symbols::EqualOperator(), Token::kEQ, false);
+}
+
+void BytecodeFlowGraphBuilder::BuildJumpIfLtInt() {
+  BuildJumpIfIntCompare(Symbols::LAngleBracket(), Token::kLT, true);
+}
+
+void BytecodeFlowGraphBuilder::BuildJumpIfLeInt() {
+  BuildJumpIfIntCompare(Symbols::LessEqualOperator(), Token::kLTE, true);
+}
+
+void BytecodeFlowGraphBuilder::BuildJumpIfGtInt() {
+  BuildJumpIfIntCompare(Symbols::RAngleBracket(), Token::kGT, true);
+}
+
+void BytecodeFlowGraphBuilder::BuildJumpIfGeInt() {
+  BuildJumpIfIntCompare(Symbols::GreaterEqualOperator(), Token::kGTE, true);
+}
+
+void BytecodeFlowGraphBuilder::BuildAddIntLocal() {
+  LoadLocal(DecodeOperandX());
+  BuildIntOp(Symbols::Plus(), Token::kADD, 2);
+}
+
 static bool IsICDataEntry(const ObjectPool& object_pool, intptr_t index) {
   if (object_pool.TypeAt(index) != ObjectPool::kTaggedObject) {
     return false;
@@ -130,6 +130,10 @@ class BytecodeFlowGraphBuilder {
   void PropagateStackState(intptr_t target_pc);
   void BuildJumpIfStrictCompare(Token::Kind cmp_kind);
   void BuildIntOp(const String& name, Token::Kind token_kind, int num_args);
+  void BuildJumpIfIntCompare(const String& name,
+                             Token::Kind token_kind,
+                             bool jump_if_true);
+  void BuildLoadField(Operand cp_index);
 
   void BuildInstruction(KernelBytecode::Opcode opcode);
 
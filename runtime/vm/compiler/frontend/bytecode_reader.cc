@@ -39,6 +39,63 @@ bool BytecodeMetadataHelper::HasBytecode(intptr_t node_offset) {
   return (md_offset >= 0);
 }
 
+void BytecodeMetadataHelper::BuildBytecodeIndex() {
+  const intptr_t kUInt32Size = 4;
+  intptr_t mappings_offset = 0;
+  const intptr_t mappings_num = GetMetadataMappings(&mappings_offset);
+
+  // The index is a view of the bytecode metadata mappings, so building it
+  // neither copies nor touches bytecode payloads.
+  uint8_t* data = NULL;
+  if (mappings_num > 0) {
+    data = reinterpret_cast<uint8_t*>(
+        H.metadata_mappings().DataAddr(mappings_offset));
+  }
+  const ExternalTypedData& index = ExternalTypedData::Handle(
+      helper_->zone_,
+      ExternalTypedData::New(kExternalTypedDataUint8ArrayCid, data,
+                             mappings_num * 2 * kUInt32Size, Heap::kOld));
+  H.GetKernelProgramInfo().set_bytecode_index(index);
+}
+
+intptr_t BytecodeMetadataHelper::LookupBytecodeIndex(
+    const ExternalTypedData& index,
+    intptr_t node_offset) {
+  const intptr_t kEntrySize = 2 * 4;
+  Reader reader(index);
+  intptr_t left = 0;
+  intptr_t right = (reader.size() / kEntrySize) - 1;
+  while (left <= right) {
+    const intptr_t mid = ((right - left) / 2) + left;
+    const intptr_t mid_node_offset = reader.ReadUInt32At(mid * kEntrySize);
+    if (node_offset < mid_node_offset) {
+      right = mid - 1;
+    } else if (node_offset > mid_node_offset) {
+      left = mid + 1;
+    } else {
+      return reader.ReadUInt32At(mid * kEntrySize + 4);
+    }
+  }
+  return -1;
+}
+
+intptr_t BytecodeMetadataHelper::GetBytecodePayloadOffset(
+    intptr_t node_offset) {
+  const KernelProgramInfo& info = H.GetKernelProgramInfo();
+  if (info.IsNull()) {
+    return GetNextMetadataPayloadOffset(node_offset);
+  }
+  ExternalTypedData& index =
+      ExternalTypedData::Handle(helper_->zone_, info.bytecode_index());
+  if (index.IsNull()) {
+    // Index is not preserved in snapshots, rebuild it on first use.
+    BuildBytecodeIndex();
+    index = info.bytecode_index();
+  }
+  return LookupBytecodeIndex(index,
+                             node_offset + helper_->data_program_offset_);
+}
+
 void BytecodeMetadataHelper::ReadMetadata(const Function& function) {
 #if !defined(PRODUCT)
   TimelineDurationScope tds(Thread::Current(), Timeline::GetCompilerStream(),
@@ -52,7 +109,7 @@ void BytecodeMetadataHelper::ReadMetadata(const Function& function) {
 #endif  // !defined(PRODUCT)
 
   const intptr_t node_offset = function.kernel_offset();
-  const intptr_t md_offset = GetNextMetadataPayloadOffset(node_offset);
+  const intptr_t md_offset = GetBytecodePayloadOffset(node_offset);
   if (md_offset < 0) {
     return;
   }
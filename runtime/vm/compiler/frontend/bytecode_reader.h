@@ -26,7 +26,18 @@ class BytecodeMetadataHelper : public MetadataHelper {
 
   void ReadMetadata(const Function& function);
 
+  // Builds an index of bytecode metadata payloads keyed by node offset and
+  // records it in the KernelProgramInfo. Bytecode of each function is then
+  // read only when the function is first called.
+  void BuildBytecodeIndex();
+
  private:
+  // Returns offset of the bytecode metadata payload of the given node,
+  // or -1 if there is no bytecode.
+  intptr_t GetBytecodePayloadOffset(intptr_t node_offset);
+  static intptr_t LookupBytecodeIndex(const ExternalTypedData& index,
+                                      intptr_t node_offset);
+
   // Returns the index of the last read pool entry.
   intptr_t ReadPoolEntries(const Function& function,
                            const Function& inner_function,
@@ -1520,6 +1520,15 @@ intptr_t MetadataHelper::FindMetadataMapping(intptr_t node_offset) {
   return left;
 }
 
+intptr_t MetadataHelper::GetMetadataMappings(intptr_t* mappings_offset) {
+  if (!mappings_scanned_) {
+    ScanMetadataMappings();
+    mappings_scanned_ = true;
+  }
+  *mappings_offset = mappings_offset_;
+  return mappings_num_;
+}
+
 intptr_t MetadataHelper::GetNextMetadataPayloadOffset(intptr_t node_offset) {
   if (!mappings_scanned_) {
     ScanMetadataMappings();
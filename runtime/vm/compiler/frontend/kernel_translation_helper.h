@@ -60,6 +60,7 @@ class TranslationHelper {
   void SetConstants(const Array& constants);
 
   void SetKernelProgramInfo(const KernelProgramInfo& info);
+  const KernelProgramInfo& GetKernelProgramInfo() const { return info_; }
 
   intptr_t StringOffset(StringIndex index) const;
   intptr_t StringSize(StringIndex index) const;
@@ -793,6 +794,10 @@ class MetadataHelper {
   // Assumes metadata is accesses for nodes in linear order most of the time.
   intptr_t GetNextMetadataPayloadOffset(intptr_t node_offset);
 
+  // Return the number of metadata mappings with this helper's tag and set
+  // [mappings_offset] to the offset of the first one in metadata mappings.
+  intptr_t GetMetadataMappings(intptr_t* mappings_offset);
+
   KernelReaderHelper* helper_;
   TranslationHelper& translation_helper_;
 
@@ -9,6 +9,7 @@
 #include "vm/code_patcher.h"
 #include "vm/compiler/aot/precompiler.h"
 #include "vm/compiler/assembler/disassembler.h"
+#include "vm/compiler/backend/block_coverage.h"
 #include "vm/compiler/backend/block_scheduler.h"
 #include "vm/compiler/backend/branch_optimizer.h"
 #include "vm/compiler/backend/constant_propagator.h"
@@ -152,6 +153,9 @@ FlowGraph* DartCompilationPipeline::BuildFlowGraph(
                                    /* not inlining */ NULL, optimized, osr_id);
   FlowGraph* graph = builder.BuildGraph();
   ASSERT(graph != NULL);
+  if (FLAG_block_coverage) {
+    BlockCoverage::Instrument(graph);
+  }
   return graph;
 }
 
@@ -676,6 +680,10 @@ RawCode* CompileParsedFunctionHelper::FinalizeCompilation(
     function.set_unoptimized_code(code);
     function.AttachCode(code);
   }
+  if (FLAG_block_coverage && !code.IsNull()) {
+    // Only code that was installed replaces the counters of earlier code.
+    BlockCoverage::RegisterCounters(flow_graph, optimized());
+  }
   if (parsed_function()->HasDeferredPrefixes()) {
     ASSERT(!FLAG_load_deferred_eagerly);
     ZoneGrowableArray<const LibraryPrefix*>* prefixes =
@@ -1024,6 +1032,15 @@ static RawObject* CompileFunctionHelper(CompilationPipeline* pipeline,
     }
 
     per_compile_timer.Stop();
+#if !defined(PRODUCT)
+    if (optimized) {
+      isolate->GetCompileOptimizedMetric()->Record(
+          per_compile_timer.TotalElapsedTime());
+    } else {
+      isolate->GetCompileUnoptimizedMetric()->Record(
+          per_compile_timer.TotalElapsedTime());
+    }
+#endif  // !defined(PRODUCT)
 
     if (trace_compiler) {
       THR_Print("--> '%s' entry: %#" Px " size: %" Pd " time: %" Pd64 " us\n",
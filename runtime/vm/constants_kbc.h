@@ -367,6 +367,30 @@ namespace dart {
 //    Receiver and argument should have static type int.
 //    Check SP[-1] and SP[0] for null; push SP[-1] <op> SP[0] ? true : false.
 //
+// SUPERINSTRUCTIONS
+//
+// The following bytecodes are fused forms of frequent instruction sequences.
+// They are only emitted by the bytecode generator when requested and have the
+// same semantics as the sequences they replace.
+//
+//  - JumpIfEqInt target; JumpIfNeInt target; JumpIfLtInt target;
+//    JumpIfLeInt target; JumpIfGtInt target; JumpIfGeInt target
+//
+//    Equivalent to CompareInt<op>; JumpIfTrue target.
+//    Check SP[-1] and SP[0] for null; pop both values and jump to the given
+//    target if SP[-1] <op> SP[0].
+//
+//  - LoadFieldLocal rA, D
+//
+//    Equivalent to Push rA; LoadFieldTOS D.
+//    Push value at offset (in words) PP[D] from object FP[rA], where rA is a
+//    signed 8-bit FP relative local.
+//
+//  - AddIntLocal rX
+//
+//    Equivalent to Push rX; AddInt.
+//    Check SP[0] and FP[rX] for null; SP[0] = SP[0] + FP[rX].
+//
 // BYTECODE LIST FORMAT
 //
 // KernelBytecode list below is specified using the following format:
@@ -460,7 +484,15 @@ namespace dart {
   V(CompareIntGt,                          0, ___, ___, ___)                   \
   V(CompareIntLt,                          0, ___, ___, ___)                   \
   V(CompareIntGe,                          0, ___, ___, ___)                   \
-  V(CompareIntLe,                          0, ___, ___, ___)
+  V(CompareIntLe,                          0, ___, ___, ___)                   \
+  V(JumpIfEqInt,                           T, tgt, ___, ___)                   \
+  V(JumpIfNeInt,                           T, tgt, ___, ___)                   \
+  V(JumpIfLtInt,                           T, tgt, ___, ___)                   \
+  V(JumpIfLeInt,                           T, tgt, ___, ___)                   \
+  V(JumpIfGtInt,                           T, tgt, ___, ___)                   \
+  V(JumpIfGeInt,                           T, tgt, ___, ___)                   \
+  V(LoadFieldLocal,                      A_D, xeg, lit, ___)                   \
+  V(AddIntLocal,                           X, xeg, ___, ___)
 
 // clang-format on
 
@@ -571,6 +603,12 @@ class KernelBytecode {
       case KernelBytecode::kJumpIfFalse:
       case KernelBytecode::kJumpIfNull:
       case KernelBytecode::kJumpIfNotNull:
+      case KernelBytecode::kJumpIfEqInt:
+      case KernelBytecode::kJumpIfNeInt:
+      case KernelBytecode::kJumpIfLtInt:
+      case KernelBytecode::kJumpIfLeInt:
+      case KernelBytecode::kJumpIfGtInt:
+      case KernelBytecode::kJumpIfGeInt:
         return true;
 
       default:
@@ -7,6 +7,7 @@
 
 #include "lib/stacktrace.h"
 #include "platform/assert.h"
+#include "platform/text_buffer.h"
 #include "vm/class_finalizer.h"
 #include "vm/clustered_snapshot.h"
 #include "vm/compilation_trace.h"
@@ -31,13 +32,16 @@
 #include "vm/lockers.h"
 #include "vm/message.h"
 #include "vm/message_handler.h"
+#include "vm/metrics.h"
 #include "vm/native_entry.h"
 #include "vm/object.h"
+#include "vm/object_graph.h"
 #include "vm/object_store.h"
 #include "vm/os.h"
 #include "vm/os_thread.h"
 #include "vm/port.h"
 #include "vm/profiler.h"
+#include "vm/profiler_service.h"
 #include "vm/program_visitor.h"
 #include "vm/resolver.h"
 #include "vm/reusable_handles.h"
@@ -5693,6 +5697,22 @@ DART_EXPORT bool Dart_IsReloading() {
   return false;
 }
 
+DART_EXPORT void Dart_SetPprofConsumer(Dart_StreamConsumer consumer,
+                                       void* user_data) {
+  return;
+}
+
+DART_EXPORT Dart_Handle
+Dart_WriteHeapSnapshot(Dart_StreamingWriteCallback callback,
+                       void* callback_data) {
+  return Api::NewError("%s is not supported in PRODUCT mode.", CURRENT_FUNC);
+}
+
+DART_EXPORT bool Dart_WriteMetrics(Dart_StreamConsumer consumer,
+                                   void* user_data) {
+  return false;
+}
+
 DART_EXPORT void Dart_GlobalTimelineSetRecordedStreams(int64_t stream_mask) {
   return;
 }
@@ -5836,6 +5856,73 @@ DART_EXPORT bool Dart_IsReloading() {
   return isolate->IsReloading();
 }
 
+DART_EXPORT void Dart_SetPprofConsumer(Dart_StreamConsumer consumer,
+                                       void* user_data) {
+  ProfilerService::SetPprofConsumer(consumer, user_data);
+}
+
+// Passes a heap snapshot to the embedder as it is written.
+class StreamingWriteSnapshotConsumer : public ObjectGraph::SnapshotConsumer {
+ public:
+  StreamingWriteSnapshotConsumer(Dart_StreamingWriteCallback callback,
+                                 void* callback_data)
+      : callback_(callback), callback_data_(callback_data) {}
+
+  virtual void Consume(const uint8_t* data, intptr_t length) {
+    callback_(callback_data_, data, length);
+  }
+
+ private:
+  Dart_StreamingWriteCallback callback_;
+  void* callback_data_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamingWriteSnapshotConsumer);
+};
+
+DART_EXPORT Dart_Handle
+Dart_WriteHeapSnapshot(Dart_StreamingWriteCallback callback,
+                       void* callback_data) {
+  DARTSCOPE(Thread::Current());
+  API_TIMELINE_DURATION(T);
+  CHECK_NULL(callback);
+  const intptr_t kChunkSize = 1 * MB;
+  uint8_t* buffer = NULL;
+  WriteStream stream(&buffer, ApiReallocate, kChunkSize + KB);
+  StreamingWriteSnapshotConsumer consumer(callback, callback_data);
+  ObjectGraph graph(T);
+  graph.Serialize(&stream, &consumer, kChunkSize, ObjectGraph::kVM,
+                  true /* collect_garbage */);
+  if (stream.bytes_written() > 0) {
+    consumer.Consume(buffer, stream.bytes_written());
+  }
+  return Api::Success();
+}
+
+DART_EXPORT bool Dart_WriteMetrics(Dart_StreamConsumer consumer,
+                                   void* user_data) {
+  if (consumer == NULL) {
+    return false;
+  }
+  // Like Dart_GlobalTimelineGetTrace, this may be called on a thread that has
+  // not entered an isolate, so no zone is used.
+  TextBuffer buffer(4 * KB);
+  Thread* thread = Thread::Current();
+  if ((thread != NULL) &&
+      (thread->execution_state() == Thread::kThreadInNative)) {
+    TransitionNativeToVM transition(thread);
+    Metric::PrintPrometheus(&buffer);
+  } else {
+    Metric::PrintPrometheus(&buffer);
+  }
+  const char* kStreamName = "metrics";
+  consumer(Dart_StreamConsumer_kStart, kStreamName, NULL, 0, user_data);
+  consumer(Dart_StreamConsumer_kData, kStreamName,
+           reinterpret_cast<const uint8_t*>(buffer.buf()), buffer.length(),
+           user_data);
+  consumer(Dart_StreamConsumer_kFinish, kStreamName, NULL, 0, user_data);
+  return true;
+}
+
 DART_EXPORT void Dart_GlobalTimelineSetRecordedStreams(int64_t stream_mask) {
   if (!FLAG_support_timeline) {
     return;
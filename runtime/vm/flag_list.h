@@ -59,6 +59,9 @@ constexpr bool kDartPrecompiledRuntime = false;
     "Run optimizing compilation in background")                                \
   R(background_compilation_stop_alot, false, bool, false,                      \
     "Stress test system: stop background compiler often.")                     \
+  R(block_coverage, false, bool, false,                                        \
+    "Count the execution of basic blocks for the _BlockCoverage source "       \
+    "report.")                                                                 \
   P(causal_async_stacks, bool, !USING_PRODUCT, "Improved async stacks")        \
   P(collect_code, bool, true, "Attempt to GC infrequently used code.")         \
   P(collect_dynamic_function_names, bool, true,                                \
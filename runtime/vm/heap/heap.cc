@@ -5,6 +5,7 @@
 #include "vm/heap/heap.h"
 
 #include "platform/assert.h"
+#include "platform/math.h"
 #include "platform/utils.h"
 #include "vm/compiler/jit/compiler.h"
 #include "vm/flags.h"
@@ -31,6 +32,7 @@
 namespace dart {
 
 DEFINE_FLAG(bool, write_protect_vm_isolate, true, "Write protect vm_isolate.");
+DECLARE_FLAG(int, allocation_sample_period);
 
 Heap::Heap(Isolate* isolate,
            intptr_t max_new_gen_semi_words,
@@ -42,7 +44,8 @@ Heap::Heap(Isolate* isolate,
       barrier_done_(new Monitor()),
       read_only_(false),
       gc_new_space_in_progress_(false),
-      gc_old_space_in_progress_(false) {
+      gc_old_space_in_progress_(false),
+      sampled_new_allocation_(0) {
   UpdateGlobalMaxUsed();
   for (int sel = 0; sel < kNumWeakSelectors; sel++) {
     new_weak_tables_[sel] = new WeakTable();
@@ -67,12 +70,16 @@ uword Heap::AllocateNew(intptr_t size) {
   isolate()->AssertCurrentThreadIsMutator();
   Thread* thread = Thread::Current();
   uword addr = new_space_.TryAllocateInTLAB(thread, size);
+  if (addr != 0) {
+    return addr;
+  }
+  addr = TryAllocateNewPastSample(thread, size);
   if (addr == 0) {
     // This call to CollectGarbage might end up "reusing" a collection spawned
     // from a different thread and will be racing to allocate the requested
     // memory with other threads being released after the collection.
     CollectGarbage(kNew);
-    addr = new_space_.TryAllocateInTLAB(thread, size);
+    addr = TryAllocateNewPastSample(thread, size);
     if (addr == 0) {
       return AllocateOld(size, HeapPage::kData);
     }
@@ -80,6 +87,17 @@ uword Heap::AllocateNew(intptr_t size) {
   return addr;
 }
 
+uword Heap::TryAllocateNewPastSample(Thread* thread, intptr_t size) {
+  uword addr = new_space_.TryAllocateInTLABPastSample(thread, size);
+  if ((addr != 0) && (thread->top() > thread->end())) {
+    // The allocation crossed the sampled byte. Draw the next one and
+    // remember the allocation for ShouldSampleAllocation.
+    SetThreadAllocationEnd(thread);
+    sampled_new_allocation_ = addr;
+  }
+  return addr;
+}
+
 uword Heap::AllocateOld(intptr_t size, HeapPage::PageType type) {
   ASSERT(Thread::Current()->no_safepoint_scope_depth() == 0);
   uword addr = old_space_.TryAllocate(size, type);
@@ -128,6 +146,54 @@ uword Heap::AllocateOld(intptr_t size, HeapPage::PageType type) {
   return 0;
 }
 
+void Heap::SetThreadAllocationEnd(Thread* thread) {
+  sampled_new_allocation_ = 0;
+  uword end = new_space_.end();
+#if !defined(PRODUCT)
+  if (FLAG_profiler && (FLAG_allocation_sample_period > 0)) {
+    // The distance to the next sampled byte is exponentially distributed, so
+    // the sampled bytes form a Poisson process. Since it is memoryless, the
+    // distance can be drawn anew whenever the buffer is reset.
+    const double uniform =
+        (static_cast<double>(allocation_sample_random_.NextUInt32()) + 1.0) /
+        4294967296.0;
+    const double distance = -log(uniform) * FLAG_allocation_sample_period;
+    const uword top = thread->top();
+    if (distance < static_cast<double>(end - top)) {
+      end = top + static_cast<uword>(distance);
+    }
+  }
+#endif  // !defined(PRODUCT)
+  thread->set_end(end);
+}
+
+bool Heap::ShouldSampleAllocation(Thread* thread, uword addr, intptr_t size) {
+#if defined(PRODUCT)
+  return false;
+#else
+  if (!thread->IsMutatorThread()) {
+    return false;
+  }
+  if (new_space_.Contains(addr)) {
+    if (addr != sampled_new_allocation_) {
+      return false;
+    }
+    sampled_new_allocation_ = 0;
+    return FLAG_profiler && (FLAG_allocation_sample_period > 0);
+  }
+  if (!FLAG_profiler || (FLAG_allocation_sample_period <= 0)) {
+    return false;
+  }
+  // Old space allocations are not bump allocated, so each is sampled with the
+  // probability that the Poisson process hits one of its bytes.
+  const double uniform =
+      static_cast<double>(allocation_sample_random_.NextUInt32()) /
+      4294967296.0;
+  return uniform < (1.0 - exp(-static_cast<double>(size) /
+                              FLAG_allocation_sample_period));
+#endif  // defined(PRODUCT)
+}
+
 void Heap::AllocateExternal(intptr_t cid, intptr_t size, Space space) {
   ASSERT(Thread::Current()->no_safepoint_scope_depth() == 0);
   if (space == kNew) {
@@ -836,6 +902,10 @@ void Heap::RecordAfterGC(GCType type) {
          (type == kMarkSweep && gc_old_space_in_progress_) ||
          (type == kMarkCompact && gc_old_space_in_progress_));
 #ifndef PRODUCT
+  isolate()->GetGCPauseMetric()->Record(delta);
+  if (isolate() == Isolate::Current()) {
+    isolate()->PublishMetrics();
+  }
   if (FLAG_support_service && Service::gc_stream.enabled() &&
       !Isolate::IsVMInternalIsolate(isolate())) {
     ServiceEvent event(isolate(), ServiceEvent::kGC);
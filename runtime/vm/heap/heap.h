@@ -14,6 +14,7 @@
 #include "vm/heap/spaces.h"
 #include "vm/heap/weak_table.h"
 #include "vm/isolate.h"
+#include "vm/random.h"
 
 namespace dart {
 
@@ -87,6 +88,18 @@ class Heap {
     return 0;
   }
 
+  // Sets the end of the mutator's allocation buffer in new space. With
+  // --allocation_sample_period the end is lowered to the next sampled byte, so
+  // that the inline allocation fast paths in generated code and the
+  // interpreter call into the runtime for the allocation to be sampled.
+  void SetThreadAllocationEnd(Thread* thread);
+
+  // Whether the object of 'size' bytes just allocated at 'addr' should be
+  // recorded as an allocation sample. The runtime allocation path moves the
+  // sampling point of 'thread' on once an allocation crosses it, so this must
+  // be checked right after the allocation.
+  bool ShouldSampleAllocation(Thread* thread, uword addr, intptr_t size);
+
   // Track external data.
   void AllocateExternal(intptr_t cid, intptr_t size, Space space);
   void FreeExternal(intptr_t size, Space space);
@@ -317,6 +330,7 @@ class Heap {
        intptr_t max_old_gen_words);
 
   uword AllocateNew(intptr_t size);
+  uword TryAllocateNewPastSample(Thread* thread, intptr_t size);
   uword AllocateOld(intptr_t size, HeapPage::PageType type);
 
   // Visit all pointers. Caller must ensure concurrent sweeper is not running,
@@ -375,6 +389,12 @@ class Heap {
   bool gc_new_space_in_progress_;
   bool gc_old_space_in_progress_;
 
+  // Draws the distances between allocation samples.
+  Random allocation_sample_random_;
+  // The last new space allocation that crossed the sampled byte, until it is
+  // checked by ShouldSampleAllocation.
+  uword sampled_new_allocation_;
+
   friend class Become;       // VisitObjectPointers
   friend class GCCompactor;  // VisitObjectPointers
   friend class Precompiler;  // VisitObjects
@@ -14,6 +14,8 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, allocation_sample_period);
+
 TEST_CASE(OldGC) {
   const char* kScriptChars =
       "main() {\n"
@@ -273,6 +275,36 @@ ISOLATE_UNIT_TEST_CASE(FindObject) {
   }
 }
 
+#if !defined(PRODUCT)
+ISOLATE_UNIT_TEST_CASE(AllocationSamplingKeepsTLABEnd) {
+  Heap* heap = thread->isolate()->heap();
+  const intptr_t size = Array::InstanceSize(1);
+  {
+    SetFlagScope<bool> sfs(&FLAG_profiler, true);
+    SetFlagScope<int> sfs2(&FLAG_allocation_sample_period, 64);
+    heap->SetThreadAllocationEnd(thread);
+    Array& array = Array::Handle();
+    for (intptr_t i = 0; i < 1000; i++) {
+      // The interpreter's fast path must stop at the sampled byte instead of
+      // allocating past it, so that the runtime can take the sample.
+      const uword top = thread->top();
+      if (heap->new_space()->TryAllocateInTLAB(thread, size) == 0) {
+        EXPECT(top + size > thread->end());
+        EXPECT_EQ(top, thread->top());
+      } else {
+        // Give the memory back, it was not initialized.
+        thread->set_top(top);
+      }
+      // The runtime allocates past it and draws the next sampled byte.
+      array = Array::New(1);
+      EXPECT(thread->top() <= thread->end());
+    }
+  }
+  heap->SetThreadAllocationEnd(thread);
+  EXPECT_EQ(heap->new_space()->end(), thread->end());
+}
+#endif  // !defined(PRODUCT)
+
 ISOLATE_UNIT_TEST_CASE(IterateReadOnly) {
   const String& obj = String::Handle(String::New("x", Heap::kOld));
   Heap* heap = Thread::Current()->isolate()->heap();
@@ -7,6 +7,7 @@
 #include "vm/dart.h"
 #include "vm/dart_api_state.h"
 #include "vm/flag_list.h"
+#include "vm/heap/heap.h"
 #include "vm/heap/pointer_block.h"
 #include "vm/heap/safepoint.h"
 #include "vm/heap/verifier.h"
@@ -447,7 +448,7 @@ SemiSpace* Scavenger::Prologue(Isolate* isolate) {
   if (isolate->IsMutatorThreadScheduled()) {
     Thread* mutator_thread = isolate->mutator_thread();
     mutator_thread->set_top(top_);
-    mutator_thread->set_end(end_);
+    heap_->SetThreadAllocationEnd(mutator_thread);
   }
 
   return from;
@@ -462,7 +463,7 @@ void Scavenger::Epilogue(Isolate* isolate, SemiSpace* from) {
   if (isolate->IsMutatorThreadScheduled()) {
     Thread* thread = isolate->mutator_thread();
     thread->set_top(top_);
-    thread->set_end(end_);
+    heap_->SetThreadAllocationEnd(thread);
   }
 
   double avg_frac = stats_history_.Get(0).PromoCandidatesSuccessFraction();
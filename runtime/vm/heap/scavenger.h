@@ -144,29 +144,15 @@ class Scavenger {
   }
 
   uword TryAllocateInTLAB(Thread* thread, intptr_t size) {
-    ASSERT(Utils::IsAligned(size, kObjectAlignment));
-    ASSERT(heap_ != Dart::vm_isolate()->heap());
-    ASSERT(thread->IsMutatorThread());
-    ASSERT(thread->isolate()->IsMutatorThreadScheduled());
-#if defined(DEBUG)
-    if (FLAG_gc_at_alloc) {
-      ASSERT(!scavenging_);
-      Scavenge();
-    }
-#endif
-    uword top = thread->top();
-    uword end = thread->end();
-    uword result = top;
-    intptr_t remaining = end - top;
-    if (remaining < size) {
-      return 0;
-    }
-    ASSERT(to_->Contains(result));
-    ASSERT((result & kObjectAlignmentMask) == object_alignment_);
-    top += size;
-    ASSERT(to_->Contains(top) || (top == to_->end()));
-    thread->set_top(top);
-    return result;
+    return TryAllocateInTLAB(thread, size, false);
+  }
+
+  // Like TryAllocateInTLAB, but may also allocate past a thread->end() that
+  // was lowered to take an allocation sample (see
+  // Heap::SetThreadAllocationEnd). Only the runtime allocation path, which
+  // takes the sample, may do so.
+  uword TryAllocateInTLABPastSample(Thread* thread, intptr_t size) {
+    return TryAllocateInTLAB(thread, size, true);
   }
 
   // Collect the garbage in this scavenger.
@@ -241,6 +227,33 @@ class Scavenger {
   };
 
   uword FirstObjectStart() const { return to_->start() | object_alignment_; }
+
+  uword TryAllocateInTLAB(Thread* thread, intptr_t size, bool past_sample) {
+    ASSERT(Utils::IsAligned(size, kObjectAlignment));
+    ASSERT(heap_ != Dart::vm_isolate()->heap());
+    ASSERT(thread->IsMutatorThread());
+    ASSERT(thread->isolate()->IsMutatorThreadScheduled());
+#if defined(DEBUG)
+    if (FLAG_gc_at_alloc) {
+      ASSERT(!scavenging_);
+      Scavenge();
+    }
+#endif
+    uword top = thread->top();
+    uword end = past_sample ? end_ : thread->end();
+    uword result = top;
+    intptr_t remaining = end - top;
+    if (remaining < size) {
+      return 0;
+    }
+    ASSERT(to_->Contains(result));
+    ASSERT((result & kObjectAlignmentMask) == object_alignment_);
+    top += size;
+    ASSERT(to_->Contains(top) || (top == to_->end()));
+    thread->set_top(top);
+    return result;
+  }
+
   SemiSpace* Prologue(Isolate* isolate);
   void IterateStoreBuffers(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateObjectIdTable(Isolate* isolate, ScavengerVisitor* visitor);
@@ -0,0 +1,604 @@
+// Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/heap_snapshot_analyzer.h"
+
+#include <stdlib.h>
+
+#include "platform/atomic.h"
+#include "vm/datastream.h"
+#include "vm/lockers.h"
+#include "vm/os_thread.h"
+#include "vm/thread_barrier.h"
+#include "vm/thread_pool.h"
+
+namespace dart {
+
+// Reads the unsigned values written by WriteStream::WriteUnsigned, checking
+// for the end of the data instead of asserting, since a snapshot read from a
+// file may be truncated.
+class SnapshotReader : public ValueObject {
+ public:
+  SnapshotReader(const uint8_t* data, intptr_t length)
+      : current_(data), end_(data + length) {}
+
+  bool ReadUnsigned(intptr_t* value) {
+    intptr_t result = 0;
+    intptr_t shift = 0;
+    while ((current_ < end_) && (shift < kBitsPerWord)) {
+      uint8_t b = *current_++;
+      if (b > kMaxUnsignedDataPerByte) {
+        *value = result | (static_cast<intptr_t>(b - kEndUnsignedByteMarker)
+                           << shift);
+        return true;
+      }
+      result |= static_cast<intptr_t>(b) << shift;
+      shift += kDataBitsPerByte;
+    }
+    return false;
+  }
+
+ private:
+  const uint8_t* current_;
+  const uint8_t* end_;
+
+  DISALLOW_COPY_AND_ASSIGN(SnapshotReader);
+};
+
+class HeapSnapshotAnalyzerTask : public ThreadPool::Task {
+ public:
+  HeapSnapshotAnalyzerTask(HeapSnapshotAnalyzer* analyzer,
+                           ThreadBarrier* barrier,
+                           intptr_t task_index,
+                           intptr_t num_tasks)
+      : analyzer_(analyzer),
+        barrier_(barrier),
+        task_index_(task_index),
+        num_tasks_(num_tasks) {}
+
+  virtual void Run() {
+    analyzer_->Work(task_index_, num_tasks_, barrier_);
+    barrier_->Exit();
+  }
+
+ private:
+  HeapSnapshotAnalyzer* analyzer_;
+  ThreadBarrier* barrier_;
+  intptr_t task_index_;
+  intptr_t num_tasks_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapSnapshotAnalyzerTask);
+};
+
+HeapSnapshotAnalyzer::HeapSnapshotAnalyzer()
+    : node_count_(0),
+      edge_count_(0),
+      object_alignment_(0),
+      stack_cid_(0),
+      num_cids_(0),
+      addresses_(NULL),
+      shallow_sizes_(NULL),
+      external_sizes_(NULL),
+      cids_(NULL),
+      first_edges_(NULL),
+      edges_(NULL),
+      sorted_addresses_(NULL),
+      reachable_count_(0),
+      rpo_nodes_(NULL),
+      rpo_numbers_(NULL),
+      first_predecessors_(NULL),
+      predecessor_cursors_(NULL),
+      predecessors_(NULL),
+      idoms_(NULL),
+      changed_pass_(-1),
+      analyzed_(false),
+      dominators_(NULL),
+      retained_sizes_(NULL),
+      class_instance_counts_(NULL),
+      class_shallow_sizes_(NULL),
+      class_retained_sizes_(NULL) {}
+
+HeapSnapshotAnalyzer::~HeapSnapshotAnalyzer() {
+  delete[] addresses_;
+  delete[] shallow_sizes_;
+  delete[] external_sizes_;
+  delete[] cids_;
+  delete[] first_edges_;
+  delete[] edges_;
+  delete[] sorted_addresses_;
+  delete[] rpo_nodes_;
+  delete[] rpo_numbers_;
+  delete[] first_predecessors_;
+  delete[] predecessor_cursors_;
+  delete[] predecessors_;
+  delete[] idoms_;
+  delete[] dominators_;
+  delete[] retained_sizes_;
+  delete[] class_instance_counts_;
+  delete[] class_shallow_sizes_;
+  delete[] class_retained_sizes_;
+}
+
+static int CompareAddresses(const void* a, const void* b) {
+  intptr_t address_a = *reinterpret_cast<const intptr_t*>(a);
+  intptr_t address_b = *reinterpret_cast<const intptr_t*>(b);
+  if (address_a < address_b) return -1;
+  if (address_a > address_b) return 1;
+  return 0;
+}
+
+bool HeapSnapshotAnalyzer::Parse(const uint8_t* data,
+                                 intptr_t length,
+                                 const char** error) {
+  ASSERT(addresses_ == NULL);
+  // The snapshot is read twice: once to count the nodes and edges, and once
+  // to fill in the arrays.
+  intptr_t node_count = 0;
+  intptr_t edge_count = 0;
+  {
+    SnapshotReader reader(data, length);
+    intptr_t field_cid;
+    if (!reader.ReadUnsigned(&object_alignment_) ||
+        !reader.ReadUnsigned(&stack_cid_) || !reader.ReadUnsigned(&field_cid) ||
+        !reader.ReadUnsigned(&num_cids_)) {
+      *error = "Heap snapshot is truncated";
+      return false;
+    }
+    if (object_alignment_ <= 0) {
+      *error = "Heap snapshot has an invalid object alignment";
+      return false;
+    }
+    while (true) {
+      intptr_t address, size, cid;
+      if (!reader.ReadUnsigned(&address)) {
+        *error = "Heap snapshot is truncated";
+        return false;
+      }
+      // The root is the first node and the only one at address 0. Any other
+      // 0 ends the nodes.
+      if ((address == 0) && (node_count > 0)) {
+        break;
+      }
+      if (!reader.ReadUnsigned(&size) || !reader.ReadUnsigned(&cid)) {
+        *error = "Heap snapshot is truncated";
+        return false;
+      }
+      if ((cid < 0) || (cid >= num_cids_)) {
+        *error = "Heap snapshot has a node with an invalid class id";
+        return false;
+      }
+      intptr_t target;
+      do {
+        if (!reader.ReadUnsigned(&target)) {
+          *error = "Heap snapshot is truncated";
+          return false;
+        }
+        if (target != 0) {
+          edge_count++;
+        }
+      } while (target != 0);
+      node_count++;
+    }
+  }
+
+  node_count_ = node_count;
+  edge_count_ = edge_count;
+  addresses_ = new intptr_t[node_count];
+  shallow_sizes_ = new intptr_t[node_count];
+  external_sizes_ = new intptr_t[node_count];
+  cids_ = new intptr_t[node_count];
+  first_edges_ = new intptr_t[node_count + 1];
+  edges_ = new intptr_t[edge_count];
+  sorted_addresses_ = new AddressEntry[node_count];
+
+  SnapshotReader reader(data, length);
+  intptr_t header;
+  for (intptr_t i = 0; i < 4; i++) {
+    reader.ReadUnsigned(&header);
+  }
+  intptr_t edge = 0;
+  for (intptr_t node = 0; node < node_count; node++) {
+    reader.ReadUnsigned(&addresses_[node]);
+    reader.ReadUnsigned(&shallow_sizes_[node]);
+    reader.ReadUnsigned(&cids_[node]);
+    external_sizes_[node] = 0;
+    sorted_addresses_[node].address = addresses_[node];
+    sorted_addresses_[node].node = node;
+    first_edges_[node] = edge;
+    intptr_t target;
+    reader.ReadUnsigned(&target);
+    while (target != 0) {
+      edges_[edge++] = target;
+      reader.ReadUnsigned(&target);
+    }
+  }
+  first_edges_[node_count] = edge;
+  ASSERT(edge == edge_count);
+  intptr_t end_of_nodes;
+  reader.ReadUnsigned(&end_of_nodes);
+  ASSERT(end_of_nodes == 0);
+
+  qsort(sorted_addresses_, node_count, sizeof(sorted_addresses_[0]),
+        CompareAddresses);
+  for (intptr_t i = 1; i < node_count; i++) {
+    if (sorted_addresses_[i].address == sorted_addresses_[i - 1].address) {
+      *error = "Heap snapshot has two nodes at the same address";
+      return false;
+    }
+  }
+
+  // External sizes of objects with weak persistent handles.
+  while (true) {
+    intptr_t address, external_size;
+    if (!reader.ReadUnsigned(&address)) {
+      *error = "Heap snapshot is truncated";
+      return false;
+    }
+    if (address == 0) {
+      break;
+    }
+    if (!reader.ReadUnsigned(&external_size)) {
+      *error = "Heap snapshot is truncated";
+      return false;
+    }
+    // The handle's object might be in the VM isolate, in which case it is not
+    // part of the snapshot.
+    intptr_t node = FindNode(address);
+    if (node != kNoNode) {
+      external_sizes_[node] += external_size;
+    }
+  }
+  return true;
+}
+
+intptr_t HeapSnapshotAnalyzer::FindNode(intptr_t address) const {
+  intptr_t low = 0;
+  intptr_t high = node_count_ - 1;
+  while (low <= high) {
+    intptr_t mid = low + (high - low) / 2;
+    intptr_t mid_address = sorted_addresses_[mid].address;
+    if (mid_address < address) {
+      low = mid + 1;
+    } else if (mid_address > address) {
+      high = mid - 1;
+    } else {
+      return sorted_addresses_[mid].node;
+    }
+  }
+  return kNoNode;
+}
+
+void HeapSnapshotAnalyzer::Analyze(ThreadPool* pool, intptr_t num_tasks) {
+  ASSERT(!analyzed_);
+  if ((pool == NULL) || (num_tasks < 2)) {
+    Work(0, 1, NULL);
+  } else {
+    Monitor barrier_monitor;
+    Monitor barrier_done_monitor;
+    ThreadBarrier barrier(num_tasks, &barrier_monitor, &barrier_done_monitor);
+    for (intptr_t task_index = 1; task_index < num_tasks; task_index++) {
+      bool result = pool->Run(
+          new HeapSnapshotAnalyzerTask(this, &barrier, task_index, num_tasks));
+      ASSERT(result);
+    }
+    Work(0, num_tasks, &barrier);
+    barrier.Exit();
+  }
+  analyzed_ = true;
+}
+
+static void Sync(ThreadBarrier* barrier) {
+  if (barrier != NULL) {
+    barrier->Sync();
+  }
+}
+
+// The part of [0, length) handled by the task 'task_index' of 'num_tasks'.
+static intptr_t TaskStart(intptr_t length,
+                          intptr_t task_index,
+                          intptr_t num_tasks) {
+  return static_cast<intptr_t>(static_cast<int64_t>(length) * task_index /
+                               num_tasks);
+}
+
+void HeapSnapshotAnalyzer::Work(intptr_t task_index,
+                                intptr_t num_tasks,
+                                ThreadBarrier* barrier) {
+  ResolveEdges(task_index, num_tasks);
+  Sync(barrier);
+  if (task_index == 0) {
+    ComputeReversePostorder();
+  }
+  Sync(barrier);
+  CountPredecessors(task_index, num_tasks);
+  Sync(barrier);
+  if (task_index == 0) {
+    AllocatePredecessors();
+  }
+  Sync(barrier);
+  FillPredecessors(task_index, num_tasks);
+  Sync(barrier);
+
+  // Iterate until a pass in which no task changed anything. Every task that
+  // changes an idom records the pass number. Once a task is in pass p + 1,
+  // all tasks saw a change in pass p, so looking for "at least p" gives all
+  // tasks the same answer.
+  for (intptr_t pass = 0;; pass++) {
+    if (ComputeDominatorsPass(task_index, num_tasks)) {
+      changed_pass_ = pass;
+    }
+    Sync(barrier);
+    if (AtomicOperations::LoadRelaxed(&changed_pass_) < pass) {
+      break;
+    }
+  }
+
+  if (task_index == 0) {
+    ComputeRetainedSizes();
+  }
+}
+
+void HeapSnapshotAnalyzer::ResolveEdges(intptr_t task_index,
+                                        intptr_t num_tasks) {
+  const intptr_t start = TaskStart(node_count_, task_index, num_tasks);
+  const intptr_t end = TaskStart(node_count_, task_index + 1, num_tasks);
+  for (intptr_t edge = first_edges_[start]; edge < first_edges_[end]; edge++) {
+    // An edge to an object missing from the snapshot is dropped.
+    edges_[edge] = FindNode(edges_[edge]);
+  }
+}
+
+void HeapSnapshotAnalyzer::ComputeReversePostorder() {
+  rpo_numbers_ = new intptr_t[node_count_];
+  for (intptr_t node = 0; node < node_count_; node++) {
+    rpo_numbers_[node] = kNoNode;
+  }
+
+  // Iterative depth-first search. A node is on the stack with the position
+  // of its next edge to follow. Postorder numbers are assigned from the end,
+  // which gives reverse postorder once the unreachable nodes are removed.
+  intptr_t* postorder = new intptr_t[node_count_];
+  intptr_t* stack_nodes = new intptr_t[node_count_];
+  intptr_t* stack_edges = new intptr_t[node_count_];
+  const intptr_t kVisited = -2;
+  intptr_t count = 0;
+  intptr_t top = 0;
+  stack_nodes[0] = 0;
+  stack_edges[0] = first_edges_[0];
+  rpo_numbers_[0] = kVisited;
+  while (top >= 0) {
+    const intptr_t node = stack_nodes[top];
+    const intptr_t edge = stack_edges[top];
+    if (edge < first_edges_[node + 1]) {
+      stack_edges[top]++;
+      const intptr_t target = edges_[edge];
+      if ((target != kNoNode) && (rpo_numbers_[target] == kNoNode)) {
+        rpo_numbers_[target] = kVisited;
+        top++;
+        stack_nodes[top] = target;
+        stack_edges[top] = first_edges_[target];
+      }
+    } else {
+      postorder[count++] = node;
+      top--;
+    }
+  }
+  delete[] stack_nodes;
+  delete[] stack_edges;
+
+  reachable_count_ = count;
+  rpo_nodes_ = new intptr_t[count];
+  for (intptr_t i = 0; i < count; i++) {
+    const intptr_t node = postorder[count - 1 - i];
+    rpo_nodes_[i] = node;
+    rpo_numbers_[node] = i;
+  }
+  delete[] postorder;
+  ASSERT(rpo_nodes_[0] == 0);
+
+  first_predecessors_ = new intptr_t[count + 1];
+  for (intptr_t i = 0; i <= count; i++) {
+    first_predecessors_[i] = 0;
+  }
+}
+
+void HeapSnapshotAnalyzer::CountPredecessors(intptr_t task_index,
+                                             intptr_t num_tasks) {
+  const intptr_t start = TaskStart(reachable_count_, task_index, num_tasks);
+  const intptr_t end = TaskStart(reachable_count_, task_index + 1, num_tasks);
+  for (intptr_t i = start; i < end; i++) {
+    const intptr_t node = rpo_nodes_[i];
+    for (intptr_t edge = first_edges_[node]; edge < first_edges_[node + 1];
+         edge++) {
+      const intptr_t target = edges_[edge];
+      if (target != kNoNode) {
+        // Counted one slot up, so the prefix sums below give the starts.
+        AtomicOperations::FetchAndIncrement(
+            &first_predecessors_[rpo_numbers_[target] + 1]);
+      }
+    }
+  }
+}
+
+void HeapSnapshotAnalyzer::AllocatePredecessors() {
+  for (intptr_t i = 1; i <= reachable_count_; i++) {
+    first_predecessors_[i] += first_predecessors_[i - 1];
+  }
+  predecessors_ = new intptr_t[first_predecessors_[reachable_count_]];
+  predecessor_cursors_ = new intptr_t[reachable_count_];
+  idoms_ = new intptr_t[reachable_count_];
+  for (intptr_t i = 0; i < reachable_count_; i++) {
+    predecessor_cursors_[i] = first_predecessors_[i];
+    idoms_[i] = kNoNode;
+  }
+  idoms_[0] = 0;
+}
+
+void HeapSnapshotAnalyzer::FillPredecessors(intptr_t task_index,
+                                            intptr_t num_tasks) {
+  const intptr_t start = TaskStart(reachable_count_, task_index, num_tasks);
+  const intptr_t end = TaskStart(reachable_count_, task_index + 1, num_tasks);
+  for (intptr_t i = start; i < end; i++) {
+    const intptr_t node = rpo_nodes_[i];
+    for (intptr_t edge = first_edges_[node]; edge < first_edges_[node + 1];
+         edge++) {
+      const intptr_t target = edges_[edge];
+      if (target != kNoNode) {
+        const intptr_t slot = AtomicOperations::FetchAndIncrement(
+            &predecessor_cursors_[rpo_numbers_[target]]);
+        predecessors_[slot] = i;
+      }
+    }
+  }
+}
+
+// The dominators are computed with the iterative algorithm of Cooper, Harvey
+// and Kennedy, "A Simple, Fast Dominance Algorithm", with the nodes numbered
+// in reverse postorder. Each task updates the idoms of its own range of nodes
+// in place while the other tasks may read them. An idom is only ever seeded
+// from a predecessor earlier in reverse postorder, so every idom a task can
+// observe names an earlier node that dominates in the tree built so far. The
+// walks in Intersect therefore terminate, and the idoms only move up the tree
+// until they reach the same fixed point as the sequential algorithm.
+intptr_t HeapSnapshotAnalyzer::Intersect(intptr_t finger1,
+                                         intptr_t finger2) const {
+  while (finger1 != finger2) {
+    while (finger1 > finger2) {
+      finger1 = AtomicOperations::LoadRelaxed(&idoms_[finger1]);
+    }
+    while (finger2 > finger1) {
+      finger2 = AtomicOperations::LoadRelaxed(&idoms_[finger2]);
+    }
+  }
+  return finger1;
+}
+
+bool HeapSnapshotAnalyzer::ComputeDominatorsPass(intptr_t task_index,
+                                                 intptr_t num_tasks) {
+  // The root is its own idom and is skipped.
+  intptr_t start = TaskStart(reachable_count_, task_index, num_tasks);
+  const intptr_t end = TaskStart(reachable_count_, task_index + 1, num_tasks);
+  if (start == 0) {
+    start = 1;
+  }
+  bool changed = false;
+  for (intptr_t i = start; i < end; i++) {
+    const intptr_t first = first_predecessors_[i];
+    const intptr_t last = first_predecessors_[i + 1];
+    // Seed with a processed predecessor that comes before the node. A back
+    // edge may already be processed by another task, but seeding with it
+    // could make the idom come after the node.
+    intptr_t new_idom = kNoNode;
+    for (intptr_t p = first; p < last; p++) {
+      const intptr_t predecessor = predecessors_[p];
+      if ((predecessor < i) &&
+          (AtomicOperations::LoadRelaxed(&idoms_[predecessor]) != kNoNode)) {
+        new_idom = predecessor;
+        break;
+      }
+    }
+    if (new_idom == kNoNode) {
+      continue;  // Revisited in the next pass.
+    }
+    for (intptr_t p = first; p < last; p++) {
+      const intptr_t predecessor = predecessors_[p];
+      if ((predecessor == new_idom) ||
+          (AtomicOperations::LoadRelaxed(&idoms_[predecessor]) == kNoNode)) {
+        continue;  // The seed, or not processed yet.
+      }
+      new_idom = Intersect(predecessor, new_idom);
+    }
+    if (new_idom != idoms_[i]) {
+      AtomicOperations::StoreRelaxed(&idoms_[i], new_idom);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+void HeapSnapshotAnalyzer::ComputeRetainedSizes() {
+  dominators_ = new intptr_t[node_count_];
+  retained_sizes_ = new intptr_t[node_count_];
+  for (intptr_t node = 0; node < node_count_; node++) {
+    dominators_[node] = kNoNode;
+    retained_sizes_[node] = ShallowSizeOf(node);
+  }
+  for (intptr_t i = 1; i < reachable_count_; i++) {
+    dominators_[rpo_nodes_[i]] = rpo_nodes_[idoms_[i]];
+  }
+
+  // An idom comes before the nodes it dominates in reverse postorder, so
+  // going backwards adds up the dominator tree bottom-up.
+  for (intptr_t i = reachable_count_ - 1; i > 0; i--) {
+    retained_sizes_[rpo_nodes_[idoms_[i]]] += retained_sizes_[rpo_nodes_[i]];
+  }
+
+  class_instance_counts_ = new intptr_t[num_cids_];
+  class_shallow_sizes_ = new intptr_t[num_cids_];
+  class_retained_sizes_ = new intptr_t[num_cids_];
+  for (intptr_t cid = 0; cid < num_cids_; cid++) {
+    class_instance_counts_[cid] = 0;
+    class_shallow_sizes_[cid] = 0;
+    class_retained_sizes_[cid] = 0;
+  }
+  for (intptr_t node = 1; node < node_count_; node++) {
+    class_instance_counts_[cids_[node]]++;
+    class_shallow_sizes_[cids_[node]] += ShallowSizeOf(node);
+  }
+
+  // A class retains what its outermost instances in the dominator tree
+  // retain. Walk the tree depth-first, counting the instances of each class
+  // on the path from the root. The children of each node are listed in the
+  // same way as the predecessors, reusing their arrays.
+  intptr_t* first_children = first_predecessors_;
+  intptr_t* children = predecessors_;
+  for (intptr_t i = 0; i <= reachable_count_; i++) {
+    first_children[i] = 0;
+  }
+  for (intptr_t i = 1; i < reachable_count_; i++) {
+    first_children[idoms_[i] + 1]++;
+  }
+  for (intptr_t i = 1; i <= reachable_count_; i++) {
+    first_children[i] += first_children[i - 1];
+  }
+  for (intptr_t i = 0; i < reachable_count_; i++) {
+    predecessor_cursors_[i] = first_children[i];
+  }
+  for (intptr_t i = 1; i < reachable_count_; i++) {
+    children[predecessor_cursors_[idoms_[i]]++] = i;
+  }
+
+  intptr_t* on_path = new intptr_t[num_cids_];
+  for (intptr_t cid = 0; cid < num_cids_; cid++) {
+    on_path[cid] = 0;
+  }
+  // Each entry is a node to enter, or the complement of a node to leave.
+  intptr_t* stack = new intptr_t[2 * reachable_count_];
+  intptr_t top = 0;
+  for (intptr_t c = first_children[0]; c < first_children[1]; c++) {
+    stack[top++] = children[c];
+  }
+  while (top > 0) {
+    const intptr_t entry = stack[--top];
+    if (entry < 0) {
+      on_path[cids_[rpo_nodes_[~entry]]]--;
+      continue;
+    }
+    const intptr_t node = rpo_nodes_[entry];
+    const intptr_t cid = cids_[node];
+    if (on_path[cid] == 0) {
+      class_retained_sizes_[cid] += retained_sizes_[node];
+    }
+    on_path[cid]++;
+    stack[top++] = ~entry;
+    for (intptr_t c = first_children[entry]; c < first_children[entry + 1];
+         c++) {
+      stack[top++] = children[c];
+    }
+  }
+  delete[] stack;
+  delete[] on_path;
+}
+
+}  // namespace dart
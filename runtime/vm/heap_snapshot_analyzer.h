@@ -0,0 +1,171 @@
+// Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_HEAP_SNAPSHOT_ANALYZER_H_
+#define RUNTIME_VM_HEAP_SNAPSHOT_ANALYZER_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+class ThreadBarrier;
+class ThreadPool;
+
+// Computes the dominator tree of a heap snapshot written by
+// ObjectGraph::Serialize, and from it the retained size of every object and
+// class in one go. Unlike the queries in ObjectGraph, this only looks at the
+// snapshot bytes, so it can analyze a snapshot saved to a file as well as one
+// just taken from a running isolate.
+//
+// Nodes are numbered in snapshot order; node 0 is the root.
+//
+// Example:
+//   HeapSnapshotAnalyzer analyzer;
+//   const char* error = NULL;
+//   if (analyzer.Parse(data, length, &error)) {
+//     analyzer.Analyze(Dart::thread_pool(), 4);
+//     ... analyzer.RetainedSizeOfClass(cid) ...
+//   }
+class HeapSnapshotAnalyzer : public ValueObject {
+ public:
+  static const intptr_t kNoNode = -1;
+
+  HeapSnapshotAnalyzer();
+  ~HeapSnapshotAnalyzer();
+
+  // Reads the nodes and edges of the snapshot in 'data'. Returns false and
+  // sets 'error' if the snapshot is malformed. The data is not referenced
+  // after this returns.
+  bool Parse(const uint8_t* data, intptr_t length, const char** error);
+
+  // Computes dominators and retained sizes. The work is split into
+  // 'num_tasks' tasks, all but one of which run on 'pool'; the calling thread
+  // runs the remaining one and blocks until all are done. With no pool or
+  // fewer than two tasks, everything runs on the calling thread.
+  void Analyze(ThreadPool* pool, intptr_t num_tasks);
+
+  intptr_t node_count() const { return node_count_; }
+  intptr_t edge_count() const { return edge_count_; }
+  intptr_t num_cids() const { return num_cids_; }
+  intptr_t object_alignment() const { return object_alignment_; }
+  intptr_t stack_cid() const { return stack_cid_; }
+
+  uword AddressOf(intptr_t node) const {
+    ASSERT((node >= 0) && (node < node_count_));
+    return addresses_[node] * object_alignment_;
+  }
+  intptr_t ClassIdOf(intptr_t node) const {
+    ASSERT((node >= 0) && (node < node_count_));
+    return cids_[node];
+  }
+  // The size of the object itself plus the external memory it owns.
+  intptr_t ShallowSizeOf(intptr_t node) const {
+    ASSERT((node >= 0) && (node < node_count_));
+    return shallow_sizes_[node] + external_sizes_[node];
+  }
+
+  // The following are only valid after Analyze.
+
+  // The immediate dominator of 'node', or kNoNode for the root and for nodes
+  // that cannot be reached from it.
+  intptr_t DominatorOf(intptr_t node) const {
+    ASSERT(analyzed_);
+    ASSERT((node >= 0) && (node < node_count_));
+    return dominators_[node];
+  }
+  // The memory that would be freed if 'node' were unreachable.
+  intptr_t RetainedSizeOf(intptr_t node) const {
+    ASSERT(analyzed_);
+    ASSERT((node >= 0) && (node < node_count_));
+    return retained_sizes_[node];
+  }
+
+  intptr_t InstanceCountOfClass(intptr_t cid) const {
+    ASSERT(analyzed_);
+    ASSERT((cid >= 0) && (cid < num_cids_));
+    return class_instance_counts_[cid];
+  }
+  intptr_t ShallowSizeOfClass(intptr_t cid) const {
+    ASSERT(analyzed_);
+    ASSERT((cid >= 0) && (cid < num_cids_));
+    return class_shallow_sizes_[cid];
+  }
+  // The sum of the retained sizes of the instances of 'cid' that are not
+  // dominated by another instance of 'cid'. Objects that are only reachable
+  // through several instances of the class are not counted, so this can be
+  // less than ObjectGraph::SizeRetainedByClass.
+  intptr_t RetainedSizeOfClass(intptr_t cid) const {
+    ASSERT(analyzed_);
+    ASSERT((cid >= 0) && (cid < num_cids_));
+    return class_retained_sizes_[cid];
+  }
+
+ private:
+  // Runs the phases of Analyze. Phases that are split between tasks are
+  // separated by 'barrier'; the serial ones run on task 0 only.
+  void Work(intptr_t task_index, intptr_t num_tasks, ThreadBarrier* barrier);
+
+  void ResolveEdges(intptr_t task_index, intptr_t num_tasks);
+  void ComputeReversePostorder();
+  void CountPredecessors(intptr_t task_index, intptr_t num_tasks);
+  void AllocatePredecessors();
+  void FillPredecessors(intptr_t task_index, intptr_t num_tasks);
+  bool ComputeDominatorsPass(intptr_t task_index, intptr_t num_tasks);
+  intptr_t Intersect(intptr_t finger1, intptr_t finger2) const;
+  void ComputeRetainedSizes();
+
+  intptr_t FindNode(intptr_t address) const;
+
+  intptr_t node_count_;
+  intptr_t edge_count_;
+  intptr_t object_alignment_;
+  intptr_t stack_cid_;
+  intptr_t num_cids_;
+
+  // Per node, in snapshot order.
+  intptr_t* addresses_;  // In units of object_alignment_.
+  intptr_t* shallow_sizes_;
+  intptr_t* external_sizes_;
+  intptr_t* cids_;
+  intptr_t* first_edges_;  // node_count_ + 1 entries.
+  // Edge targets: addresses after Parse, then nodes (or kNoNode) after
+  // ResolveEdges.
+  intptr_t* edges_;
+
+  // Pairs of (address, node), sorted by address.
+  struct AddressEntry {
+    intptr_t address;
+    intptr_t node;
+  };
+  AddressEntry* sorted_addresses_;
+
+  // Reachable nodes in reverse postorder of a depth-first search from the
+  // root, and the position of every node in that order (kNoNode if
+  // unreachable). The phases below work on these positions.
+  intptr_t reachable_count_;
+  intptr_t* rpo_nodes_;
+  intptr_t* rpo_numbers_;
+  intptr_t* first_predecessors_;  // reachable_count_ + 1 entries.
+  intptr_t* predecessor_cursors_;
+  intptr_t* predecessors_;
+  intptr_t* idoms_;
+  // The last dominator pass in which some task changed an idom.
+  intptr_t changed_pass_;
+
+  bool analyzed_;
+  intptr_t* dominators_;
+  intptr_t* retained_sizes_;
+  intptr_t* class_instance_counts_;
+  intptr_t* class_shallow_sizes_;
+  intptr_t* class_retained_sizes_;
+
+  friend class HeapSnapshotAnalyzerTask;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapSnapshotAnalyzer);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_HEAP_SNAPSHOT_ANALYZER_H_
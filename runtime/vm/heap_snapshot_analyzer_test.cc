@@ -0,0 +1,226 @@
+// Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/heap_snapshot_analyzer.h"
+#include "platform/assert.h"
+#include "vm/dart.h"
+#include "vm/datastream.h"
+#include "vm/object_graph.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+static uint8_t* malloc_allocator(uint8_t* ptr,
+                                 intptr_t old_size,
+                                 intptr_t new_size) {
+  return reinterpret_cast<uint8_t*>(realloc(ptr, new_size));
+}
+
+static void WriteNode(WriteStream* stream,
+                      intptr_t address,
+                      intptr_t size,
+                      intptr_t cid,
+                      intptr_t edge1 = 0,
+                      intptr_t edge2 = 0) {
+  stream->WriteUnsigned(address);
+  stream->WriteUnsigned(size);
+  stream->WriteUnsigned(cid);
+  if (edge1 != 0) stream->WriteUnsigned(edge1);
+  if (edge2 != 0) stream->WriteUnsigned(edge2);
+  stream->WriteUnsigned(0);
+}
+
+// root -> A, B; A -> C, E; B -> C; C -> D; D -> C, (missing).
+// U is unreachable and points to A.
+static const intptr_t kA = 2, kB = 3, kC = 4, kD = 5, kE = 6, kU = 7;
+
+static void CheckDominators(ThreadPool* pool, intptr_t num_tasks) {
+  uint8_t* buffer = NULL;
+  WriteStream stream(&buffer, &malloc_allocator, KB);
+  stream.WriteUnsigned(16);  // Object alignment.
+  stream.WriteUnsigned(8);   // Stack cid.
+  stream.WriteUnsigned(9);   // Field cid.
+  stream.WriteUnsigned(10);  // Number of cids.
+  WriteNode(&stream, 0, 0, 0, kA, kB);
+  WriteNode(&stream, kA, 32, 5, kC, kE);
+  WriteNode(&stream, kB, 16, 5, kC);
+  WriteNode(&stream, kC, 64, 6, kD);
+  WriteNode(&stream, kD, 16, 7, kC, 99);
+  WriteNode(&stream, kE, 48, 5);
+  WriteNode(&stream, kU, 16, 7, kA);
+  stream.WriteUnsigned(0);
+  // External sizes, including one for an object that is not in the snapshot.
+  stream.WriteUnsigned(kA);
+  stream.WriteUnsigned(100);
+  stream.WriteUnsigned(77);
+  stream.WriteUnsigned(5);
+  stream.WriteUnsigned(0);
+
+  HeapSnapshotAnalyzer analyzer;
+  const char* error = NULL;
+  EXPECT(analyzer.Parse(buffer, stream.bytes_written(), &error));
+  EXPECT(error == NULL);
+  free(buffer);
+  EXPECT_EQ(7, analyzer.node_count());
+  EXPECT_EQ(9, analyzer.edge_count());
+  EXPECT_EQ(kC * 16, static_cast<intptr_t>(analyzer.AddressOf(3)));
+  EXPECT_EQ(132, analyzer.ShallowSizeOf(1));
+
+  analyzer.Analyze(pool, num_tasks);
+  const intptr_t kNoNode = HeapSnapshotAnalyzer::kNoNode;
+  EXPECT_EQ(kNoNode, analyzer.DominatorOf(0));
+  EXPECT_EQ(0, analyzer.DominatorOf(1));  // A
+  EXPECT_EQ(0, analyzer.DominatorOf(2));  // B
+  EXPECT_EQ(0, analyzer.DominatorOf(3));  // C
+  EXPECT_EQ(3, analyzer.DominatorOf(4));  // D
+  EXPECT_EQ(1, analyzer.DominatorOf(5));  // E
+  EXPECT_EQ(kNoNode, analyzer.DominatorOf(6));  // U
+
+  EXPECT_EQ(132 + 48, analyzer.RetainedSizeOf(1));
+  EXPECT_EQ(16, analyzer.RetainedSizeOf(2));
+  EXPECT_EQ(64 + 16, analyzer.RetainedSizeOf(3));
+  EXPECT_EQ(16, analyzer.RetainedSizeOf(4));
+  EXPECT_EQ(48, analyzer.RetainedSizeOf(5));
+  EXPECT_EQ(16, analyzer.RetainedSizeOf(6));
+  EXPECT_EQ(180 + 16 + 80, analyzer.RetainedSizeOf(0));
+
+  // E is dominated by A, another instance of its class.
+  EXPECT_EQ(3, analyzer.InstanceCountOfClass(5));
+  EXPECT_EQ(132 + 16 + 48, analyzer.ShallowSizeOfClass(5));
+  EXPECT_EQ(180 + 16, analyzer.RetainedSizeOfClass(5));
+  EXPECT_EQ(80, analyzer.RetainedSizeOfClass(6));
+  // U is unreachable, so it retains nothing.
+  EXPECT_EQ(2, analyzer.InstanceCountOfClass(7));
+  EXPECT_EQ(16, analyzer.RetainedSizeOfClass(7));
+}
+
+VM_UNIT_TEST_CASE(HeapSnapshotAnalyzer_Dominators) {
+  CheckDominators(NULL, 0);
+  CheckDominators(Dart::thread_pool(), 2);
+  CheckDominators(Dart::thread_pool(), 8);  // More tasks than nodes.
+}
+
+// root -> chain[0] -> chain[1] -> ... -> chain[n - 1] -> chain[0], with an
+// edge from every third node to the one halfway around the cycle. The back
+// edges cross the ranges of nodes handled by different tasks.
+static void WriteCycle(WriteStream* stream, intptr_t length) {
+  const intptr_t kFirst = 2;
+  stream->WriteUnsigned(16);
+  stream->WriteUnsigned(8);
+  stream->WriteUnsigned(9);
+  stream->WriteUnsigned(10);
+  WriteNode(stream, 0, 0, 0, kFirst);
+  for (intptr_t i = 0; i < length; i++) {
+    const intptr_t next = kFirst + (i + 1) % length;
+    const intptr_t across =
+        (i % 3 == 0) ? kFirst + (i + length / 2) % length : 0;
+    WriteNode(stream, kFirst + i, 16, 5, next, across);
+  }
+  stream->WriteUnsigned(0);
+  stream->WriteUnsigned(0);
+}
+
+VM_UNIT_TEST_CASE(HeapSnapshotAnalyzer_CycleAcrossTasks) {
+  const intptr_t kLength = 200;
+  uint8_t* buffer = NULL;
+  WriteStream stream(&buffer, &malloc_allocator, KB);
+  WriteCycle(&stream, kLength);
+
+  HeapSnapshotAnalyzer serial;
+  const char* error = NULL;
+  EXPECT(serial.Parse(buffer, stream.bytes_written(), &error));
+  serial.Analyze(NULL, 0);
+  EXPECT_EQ(kLength + 1, serial.node_count());
+  EXPECT_EQ(0, serial.DominatorOf(1));
+  EXPECT_EQ(16 * kLength, serial.RetainedSizeOf(0));
+
+  const intptr_t kNumTasks[] = {2, 4, 8};
+  for (intptr_t t = 0; t < 3; t++) {
+    // Repeated, since the order in which the tasks run varies.
+    for (intptr_t repeat = 0; repeat < 10; repeat++) {
+      HeapSnapshotAnalyzer parallel;
+      EXPECT(parallel.Parse(buffer, stream.bytes_written(), &error));
+      parallel.Analyze(Dart::thread_pool(), kNumTasks[t]);
+      for (intptr_t node = 0; node < serial.node_count(); node++) {
+        EXPECT_EQ(serial.DominatorOf(node), parallel.DominatorOf(node));
+        EXPECT_EQ(serial.RetainedSizeOf(node), parallel.RetainedSizeOf(node));
+      }
+    }
+  }
+  free(buffer);
+}
+
+VM_UNIT_TEST_CASE(HeapSnapshotAnalyzer_Truncated) {
+  uint8_t* buffer = NULL;
+  WriteStream stream(&buffer, &malloc_allocator, KB);
+  stream.WriteUnsigned(16);
+  stream.WriteUnsigned(8);
+  stream.WriteUnsigned(9);
+  stream.WriteUnsigned(10);
+  WriteNode(&stream, 0, 0, 0, kA);
+  stream.WriteUnsigned(kA);
+  HeapSnapshotAnalyzer analyzer;
+  const char* error = NULL;
+  EXPECT(!analyzer.Parse(buffer, stream.bytes_written(), &error));
+  EXPECT_STREQ("Heap snapshot is truncated", error);
+  free(buffer);
+}
+
+ISOLATE_UNIT_TEST_CASE(HeapSnapshotAnalyzer_Isolate) {
+  // 'array' is the only reference to 'inner', so it retains both.
+  const Array& array = Array::Handle(Array::New(2, Heap::kOld));
+  intptr_t array_size = array.raw()->Size();
+  {
+    HANDLESCOPE(thread);
+    const Array& inner = Array::Handle(Array::New(10, Heap::kOld));
+    array.SetAt(0, inner);
+    array_size += inner.raw()->Size();
+  }
+  {
+    ObjectGraph graph(thread);
+    EXPECT_EQ(array_size, graph.SizeRetainedByInstance(array));
+  }
+
+  uint8_t* buffer = NULL;
+  WriteStream stream(&buffer, &malloc_allocator, 1 * MB);
+  intptr_t node_count;
+  {
+    ObjectGraph graph(thread);
+    node_count = graph.Serialize(&stream, ObjectGraph::kVM, false);
+  }
+
+  HeapSnapshotAnalyzer serial;
+  HeapSnapshotAnalyzer parallel;
+  const char* error = NULL;
+  EXPECT(serial.Parse(buffer, stream.bytes_written(), &error));
+  EXPECT(parallel.Parse(buffer, stream.bytes_written(), &error));
+  free(buffer);
+  EXPECT_EQ(node_count, serial.node_count());
+  serial.Analyze(NULL, 0);
+  parallel.Analyze(Dart::thread_pool(), 4);
+
+  const uword array_address = RawObject::ToAddr(array.raw());
+  intptr_t array_node = HeapSnapshotAnalyzer::kNoNode;
+  intptr_t total_size = 0;
+  for (intptr_t node = 0; node < node_count; node++) {
+    EXPECT_EQ(serial.DominatorOf(node), parallel.DominatorOf(node));
+    EXPECT_EQ(serial.RetainedSizeOf(node), parallel.RetainedSizeOf(node));
+    if (node > 0) {
+      EXPECT_NE(HeapSnapshotAnalyzer::kNoNode, serial.DominatorOf(node));
+    }
+    if (serial.AddressOf(node) == array_address) {
+      array_node = node;
+    }
+    total_size += serial.ShallowSizeOf(node);
+  }
+  EXPECT_EQ(total_size, serial.RetainedSizeOf(0));
+  EXPECT_NE(HeapSnapshotAnalyzer::kNoNode, array_node);
+  EXPECT_EQ(array_size, serial.RetainedSizeOf(array_node));
+  for (intptr_t cid = 0; cid < serial.num_cids(); cid++) {
+    EXPECT_EQ(serial.RetainedSizeOfClass(cid),
+              parallel.RetainedSizeOfClass(cid));
+  }
+}
+
+}  // namespace dart
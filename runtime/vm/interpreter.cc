@@ -16,6 +16,7 @@
 #include "vm/cpu.h"
 #include "vm/dart_entry.h"
 #include "vm/debugger.h"
+#include "vm/json_stream.h"
 #include "vm/lockers.h"
 #include "vm/native_arguments.h"
 #include "vm/native_entry.h"
@@ -31,6 +32,10 @@ DEFINE_FLAG(uint64_t,
             trace_interpreter_after,
             ULLONG_MAX,
             "Trace interpreter execution after instruction count reached.");
+DEFINE_FLAG(bool,
+            interpreter_profile,
+            false,
+            "Count executed bytecodes and interpreted function invocations.");
 
 #define LIKELY(cond) __builtin_expect((cond), 1)
 #define UNLIKELY(cond) __builtin_expect((cond), 0)
@@ -116,6 +121,14 @@ class InterpreterHelpers {
     f->ptr()->usage_counter_++;
   }
 
+  // Returns true if an ICData checks array of the given length holds more
+  // checks than an unoptimized call site is expected to see.
+  DART_FORCE_INLINE static bool IsMegamorphicICData(intptr_t length,
+                                                    intptr_t args_tested) {
+    // The checks array is terminated by a sentinel entry.
+    return (length / (args_tested + 2)) > (FLAG_max_polymorphic_checks + 1);
+  }
+
   DART_FORCE_INLINE static void IncrementICUsageCount(RawObject** entries,
                                                       intptr_t offset,
                                                       intptr_t args_tested) {
@@ -544,7 +557,7 @@ void Interpreter::InitOnce() {
 }
 
 Interpreter::Interpreter()
-    : stack_(NULL), fp_(NULL), pp_(NULL), argdesc_(NULL) {
+    : stack_(NULL), fp_(NULL), pp_(NULL), argdesc_(NULL), profile_(NULL) {
   // Setup interpreter support first. Some of this information is needed to
   // setup the architecture state.
   // We allocate the stack here, the size is computed as the sum of
@@ -568,6 +581,7 @@ Interpreter::Interpreter()
 
 Interpreter::~Interpreter() {
   delete[] stack_;
+  delete profile_;
   Isolate* isolate = Isolate::Current();
   if (isolate != NULL) {
     isolate->set_interpreter(NULL);
@@ -1080,6 +1094,9 @@ DART_FORCE_INLINE bool Interpreter::Invoke(Thread* thread,
               Function::Handle(function).ToFullyQualifiedCString());
   }
 #endif
+  if (UNLIKELY(profile_ != NULL)) {
+    profile_->CountInvocation(function);
+  }
   RawCode* bytecode = function->ptr()->bytecode_;
   callee_fp[kKBCPcMarkerSlotFromFp] = bytecode;
   callee_fp[kKBCSavedCallerPcSlotFromFp] = reinterpret_cast<RawObject*>(*pc);
@@ -1126,6 +1143,18 @@ void Interpreter::InlineCacheMiss(int checked_args,
               result, reinterpret_cast<uword>(handler));
 }
 
+DART_FORCE_INLINE void Interpreter::UpdateLookupCache(RawSmi* receiver_cid,
+                                                      RawICData* icdata,
+                                                      RawObject* target) {
+  // The miss handler returns null when no target could be resolved and lazy
+  // dispatchers are disabled; such lookups are not cached.
+  if (target->IsHeapObject() && (target->GetClassId() == kFunctionCid)) {
+    lookup_cache_.Insert(receiver_cid, icdata->ptr()->target_name_,
+                         icdata->ptr()->args_descriptor_,
+                         static_cast<RawFunction*>(target));
+  }
+}
+
 DART_FORCE_INLINE bool Interpreter::InstanceCall1(Thread* thread,
                                                   RawICData* icdata,
                                                   RawObject** call_base,
@@ -1146,8 +1175,21 @@ DART_FORCE_INLINE bool Interpreter::InstanceCall1(Thread* thread,
   RawSmi* receiver_cid =
       InterpreterHelpers::GetClassIdAsSmi(args[receiver_idx]);
 
-  bool found = false;
+  argdesc_ = icdata->ptr()->args_descriptor_;
+
   const intptr_t length = Smi::Value(cache->length_);
+  const bool is_megamorphic =
+      InterpreterHelpers::IsMegamorphicICData(length, kCheckedArgs);
+  if (is_megamorphic) {
+    RawFunction* target = lookup_cache_.Lookup(
+        receiver_cid, icdata->ptr()->target_name_, argdesc_);
+    if (target != NULL) {
+      top[0] = target;
+      return Invoke(thread, call_base, top, pc, FP, SP);
+    }
+  }
+
+  bool found = false;
   intptr_t i;
   for (i = 0; i < (length - (kCheckedArgs + 2)); i += (kCheckedArgs + 2)) {
     if (cache->data()[i + 0] == receiver_cid) {
@@ -1157,8 +1199,6 @@ DART_FORCE_INLINE bool Interpreter::InstanceCall1(Thread* thread,
     }
   }
 
-  argdesc_ = icdata->ptr()->args_descriptor_;
-
   if (found) {
     if (!optimized) {
       InterpreterHelpers::IncrementICUsageCount(cache->data(), i, kCheckedArgs);
@@ -1166,6 +1206,13 @@ DART_FORCE_INLINE bool Interpreter::InstanceCall1(Thread* thread,
   } else {
     InlineCacheMiss(kCheckedArgs, thread, icdata, call_base + receiver_idx, top,
                     *pc, *FP, *SP);
+    // The runtime call may have moved the ICData, reload it from the
+    // miss handler arguments which are visited by the GC.
+    icdata = RAW_CAST(ICData, top[1 + kCheckedArgs]);
+  }
+
+  if (is_megamorphic) {
+    UpdateLookupCache(receiver_cid, icdata, top[0]);
   }
 
   return Invoke(thread, call_base, top, pc, FP, SP);
@@ -1193,8 +1240,25 @@ DART_FORCE_INLINE bool Interpreter::InstanceCall2(Thread* thread,
   RawSmi* arg0_cid =
       InterpreterHelpers::GetClassIdAsSmi(args[receiver_idx + 1]);
 
-  bool found = false;
+  argdesc_ = icdata->ptr()->args_descriptor_;
+
+  // The lookup cache is keyed on the receiver class only, which is sufficient
+  // to resolve the target of any 2-argument call except the type test
+  // specialization done by the miss handler for _simpleInstanceOf.
   const intptr_t length = Smi::Value(cache->length_);
+  const bool is_megamorphic =
+      InterpreterHelpers::IsMegamorphicICData(length, kCheckedArgs) &&
+      (icdata->ptr()->target_name_ != Symbols::_simpleInstanceOf().raw());
+  if (is_megamorphic) {
+    RawFunction* target = lookup_cache_.Lookup(
+        receiver_cid, icdata->ptr()->target_name_, argdesc_);
+    if (target != NULL) {
+      top[0] = target;
+      return Invoke(thread, call_base, top, pc, FP, SP);
+    }
+  }
+
+  bool found = false;
   intptr_t i;
   for (i = 0; i < (length - (kCheckedArgs + 2)); i += (kCheckedArgs + 2)) {
     if ((cache->data()[i + 0] == receiver_cid) &&
@@ -1205,8 +1269,6 @@ DART_FORCE_INLINE bool Interpreter::InstanceCall2(Thread* thread,
     }
   }
 
-  argdesc_ = icdata->ptr()->args_descriptor_;
-
   if (found) {
     if (!optimized) {
       InterpreterHelpers::IncrementICUsageCount(cache->data(), i, kCheckedArgs);
@@ -1214,6 +1276,13 @@ DART_FORCE_INLINE bool Interpreter::InstanceCall2(Thread* thread,
   } else {
     InlineCacheMiss(kCheckedArgs, thread, icdata, call_base + receiver_idx, top,
                     *pc, *FP, *SP);
+    // The runtime call may have moved the ICData, reload it from the
+    // miss handler arguments which are visited by the GC.
+    icdata = RAW_CAST(ICData, top[1 + kCheckedArgs]);
+  }
+
+  if (is_megamorphic) {
+    UpdateLookupCache(receiver_cid, icdata, top[0]);
   }
 
   return Invoke(thread, call_base, top, pc, FP, SP);
@@ -1251,6 +1320,12 @@ DART_FORCE_INLINE void Interpreter::PrepareForTailCall(
 #define TRACE_INSTRUCTION
 #endif  // defined(DEBUG)
 
+// Counts executed bytecode instructions if --interpreter_profile is enabled.
+#define PROFILE_INSTRUCTION                                                    \
+  if (UNLIKELY(bytecode_counts != NULL)) {                                     \
+    bytecode_counts[op & 0xFF]++;                                              \
+  }
+
 // Decode opcode and A part of the given value and dispatch to the
 // corresponding bytecode handler.
 #define DISPATCH_OP(val)                                                       \
@@ -1258,6 +1333,7 @@ DART_FORCE_INLINE void Interpreter::PrepareForTailCall(
     op = (val);                                                                \
     rA = ((op >> 8) & 0xFF);                                                   \
     TRACE_INSTRUCTION                                                          \
+    PROFILE_INSTRUCTION                                                        \
     goto* dispatch[op & 0xFF];                                                 \
   } while (0)
 
@@ -1617,6 +1693,12 @@ RawObject* Interpreter::Call(RawFunction* function,
   uint32_t op;  // Currently executing op.
   uint16_t rA;  // A component of the currently executing op.
 
+  if (UNLIKELY(FLAG_interpreter_profile && (profile_ == NULL))) {
+    profile_ = new InterpreterProfile();
+  }
+  uint64_t* const bytecode_counts =
+      (profile_ != NULL) ? profile_->bytecode_counts() : NULL;
+
   bool reentering = fp_ != NULL;
   if (!reentering) {
     fp_ = reinterpret_cast<RawObject**>(stack_base_);
@@ -1680,6 +1762,9 @@ RawObject* Interpreter::Call(RawFunction* function,
     fp_[kKBCEntrySavedSlots + i] = argv[argc < 0 ? -i : i];
   }
 
+  if (UNLIKELY(profile_ != NULL)) {
+    profile_->CountInvocation(function);
+  }
   RawCode* bytecode = function->ptr()->bytecode_;
   FP[kKBCFunctionSlotFromFp] = function;
   FP[kKBCPcMarkerSlotFromFp] = bytecode;
@@ -2890,6 +2975,107 @@ RawObject* Interpreter::Call(RawFunction* function,
     DISPATCH();
   }
 
+  {
+    BYTECODE(JumpIfEqInt, 0);
+    SP -= 2;
+    if (SP[1] == SP[2]) {
+      LOAD_JUMP_TARGET();
+    } else if (SP[1]->IsHeapObject() && SP[2]->IsHeapObject() &&
+               (SP[1] != null_value) && (SP[2] != null_value)) {
+      int64_t a = Integer::GetInt64Value(RAW_CAST(Integer, SP[1]));
+      int64_t b = Integer::GetInt64Value(RAW_CAST(Integer, SP[2]));
+      if (a == b) {
+        LOAD_JUMP_TARGET();
+      }
+    }
+    DISPATCH();
+  }
+
+  {
+    BYTECODE(JumpIfNeInt, 0);
+    SP -= 2;
+    if (SP[1] != SP[2]) {
+      if (!SP[1]->IsHeapObject() || !SP[2]->IsHeapObject() ||
+          (SP[1] == null_value) || (SP[2] == null_value)) {
+        LOAD_JUMP_TARGET();
+      } else {
+        int64_t a = Integer::GetInt64Value(RAW_CAST(Integer, SP[1]));
+        int64_t b = Integer::GetInt64Value(RAW_CAST(Integer, SP[2]));
+        if (a != b) {
+          LOAD_JUMP_TARGET();
+        }
+      }
+    }
+    DISPATCH();
+  }
+
+  {
+    BYTECODE(JumpIfLtInt, 0);
+    SP -= 1;
+    UNBOX_INT64(a, SP[0], Symbols::LAngleBracket());
+    UNBOX_INT64(b, SP[1], Symbols::LAngleBracket());
+    SP -= 1;
+    if (a < b) {
+      LOAD_JUMP_TARGET();
+    }
+    DISPATCH();
+  }
+
+  {
+    BYTECODE(JumpIfLeInt, 0);
+    SP -= 1;
+    UNBOX_INT64(a, SP[0], Symbols::LessEqualOperator());
+    UNBOX_INT64(b, SP[1], Symbols::LessEqualOperator());
+    SP -= 1;
+    if (a <= b) {
+      LOAD_JUMP_TARGET();
+    }
+    DISPATCH();
+  }
+
+  {
+    BYTECODE(JumpIfGtInt, 0);
+    SP -= 1;
+    UNBOX_INT64(a, SP[0], Symbols::RAngleBracket());
+    UNBOX_INT64(b, SP[1], Symbols::RAngleBracket());
+    SP -= 1;
+    if (a > b) {
+      LOAD_JUMP_TARGET();
+    }
+    DISPATCH();
+  }
+
+  {
+    BYTECODE(JumpIfGeInt, 0);
+    SP -= 1;
+    UNBOX_INT64(a, SP[0], Symbols::GreaterEqualOperator());
+    UNBOX_INT64(b, SP[1], Symbols::GreaterEqualOperator());
+    SP -= 1;
+    if (a >= b) {
+      LOAD_JUMP_TARGET();
+    }
+    DISPATCH();
+  }
+
+  {
+    BYTECODE(LoadFieldLocal, A_D);
+    const uword offset_in_words =
+        static_cast<uword>(Smi::Value(RAW_CAST(Smi, LOAD_CONSTANT(rD))));
+    RawInstance* instance =
+        static_cast<RawInstance*>(FP[static_cast<int8_t>(rA)]);
+    *++SP = reinterpret_cast<RawObject**>(instance->ptr())[offset_in_words];
+    DISPATCH();
+  }
+
+  {
+    BYTECODE(AddIntLocal, A_X);
+    UNBOX_INT64(a, SP[0], Symbols::Plus());
+    UNBOX_INT64(b, FP[rD], Symbols::Plus());
+    int64_t result = Utils::AddWithWrapAround(a, b);
+    BOX_INT64_RESULT(result);
+    DISPATCH();
+  }
+
   {
     BYTECODE(Trap, 0);
     UNIMPLEMENTED();
@@ -3040,9 +3226,153 @@ void Interpreter::JumpToFrame(uword pc, uword sp, uword fp, Thread* thread) {
   UNREACHABLE();
 }
 
+void InterpreterLookupCache::VisitObjectPointers(
+    ObjectPointerVisitor* visitor) {
+  visitor->VisitPointers(
+      reinterpret_cast<RawObject**>(&entries_[0].receiver_cid),
+      reinterpret_cast<RawObject**>(&entries_[kNumEntries - 1].target));
+}
+
+InterpreterProfile::InterpreterProfile()
+    : functions_(NULL), capacity_(0), size_(0), needs_rehash_(false) {
+  Reset();
+}
+
+InterpreterProfile::~InterpreterProfile() {
+  free(functions_);
+}
+
+void InterpreterProfile::Reset() {
+  memset(bytecode_counts_, 0, sizeof(bytecode_counts_));
+  free(functions_);
+  capacity_ = kInitialCapacity;
+  size_ = 0;
+  needs_rehash_ = false;
+  functions_ = reinterpret_cast<FunctionEntry*>(
+      calloc(capacity_, sizeof(FunctionEntry)));
+}
+
+intptr_t InterpreterProfile::IndexFor(RawFunction* function,
+                                      intptr_t capacity) {
+  const uword hash = reinterpret_cast<uword>(function) >> kObjectAlignmentLog2;
+  return (hash ^ (hash >> 13)) & (capacity - 1);
+}
+
+void InterpreterProfile::CountInvocation(RawFunction* function) {
+  FindOrInsert(function)->count++;
+}
+
+InterpreterProfile::FunctionEntry* InterpreterProfile::FindOrInsert(
+    RawFunction* function) {
+  if (needs_rehash_) {
+    Rehash(capacity_);
+  }
+  intptr_t index = IndexFor(function, capacity_);
+  while (functions_[index].function != NULL) {
+    if (functions_[index].function == function) {
+      return &functions_[index];
+    }
+    index = (index + 1) & (capacity_ - 1);
+  }
+  // Keep load factor below 1/2.
+  if (2 * (size_ + 1) > capacity_) {
+    Rehash(2 * capacity_);
+    return FindOrInsert(function);
+  }
+  size_++;
+  functions_[index].function = function;
+  functions_[index].count = 0;
+  return &functions_[index];
+}
+
+void InterpreterProfile::Rehash(intptr_t new_capacity) {
+  FunctionEntry* old_functions = functions_;
+  const intptr_t old_capacity = capacity_;
+  functions_ = reinterpret_cast<FunctionEntry*>(
+      calloc(new_capacity, sizeof(FunctionEntry)));
+  capacity_ = new_capacity;
+  size_ = 0;
+  needs_rehash_ = false;
+  for (intptr_t i = 0; i < old_capacity; i++) {
+    RawFunction* function = old_functions[i].function;
+    if (function == NULL) {
+      continue;
+    }
+    // Entries for the same function may have been split by a moving GC.
+    FindOrInsert(function)->count += old_functions[i].count;
+  }
+  free(old_functions);
+}
+
+#ifndef PRODUCT
+void InterpreterProfile::PrintJSON(JSONStream* js, intptr_t max_functions) {
+  if (needs_rehash_) {
+    Rehash(capacity_);
+  }
+  JSONObject jsobj(js);
+  jsobj.AddProperty("type", "_InterpreterProfile");
+  {
+    uint64_t total = 0;
+    JSONArray bytecodes(&jsobj, "bytecodes");
+    for (intptr_t i = 0; i < kNumBytecodes; i++) {
+      if (bytecode_counts_[i] == 0) {
+        continue;
+      }
+      total += bytecode_counts_[i];
+      JSONObject entry(&bytecodes);
+      entry.AddProperty(
+          "name", KernelBytecode::NameOf(KernelBytecode::Encode(
+                      static_cast<KernelBytecode::Opcode>(i))));
+      entry.AddProperty64("count", bytecode_counts_[i]);
+    }
+    jsobj.AddProperty64("totalBytecodes", total);
+  }
+
+  // Sort functions by invocation count, most frequent first.
+  Zone* zone = Thread::Current()->zone();
+  GrowableArray<FunctionEntry> sorted(zone, size_);
+  for (intptr_t i = 0; i < capacity_; i++) {
+    if (functions_[i].function != NULL) {
+      sorted.Add(functions_[i]);
+    }
+  }
+  sorted.Sort(HighestCountFirst);
+  JSONArray functions(&jsobj, "functions");
+  Function& function = Function::Handle(zone);
+  for (intptr_t i = 0; (i < sorted.length()) && (i < max_functions); i++) {
+    function = sorted[i].function;
+    JSONObject entry(&functions);
+    entry.AddProperty("function", function);
+    entry.AddProperty64("invocations", sorted[i].count);
+  }
+}
+
+int InterpreterProfile::HighestCountFirst(const FunctionEntry* a,
+                                          const FunctionEntry* b) {
+  if (a->count > b->count) {
+    return -1;
+  }
+  return (a->count < b->count) ? 1 : 0;
+}
+#endif  // !PRODUCT
+
+void InterpreterProfile::VisitObjectPointers(ObjectPointerVisitor* visitor) {
+  for (intptr_t i = 0; i < capacity_; i++) {
+    if (functions_[i].function != NULL) {
+      visitor->VisitPointer(
+          reinterpret_cast<RawObject**>(&functions_[i].function));
+    }
+  }
+  needs_rehash_ = true;
+}
+
 void Interpreter::VisitObjectPointers(ObjectPointerVisitor* visitor) {
   visitor->VisitPointer(reinterpret_cast<RawObject**>(&pp_));
   visitor->VisitPointer(reinterpret_cast<RawObject**>(&argdesc_));
+  lookup_cache_.VisitObjectPointers(visitor);
+  if (profile_ != NULL) {
+    profile_->VisitObjectPointers(visitor);
+  }
 }
 
 }  // namespace dart
@@ -16,6 +16,7 @@ namespace dart {
 class Isolate;
 class RawObject;
 class InterpreterSetjmpBuffer;
+class JSONStream;
 class Thread;
 class Code;
 class Array;
@@ -25,6 +26,8 @@ class RawArray;
 class RawObjectPool;
 class RawFunction;
 class RawSubtypeTestCache;
+class RawSmi;
+class RawString;
 class ObjectPointerVisitor;
 
 // Interpreter intrinsic handler. It is invoked on entry to the intrinsified
@@ -36,6 +39,130 @@ typedef bool (*IntrinsicHandler)(Thread* thread,
                                  RawObject** FP,
                                  RawObject** result);
 
+// Direct-mapped cache of instance call targets shared by all call sites
+// executed by an interpreter, keyed on (receiver class id, target name,
+// arguments descriptor). It plays the role of the MegamorphicCacheTable used
+// by compiled code: once the ICData of a call site has become megamorphic,
+// the interpreter probes this cache instead of scanning the ICData checks.
+// Entries are raw pointers visited by the GC. A stale entry left behind by a
+// moving GC only results in a miss, since keys are compared by identity.
+class InterpreterLookupCache {
+ public:
+  static const intptr_t kNumEntries = 2048;  // Must be a power of 2.
+
+  InterpreterLookupCache() { Clear(); }
+
+  void Clear() {
+    for (intptr_t i = 0; i < kNumEntries; i++) {
+      entries_[i].receiver_cid = NULL;
+      entries_[i].target_name = NULL;
+      entries_[i].args_descriptor = NULL;
+      entries_[i].target = NULL;
+    }
+  }
+
+  DART_FORCE_INLINE RawFunction* Lookup(RawSmi* receiver_cid,
+                                        RawString* target_name,
+                                        RawArray* args_descriptor) const {
+    const Entry& entry =
+        entries_[IndexFor(receiver_cid, target_name, args_descriptor)];
+    if ((entry.receiver_cid == receiver_cid) &&
+        (entry.target_name == target_name) &&
+        (entry.args_descriptor == args_descriptor)) {
+      return entry.target;
+    }
+    return NULL;
+  }
+
+  DART_FORCE_INLINE void Insert(RawSmi* receiver_cid,
+                                RawString* target_name,
+                                RawArray* args_descriptor,
+                                RawFunction* target) {
+    Entry* entry =
+        &entries_[IndexFor(receiver_cid, target_name, args_descriptor)];
+    entry->receiver_cid = receiver_cid;
+    entry->target_name = target_name;
+    entry->args_descriptor = args_descriptor;
+    entry->target = target;
+  }
+
+  void VisitObjectPointers(ObjectPointerVisitor* visitor);
+
+ private:
+  struct Entry {
+    RawSmi* receiver_cid;
+    RawString* target_name;
+    RawArray* args_descriptor;
+    RawFunction* target;
+  };
+
+  static DART_FORCE_INLINE intptr_t IndexFor(RawSmi* receiver_cid,
+                                             RawString* target_name,
+                                             RawArray* args_descriptor) {
+    const uword hash = reinterpret_cast<uword>(receiver_cid) ^
+                       (reinterpret_cast<uword>(target_name) >> 3) ^
+                       (reinterpret_cast<uword>(args_descriptor) >> 5);
+    return (hash ^ (hash >> 11)) & (kNumEntries - 1);
+  }
+
+  Entry entries_[kNumEntries];
+
+  DISALLOW_COPY_AND_ASSIGN(InterpreterLookupCache);
+};
+
+// Execution counters collected by an interpreter when
+// --interpreter_profile is enabled: the number of times each bytecode was
+// executed and the number of interpreted invocations of each function.
+// Function keys are visited by the GC; since a moving GC invalidates the
+// address based hashing, the table is rehashed lazily after each visit.
+class InterpreterProfile {
+ public:
+  InterpreterProfile();
+  ~InterpreterProfile();
+
+  DART_FORCE_INLINE uint64_t* bytecode_counts() { return bytecode_counts_; }
+
+  void CountInvocation(RawFunction* function);
+
+  void Reset();
+
+#ifndef PRODUCT
+  // Prints bytecode counts and the [max_functions] most frequently invoked
+  // functions.
+  void PrintJSON(JSONStream* js, intptr_t max_functions);
+#endif  // !PRODUCT
+
+  void VisitObjectPointers(ObjectPointerVisitor* visitor);
+
+ private:
+  struct FunctionEntry {
+    RawFunction* function;
+    uint64_t count;
+  };
+
+  static const intptr_t kNumBytecodes = 0
+#define COUNT_BYTECODE(name, encoding, op1, op2, op3) +1
+      KERNEL_BYTECODES_LIST(COUNT_BYTECODE);
+#undef COUNT_BYTECODE
+  static const intptr_t kInitialCapacity = 1024;  // Must be a power of 2.
+
+  static intptr_t IndexFor(RawFunction* function, intptr_t capacity);
+
+  FunctionEntry* FindOrInsert(RawFunction* function);
+  static int HighestCountFirst(const FunctionEntry* a, const FunctionEntry* b);
+  void Rehash(intptr_t new_capacity);
+
+  // Indexed by the low byte of an instruction, so that counting needs no
+  // bounds check.
+  uint64_t bytecode_counts_[256];
+  FunctionEntry* functions_;
+  intptr_t capacity_;
+  intptr_t size_;
+  bool needs_rehash_;
+
+  DISALLOW_COPY_AND_ASSIGN(InterpreterProfile);
+};
+
 class Interpreter {
  public:
   static const uword kInterpreterStackUnderflowSize = 0x80;
@@ -96,6 +223,14 @@ class Interpreter {
 
   void VisitObjectPointers(ObjectPointerVisitor* visitor);
 
+  // Drops all cached instance call targets, e.g. when a reload changes the
+  // result of method resolution.
+  void ClearLookupCache() { lookup_cache_.Clear(); }
+
+  // Execution counters, or NULL if --interpreter_profile was not enabled
+  // when the interpreter was last entered.
+  InterpreterProfile* profile() const { return profile_; }
+
  private:
   uintptr_t* stack_;
   uword stack_base_;
@@ -112,6 +247,9 @@ class Interpreter {
                        // call instruction and the function entry.
   RawObject* special_[KernelBytecode::kSpecialIndexCount];
 
+  InterpreterLookupCache lookup_cache_;
+  InterpreterProfile* profile_;
+
   static IntrinsicHandler intrinsics_[kIntrinsicCount];
 
   void Exit(Thread* thread,
@@ -167,6 +305,10 @@ class Interpreter {
                        RawObject** FP,
                        RawObject** SP);
 
+  void UpdateLookupCache(RawSmi* receiver_cid,
+                         RawICData* icdata,
+                         RawObject* target);
+
   bool InstanceCall1(Thread* thread,
                      RawICData* icdata,
                      RawObject** call_base,
@@ -180,6 +180,16 @@ void Interpreter::VisitObjectPointers(ObjectPointerVisitor* visitor) {
   UNIMPLEMENTED();
 }
 
+void InterpreterProfile::Reset() {
+  UNIMPLEMENTED();
+}
+
+#ifndef PRODUCT
+void InterpreterProfile::PrintJSON(JSONStream* js, intptr_t max_functions) {
+  UNIMPLEMENTED();
+}
+#endif  // !PRODUCT
+
 }  // namespace dart
 
 #endif  // !defined(DART_PRECOMPILED_RUNTIME) && defined(TARGET_OS_WINDOWS)
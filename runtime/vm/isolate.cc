@@ -35,6 +35,7 @@
 #include "vm/os_thread.h"
 #include "vm/port.h"
 #include "vm/profiler.h"
+#include "vm/profiler_service.h"
 #include "vm/reusable_handles.h"
 #include "vm/service.h"
 #include "vm/service_event.h"
@@ -473,6 +474,10 @@ RawError* IsolateMessageHandler::HandleLibMessage(const Array& message) {
 }
 
 void IsolateMessageHandler::MessageNotify(Message::Priority priority) {
+#if !defined(PRODUCT)
+  // Also updated here, so the queue of a busy isolate does not look empty.
+  I->GetMessageQueueLengthMetric()->set_value(queue_length());
+#endif  // !defined(PRODUCT)
   if (priority >= Message::kOOBPriority) {
     // Handle out of band messages even if the mutator thread is busy.
     I->ScheduleInterrupts(Thread::kMessageInterrupt);
@@ -492,6 +497,7 @@ MessageHandler::MessageStatus IsolateMessageHandler::HandleMessage(
   Zone* zone = stack_zone.GetZone();
   HandleScope handle_scope(thread);
 #ifndef PRODUCT
+  ProfilerService::DrainPprof(thread, false);
   TimelineDurationScope tds(
       thread, Timeline::GetIsolateStream(),
       message->IsOOB() ? "HandleOOBMessage" : "HandleMessage");
@@ -637,6 +643,9 @@ MessageHandler::MessageStatus IsolateMessageHandler::HandleMessage(
       ASSERT(result.IsNull());
     }
   }
+  // Published once the message was handled, so that exporters on other
+  // threads see the heap as the handler left it.
+  I->PublishMetrics();
 #endif  // !PRODUCT
   return status;
 }
@@ -880,6 +889,7 @@ Isolate::Isolate(const Dart_IsolateFlags& api_flags)
       last_resume_timestamp_(OS::GetCurrentTimeMillis()),
       last_allocationprofile_accumulator_reset_timestamp_(0),
       last_allocationprofile_gc_timestamp_(0),
+      last_pprof_micros_(OS::GetCurrentMonotonicMicros()),
       vm_tag_counters_(),
       pending_service_extension_calls_(GrowableObjectArray::null()),
       registered_service_extension_handlers_(GrowableObjectArray::null()),
@@ -1886,6 +1896,10 @@ void Isolate::Shutdown() {
     HandleScope handle_scope(thread);
     ServiceIsolate::SendIsolateShutdownMessage();
     KernelIsolate::NotifyAboutIsolateShutdown(this);
+#if !defined(PRODUCT)
+    // Write out the samples taken since the last pprof profile.
+    ProfilerService::DrainPprof(thread, true);
+#endif  // !defined(PRODUCT)
   }
 
   if (heap_ != NULL) {
@@ -2116,6 +2130,27 @@ void Isolate::ClearPendingDeoptsAtOrBelow(uword fp) const {
   }
 }
 
+#if !defined(PRODUCT)
+void Isolate::PublishMetrics() {
+  GetHeapOldUsedMetric()->Publish();
+  GetHeapOldCapacityMetric()->Publish();
+  GetHeapOldExternalMetric()->Publish();
+  GetHeapNewUsedMetric()->Publish();
+  GetHeapNewCapacityMetric()->Publish();
+  GetHeapNewExternalMetric()->Publish();
+  GetHeapGlobalUsedMetric()->Publish();
+  GetHeapOldUsedMaxMetric()->SetValue(GetHeapOldUsedMetric()->value());
+  GetHeapOldCapacityMaxMetric()->SetValue(GetHeapOldCapacityMetric()->value());
+  GetHeapNewUsedMaxMetric()->SetValue(GetHeapNewUsedMetric()->value());
+  GetHeapNewCapacityMaxMetric()->SetValue(GetHeapNewCapacityMetric()->value());
+  GetHeapGlobalUsedMaxMetric()->SetValue(GetHeapGlobalUsedMetric()->value());
+  if (message_handler() != NULL) {
+    GetMessageQueueLengthMetric()->set_value(
+        message_handler()->queue_length());
+  }
+}
+#endif  // !defined(PRODUCT)
+
 #ifndef PRODUCT
 static const char* ExceptionPauseInfoToServiceEnum(Dart_ExceptionPauseInfo pi) {
   switch (pi) {
@@ -2822,7 +2857,7 @@ Thread* Isolate::ScheduleThread(bool is_mutator, bool bypass_safepoint) {
       scheduled_mutator_thread_ = thread;
       if (this != Dart::vm_isolate()) {
         scheduled_mutator_thread_->set_top(heap()->new_space()->top());
-        scheduled_mutator_thread_->set_end(heap()->new_space()->end());
+        heap()->SetThreadAllocationEnd(scheduled_mutator_thread_);
       }
     }
     Thread::SetCurrent(thread);
@@ -2864,7 +2899,6 @@ void Isolate::UnscheduleThread(Thread* thread,
   if (is_mutator) {
     if (this != Dart::vm_isolate()) {
       heap()->new_space()->set_top(scheduled_mutator_thread_->top_);
-      heap()->new_space()->set_end(scheduled_mutator_thread_->end_);
     }
     scheduled_mutator_thread_->top_ = 0;
     scheduled_mutator_thread_->end_ = 0;
@@ -494,6 +494,9 @@ class Isolate : public BaseIsolate {
   int64_t last_allocationprofile_gc_timestamp() const {
     return last_allocationprofile_gc_timestamp_;
   }
+
+  int64_t last_pprof_micros() const { return last_pprof_micros_; }
+  void set_last_pprof_micros(int64_t value) { last_pprof_micros_ = value; }
 #endif  // !defined(PRODUCT)
 
   intptr_t BlockClassFinalization() {
@@ -573,6 +576,11 @@ class Isolate : public BaseIsolate {
   type* Get##variable##Metric() { return &metric_##variable##_; }
   ISOLATE_METRIC_LIST(ISOLATE_METRIC_ACCESSOR);
 #undef ISOLATE_METRIC_ACCESSOR
+
+  // Stores the current values of the metrics computed on demand, and updates
+  // the maximum heap metrics, for Metric::PrintPrometheus. Must be called on
+  // the isolate's thread.
+  void PublishMetrics();
 #endif  // !defined(PRODUCT)
 
   static intptr_t IsolateListLength();
@@ -916,6 +924,8 @@ class Isolate : public BaseIsolate {
   // Timestamps of last operation via service.
   int64_t last_allocationprofile_accumulator_reset_timestamp_;
   int64_t last_allocationprofile_gc_timestamp_;
+  // Monotonic time up to which samples have been written as pprof profiles.
+  int64_t last_pprof_micros_;
 
   VMTagCounters vm_tag_counters_;
 
@@ -13,6 +13,7 @@
 #include "vm/hash_table.h"
 #include "vm/heap/become.h"
 #include "vm/heap/safepoint.h"
+#include "vm/interpreter.h"
 #include "vm/isolate.h"
 #include "vm/kernel_isolate.h"
 #include "vm/kernel_loader.h"
@@ -1851,6 +1852,10 @@ void IsolateReloadContext::ResetMegamorphicCaches() {
   // better to clear the table instead of clearing each of the caches, allow
   // the current megamorphic caches get GC'd and any new optimized code allocate
   // new ones.
+  Interpreter* interpreter = isolate_->interpreter();
+  if (interpreter != NULL) {
+    interpreter->ClearLookupCache();
+  }
 }
 
 class MarkFunctionsForRecompilation : public ObjectVisitor {
@@ -81,6 +81,37 @@ TEST_CASE(JSON_JSONStream_Primitives) {
   }
 }
 
+TEST_CASE(JSON_JSONStream_Numbers) {
+  // Integers and doubles are formatted without printf, so compare them to
+  // what printf produces.
+  const int64_t kIntegers[] = {0,         7,          -7,      9,
+                               10,        99,         100,     -100,
+                               123456789, -987654321, kMaxInt32,
+                               9007199254740991LL, -9007199254740991LL};
+  const double kDoubles[] = {0.0,   -0.0,  1.0,    -3.0,    2.5,   -0.125,
+                             1e15,  1e20,  -1e300, 12345.0, 1e-7};
+  const intptr_t kNumIntegers = ARRAY_SIZE(kIntegers);
+  const intptr_t kNumDoubles = ARRAY_SIZE(kDoubles);
+  JSONStream js;
+  TextBuffer expected(256);
+  {
+    JSONArray jsarr(&js);
+    expected.AddChar('[');
+    for (intptr_t i = 0; i < kNumIntegers; i++) {
+      jsarr.AddValue64(kIntegers[i]);
+      jsarr.AddValue(static_cast<intptr_t>(kIntegers[i] % kMaxInt32));
+      expected.Printf("%s%" Pd64 ",%" Pd64, (i == 0) ? "" : ",", kIntegers[i],
+                      kIntegers[i] % kMaxInt32);
+    }
+    for (intptr_t i = 0; i < kNumDoubles; i++) {
+      jsarr.AddValue(kDoubles[i]);
+      expected.Printf(",%f", kDoubles[i]);
+    }
+    expected.AddChar(']');
+  }
+  EXPECT_STREQ(expected.buf(), js.ToCString());
+}
+
 TEST_CASE(JSON_JSONStream_Array) {
   JSONStream js;
   {
@@ -201,6 +232,20 @@ TEST_CASE(JSON_JSONStream_EscapedString) {
   EXPECT_STREQ("[\"Hel\\\"\\\"lo\\r\\n\\t\"]", js.ToCString());
 }
 
+TEST_CASE(JSON_JSONStream_EscapedRuns) {
+  JSONStream js;
+  {
+    JSONArray jsarr(&js);
+    jsarr.AddValue("plain");
+    jsarr.AddValue("a/b\\c\x01" "d\x7F");
+    jsarr.AddValue("caf\xC3\xA9 \xE2\x82\xAC");
+  }
+  EXPECT_STREQ(
+      "[\"plain\",\"a\\/b\\\\c\\u0001d\x7F\","
+      "\"caf\xC3\xA9 \xE2\x82\xAC\"]",
+      js.ToCString());
+}
+
 TEST_CASE(JSON_JSONStream_DartString) {
   const char* kScriptChars =
       "var ascii = 'Hello, World!';\n"
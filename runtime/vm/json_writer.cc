@@ -3,6 +3,7 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "platform/assert.h"
+#include "platform/math.h"
 
 #include "vm/json_writer.h"
 #include "vm/object.h"
@@ -31,9 +32,82 @@ class MaybeOnStackBuffer {
   char buffer_[kOnStackBufferCapacity];
 };
 
+// ASCII characters that EscapeAndAddCodeUnit does not copy as they are.
+static const bool kNeedsEscape[128] = {
+    true,  true,  true,  true,  true,  true,  true,  true,   // 0x00
+    true,  true,  true,  true,  true,  true,  true,  true,   // 0x08
+    true,  true,  true,  true,  true,  true,  true,  true,   // 0x10
+    true,  true,  true,  true,  true,  true,  true,  true,   // 0x18
+    false, false, true,  false, false, false, false, false,  // 0x20 '"'
+    false, false, false, false, false, false, false, true,   // 0x28 '/'
+    false, false, false, false, false, false, false, false,  // 0x30
+    false, false, false, false, false, false, false, false,  // 0x38
+    false, false, false, false, false, false, false, false,  // 0x40
+    false, false, false, false, false, false, false, false,  // 0x48
+    false, false, false, false, false, false, false, false,  // 0x50
+    false, false, false, false, true,  false, false, false,  // 0x58 '\\'
+    false, false, false, false, false, false, false, false,  // 0x60
+    false, false, false, false, false, false, false, false,  // 0x68
+    false, false, false, false, false, false, false, false,  // 0x70
+    false, false, false, false, false, false, false, false,  // 0x78
+};
+
+static const char kDigitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// A sign and 19 digits.
+static const intptr_t kMaxInt64Digits = 20;
+
+// Formats 'value' in decimal without going through printf, two digits at a
+// time. Returns the number of characters written to 'buffer', which must hold
+// at least kMaxInt64Digits characters.
+static intptr_t FormatInt64(int64_t value, char* buffer) {
+  // Negate as unsigned, so that kMinInt64 does not overflow.
+  uint64_t magnitude = static_cast<uint64_t>(value);
+  if (value < 0) {
+    magnitude = ~magnitude + 1;
+  }
+  char digits[kMaxInt64Digits];
+  intptr_t pos = kMaxInt64Digits;
+  while (magnitude >= 100) {
+    intptr_t pair = static_cast<intptr_t>(magnitude % 100) * 2;
+    magnitude /= 100;
+    digits[--pos] = kDigitPairs[pair + 1];
+    digits[--pos] = kDigitPairs[pair];
+  }
+  if (magnitude >= 10) {
+    intptr_t pair = static_cast<intptr_t>(magnitude) * 2;
+    digits[--pos] = kDigitPairs[pair + 1];
+    digits[--pos] = kDigitPairs[pair];
+  } else {
+    digits[--pos] = static_cast<char>('0' + magnitude);
+  }
+  intptr_t length = 0;
+  if (value < 0) {
+    buffer[length++] = '-';
+  }
+  memmove(buffer + length, digits + pos, kMaxInt64Digits - pos);
+  return length + kMaxInt64Digits - pos;
+}
+
 JSONWriter::JSONWriter(intptr_t buf_size)
     : open_objects_(0), buffer_(buf_size) {}
 
+void JSONWriter::AddInt64(int64_t i) {
+  char digits[kMaxInt64Digits];
+  intptr_t length = FormatInt64(i, digits);
+  buffer_.AddRaw(reinterpret_cast<const uint8_t*>(digits), length);
+}
+
 void JSONWriter::AppendSerializedObject(const char* serialized_object) {
   PrintCommaIfNeeded();
   buffer_.AddString(serialized_object);
@@ -96,29 +170,43 @@ void JSONWriter::CloseArray() {
 
 void JSONWriter::PrintValueNull() {
   PrintCommaIfNeeded();
-  buffer_.Printf("null");
+  buffer_.AddRaw(reinterpret_cast<const uint8_t*>("null"), 4);
 }
 
 void JSONWriter::PrintValueBool(bool b) {
   PrintCommaIfNeeded();
-  buffer_.Printf("%s", b ? "true" : "false");
+  if (b) {
+    buffer_.AddRaw(reinterpret_cast<const uint8_t*>("true"), 4);
+  } else {
+    buffer_.AddRaw(reinterpret_cast<const uint8_t*>("false"), 5);
+  }
 }
 
 void JSONWriter::PrintValue(intptr_t i) {
   EnsureIntegerIsRepresentableInJavaScript(static_cast<int64_t>(i));
   PrintCommaIfNeeded();
-  buffer_.Printf("%" Pd "", i);
+  AddInt64(i);
 }
 
 void JSONWriter::PrintValue64(int64_t i) {
   EnsureIntegerIsRepresentableInJavaScript(i);
   PrintCommaIfNeeded();
-  buffer_.Printf("%" Pd64 "", i);
+  AddInt64(i);
 }
 
 void JSONWriter::PrintValue(double d) {
   PrintCommaIfNeeded();
-  buffer_.Printf("%f", d);
+  // Most doubles in service responses are counts and percentages that hold
+  // whole numbers. Print those like "%f" does, without formatting a fraction.
+  const double kMaxExactInteger = 9007199254740992.0;  // 2^53.
+  if ((d > -kMaxExactInteger) && (d < kMaxExactInteger) &&
+      (d == static_cast<double>(static_cast<int64_t>(d))) &&
+      ((d != 0.0) || !signbit(d))) {
+    AddInt64(static_cast<int64_t>(d));
+    buffer_.AddRaw(reinterpret_cast<const uint8_t*>(".000000"), 7);
+  } else {
+    buffer_.Printf("%f", d);
+  }
 }
 
 static const char base64_digits[65] =
@@ -127,6 +215,7 @@ static const char base64_pad = '=';
 
 void JSONWriter::PrintValueBase64(const uint8_t* bytes, intptr_t length) {
   PrintCommaIfNeeded();
+  buffer_.Reserve(((length + 2) / 3) * 4 + 2);
   buffer_.AddChar('"');
 
   intptr_t odd_bits = length % 3;
@@ -174,7 +263,7 @@ bool JSONWriter::PrintValueStr(const String& s,
 
 void JSONWriter::PrintValueNoEscape(const char* s) {
   PrintCommaIfNeeded();
-  buffer_.Printf("%s", s);
+  buffer_.AddString(s);
 }
 
 void JSONWriter::PrintfValue(const char* format, ...) {
@@ -339,8 +428,20 @@ void JSONWriter::AddEscapedUTF8String(const char* s, intptr_t len) {
     return;
   }
   const uint8_t* s8 = reinterpret_cast<const uint8_t*>(s);
+  buffer_.Reserve(len);
   intptr_t i = 0;
   for (; i < len;) {
+    // Copy runs of ASCII characters that need no escaping in one go.
+    intptr_t run_end = i;
+    while ((run_end < len) && (s8[run_end] < 0x80) &&
+           !kNeedsEscape[s8[run_end]]) {
+      run_end++;
+    }
+    if (run_end > i) {
+      buffer_.AddRaw(&s8[i], run_end - i);
+      i = run_end;
+      continue;
+    }
     // Extract next UTF8 character.
     int32_t ch = 0;
     int32_t ch_len = Utf8::Decode(&s8[i], len - i, &ch);
@@ -364,9 +465,12 @@ bool JSONWriter::AddDartString(const String& s,
     count = length - offset;
   }
   intptr_t limit = offset + count;
+  buffer_.Reserve(count);
   for (intptr_t i = offset; i < limit; i++) {
     uint16_t code_unit = s.CharAt(i);
-    if (Utf16::IsTrailSurrogate(code_unit)) {
+    if ((code_unit < 0x80) && !kNeedsEscape[code_unit]) {
+      buffer_.AddChar(static_cast<char>(code_unit));
+    } else if (Utf16::IsTrailSurrogate(code_unit)) {
       buffer_.EscapeAndAddUTF16CodeUnit(code_unit);
     } else if (Utf16::IsLeadSurrogate(code_unit)) {
       if (i + 1 == limit) {
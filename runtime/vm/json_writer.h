@@ -79,6 +79,8 @@ class JSONWriter : ValueObject {
 
  private:
   bool NeedComma();
+  // Appends 'i' in decimal.
+  void AddInt64(int64_t i);
   bool AddDartString(const String& s, intptr_t offset, intptr_t count);
 
   // Debug only fatal assertion.
@@ -337,6 +337,12 @@ void KernelLoader::InitializeFields() {
 
   H.InitFromKernelProgramInfo(kernel_program_info_);
 
+  if (FLAG_enable_interpreter || FLAG_use_bytecode_compiler) {
+    // Function bytecode is read lazily using this index when a function is
+    // first called (see BytecodeReader::ReadFunctionBytecode).
+    bytecode_metadata_helper_.BuildBytecodeIndex();
+  }
+
   Script& script = Script::Handle(Z);
   for (intptr_t index = 0; index < source_table_size; ++index) {
     script = LoadScriptAt(index);
@@ -85,6 +85,7 @@ const char* Message::PriorityAsString(Priority priority) {
 MessageQueue::MessageQueue() {
   head_ = NULL;
   tail_ = NULL;
+  length_ = 0;
 }
 
 MessageQueue::~MessageQueue() {
@@ -96,6 +97,7 @@ MessageQueue::~MessageQueue() {
 void MessageQueue::Enqueue(Message* msg, bool before_events) {
   // Make sure messages are not reused.
   ASSERT(msg->next_ == NULL);
+  length_++;
   if (head_ == NULL) {
     // Only element in the queue.
     ASSERT(tail_ == NULL);
@@ -137,6 +139,7 @@ void MessageQueue::Enqueue(Message* msg, bool before_events) {
 Message* MessageQueue::Dequeue() {
   Message* result = head_;
   if (result != NULL) {
+    length_--;
     head_ = result->next_;
     // The following update to tail_ is not strictly needed.
     if (head_ == NULL) {
@@ -154,6 +157,7 @@ void MessageQueue::Clear() {
   Message* cur = head_;
   head_ = NULL;
   tail_ = NULL;
+  length_ = 0;
   while (cur != NULL) {
     Message* next = cur->next_;
     if (cur->RedirectToDeliveryFailurePort()) {
@@ -188,16 +192,6 @@ Message* MessageQueue::Iterator::Next() {
   return current;
 }
 
-intptr_t MessageQueue::Length() const {
-  MessageQueue::Iterator it(this);
-  intptr_t length = 0;
-  while (it.HasNext()) {
-    it.Next();
-    length++;
-  }
-  return length;
-}
-
 Message* MessageQueue::FindMessageById(intptr_t id) {
   MessageQueue::Iterator it(this);
   while (it.HasNext()) {
@@ -143,7 +143,7 @@ class MessageQueue {
     Message* next_;
   };
 
-  intptr_t Length() const;
+  intptr_t Length() const { return length_; }
 
   // Returns the message with id or NULL.
   Message* FindMessageById(intptr_t id);
@@ -153,6 +153,7 @@ class MessageQueue {
  private:
   Message* head_;
   Message* tail_;
+  intptr_t length_;
 
   DISALLOW_COPY_AND_ASSIGN(MessageQueue);
 };
@@ -75,6 +75,10 @@ class MessageHandler {
   // handler.
   bool HasOOBMessages();
 
+  // Returns the number of pending messages that are not OOB. Does not take
+  // the monitor, so the result may be slightly out of date.
+  intptr_t queue_length() const { return queue_->Length(); }
+
   // A message handler tracks how many live ports it has.
   bool HasLivePorts() const { return live_ports_ > 0; }
 
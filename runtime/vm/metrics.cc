@@ -6,11 +6,13 @@
 
 #include "vm/metrics.h"
 
+#include "platform/text_buffer.h"
 #include "vm/isolate.h"
 #include "vm/json_stream.h"
 #include "vm/log.h"
 #include "vm/native_entry.h"
 #include "vm/object.h"
+#include "vm/port.h"
 #include "vm/runtime_entry.h"
 
 namespace dart {
@@ -159,6 +161,123 @@ char* Metric::ToString() {
   return zone->PrintToString("%s %s", name(), ValueToString(Value(), unit()));
 }
 
+static const char* PrometheusUnitSuffix(Metric::Unit unit) {
+  switch (unit) {
+    case Metric::kCounter:
+      return "";
+    case Metric::kByte:
+      return "_bytes";
+    case Metric::kMicrosecond:
+      return "_microseconds";
+    default:
+      UNREACHABLE();
+  }
+  return NULL;
+}
+
+// Metric names are dotted, which Prometheus does not allow. For example,
+// heap.old.used is exported as dart_heap_old_used_bytes.
+static void PrometheusName(const Metric* metric, char* buffer, intptr_t size) {
+  Utils::SNPrint(buffer, size, "dart_%s%s", metric->name(),
+                 PrometheusUnitSuffix(metric->unit()));
+  for (char* c = buffer; *c != '\0'; c++) {
+    if (!(((*c >= 'a') && (*c <= 'z')) || ((*c >= 'A') && (*c <= 'Z')) ||
+          ((*c >= '0') && (*c <= '9')) || (*c == '_'))) {
+      *c = '_';
+    }
+  }
+}
+
+// Escapes a label value or help text.
+static void AddPrometheusEscaped(TextBuffer* buffer,
+                                 const char* s,
+                                 bool quotes) {
+  for (; *s != '\0'; s++) {
+    if (*s == '\\') {
+      buffer->AddString("\\\\");
+    } else if (*s == '\n') {
+      buffer->AddString("\\n");
+    } else if (quotes && (*s == '"')) {
+      buffer->AddString("\\\"");
+    } else {
+      buffer->AddChar(*s);
+    }
+  }
+}
+
+void Metric::PrintPrometheusHeader(TextBuffer* buffer, const char* name) {
+  buffer->Printf("# HELP %s ", name);
+  AddPrometheusEscaped(buffer,
+                       (description_ != NULL) ? description_ : name_, false);
+  buffer->Printf("\n# TYPE %s %s\n", name, PrometheusType());
+}
+
+void Metric::PrintPrometheusSamples(TextBuffer* buffer,
+                                    const char* name,
+                                    const char* labels) {
+  const int64_t value = (isolate_ == NULL) ? Value() : this->value();
+  if (labels[0] == '\0') {
+    buffer->Printf("%s %" Pd64 "\n", name, value);
+  } else {
+    buffer->Printf("%s{%s} %" Pd64 "\n", name, labels, value);
+  }
+}
+
+// Prints one isolate metric of every isolate, so the samples of each metric
+// are grouped together as Prometheus requires.
+class PrometheusIsolateVisitor : public IsolateVisitor {
+ public:
+  PrometheusIsolateVisitor(TextBuffer* buffer, const char* metric_name)
+      : buffer_(buffer), metric_name_(metric_name), printed_header_(false) {}
+
+  virtual void VisitIsolate(Isolate* isolate) {
+    Metric* metric = isolate->metrics_list_head();
+    while ((metric != NULL) && (strcmp(metric->name(), metric_name_) != 0)) {
+      metric = metric->next();
+    }
+    if (metric == NULL) {
+      return;
+    }
+    char name[128];
+    PrometheusName(metric, name, sizeof(name));
+    if (!printed_header_) {
+      metric->PrintPrometheusHeader(buffer_, name);
+      printed_header_ = true;
+    }
+    TextBuffer labels(64);
+    labels.AddString("isolate=\"");
+    AddPrometheusEscaped(&labels, isolate->name(), true);
+    labels.Printf("\",isolate_port=\"%" Pd64 "\"",
+                  static_cast<int64_t>(isolate->main_port()));
+    metric->PrintPrometheusSamples(buffer_, name, labels.buf());
+  }
+
+ private:
+  TextBuffer* buffer_;
+  const char* metric_name_;
+  bool printed_header_;
+
+  DISALLOW_COPY_AND_ASSIGN(PrometheusIsolateVisitor);
+};
+
+void Metric::PrintPrometheus(TextBuffer* buffer) {
+  // VM metrics come first, as some of them lock the isolate list.
+  char prometheus_name[128];
+  for (Metric* current = vm_list_head_; current != NULL;
+       current = current->next()) {
+    PrometheusName(current, prometheus_name, sizeof(prometheus_name));
+    current->PrintPrometheusHeader(buffer, prometheus_name);
+    current->PrintPrometheusSamples(buffer, prometheus_name, "");
+  }
+#define ISOLATE_METRIC_PRINT_PROMETHEUS(type, variable, name, unit)            \
+  {                                                                            \
+    PrometheusIsolateVisitor visitor(buffer, name);                            \
+    Isolate::VisitIsolates(&visitor);                                          \
+  }
+  ISOLATE_METRIC_LIST(ISOLATE_METRIC_PRINT_PROMETHEUS)
+#undef ISOLATE_METRIC_PRINT_PROMETHEUS
+}
+
 bool Metric::NameExists(Metric* head, const char* name) {
   ASSERT(name != NULL);
   while (head != NULL) {
@@ -303,6 +422,10 @@ int64_t MetricPeakRSS::Value() const {
   return Service::MaxRSS();
 }
 
+int64_t MetricPortCount::Value() const {
+  return PortMap::NumPorts();
+}
+
 #define VM_METRIC_VARIABLE(type, variable, name, unit)                         \
   static type vm_metric_##variable##_;
 VM_METRIC_LIST(VM_METRIC_VARIABLE);
@@ -343,6 +466,14 @@ void MaxMetric::SetValue(int64_t new_value) {
   }
 }
 
+void MaxMetric::PrintPrometheusSamples(TextBuffer* buffer,
+                                       const char* name,
+                                       const char* labels) {
+  if (value() != kMinInt64) {
+    Metric::PrintPrometheusSamples(buffer, name, labels);
+  }
+}
+
 MinMetric::MinMetric() : Metric() {
   set_value(kMaxInt64);
 }
@@ -353,6 +484,64 @@ void MinMetric::SetValue(int64_t new_value) {
   }
 }
 
+void MinMetric::PrintPrometheusSamples(TextBuffer* buffer,
+                                       const char* name,
+                                       const char* labels) {
+  if (value() != kMaxInt64) {
+    Metric::PrintPrometheusSamples(buffer, name, labels);
+  }
+}
+
+HistogramMetric::HistogramMetric() : Metric(), count_(0), sum_(0) {
+  for (intptr_t i = 0; i < kNumBuckets; i++) {
+    buckets_[i] = 0;
+  }
+}
+
+void HistogramMetric::Record(int64_t value) {
+  intptr_t bucket = 0;
+  if (value > 1) {
+    bucket = Utils::HighestBit(value - 1) + 1;
+    if (bucket >= kNumBuckets) {
+      bucket = kNumBuckets - 1;
+    }
+  }
+  AtomicOperations::IncrementInt64By(&buckets_[bucket], 1);
+  AtomicOperations::IncrementInt64By(&sum_, value);
+  AtomicOperations::IncrementInt64By(&count_, 1);
+}
+
+int64_t HistogramMetric::BucketUpperBound(intptr_t bucket) {
+  ASSERT((bucket >= 0) && (bucket < kNumBuckets));
+  if (bucket == kNumBuckets - 1) {
+    return kMaxInt64;
+  }
+  return static_cast<int64_t>(1) << bucket;
+}
+
+void HistogramMetric::PrintPrometheusSamples(TextBuffer* buffer,
+                                             const char* name,
+                                             const char* labels) {
+  const char* separator = (labels[0] == '\0') ? "" : ",";
+  // Prometheus buckets are cumulative.
+  int64_t cumulative = 0;
+  for (intptr_t i = 0; i < kNumBuckets - 1; i++) {
+    cumulative += buckets_[i];
+    buffer->Printf("%s_bucket{%s%sle=\"%" Pd64 "\"} %" Pd64 "\n", name,
+                   labels, separator, BucketUpperBound(i), cumulative);
+  }
+  cumulative += buckets_[kNumBuckets - 1];
+  buffer->Printf("%s_bucket{%s%sle=\"+Inf\"} %" Pd64 "\n", name, labels,
+                 separator, cumulative);
+  if (labels[0] == '\0') {
+    buffer->Printf("%s_sum %" Pd64 "\n%s_count %" Pd64 "\n", name, sum_, name,
+                   cumulative);
+  } else {
+    buffer->Printf("%s_sum{%s} %" Pd64 "\n%s_count{%s} %" Pd64 "\n", name,
+                   labels, sum_, name, labels, cumulative);
+  }
+}
+
 }  // namespace dart
 
 #endif  // !defined(PRODUCT)
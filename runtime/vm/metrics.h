@@ -5,12 +5,14 @@
 #ifndef RUNTIME_VM_METRICS_H_
 #define RUNTIME_VM_METRICS_H_
 
+#include "platform/atomic.h"
 #include "vm/allocation.h"
 
 namespace dart {
 
 class Isolate;
 class JSONStream;
+class TextBuffer;
 
 // Metrics for each isolate.
 #define ISOLATE_METRIC_LIST(V)                                                 \
@@ -27,12 +29,18 @@ class JSONStream;
   V(MetricHeapUsed, HeapGlobalUsed, "heap.global.used", kByte)                 \
   V(MaxMetric, HeapGlobalUsedMax, "heap.global.used.max", kByte)               \
   V(Metric, RunnableLatency, "isolate.runnable.latency", kMicrosecond)         \
-  V(Metric, RunnableHeapSize, "isolate.runnable.heap", kByte)
+  V(Metric, RunnableHeapSize, "isolate.runnable.heap", kByte)                  \
+  V(Metric, MessageQueueLength, "isolate.message.queue", kCounter)             \
+  V(HistogramMetric, GCPause, "gc.pause", kMicrosecond)                        \
+  V(HistogramMetric, CompileUnoptimized, "compiler.unoptimized.time",         \
+    kMicrosecond)                                                              \
+  V(HistogramMetric, CompileOptimized, "compiler.optimized.time", kMicrosecond)
 
 #define VM_METRIC_LIST(V)                                                      \
   V(MetricIsolateCount, IsolateCount, "vm.isolate.count", kCounter)            \
   V(MetricCurrentRSS, CurrentRSS, "vm.memory.current", kByte)                  \
-  V(MetricPeakRSS, PeakRSS, "vm.memory.max", kByte)
+  V(MetricPeakRSS, PeakRSS, "vm.memory.max", kByte)                            \
+  V(MetricPortCount, PortCount, "vm.port.count", kCounter)
 
 class Metric {
  public:
@@ -71,10 +79,24 @@ class Metric {
   // Returns a zone allocated string.
   char* ToString();
 
+  // Appends the VM metrics and the metrics of every isolate to 'buffer' in
+  // the Prometheus text format (https://prometheus.io/docs/instrumenting/
+  // exposition_formats/). May be called on any thread. Isolate metrics that
+  // are computed on demand can only be computed on their isolate's thread, so
+  // their value as of the last Isolate::PublishMetrics is used.
+  static void PrintPrometheus(TextBuffer* buffer);
+
   int64_t value() const { return value_; }
   void set_value(int64_t value) { value_ = value; }
 
-  void increment() { value_++; }
+  // Safe to call on several threads at once.
+  void increment() { AtomicOperations::IncrementInt64By(&value_, 1); }
+  void Add(int64_t delta) {
+    AtomicOperations::IncrementInt64By(&value_, delta);
+  }
+
+  // Stores the value computed on demand, so it can be read from other threads.
+  void Publish() { set_value(Value()); }
 
   Metric* next() const { return next_; }
   void set_next(Metric* next) { next_ = next; }
@@ -93,6 +115,14 @@ class Metric {
   // Use this for metrics that produce their value on demand.
   virtual int64_t Value() const { return value(); }
 
+  virtual const char* PrometheusType() const { return "gauge"; }
+  // Appends the samples of this metric named 'name'. 'labels' are the
+  // comma separated labels of every sample, possibly empty.
+  virtual void PrintPrometheusSamples(TextBuffer* buffer,
+                                      const char* name,
+                                      const char* labels);
+  void PrintPrometheusHeader(TextBuffer* buffer, const char* name);
+
  private:
   Isolate* isolate_;
   const char* name_;
@@ -109,6 +139,8 @@ class Metric {
   void DeregisterWithVM();
 
   static Metric* vm_list_head_;
+
+  friend class PrometheusIsolateVisitor;
   DISALLOW_COPY_AND_ASSIGN(Metric);
 };
 
@@ -119,6 +151,12 @@ class MaxMetric : public Metric {
   MaxMetric();
 
   void SetValue(int64_t new_value);
+
+ protected:
+  // Not exported before a value has been observed.
+  virtual void PrintPrometheusSamples(TextBuffer* buffer,
+                                      const char* name,
+                                      const char* labels);
 };
 
 // A Metric class that reports the minimum value observed.
@@ -128,6 +166,49 @@ class MinMetric : public Metric {
   MinMetric();
 
   void SetValue(int64_t new_value);
+
+ protected:
+  // Not exported before a value has been observed.
+  virtual void PrintPrometheusSamples(TextBuffer* buffer,
+                                      const char* name,
+                                      const char* labels);
+};
+
+// A Metric class that records the distribution of the values it is given,
+// e.g. the duration of every GC pause, in buckets with power of two bounds.
+// Its value is the sum of all recorded values. Recording is safe on several
+// threads at once.
+class HistogramMetric : public Metric {
+ public:
+  // Bucket 0 counts the values up to 1, bucket i > 0 those in
+  // (2^(i-1), 2^i], and the last bucket all values above that.
+  static const intptr_t kNumBuckets = 28;
+
+  HistogramMetric();
+
+  void Record(int64_t value);
+
+  int64_t count() const { return count_; }
+  int64_t sum() const { return sum_; }
+  int64_t BucketCount(intptr_t bucket) const {
+    ASSERT((bucket >= 0) && (bucket < kNumBuckets));
+    return buckets_[bucket];
+  }
+  // kMaxInt64 for the last bucket.
+  static int64_t BucketUpperBound(intptr_t bucket);
+
+ protected:
+  virtual int64_t Value() const { return sum_; }
+
+  virtual const char* PrometheusType() const { return "histogram"; }
+  virtual void PrintPrometheusSamples(TextBuffer* buffer,
+                                      const char* name,
+                                      const char* labels);
+
+ private:
+  int64_t count_;
+  int64_t sum_;
+  int64_t buckets_[kNumBuckets];
 };
 
 class MetricHeapOldUsed : public Metric {
@@ -180,6 +261,11 @@ class MetricHeapUsed : public Metric {
   virtual int64_t Value() const;
 };
 
+class MetricPortCount : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
 }  // namespace dart
 
 #endif  // RUNTIME_VM_METRICS_H_
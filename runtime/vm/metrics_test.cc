@@ -3,6 +3,7 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "platform/assert.h"
+#include "platform/text_buffer.h"
 
 #include "vm/dart_api_impl.h"
 #include "vm/dart_api_state.h"
@@ -72,6 +73,65 @@ VM_UNIT_TEST_CASE(Metric_OnDemand) {
   Dart_ShutdownIsolate();
 }
 
+VM_UNIT_TEST_CASE(Metric_Histogram) {
+  TestCase::CreateTestIsolate();
+  {
+    HistogramMetric metric;
+    metric.InitInstance(Isolate::Current(), "a.b.c", "foobar",
+                        Metric::kMicrosecond);
+    metric.Record(0);
+    metric.Record(1);
+    metric.Record(2);
+    metric.Record(3);
+    metric.Record(4);
+    metric.Record(5);
+    metric.Record(kMaxInt64 / 2);
+    EXPECT_EQ(7, metric.count());
+    EXPECT_EQ(15 + kMaxInt64 / 2, metric.sum());
+    EXPECT_EQ(2, metric.BucketCount(0));
+    EXPECT_EQ(1, metric.BucketCount(1));
+    EXPECT_EQ(2, metric.BucketCount(2));
+    EXPECT_EQ(1, metric.BucketCount(3));
+    EXPECT_EQ(1, metric.BucketCount(HistogramMetric::kNumBuckets - 1));
+    EXPECT_EQ(1, HistogramMetric::BucketUpperBound(0));
+    EXPECT_EQ(8, HistogramMetric::BucketUpperBound(3));
+    EXPECT_EQ(kMaxInt64, HistogramMetric::BucketUpperBound(
+                             HistogramMetric::kNumBuckets - 1));
+  }
+  Dart_ShutdownIsolate();
+}
+
+VM_UNIT_TEST_CASE(Metric_Prometheus) {
+  TestCase::CreateTestIsolate();
+  {
+    Isolate* isolate = Isolate::Current();
+    isolate->GetGCPauseMetric()->Record(3);
+    isolate->GetMessageQueueLengthMetric()->set_value(5);
+
+    TextBuffer buffer(1 * KB);
+    Metric::PrintPrometheus(&buffer);
+    const char* text = buffer.buf();
+    EXPECT_SUBSTRING("# TYPE dart_vm_isolate_count gauge\n", text);
+    EXPECT_SUBSTRING("# TYPE dart_gc_pause_microseconds histogram\n", text);
+    char labels[128];
+    Utils::SNPrint(labels, sizeof(labels),
+                   "isolate=\"%s\",isolate_port=\"%" Pd64 "\"",
+                   isolate->name(), static_cast<int64_t>(isolate->main_port()));
+    char expected[256];
+    Utils::SNPrint(expected, sizeof(expected),
+                   "dart_gc_pause_microseconds_bucket{%s,le=\"4\"} 1\n",
+                   labels);
+    EXPECT_SUBSTRING(expected, text);
+    Utils::SNPrint(expected, sizeof(expected),
+                   "dart_gc_pause_microseconds_count{%s} 1\n", labels);
+    EXPECT_SUBSTRING(expected, text);
+    Utils::SNPrint(expected, sizeof(expected),
+                   "dart_isolate_message_queue{%s} 5\n", labels);
+    EXPECT_SUBSTRING(expected, text);
+  }
+  Dart_ShutdownIsolate();
+}
+
 #endif  // !PRODUCT
 
 }  // namespace dart
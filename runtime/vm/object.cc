@@ -2073,6 +2073,9 @@ RawObject* Object::Allocate(intptr_t cls_id, intptr_t size, Heap::Space space) {
   if (FLAG_profiler && cls.TraceAllocation(isolate)) {
     Profiler::SampleAllocation(thread, cls_id);
   }
+  if (heap->ShouldSampleAllocation(thread, address, size)) {
+    Profiler::SampleAllocation(thread, cls_id, size);
+  }
 #endif  // !PRODUCT
   NoSafepointScope no_safepoint;
   InitializeObject(address, cls_id, size, (isolate == Dart::vm_isolate()));
@@ -12341,6 +12344,11 @@ void KernelProgramInfo::set_constants_table(
   StorePointer(&raw_ptr()->constants_table_, value.raw());
 }
 
+void KernelProgramInfo::set_bytecode_index(
+    const ExternalTypedData& index) const {
+  StorePointer(&raw_ptr()->bytecode_index_, index.raw());
+}
+
 void KernelProgramInfo::set_potential_natives(
     const GrowableObjectArray& candidates) const {
   StorePointer(&raw_ptr()->potential_natives_, candidates.raw());
@@ -4189,6 +4189,13 @@ class KernelProgramInfo : public Object {
                         const Smi& name_index,
                         const Class& klass) const;
 
+  // Sorted (node offset, payload offset) pairs of the bytecode metadata,
+  // used to locate bytecode of a function when it is first called.
+  RawExternalTypedData* bytecode_index() const {
+    return raw_ptr()->bytecode_index_;
+  }
+  void set_bytecode_index(const ExternalTypedData& index) const;
+
  private:
   static RawKernelProgramInfo* New();
 
@@ -6,6 +6,7 @@
 
 #include "vm/dart.h"
 #include "vm/dart_api_state.h"
+#include "vm/flags.h"
 #include "vm/growable_array.h"
 #include "vm/isolate.h"
 #include "vm/object.h"
@@ -16,12 +17,24 @@
 
 namespace dart {
 
+DEFINE_FLAG(int,
+            heap_snapshot_traversal_budget,
+            64 * KB,
+            "Approximate memory in KB used by the traversal while writing a "
+            "heap snapshot. Larger heaps take more passes over the heap.");
+
 // The state of a pre-order, depth-first traversal of an object graph.
 // When a node is visited, *all* its children are pushed to the stack at once.
 // We insert a sentinel between the node and its children on the stack, to
 // remember that the node has been visited. The node is kept on the stack while
 // its children are processed, to give the visitor a complete chain of parents.
 //
+// The stack can be given a memory budget. Objects that do not fit are left
+// unmarked and the stack remembers that it overflowed; the traversal is then
+// completed by pushing the roots and the pointers of all marked objects again.
+// Parent chains are incomplete after an overflow, so this is only used when
+// the visitor does not look at parents.
+//
 // TODO(koda): Potential optimizations:
 // - Use tag bits for compact Node and sentinel representations.
 class ObjectGraph::Stack : public ObjectPointerVisitor {
@@ -29,8 +42,18 @@ class ObjectGraph::Stack : public ObjectPointerVisitor {
   explicit Stack(Isolate* isolate)
       : ObjectPointerVisitor(isolate),
         include_vm_objects_(true),
+        limit_(0),
+        overflowed_(false),
         data_(kInitialCapacity) {}
 
+  void SetMemoryBudget(intptr_t bytes) {
+    limit_ = Utils::Maximum(bytes / static_cast<intptr_t>(sizeof(Node)),
+                            kInitialCapacity);
+  }
+
+  bool overflowed() const { return overflowed_; }
+  void clear_overflowed() { overflowed_ = false; }
+
   // Marks and pushes. Used to initialize this stack with roots.
   virtual void VisitPointers(RawObject** first, RawObject** last) {
     for (RawObject** current = first; current <= last; ++current) {
@@ -42,6 +65,10 @@ class ObjectGraph::Stack : public ObjectPointerVisitor {
             continue;
           }
         }
+        if ((limit_ > 0) && (data_.length() >= limit_)) {
+          overflowed_ = true;
+          continue;
+        }
         (*current)->SetGraphMarked();
         Node node;
         node.ptr = current;
@@ -91,6 +118,9 @@ class ObjectGraph::Stack : public ObjectPointerVisitor {
   static const intptr_t kInitialCapacity = 1024;
   static const intptr_t kNoParent = -1;
 
+  intptr_t limit_;
+  bool overflowed_;
+
   intptr_t Parent(intptr_t index) const {
     // The parent is just below the next sentinel.
     for (intptr_t i = index; i >= 1; --i) {
@@ -507,7 +537,32 @@ intptr_t ObjectGraph::InboundReferences(Object* obj, const Array& references) {
   return visitor.length();
 }
 
-static void WritePtr(RawObject* raw, WriteStream* stream) {
+// Writes a snapshot to a WriteStream, optionally handing it to a consumer
+// in chunks as it fills up.
+class ObjectGraphWriter : public ValueObject {
+ public:
+  ObjectGraphWriter(WriteStream* stream,
+                    ObjectGraph::SnapshotConsumer* consumer,
+                    intptr_t chunk_size)
+      : stream_(stream), consumer_(consumer), chunk_size_(chunk_size) {}
+
+  void WriteUnsigned(intptr_t value) {
+    stream_->WriteUnsigned(value);
+    if ((consumer_ != NULL) && (stream_->bytes_written() >= chunk_size_)) {
+      consumer_->Consume(stream_->buffer(), stream_->bytes_written());
+      stream_->SetPosition(0);
+    }
+  }
+
+ private:
+  WriteStream* stream_;
+  ObjectGraph::SnapshotConsumer* consumer_;
+  intptr_t chunk_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(ObjectGraphWriter);
+};
+
+static void WritePtr(RawObject* raw, ObjectGraphWriter* stream) {
   ASSERT(raw->IsHeapObject());
   ASSERT(raw->IsOldObject());
   uword addr = RawObject::ToAddr(raw);
@@ -521,7 +576,7 @@ static void WritePtr(RawObject* raw, WriteStream* stream) {
 class WritePointerVisitor : public ObjectPointerVisitor {
  public:
   WritePointerVisitor(Isolate* isolate,
-                      WriteStream* stream,
+                      ObjectGraphWriter* stream,
                       bool only_instances)
       : ObjectPointerVisitor(isolate),
         stream_(stream),
@@ -548,7 +603,7 @@ class WritePointerVisitor : public ObjectPointerVisitor {
   intptr_t count() const { return count_; }
 
  private:
-  WriteStream* stream_;
+  ObjectGraphWriter* stream_;
   bool only_instances_;
   intptr_t count_;
 };
@@ -556,7 +611,7 @@ class WritePointerVisitor : public ObjectPointerVisitor {
 static void WriteHeader(RawObject* raw,
                         intptr_t size,
                         intptr_t cid,
-                        WriteStream* stream) {
+                        ObjectGraphWriter* stream) {
   WritePtr(raw, stream);
   ASSERT(Utils::IsAligned(size, kObjectAlignment));
   stream->WriteUnsigned(size);
@@ -566,7 +621,7 @@ static void WriteHeader(RawObject* raw,
 class WriteGraphVisitor : public ObjectGraph::Visitor {
  public:
   WriteGraphVisitor(Isolate* isolate,
-                    WriteStream* stream,
+                    ObjectGraphWriter* stream,
                     ObjectGraph::SnapshotRoots roots)
       : stream_(stream),
         ptr_writer_(isolate, stream, roots == ObjectGraph::kUser),
@@ -593,7 +648,7 @@ class WriteGraphVisitor : public ObjectGraph::Visitor {
   intptr_t count() const { return count_; }
 
  private:
-  WriteStream* stream_;
+  ObjectGraphWriter* stream_;
   WritePointerVisitor ptr_writer_;
   ObjectGraph::SnapshotRoots roots_;
   intptr_t count_;
@@ -601,7 +656,7 @@ class WriteGraphVisitor : public ObjectGraph::Visitor {
 
 class WriteGraphExternalSizesVisitor : public HandleVisitor {
  public:
-  WriteGraphExternalSizesVisitor(Thread* thread, WriteStream* stream)
+  WriteGraphExternalSizesVisitor(Thread* thread, ObjectGraphWriter* stream)
       : HandleVisitor(thread), stream_(stream) {}
 
   void VisitHandle(uword addr) {
@@ -616,12 +671,40 @@ class WriteGraphExternalSizesVisitor : public HandleVisitor {
   }
 
  private:
-  WriteStream* stream_;
+  ObjectGraphWriter* stream_;
+};
+
+// Pushes the pointers of all marked objects onto the stack, to find the
+// objects that were dropped when the stack overflowed.
+class MarkedObjectsVisitor : public ObjectVisitor {
+ public:
+  explicit MarkedObjectsVisitor(ObjectPointerVisitor* stack) : stack_(stack) {}
+
+  void VisitObject(RawObject* obj) {
+    if (obj->IsGraphMarked()) {
+      obj->VisitPointers(stack_);
+    }
+  }
+
+ private:
+  ObjectPointerVisitor* stack_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkedObjectsVisitor);
 };
 
 intptr_t ObjectGraph::Serialize(WriteStream* stream,
                                 SnapshotRoots roots,
                                 bool collect_garbage) {
+  return Serialize(stream, NULL, 0, roots, collect_garbage);
+}
+
+intptr_t ObjectGraph::Serialize(WriteStream* out,
+                                SnapshotConsumer* consumer,
+                                intptr_t chunk_size,
+                                SnapshotRoots roots,
+                                bool collect_garbage) {
+  ObjectGraphWriter writer(out, consumer, chunk_size);
+  ObjectGraphWriter* stream = &writer;
   if (collect_garbage) {
     isolate()->heap()->CollectAllGarbage();
   }
@@ -667,7 +750,23 @@ intptr_t ObjectGraph::Serialize(WriteStream* stream,
   }
 
   WriteGraphVisitor visitor(isolate(), stream, roots);
-  IterateObjects(&visitor);
+  {
+    // Like IterateObjects, but within the memory budget.
+    Stack stack(isolate());
+    stack.SetMemoryBudget(FLAG_heap_snapshot_traversal_budget * KB);
+    isolate()->VisitObjectPointers(&stack,
+                                   ValidationPolicy::kDontValidateFrames);
+    stack.TraverseGraph(&visitor);
+    while (stack.overflowed()) {
+      stack.clear_overflowed();
+      isolate()->VisitObjectPointers(&stack,
+                                     ValidationPolicy::kDontValidateFrames);
+      MarkedObjectsVisitor marked_objects(&stack);
+      iteration_scope.IterateObjectsNoImagePages(&marked_objects);
+      stack.TraverseGraph(&visitor);
+    }
+    Unmarker::UnmarkAll(isolate());
+  }
   stream->WriteUnsigned(0);
 
   WriteGraphExternalSizesVisitor external_visitor(Thread::Current(), stream);
@@ -99,12 +99,32 @@ class ObjectGraph : public StackResource {
 
   enum SnapshotRoots { kVM, kUser };
 
+  // Receives a snapshot piece by piece while it is being written.
+  class SnapshotConsumer {
+   public:
+    virtual ~SnapshotConsumer() {}
+    // Called with the next piece of the snapshot. The data is only valid
+    // during this call. This method must not allocate from the heap or
+    // trigger GC in any way.
+    virtual void Consume(const uint8_t* data, intptr_t length) = 0;
+  };
+
   // Write the isolate's object graph to 'stream'. Smis and nulls are omitted.
   // Returns the number of nodes in the stream, including the root.
   // If collect_garbage is false, the graph will include weakly-reachable
   // objects.
-  // TODO(koda): Document format; support streaming/chunking.
+  // TODO(koda): Document format.
+  intptr_t Serialize(WriteStream* stream,
+                     SnapshotRoots roots,
+                     bool collect_garbage);
+
+  // Like the above, but whenever 'stream' holds at least 'chunk_size' bytes
+  // they are passed to 'consumer' and the stream is rewound, so only about
+  // one chunk is held in memory. The rest of the snapshot is left in
+  // 'stream' on return.
   intptr_t Serialize(WriteStream* stream,
+                     SnapshotConsumer* consumer,
+                     intptr_t chunk_size,
                      SnapshotRoots roots,
                      bool collect_garbage);
 
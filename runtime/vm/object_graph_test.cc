@@ -4,10 +4,13 @@
 
 #include "vm/object_graph.h"
 #include "platform/assert.h"
+#include "vm/datastream.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
+DECLARE_FLAG(int, heap_snapshot_traversal_budget);
+
 class CounterVisitor : public ObjectGraph::Visitor {
  public:
   // Records the number of objects and total size visited, excluding 'skip'
@@ -138,4 +141,79 @@ ISOLATE_UNIT_TEST_CASE(ObjectGraph) {
   }
 }
 
+static uint8_t* malloc_allocator(uint8_t* ptr,
+                                 intptr_t old_size,
+                                 intptr_t new_size) {
+  return reinterpret_cast<uint8_t*>(realloc(ptr, new_size));
+}
+
+class CollectingSnapshotConsumer : public ObjectGraph::SnapshotConsumer {
+ public:
+  CollectingSnapshotConsumer() : chunks_(0) {}
+
+  virtual void Consume(const uint8_t* data, intptr_t length) {
+    for (intptr_t i = 0; i < length; i++) {
+      data_.Add(data[i]);
+    }
+    chunks_++;
+  }
+
+  const GrowableArray<uint8_t>& data() const { return data_; }
+  intptr_t chunks() const { return chunks_; }
+
+ private:
+  GrowableArray<uint8_t> data_;
+  intptr_t chunks_;
+};
+
+ISOLATE_UNIT_TEST_CASE(ObjectGraph_StreamingSerialize) {
+  const intptr_t kChunkSize = 4 * KB;
+
+  // Write the whole snapshot to one buffer.
+  uint8_t* whole = NULL;
+  WriteStream whole_stream(&whole, &malloc_allocator, 1 * MB);
+  intptr_t node_count;
+  {
+    ObjectGraph graph(thread);
+    node_count = graph.Serialize(&whole_stream, ObjectGraph::kVM, true);
+  }
+  EXPECT_LT(2, node_count);
+
+  // Without another GC, the streamed snapshot is the same, and only the tail
+  // is left behind.
+  {
+    uint8_t* buffer = NULL;
+    WriteStream stream(&buffer, &malloc_allocator, kChunkSize + KB);
+    CollectingSnapshotConsumer consumer;
+    ObjectGraph graph(thread);
+    EXPECT_EQ(node_count, graph.Serialize(&stream, &consumer, kChunkSize,
+                                          ObjectGraph::kVM, false));
+    EXPECT_LT(1, consumer.chunks());
+    EXPECT_LT(stream.bytes_written(), kChunkSize);
+    consumer.Consume(buffer, stream.bytes_written());
+    EXPECT_EQ(whole_stream.bytes_written(), consumer.data().length());
+    EXPECT_EQ(0, memcmp(whole, consumer.data().data(),
+                        whole_stream.bytes_written()));
+    free(buffer);
+  }
+
+  // With a tiny traversal budget the heap is visited in several passes. The
+  // order changes, but not the nodes and edges.
+  {
+    const intptr_t saved_budget = FLAG_heap_snapshot_traversal_budget;
+    FLAG_heap_snapshot_traversal_budget = 1;
+    uint8_t* buffer = NULL;
+    WriteStream stream(&buffer, &malloc_allocator, kChunkSize + KB);
+    CollectingSnapshotConsumer consumer;
+    ObjectGraph graph(thread);
+    EXPECT_EQ(node_count, graph.Serialize(&stream, &consumer, kChunkSize,
+                                          ObjectGraph::kVM, false));
+    consumer.Consume(buffer, stream.bytes_written());
+    EXPECT_EQ(whole_stream.bytes_written(), consumer.data().length());
+    FLAG_heap_snapshot_traversal_budget = saved_budget;
+    free(buffer);
+  }
+  free(whole);
+}
+
 }  // namespace dart
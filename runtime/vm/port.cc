@@ -276,6 +276,11 @@ Isolate* PortMap::GetIsolate(Dart_Port id) {
   return handler->isolate();
 }
 
+intptr_t PortMap::NumPorts() {
+  MutexLocker ml(mutex_);
+  return used_;
+}
+
 void PortMap::Init() {
   if (mutex_ == NULL) {
     mutex_ = new Mutex();
@@ -54,6 +54,9 @@ class PortMap : public AllStatic {
   // Returns the owning Isolate for port 'id'.
   static Isolate* GetIsolate(Dart_Port id);
 
+  // Returns the number of open ports of all isolates.
+  static intptr_t NumPorts();
+
   static void Init();
   static void Cleanup();
 
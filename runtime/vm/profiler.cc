@@ -3,6 +3,7 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "platform/address_sanitizer.h"
+#include "platform/math.h"
 #include "platform/memory_sanitizer.h"
 #include "platform/utils.h"
 
@@ -10,6 +11,7 @@
 #include "vm/allocation.h"
 #include "vm/code_patcher.h"
 #include "vm/debugger.h"
+#include "vm/hash.h"
 #include "vm/instructions.h"
 #include "vm/isolate.h"
 #include "vm/json_stream.h"
@@ -26,8 +28,11 @@
 
 namespace dart {
 
+// Number of pcs stored in the sample itself. Frames beyond these are kept in
+// the buffer's SampleStackTable.
 static const intptr_t kSampleSize = 8;
-static const intptr_t kMaxSamplesPerTick = 16;
+static const intptr_t kMaxProfileDepth = 1024;
+static const intptr_t kMaxCallerFrames = kMaxProfileDepth - kSampleSize;
 
 DEFINE_FLAG(bool, trace_profiled_isolates, false, "Trace profiled isolates.");
 
@@ -44,8 +49,8 @@ DEFINE_FLAG(int,
 #endif
 DEFINE_FLAG(int,
             max_profile_depth,
-            kSampleSize* kMaxSamplesPerTick,
-            "Maximum number stack frames walked. Minimum 1. Maximum 255.");
+            kMaxProfileDepth,
+            "Maximum number stack frames walked. Minimum 1. Maximum 1024.");
 #if defined(USING_SIMULATOR)
 DEFINE_FLAG(bool, profile_vm, true, "Always collect native stack traces.");
 #else
@@ -55,6 +60,13 @@ DEFINE_FLAG(bool,
             profile_vm_allocation,
             false,
             "Collect native stack traces when tracing Dart allocations.");
+DEFINE_FLAG(int,
+            allocation_sample_period,
+            0,
+            "Average number of bytes allocated in the Dart heap between two "
+            "allocation samples. Every byte is equally likely to be sampled, "
+            "so this attributes allocations to their sites without tracing "
+            "any class. 0 disables sampling.");
 
 #ifndef PRODUCT
 
@@ -106,7 +118,7 @@ void Profiler::Cleanup() {
 
 void Profiler::SetSampleDepth(intptr_t depth) {
   const int kMinimumDepth = 2;
-  const int kMaximumDepth = 255;
+  const int kMaximumDepth = kMaxProfileDepth;
   if (depth < kMinimumDepth) {
     FLAG_max_profile_depth = kMinimumDepth;
   } else if (depth > kMaximumDepth) {
@@ -152,6 +164,20 @@ SampleBuffer::SampleBuffer(intptr_t capacity) {
   samples_ = reinterpret_cast<Sample*>(memory_->address());
   capacity_ = capacity;
   cursor_ = 0;
+  stack_table_ =
+      new SampleStackTable(capacity * kStackTableEntriesPerSample);
+
+  const intptr_t caller_frames_size =
+      Utils::RoundUp(kCallerFramesBuffers * kMaxCallerFrames * sizeof(uword),
+                     VirtualMemory::PageSize());
+  caller_frames_memory_ = VirtualMemory::Allocate(
+      caller_frames_size, kNotExecutable, "dart-profiler");
+  if (caller_frames_memory_ == NULL) {
+    OUT_OF_MEMORY();
+  }
+  for (intptr_t i = 0; i < kCallerFramesBuffers; i++) {
+    caller_frames_in_use_[i] = 0;
+  }
 
   if (FLAG_trace_profiler) {
     OS::PrintErr("Profiler holds %" Pd " samples\n", capacity);
@@ -161,9 +187,14 @@ SampleBuffer::SampleBuffer(intptr_t capacity) {
 }
 
 AllocationSampleBuffer::AllocationSampleBuffer(intptr_t capacity)
-    : SampleBuffer(capacity), mutex_(new Mutex()), free_sample_list_(NULL) {}
+    : SampleBuffer(capacity),
+      mutex_(new Mutex()),
+      free_sample_list_(NULL),
+      reserve_count_(0) {}
 
 SampleBuffer::~SampleBuffer() {
+  delete caller_frames_memory_;
+  delete stack_table_;
   delete memory_;
 }
 
@@ -171,6 +202,109 @@ AllocationSampleBuffer::~AllocationSampleBuffer() {
   delete mutex_;
 }
 
+SampleStackTable::SampleStackTable(intptr_t capacity) : length_(0) {
+  const intptr_t size =
+      Utils::RoundUp(capacity * sizeof(Entry), VirtualMemory::PageSize());
+  const bool kNotExecutable = false;
+  memory_ = VirtualMemory::Allocate(size, kNotExecutable, "dart-profiler");
+  if (memory_ == NULL) {
+    OUT_OF_MEMORY();
+  }
+  // Freshly mapped memory is zeroed, i.e. every entry is free.
+  entries_ = reinterpret_cast<Entry*>(memory_->address());
+  capacity_ = size / sizeof(Entry);
+
+  if (FLAG_trace_profiler) {
+    OS::PrintErr("Profiler stack table holds %" Pd " frames\n", capacity_);
+  }
+}
+
+SampleStackTable::~SampleStackTable() {
+  delete memory_;
+}
+
+intptr_t SampleStackTable::Intern(uword epoch, intptr_t caller, uword pc) {
+  ASSERT((caller == kRoot) || IsValid(caller));
+  ASSERT(pc != 0);
+  ASSERT((epoch >= kFirstEpoch) && (epoch != kBusy));
+  const uword caller_key = static_cast<uword>(caller) + 1;
+  uint32_t hash = CombineHashes(static_cast<uint32_t>(caller),
+                                static_cast<uint32_t>(pc));
+#if defined(ARCH_IS_64_BIT)
+  hash = CombineHashes(hash, static_cast<uint32_t>(pc >> 32));
+#endif
+  intptr_t index = FinalizeHash(hash, 31) % capacity_;
+  for (intptr_t probe = 0; probe < kMaxProbes; probe++) {
+    Entry* entry = &entries_[index];
+    const uword entry_epoch = AtomicOperations::LoadRelaxed(&entry->epoch);
+    if ((entry_epoch == 0) || !IsLive(entry_epoch, epoch)) {
+      // Free or stale, try to claim it.
+      if (AtomicOperations::CompareAndSwapWord(&entry->epoch, entry_epoch,
+                                               kBusy) == entry_epoch) {
+        AtomicOperations::StoreRelaxed(&entry->pc, pc);
+        AtomicOperations::StoreRelaxed(&entry->caller, caller_key);
+        AtomicOperations::CompareAndSwapWord(&entry->epoch, kBusy, epoch);
+        if (entry_epoch == 0) {
+          AtomicOperations::FetchAndIncrement(&length_);
+        }
+        return index + 1;
+      }
+    } else if ((entry_epoch != kBusy) &&
+               (AtomicOperations::LoadRelaxed(&entry->pc) == pc) &&
+               (AtomicOperations::LoadRelaxed(&entry->caller) == caller_key)) {
+      if ((entry_epoch >= epoch) ||
+          (AtomicOperations::CompareAndSwapWord(&entry->epoch, entry_epoch,
+                                                epoch) == entry_epoch)) {
+        return index + 1;
+      }
+    }
+    index = (index + 1) % capacity_;
+  }
+  return kFull;
+}
+
+void SampleBuffer::InternCallerFrames(Sample* sample,
+                                      const uword* caller_pcs,
+                                      intptr_t count) {
+  if (count <= 0) {
+    return;
+  }
+  // Frames are interned outermost first so that samples sharing callers
+  // share table entries.
+  const uword epoch = StackTableEpoch();
+  intptr_t entry = SampleStackTable::kRoot;
+  for (intptr_t i = count - 1; i >= 0; i--) {
+    entry = stack_table_->Intern(epoch, entry, caller_pcs[i]);
+    if (entry == SampleStackTable::kFull) {
+      // Keep only the frames in the sample itself.
+      sample->set_truncated_trace(true);
+      return;
+    }
+  }
+  sample->set_stack_table_entry(entry, epoch);
+}
+
+uword* SampleBuffer::ClaimCallerFrames() {
+  for (intptr_t i = 0; i < kCallerFramesBuffers; i++) {
+    if (AtomicOperations::CompareAndSwapWord(&caller_frames_in_use_[i], 0,
+                                             1) == 0) {
+      return reinterpret_cast<uword*>(caller_frames_memory_->address()) +
+             i * kMaxCallerFrames;
+    }
+  }
+  return NULL;
+}
+
+void SampleBuffer::ReleaseCallerFrames(uword* caller_pcs) {
+  const intptr_t i =
+      (caller_pcs -
+       reinterpret_cast<uword*>(caller_frames_memory_->address())) /
+      kMaxCallerFrames;
+  ASSERT((i >= 0) && (i < kCallerFramesBuffers));
+  ASSERT(caller_frames_in_use_[i] == 1);
+  AtomicOperations::CompareAndSwapWord(&caller_frames_in_use_[i], 1, 0);
+}
+
 Sample* SampleBuffer::At(intptr_t idx) const {
   ASSERT(idx >= 0);
   ASSERT(idx < capacity_);
@@ -191,33 +325,12 @@ Sample* SampleBuffer::ReserveSample() {
   return At(ReserveSampleSlot());
 }
 
-Sample* SampleBuffer::ReserveSampleAndLink(Sample* previous) {
-  ASSERT(previous != NULL);
-  intptr_t next_index = ReserveSampleSlot();
-  Sample* next = At(next_index);
-  next->Init(previous->port(), previous->timestamp(), previous->tid());
-  next->set_head_sample(false);
-  // Mark that previous continues at next.
-  previous->SetContinuationIndex(next_index);
-  return next;
-}
-
 void AllocationSampleBuffer::FreeAllocationSample(Sample* sample) {
   MutexLocker ml(mutex_);
-  while (sample != NULL) {
-    intptr_t continuation_index = -1;
-    if (sample->is_continuation_sample()) {
-      continuation_index = sample->continuation_index();
-    }
+  if (sample != NULL) {
     sample->Clear();
     sample->set_next_free(free_sample_list_);
     free_sample_list_ = sample;
-
-    if (continuation_index != -1) {
-      sample = At(continuation_index);
-    } else {
-      sample = NULL;
-    }
   }
 }
 
@@ -237,31 +350,13 @@ intptr_t AllocationSampleBuffer::ReserveSampleSlotLocked() {
   }
 }
 
-Sample* AllocationSampleBuffer::ReserveSampleAndLink(Sample* previous) {
-  MutexLocker ml(mutex_);
-  ASSERT(previous != NULL);
-  intptr_t next_index = ReserveSampleSlotLocked();
-  if (next_index < 0) {
-    // Could not find a free sample.
-    return NULL;
-  }
-  Sample* next = At(next_index);
-  next->Init(previous->port(), previous->timestamp(), previous->tid());
-  next->set_native_allocation_address(previous->native_allocation_address());
-  next->set_native_allocation_size_bytes(
-      previous->native_allocation_size_bytes());
-  next->set_head_sample(false);
-  // Mark that previous continues at next.
-  previous->SetContinuationIndex(next_index);
-  return next;
-}
-
 Sample* AllocationSampleBuffer::ReserveSample() {
   MutexLocker ml(mutex_);
   intptr_t index = ReserveSampleSlotLocked();
   if (index < 0) {
     return NULL;
   }
+  reserve_count_++;
   return At(index);
 }
 
@@ -441,24 +536,25 @@ static void DumpStackFrame(intptr_t frame_index, uword pc) {
 class ProfilerStackWalker : public ValueObject {
  public:
   ProfilerStackWalker(Dart_Port port_id,
-                      Sample* head_sample,
+                      Sample* sample,
                       SampleBuffer* sample_buffer,
                       intptr_t skip_count = 0)
       : port_id_(port_id),
-        sample_(head_sample),
+        sample_(sample),
         sample_buffer_(sample_buffer),
+        caller_pcs_(NULL),
         skip_count_(skip_count),
         frames_skipped_(0),
-        frame_index_(0),
         total_frames_(0) {
     if (sample_ == NULL) {
       ASSERT(sample_buffer_ == NULL);
     } else {
       ASSERT(sample_buffer_ != NULL);
-      ASSERT(sample_->head_sample());
     }
   }
 
+  ~ProfilerStackWalker() { ReleaseCallerFrames(); }
+
   bool Append(uword pc) {
     if (frames_skipped_ < skip_count_) {
       frames_skipped_++;
@@ -466,8 +562,7 @@ class ProfilerStackWalker : public ValueObject {
     }
 
     if (sample_ == NULL) {
-      DumpStackFrame(frame_index_, pc);
-      frame_index_++;
+      DumpStackFrame(total_frames_, pc);
       total_frames_++;
       return true;
     }
@@ -475,31 +570,47 @@ class ProfilerStackWalker : public ValueObject {
       sample_->set_truncated_trace(true);
       return false;
     }
-    ASSERT(sample_ != NULL);
-    if (frame_index_ == kSampleSize) {
-      Sample* new_sample = sample_buffer_->ReserveSampleAndLink(sample_);
-      if (new_sample == NULL) {
-        // Could not reserve new sample- mark this as truncated.
-        sample_->set_truncated_trace(true);
-        return false;
+    if (total_frames_ < kSampleSize) {
+      sample_->SetAt(total_frames_, pc);
+    } else {
+      if (caller_pcs_ == NULL) {
+        caller_pcs_ = sample_buffer_->ClaimCallerFrames();
+        if (caller_pcs_ == NULL) {
+          // Too many concurrent walks, keep the frames in the sample.
+          sample_->set_truncated_trace(true);
+          return false;
+        }
       }
-      frame_index_ = 0;
-      sample_ = new_sample;
+      caller_pcs_[total_frames_ - kSampleSize] = pc;
     }
-    ASSERT(frame_index_ < kSampleSize);
-    sample_->SetAt(frame_index_, pc);
-    frame_index_++;
     total_frames_++;
     return true;
   }
 
  protected:
+  // Moves the frames that did not fit in the sample into the stack table.
+  void InternCallerFrames() {
+    if ((sample_ == NULL) || (caller_pcs_ == NULL)) {
+      return;
+    }
+    sample_buffer_->InternCallerFrames(sample_, caller_pcs_,
+                                       total_frames_ - kSampleSize);
+    ReleaseCallerFrames();
+  }
+
+  void ReleaseCallerFrames() {
+    if (caller_pcs_ != NULL) {
+      sample_buffer_->ReleaseCallerFrames(caller_pcs_);
+      caller_pcs_ = NULL;
+    }
+  }
+
   Dart_Port port_id_;
   Sample* sample_;
   SampleBuffer* sample_buffer_;
+  uword* caller_pcs_;
   intptr_t skip_count_;
   intptr_t frames_skipped_;
-  intptr_t frame_index_;
   intptr_t total_frames_;
 };
 
@@ -566,6 +677,12 @@ class ProfilerDartStackWalker : public ProfilerStackWalker {
   }
 
   void walk() {
+    WalkFrames();
+    InternCallerFrames();
+  }
+
+ private:
+  void WalkFrames() {
     sample_->set_exit_frame_sample(has_exit_frame_);
     if (!ValidFramePointer()) {
       sample_->set_ignore_sample(true);
@@ -593,7 +710,6 @@ class ProfilerDartStackWalker : public ProfilerStackWalker {
     }
   }
 
- private:
   bool Next() {
     if (!ValidFramePointer()) {
       return false;
@@ -723,6 +839,12 @@ class ProfilerNativeStackWalker : public ProfilerStackWalker {
         lower_bound_(stack_lower) {}
 
   void walk() {
+    WalkFrames();
+    InternCallerFrames();
+  }
+
+ private:
+  void WalkFrames() {
     const uword kMaxStep = VirtualMemory::PageSize();
 
     Append(original_pc_);
@@ -785,7 +907,6 @@ class ProfilerNativeStackWalker : public ProfilerStackWalker {
     }
   }
 
- private:
   uword* CallerPC(uword* fp) const {
     ASSERT(fp != NULL);
     uword* caller_pc_ptr = fp + kSavedCallerPcSlotFromFp;
@@ -1127,7 +1248,7 @@ void Profiler::DumpStackTrace(uword sp, uword fp, uword pc, bool for_crash) {
   OS::PrintErr("-- End of DumpStackTrace\n");
 }
 
-void Profiler::SampleAllocation(Thread* thread, intptr_t cid) {
+void Profiler::SampleAllocation(Thread* thread, intptr_t cid, intptr_t size) {
   ASSERT(thread != NULL);
   OSThread* os_thread = thread->os_thread();
   ASSERT(os_thread != NULL);
@@ -1165,6 +1286,7 @@ void Profiler::SampleAllocation(Thread* thread, intptr_t cid) {
 
   Sample* sample = SetupSample(thread, sample_buffer, os_thread->trace_id());
   sample->SetAllocationCid(cid);
+  sample->set_allocation_size(size, FLAG_allocation_sample_period);
 
   if (FLAG_profile_vm_allocation) {
     ProfilerNativeStackWalker native_stack_walker(
@@ -1181,6 +1303,7 @@ void Profiler::SampleAllocation(Thread* thread, intptr_t cid) {
     uintptr_t pc = OS::GetProgramCounter();
     Sample* sample = SetupSample(thread, sample_buffer, os_thread->trace_id());
     sample->SetAllocationCid(cid);
+    sample->set_allocation_size(size, FLAG_allocation_sample_period);
     sample->SetAt(0, pc);
   }
 }
@@ -1230,9 +1353,10 @@ Sample* Profiler::SampleNativeAllocation(intptr_t skip_count,
   sample->set_native_allocation_address(address);
   sample->set_native_allocation_size_bytes(allocation_size);
 
-  ProfilerNativeStackWalker native_stack_walker(
-      ILLEGAL_PORT, sample, sample_buffer, stack_lower, stack_upper, pc, fp, sp,
-      skip_count);
+  ProfilerNativeStackWalker native_stack_walker(ILLEGAL_PORT, sample,
+                                                sample_buffer, stack_lower,
+                                                stack_upper, pc, fp, sp,
+                                                skip_count);
 
   native_stack_walker.walk();
 
@@ -1520,10 +1644,6 @@ ProcessedSampleBuffer* SampleBuffer::BuildProcessedSampleBuffer(
       // Bad sample.
       continue;
     }
-    if (!sample->head_sample()) {
-      // An inner sample in a chain of samples.
-      continue;
-    }
     // If we're requesting all the native allocation samples, we don't care
     // whether or not we're in the same isolate as the sample.
     if (sample->port() != filter->port()) {
@@ -1555,6 +1675,22 @@ ProcessedSampleBuffer* SampleBuffer::BuildProcessedSampleBuffer(
   return buffer;
 }
 
+// An object of 'size' bytes is sampled with probability
+// 1 - exp(-size / period), so each sample stands for size divided by that
+// probability. This keeps the estimated totals unbiased for small objects,
+// which are sampled much less often than once per period.
+static intptr_t SampledBytes(intptr_t size, intptr_t period) {
+  if (period <= 0) {
+    return size;
+  }
+  const double probability =
+      1.0 - exp(-static_cast<double>(size) / static_cast<double>(period));
+  if (probability <= 0.0) {
+    return size;
+  }
+  return static_cast<intptr_t>(size / probability);
+}
+
 ProcessedSample* SampleBuffer::BuildProcessedSample(
     Sample* sample,
     const CodeLookupTable& clt) {
@@ -1573,21 +1709,32 @@ ProcessedSample* SampleBuffer::BuildProcessedSample(
   if (sample->is_allocation_sample()) {
     processed_sample->set_allocation_cid(sample->allocation_cid());
   }
+  if (sample->allocation_size() != 0) {
+    processed_sample->set_sampled_bytes(SampledBytes(
+        sample->allocation_size(), sample->allocation_sample_period()));
+  }
   processed_sample->set_first_frame_executing(!sample->exit_frame_sample());
 
-  // Copy stack trace from sample(s).
-  bool truncated = false;
-  Sample* current = sample;
-  while (current != NULL) {
-    for (intptr_t i = 0; i < kSampleSize; i++) {
-      if (current->At(i) == 0) {
-        break;
-      }
-      processed_sample->Add(current->At(i));
+  // Copy stack trace from sample, followed by the frames it shares with
+  // other samples in the stack table.
+  for (intptr_t i = 0; i < kSampleSize; i++) {
+    if (sample->At(i) == 0) {
+      break;
     }
-
-    truncated = truncated || current->truncated_trace();
-    current = Next(current);
+    processed_sample->Add(sample->At(i));
+  }
+  intptr_t entry = sample->stack_table_entry();
+  if (stack_table_->IsValid(entry) &&
+      !SampleStackTable::IsLive(sample->stack_table_epoch(),
+                                StackTableEpoch())) {
+    // The entries may have been reused for other frames.
+    entry = SampleStackTable::kRoot;
+    processed_sample->set_truncated(true);
+  }
+  for (intptr_t i = kSampleSize;
+       stack_table_->IsValid(entry) && (i < kMaxProfileDepth); i++) {
+    processed_sample->Add(stack_table_->PcAt(entry));
+    entry = stack_table_->CallerAt(entry);
   }
 
   if (!sample->exit_frame_sample()) {
@@ -1595,26 +1742,10 @@ ProcessedSample* SampleBuffer::BuildProcessedSample(
                                   sample->GetStackBuffer());
   }
 
-  processed_sample->set_truncated(truncated);
-  return processed_sample;
-}
-
-Sample* SampleBuffer::Next(Sample* sample) {
-  if (!sample->is_continuation_sample()) return NULL;
-  Sample* next_sample = At(sample->continuation_index());
-  // Sanity check.
-  ASSERT(sample != next_sample);
-  // Detect invalid chaining.
-  if (sample->port() != next_sample->port()) {
-    return NULL;
+  if (sample->truncated_trace()) {
+    processed_sample->set_truncated(true);
   }
-  if (sample->timestamp() != next_sample->timestamp()) {
-    return NULL;
-  }
-  if (sample->tid() != next_sample->tid()) {
-    return NULL;
-  }
-  return next_sample;
+  return processed_sample;
 }
 
 ProcessedSample::ProcessedSample()
@@ -1623,6 +1754,7 @@ ProcessedSample::ProcessedSample()
       vm_tag_(0),
       user_tag_(0),
       allocation_cid_(-1),
+      sampled_bytes_(0),
       truncated_(false),
       timeline_trie_(NULL) {}
 
@@ -5,6 +5,7 @@
 #ifndef RUNTIME_VM_PROFILER_H_
 #define RUNTIME_VM_PROFILER_H_
 
+#include "platform/atomic.h"
 #include "vm/allocation.h"
 #include "vm/bitfield.h"
 #include "vm/code_observers.h"
@@ -65,7 +66,9 @@ class Profiler : public AllStatic {
   static void DumpStackTrace(void* context);
   static void DumpStackTrace(bool for_crash = true);
 
-  static void SampleAllocation(Thread* thread, intptr_t cid);
+  // Records the stack of an allocation of class 'cid'. 'size' is only given
+  // for the samples taken by --allocation_sample_period.
+  static void SampleAllocation(Thread* thread, intptr_t cid, intptr_t size = 0);
   static Sample* SampleNativeAllocation(intptr_t skip_count,
                                         uword address,
                                         uintptr_t allocation_size);
@@ -192,13 +195,15 @@ class Sample {
     state_ = 0;
     native_allocation_address_ = 0;
     native_allocation_size_bytes_ = 0;
-    continuation_index_ = -1;
+    allocation_size_ = 0;
+    allocation_sample_period_ = 0;
+    stack_table_entry_ = 0;
+    stack_table_epoch_ = 0;
     next_free_ = NULL;
     uword* pcs = GetPCArray();
     for (intptr_t i = 0; i < pcs_length_; i++) {
       pcs[i] = 0;
     }
-    set_head_sample(true);
   }
 
   // Timestamp sample was taken at.
@@ -309,6 +314,20 @@ class Sample {
     native_allocation_size_bytes_ = size;
   }
 
+  // The size of the sampled allocation if the sample was taken by
+  // --allocation_sample_period, 0 otherwise.
+  intptr_t allocation_size() const { return allocation_size_; }
+
+  // The --allocation_sample_period the sample was taken with.
+  intptr_t allocation_sample_period() const {
+    return allocation_sample_period_;
+  }
+
+  void set_allocation_size(intptr_t size, intptr_t period) {
+    allocation_size_ = size;
+    allocation_sample_period_ = period;
+  }
+
   Sample* next_free() const { return next_free_; }
   void set_next_free(Sample* next_free) { next_free_ = next_free; }
 
@@ -318,21 +337,16 @@ class Sample {
     state_ = ThreadTaskBit::update(task, state_);
   }
 
-  bool is_continuation_sample() const {
-    return ContinuationSampleBit::decode(state_);
-  }
+  // Entry in the buffer's SampleStackTable holding the frames that did not
+  // fit in the pc array, or 0 if there are none.
+  intptr_t stack_table_entry() const { return stack_table_entry_; }
 
-  void SetContinuationIndex(intptr_t index) {
-    ASSERT(!is_continuation_sample());
-    ASSERT(continuation_index_ == -1);
-    state_ = ContinuationSampleBit::update(true, state_);
-    continuation_index_ = index;
-    ASSERT(is_continuation_sample());
-  }
+  // Stack table epoch the entry was interned in.
+  uword stack_table_epoch() const { return stack_table_epoch_; }
 
-  intptr_t continuation_index() const {
-    ASSERT(is_continuation_sample());
-    return continuation_index_;
+  void set_stack_table_entry(intptr_t entry, uword epoch) {
+    stack_table_entry_ = entry;
+    stack_table_epoch_ = epoch;
   }
 
   intptr_t allocation_cid() const {
@@ -340,12 +354,6 @@ class Sample {
     return metadata_;
   }
 
-  void set_head_sample(bool head_sample) {
-    state_ = HeadSampleBit::update(head_sample, state_);
-  }
-
-  bool head_sample() const { return HeadSampleBit::decode(state_); }
-
   void set_metadata(intptr_t metadata) { metadata_ = metadata; }
 
   void SetAllocationCid(intptr_t cid) {
@@ -366,18 +374,15 @@ class Sample {
   static intptr_t instance_size_;
   static intptr_t pcs_length_;
   enum StateBits {
-    kHeadSampleBit = 0,
-    kLeafFrameIsDartBit = 1,
-    kIgnoreBit = 2,
-    kExitFrameBit = 3,
-    kMissingFrameInsertedBit = 4,
-    kTruncatedTraceBit = 5,
-    kClassAllocationSampleBit = 6,
-    kContinuationSampleBit = 7,
-    kThreadTaskBit = 8,  // 5 bits.
-    kNextFreeBit = 13,
+    kLeafFrameIsDartBit = 0,
+    kIgnoreBit = 1,
+    kExitFrameBit = 2,
+    kMissingFrameInsertedBit = 3,
+    kTruncatedTraceBit = 4,
+    kClassAllocationSampleBit = 5,
+    kThreadTaskBit = 6,  // 5 bits.
+    kNextFreeBit = 11,
   };
-  class HeadSampleBit : public BitField<uword, bool, kHeadSampleBit, 1> {};
   class LeafFrameIsDart : public BitField<uword, bool, kLeafFrameIsDartBit, 1> {
   };
   class IgnoreBit : public BitField<uword, bool, kIgnoreBit, 1> {};
@@ -388,8 +393,6 @@ class Sample {
       : public BitField<uword, bool, kTruncatedTraceBit, 1> {};
   class ClassAllocationSampleBit
       : public BitField<uword, bool, kClassAllocationSampleBit, 1> {};
-  class ContinuationSampleBit
-      : public BitField<uword, bool, kContinuationSampleBit, 1> {};
   class ThreadTaskBit
       : public BitField<uword, Thread::TaskKind, kThreadTaskBit, 5> {};
 
@@ -405,7 +408,10 @@ class Sample {
   uword state_;
   uword native_allocation_address_;
   uintptr_t native_allocation_size_bytes_;
-  intptr_t continuation_index_;
+  intptr_t allocation_size_;
+  intptr_t allocation_sample_period_;
+  intptr_t stack_table_entry_;
+  uword stack_table_epoch_;
   Sample* next_free_;
 
   /* There are a variable number of words that follow, the words hold the
@@ -434,6 +440,23 @@ class NativeAllocationSampleFilter : public SampleFilter {
   }
 };
 
+// Passes the allocation samples taken by --allocation_sample_period.
+class SampledAllocationFilter : public SampleFilter {
+ public:
+  SampledAllocationFilter(Dart_Port port,
+                          intptr_t thread_task_mask,
+                          int64_t time_origin_micros,
+                          int64_t time_extent_micros)
+      : SampleFilter(port,
+                     thread_task_mask,
+                     time_origin_micros,
+                     time_extent_micros) {}
+
+  bool FilterSample(Sample* sample) {
+    return sample->is_allocation_sample() && (sample->allocation_size() != 0);
+  }
+};
+
 // A Code object descriptor.
 class CodeDescriptor : public ZoneAllocated {
  public:
@@ -502,31 +525,127 @@ class CodeLookupTable : public ZoneAllocated {
   DISALLOW_COPY_AND_ASSIGN(CodeLookupTable);
 };
 
+// Table of interned stack frames shared by all samples in a SampleBuffer.
+// Each entry is a (caller entry, pc) pair, so the table forms a trie rooted
+// at the outermost frame and samples with a common chain of callers share
+// the entries for it. A sample records the entry of its innermost frame
+// that did not fit in its pc array.
+//
+// Every entry is tagged with the epoch it was last interned in. The owning
+// buffer advances the epoch as it recycles samples, and an entry whose tag
+// is two or more epochs old is no longer referenced by any live sample, so
+// it may be reused for another frame. Insertion is lock-free and does not
+// allocate so that it can be done from the thread interrupter. Two threads
+// racing to insert the same frame may both add an entry; that only costs
+// space.
+class SampleStackTable {
+ public:
+  // The (empty) caller of the outermost frame.
+  static const intptr_t kRoot = 0;
+  // Returned by Intern when no free entry could be found.
+  static const intptr_t kFull = -1;
+  // Epochs start at 1; 0 tags an entry that was never used.
+  static const uword kFirstEpoch = 1;
+
+  explicit SampleStackTable(intptr_t capacity);
+  ~SampleStackTable();
+
+  intptr_t capacity() const { return capacity_; }
+
+  // Number of entries that have ever been used.
+  intptr_t length() const {
+    return static_cast<intptr_t>(AtomicOperations::LoadRelaxed(&length_));
+  }
+
+  // Returns the entry for |pc| called from |caller|, adding it if needed,
+  // and tags it with |epoch|. |caller| must have been interned in |epoch|.
+  intptr_t Intern(uword epoch, intptr_t caller, uword pc);
+
+  // Whether entries interned in |entry_epoch| are still intact in |epoch|.
+  static bool IsLive(uword entry_epoch, uword epoch) {
+    return epoch < entry_epoch + 2;
+  }
+
+  bool IsValid(intptr_t entry) const {
+    return (entry > kRoot) && (entry <= capacity_);
+  }
+
+  uword PcAt(intptr_t entry) const {
+    ASSERT(IsValid(entry));
+    return entries_[entry - 1].pc;
+  }
+
+  intptr_t CallerAt(intptr_t entry) const {
+    ASSERT(IsValid(entry));
+    return static_cast<intptr_t>(entries_[entry - 1].caller) - 1;
+  }
+
+ private:
+  // All fields are 0 in a free entry. |caller| is stored biased by one so
+  // that it is never 0 in an entry in use. |epoch| is kBusy while the entry
+  // is being (re)written.
+  struct Entry {
+    uword pc;
+    uword caller;
+    uword epoch;
+  };
+
+  static const intptr_t kMaxProbes = 32;
+  static const uword kBusy = ~static_cast<uword>(0);
+
+  VirtualMemory* memory_;
+  Entry* entries_;
+  intptr_t capacity_;
+  uintptr_t length_;
+
+  DISALLOW_COPY_AND_ASSIGN(SampleStackTable);
+};
+
 // Ring buffer of Samples that is (usually) shared by many isolates.
 class SampleBuffer {
  public:
-  // Up to 1 minute @ 1000Hz, less if samples are deep.
+  // Up to 1 minute @ 1000Hz.
   static const intptr_t kDefaultBufferCapacity = 60000;
+  // Stack table entries reserved per sample for frames beyond the first few.
+  static const intptr_t kStackTableEntriesPerSample = 4;
+  // Number of stack walks that can hold frames beyond the first few at once.
+  static const intptr_t kCallerFramesBuffers = 16;
 
   explicit SampleBuffer(intptr_t capacity = kDefaultBufferCapacity);
   virtual ~SampleBuffer();
 
   intptr_t capacity() const { return capacity_; }
 
+  SampleStackTable* stack_table() const { return stack_table_; }
+
+  // The stack table epoch advances every time the whole buffer has been
+  // reused, so that samples interned two epochs ago have been overwritten.
+  virtual uword StackTableEpoch() const {
+    return AtomicOperations::LoadRelaxed(&cursor_) / capacity_ +
+           SampleStackTable::kFirstEpoch;
+  }
+
+  // Interns the |count| frames in |caller_pcs|, innermost first, that did
+  // not fit in |sample|. Marks the sample truncated if the table is full.
+  void InternCallerFrames(Sample* sample,
+                          const uword* caller_pcs,
+                          intptr_t count);
+
+  // Scratch space for the frames beyond the first few of a stack walk. Walks
+  // may run in a signal handler, where they can neither allocate nor afford
+  // the space on the stack. Returns NULL if all buffers are in use.
+  uword* ClaimCallerFrames();
+  void ReleaseCallerFrames(uword* caller_pcs);
+
   Sample* At(intptr_t idx) const;
   intptr_t ReserveSampleSlot();
   virtual Sample* ReserveSample();
-  virtual Sample* ReserveSampleAndLink(Sample* previous);
 
   void VisitSamples(SampleVisitor* visitor) {
     ASSERT(visitor != NULL);
     const intptr_t length = capacity();
     for (intptr_t i = 0; i < length; i++) {
       Sample* sample = At(i);
-      if (!sample->head_sample()) {
-        // An inner sample in a chain of samples.
-        continue;
-      }
       if (sample->ignore_sample()) {
         // Bad sample.
         continue;
@@ -553,14 +672,17 @@ class SampleBuffer {
  protected:
   ProcessedSample* BuildProcessedSample(Sample* sample,
                                         const CodeLookupTable& clt);
-  Sample* Next(Sample* sample);
 
   VirtualMemory* memory_;
   Sample* samples_;
+  SampleStackTable* stack_table_;
   intptr_t capacity_;
   uintptr_t cursor_;
 
  private:
+  VirtualMemory* caller_frames_memory_;
+  uintptr_t caller_frames_in_use_[kCallerFramesBuffers];
+
   DISALLOW_COPY_AND_ASSIGN(SampleBuffer);
 };
 
@@ -571,19 +693,27 @@ class AllocationSampleBuffer : public SampleBuffer {
 
   intptr_t ReserveSampleSlotLocked();
   virtual Sample* ReserveSample();
-  virtual Sample* ReserveSampleAndLink(Sample* previous);
   void FreeAllocationSample(Sample* sample);
 
+  // Allocation samples live as long as their objects, so the epoch advances
+  // with the number of samples taken instead. Deep frames of samples older
+  // than two epochs are reported as truncated.
+  virtual uword StackTableEpoch() const {
+    return AtomicOperations::LoadRelaxed(&reserve_count_) / capacity_ +
+           SampleStackTable::kFirstEpoch;
+  }
+
  private:
   Mutex* mutex_;
   Sample* free_sample_list_;
+  uintptr_t reserve_count_;
 
   DISALLOW_COPY_AND_ASSIGN(AllocationSampleBuffer);
 };
 
-// A |ProcessedSample| is a combination of 1 (or more) |Sample|(s) that have
-// been merged into a logical sample. The raw data may have been processed to
-// improve the quality of the stack trace.
+// A |ProcessedSample| is a |Sample| whose stack trace has been expanded with
+// the frames kept in the |SampleStackTable|. The raw data may have been
+// processed to improve the quality of the stack trace.
 class ProcessedSample : public ZoneAllocated {
  public:
   ProcessedSample();
@@ -636,6 +766,11 @@ class ProcessedSample : public ZoneAllocated {
     native_allocation_size_bytes_ = allocation_size;
   }
 
+  // For allocations sampled by --allocation_sample_period, the number of
+  // bytes the sample stands for. 0 otherwise.
+  intptr_t sampled_bytes() const { return sampled_bytes_; }
+  void set_sampled_bytes(intptr_t bytes) { sampled_bytes_ = bytes; }
+
   // Was the stack trace truncated?
   bool truncated() const { return truncated_; }
   void set_truncated(bool truncated) { truncated_ = truncated; }
@@ -668,6 +803,7 @@ class ProcessedSample : public ZoneAllocated {
   uword vm_tag_;
   uword user_tag_;
   intptr_t allocation_cid_;
+  intptr_t sampled_bytes_;
   bool truncated_;
   bool first_frame_executing_;
   uword native_allocation_address_;
@@ -4,7 +4,9 @@
 
 #include "vm/profiler_service.h"
 
+#include "vm/dart.h"
 #include "vm/growable_array.h"
+#include "vm/hash.h"
 #include "vm/hash_map.h"
 #include "vm/log.h"
 #include "vm/malloc_hooks.h"
@@ -17,6 +19,7 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, allocation_sample_period);
 DECLARE_FLAG(int, max_profile_depth);
 DECLARE_FLAG(int, profile_period);
 DECLARE_FLAG(bool, show_invisible_frames);
@@ -24,6 +27,17 @@ DECLARE_FLAG(bool, profile_vm);
 
 #ifndef PRODUCT
 
+DEFINE_FLAG(charp,
+            pprof_dir,
+            NULL,
+            "Periodically write the CPU profile of each isolate to this "
+            "directory in the pprof format.");
+DEFINE_FLAG(int,
+            pprof_period,
+            10000,
+            "Milliseconds between pprof profiles written for --pprof_dir or "
+            "Dart_SetPprofConsumer.");
+
 class DeoptimizedCodeSet : public ZoneAllocated {
  public:
   explicit DeoptimizedCodeSet(Isolate* isolate)
@@ -853,7 +867,9 @@ ProfileTrieNode::~ProfileTrieNode() {}
 
 void ProfileTrieNode::Tick(ProcessedSample* sample, bool exclusive) {
   count_++;
-  IncrementAllocation(sample->native_allocation_size_bytes(), exclusive);
+  IncrementAllocation(
+      sample->native_allocation_size_bytes() + sample->sampled_bytes(),
+      exclusive);
 }
 
 void ProfileTrieNode::SortChildren() {
@@ -2785,6 +2801,19 @@ void ProfilerService::PrintNativeAllocationJSON(JSONStream* stream,
                 Profiler::allocation_sample_buffer(), as_timeline);
 }
 
+void ProfilerService::PrintSampledAllocationJSON(JSONStream* stream,
+                                                 Profile::TagOrder tag_order,
+                                                 int64_t time_origin_micros,
+                                                 int64_t time_extent_micros) {
+  Thread* thread = Thread::Current();
+  Isolate* isolate = thread->isolate();
+  SampledAllocationFilter filter(isolate->main_port(), Thread::kMutatorTask,
+                                 time_origin_micros, time_extent_micros);
+  const bool as_timeline = false;
+  PrintJSONImpl(thread, stream, tag_order, kNoExtraTags, &filter,
+                Profiler::sample_buffer(), as_timeline);
+}
+
 void ProfilerService::PrintTimelineJSON(JSONStream* stream,
                                         Profile::TagOrder tag_order,
                                         int64_t time_origin_micros,
@@ -2817,6 +2846,402 @@ void ProfilerService::ClearSamples() {
   sample_buffer->VisitSamples(&clear_profile);
 }
 
+// Writes the protocol buffer wire format.
+class ProtobufWriter : public ValueObject {
+ public:
+  explicit ProtobufWriter(Zone* zone) : zone_(zone), bytes_(zone, 256) {}
+
+  const uint8_t* data() const { return bytes_.data(); }
+  intptr_t length() const { return bytes_.length(); }
+
+  void WriteVarintField(intptr_t field, uint64_t value) {
+    WriteVarint((field << 3) | kVarintWireType);
+    WriteVarint(value);
+  }
+
+  void WriteBytesField(intptr_t field, const void* bytes, intptr_t length) {
+    WriteVarint((field << 3) | kLengthDelimitedWireType);
+    WriteVarint(length);
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(bytes);
+    for (intptr_t i = 0; i < length; i++) {
+      bytes_.Add(data[i]);
+    }
+  }
+
+  void WriteStringField(intptr_t field, const char* value) {
+    WriteBytesField(field, value, strlen(value));
+  }
+
+  void WriteMessageField(intptr_t field, const ProtobufWriter& message) {
+    WriteBytesField(field, message.data(), message.length());
+  }
+
+  // Writes [values] as a packed repeated field.
+  void WritePackedField(intptr_t field, const GrowableArray<uint64_t>& values) {
+    ProtobufWriter packed(zone_);
+    for (intptr_t i = 0; i < values.length(); i++) {
+      packed.WriteVarint(values[i]);
+    }
+    WriteMessageField(field, packed);
+  }
+
+ private:
+  static const intptr_t kVarintWireType = 0;
+  static const intptr_t kLengthDelimitedWireType = 2;
+
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      bytes_.Add(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    bytes_.Add(static_cast<uint8_t>(value));
+  }
+
+  Zone* zone_;
+  GrowableArray<uint8_t> bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProtobufWriter);
+};
+
+// Encodes a |Profile| as a pprof Profile message, as defined in
+// https://github.com/google/pprof/blob/master/proto/profile.proto.
+//
+// Each |ProfileFunction|, including functions inlined into the sampled code,
+// becomes a pprof function with a location of its own. Stacks are read off
+// the exclusive function trie, in which every path from the root is a stack
+// with the innermost frame first.
+//
+// A CPU profile weighs every sample with --profile_period. An allocation
+// profile weighs it with the bytes it stands for, which the trie nodes sum up
+// as their allocations.
+class PprofWriter : public ValueObject {
+ public:
+  PprofWriter(Zone* zone, Profile* profile, ProfilerService::PprofKind kind)
+      : zone_(zone),
+        profile_(profile),
+        kind_(kind),
+        strings_(zone),
+        string_table_(zone, 64) {
+    // The first entry of the string table must be the empty string.
+    InternString("");
+  }
+
+  void Write(ProtobufWriter* out);
+
+ private:
+  // Field numbers of the messages in profile.proto.
+  enum {
+    kProfileSampleType = 1,
+    kProfileSample = 2,
+    kProfileLocation = 4,
+    kProfileFunction = 5,
+    kProfileStringTable = 6,
+    kProfileTimeNanos = 9,
+    kProfileDurationNanos = 10,
+    kProfilePeriodType = 11,
+    kProfilePeriod = 12,
+  };
+  enum { kValueTypeType = 1, kValueTypeUnit = 2 };
+  enum { kSampleLocationId = 1, kSampleValue = 2 };
+  enum { kLocationId = 1, kLocationLine = 4 };
+  enum { kLineFunctionId = 1 };
+  enum {
+    kFunctionId = 1,
+    kFunctionName = 2,
+    kFunctionSystemName = 3,
+    kFunctionFilename = 4,
+    kFunctionStartLine = 5,
+  };
+
+  struct StringTrait {
+    typedef const char* Key;
+    typedef intptr_t Value;
+    struct Pair {
+      Key key;
+      Value value;
+      Pair() : key(NULL), value(0) {}
+      Pair(Key k, Value v) : key(k), value(v) {}
+    };
+    static Key KeyOf(Pair kv) { return kv.key; }
+    static Value ValueOf(Pair kv) { return kv.value; }
+    static intptr_t Hashcode(Key key) {
+      uint32_t hash = 0;
+      for (const char* c = key; *c != '\0'; c++) {
+        hash = CombineHashes(hash, static_cast<uint8_t>(*c));
+      }
+      return FinalizeHash(hash, kBitsPerWord - 1);
+    }
+    static bool IsKeyEqual(Pair kv, Key key) {
+      return strcmp(kv.key, key) == 0;
+    }
+  };
+
+  intptr_t InternString(const char* string);
+  void WriteValueType(ProtobufWriter* out,
+                      intptr_t field,
+                      const char* type,
+                      const char* unit);
+  void WriteFunctions(ProtobufWriter* out);
+  void WriteSamples(ProtobufWriter* out,
+                    ProfileTrieNode* node,
+                    GrowableArray<uint64_t>* stack);
+
+  Zone* zone_;
+  Profile* profile_;
+  ProfilerService::PprofKind kind_;
+  // Maps strings to their string table index plus one, as a missing key
+  // looks up as 0.
+  DirectChainedHashMap<StringTrait> strings_;
+  GrowableArray<const char*> string_table_;
+
+  DISALLOW_COPY_AND_ASSIGN(PprofWriter);
+};
+
+intptr_t PprofWriter::InternString(const char* string) {
+  intptr_t index = strings_.LookupValue(string);
+  if (index != 0) {
+    return index - 1;
+  }
+  index = string_table_.length();
+  string_table_.Add(string);
+  strings_.Insert(StringTrait::Pair(string, index + 1));
+  return index;
+}
+
+void PprofWriter::WriteValueType(ProtobufWriter* out,
+                                 intptr_t field,
+                                 const char* type,
+                                 const char* unit) {
+  ProtobufWriter value_type(zone_);
+  value_type.WriteVarintField(kValueTypeType, InternString(type));
+  value_type.WriteVarintField(kValueTypeUnit, InternString(unit));
+  out->WriteMessageField(field, value_type);
+}
+
+void PprofWriter::WriteFunctions(ProtobufWriter* out) {
+  Script& script = Script::Handle(zone_);
+  String& url = String::Handle(zone_);
+  for (intptr_t i = 0; i < profile_->NumFunctions(); i++) {
+    ProfileFunction* profile_function = profile_->GetFunction(i);
+    const uint64_t id = profile_function->table_index() + 1;
+    const char* name = profile_function->Name();
+    ProtobufWriter function(zone_);
+    function.WriteVarintField(kFunctionId, id);
+    function.WriteVarintField(kFunctionName, InternString(name));
+    function.WriteVarintField(kFunctionSystemName, InternString(name));
+    const Function& dart_function = *profile_function->function();
+    if ((profile_function->kind() == ProfileFunction::kDartFunction) &&
+        !dart_function.IsNull()) {
+      script = dart_function.script();
+      if (!script.IsNull()) {
+        url = script.url();
+        function.WriteVarintField(kFunctionFilename,
+                                  InternString(url.ToCString()));
+        if (dart_function.token_pos().IsReal()) {
+          intptr_t line = 0;
+          intptr_t column = 0;
+          script.GetTokenLocation(dart_function.token_pos(), &line, &column);
+          function.WriteVarintField(kFunctionStartLine, line);
+        }
+      }
+    }
+    out->WriteMessageField(kProfileFunction, function);
+
+    ProtobufWriter line(zone_);
+    line.WriteVarintField(kLineFunctionId, id);
+    ProtobufWriter location(zone_);
+    location.WriteVarintField(kLocationId, id);
+    location.WriteMessageField(kLocationLine, line);
+    out->WriteMessageField(kProfileLocation, location);
+  }
+}
+
+void PprofWriter::WriteSamples(ProtobufWriter* out,
+                               ProfileTrieNode* node,
+                               GrowableArray<uint64_t>* stack) {
+  // Samples pass through every node on their path, so the samples whose
+  // stack ends at this node are those not accounted for by its children.
+  intptr_t count = node->count();
+  intptr_t bytes = node->inclusive_allocations();
+  for (intptr_t i = 0; i < node->NumChildren(); i++) {
+    ProfileTrieNode* child = node->At(i);
+    count -= child->count();
+    bytes -= child->inclusive_allocations();
+    stack->Add(child->table_index() + 1);
+    WriteSamples(out, child, stack);
+    stack->RemoveLast();
+  }
+  if ((count <= 0) || (stack->length() == 0)) {
+    return;
+  }
+  GrowableArray<uint64_t> values(2);
+  values.Add(count);
+  if (kind_ == ProfilerService::kAllocationPprof) {
+    values.Add(bytes);
+  } else {
+    const int64_t period_nanos =
+        static_cast<int64_t>(FLAG_profile_period) * kNanosecondsPerMicrosecond;
+    values.Add(count * period_nanos);
+  }
+  ProtobufWriter sample(zone_);
+  sample.WritePackedField(kSampleLocationId, *stack);
+  sample.WritePackedField(kSampleValue, values);
+  out->WriteMessageField(kProfileSample, sample);
+}
+
+void PprofWriter::Write(ProtobufWriter* out) {
+  WriteValueType(out, kProfileSampleType, "samples", "count");
+  if (kind_ == ProfilerService::kAllocationPprof) {
+    WriteValueType(out, kProfileSampleType, "space", "bytes");
+  } else {
+    WriteValueType(out, kProfileSampleType, "cpu", "nanoseconds");
+  }
+
+  // The root of the trie is a synthetic function that is not reported.
+  GrowableArray<uint64_t> stack(FLAG_max_profile_depth);
+  WriteSamples(out, profile_->GetTrieRoot(Profile::kExclusiveFunction),
+               &stack);
+  WriteFunctions(out);
+
+  // Sample timestamps are monotonic; pprof wants the wall clock.
+  const int64_t start_micros = OS::GetCurrentTimeMicros() -
+                               (OS::GetCurrentMonotonicMicros() -
+                                profile_->min_time());
+  out->WriteVarintField(kProfileTimeNanos,
+                        start_micros * kNanosecondsPerMicrosecond);
+  out->WriteVarintField(kProfileDurationNanos,
+                        profile_->GetTimeSpan() * kNanosecondsPerMicrosecond);
+  if (kind_ == ProfilerService::kAllocationPprof) {
+    WriteValueType(out, kProfilePeriodType, "space", "bytes");
+    out->WriteVarintField(kProfilePeriod, FLAG_allocation_sample_period);
+  } else {
+    const int64_t period_nanos =
+        static_cast<int64_t>(FLAG_profile_period) * kNanosecondsPerMicrosecond;
+    WriteValueType(out, kProfilePeriodType, "cpu", "nanoseconds");
+    out->WriteVarintField(kProfilePeriod, period_nanos);
+  }
+
+  // Written last, once every string has been interned.
+  for (intptr_t i = 0; i < string_table_.length(); i++) {
+    out->WriteStringField(kProfileStringTable, string_table_[i]);
+  }
+}
+
+Dart_StreamConsumer ProfilerService::pprof_consumer_ = NULL;
+void* ProfilerService::pprof_consumer_data_ = NULL;
+
+uint8_t* ProfilerService::WritePprof(Thread* thread,
+                                     SampleFilter* filter,
+                                     PprofKind kind,
+                                     intptr_t* length) {
+  SampleBuffer* sample_buffer = Profiler::sample_buffer();
+  if (sample_buffer == NULL) {
+    return NULL;
+  }
+  Isolate* isolate = thread->isolate();
+  // Disable thread interrupts while processing the buffer.
+  DisableThreadInterruptsScope dtis(thread);
+
+  StackZone zone(thread);
+  HANDLESCOPE(thread);
+  Profile profile(isolate);
+  profile.Build(thread, filter, sample_buffer, Profile::kNoTags);
+  if (profile.sample_count() == 0) {
+    return NULL;
+  }
+  ProtobufWriter out(zone.GetZone());
+  PprofWriter writer(zone.GetZone(), &profile, kind);
+  writer.Write(&out);
+  uint8_t* result = reinterpret_cast<uint8_t*>(malloc(out.length()));
+  memmove(result, out.data(), out.length());
+  *length = out.length();
+  return result;
+}
+
+void ProfilerService::SetPprofConsumer(Dart_StreamConsumer consumer,
+                                       void* user_data) {
+  pprof_consumer_ = consumer;
+  pprof_consumer_data_ = user_data;
+}
+
+// Writes 'profile' to a file named after 'kind', the process and the isolate
+// in --pprof_dir.
+static void WritePprofFile(const char* kind,
+                           Isolate* isolate,
+                           int64_t now,
+                           const uint8_t* profile,
+                           intptr_t length) {
+  Dart_FileOpenCallback file_open = Dart::file_open_callback();
+  Dart_FileWriteCallback file_write = Dart::file_write_callback();
+  Dart_FileCloseCallback file_close = Dart::file_close_callback();
+  if ((FLAG_pprof_dir == NULL) || (file_open == NULL) ||
+      (file_write == NULL) || (file_close == NULL)) {
+    return;
+  }
+  char* filename =
+      OS::SCreate(NULL, "%s/dart-%s-%" Pd "-%" Pd64 "-%" Pd64 ".pb",
+                  FLAG_pprof_dir, kind, static_cast<intptr_t>(OS::ProcessId()),
+                  static_cast<int64_t>(isolate->main_port()), now);
+  void* file = (*file_open)(filename, true);
+  if (file == NULL) {
+    OS::PrintErr("Failed to write pprof profile: %s\n", filename);
+  } else {
+    (*file_write)(profile, length, file);
+    (*file_close)(file);
+  }
+  free(filename);
+}
+
+void ProfilerService::DrainPprof(Thread* thread, bool force) {
+  if ((FLAG_pprof_dir == NULL) && (pprof_consumer_ == NULL)) {
+    return;
+  }
+  Isolate* isolate = thread->isolate();
+  if (Isolate::IsVMInternalIsolate(isolate)) {
+    return;
+  }
+  const int64_t now = OS::GetCurrentMonotonicMicros();
+  const int64_t origin = isolate->last_pprof_micros();
+  if (!force &&
+      ((now - origin) < FLAG_pprof_period * kMicrosecondsPerMillisecond)) {
+    return;
+  }
+  // The time filter includes both ends of the range.
+  isolate->set_last_pprof_micros(now + 1);
+
+  if ((FLAG_pprof_dir != NULL) && (FLAG_allocation_sample_period > 0)) {
+    SampledAllocationFilter filter(isolate->main_port(), Thread::kMutatorTask,
+                                   origin, now - origin);
+    intptr_t length = 0;
+    uint8_t* profile = WritePprof(thread, &filter, kAllocationPprof, &length);
+    if (profile != NULL) {
+      WritePprofFile("allocations", isolate, now, profile, length);
+      free(profile);
+    }
+  }
+
+  NoAllocationSampleFilter filter(isolate->main_port(), Thread::kMutatorTask,
+                                  origin, now - origin);
+  intptr_t length = 0;
+  uint8_t* profile = WritePprof(thread, &filter, kCpuPprof, &length);
+  if (profile == NULL) {
+    return;
+  }
+
+  Dart_StreamConsumer consumer = pprof_consumer_;
+  if (consumer != NULL) {
+    void* user_data = pprof_consumer_data_;
+    consumer(Dart_StreamConsumer_kStart, isolate->name(), NULL, 0, user_data);
+    consumer(Dart_StreamConsumer_kData, isolate->name(), profile, length,
+             user_data);
+    consumer(Dart_StreamConsumer_kFinish, isolate->name(), NULL, 0,
+             user_data);
+  }
+
+  WritePprofFile("profile", isolate, now, profile, length);
+  free(profile);
+}
+
 #endif  // !PRODUCT
 
 }  // namespace dart
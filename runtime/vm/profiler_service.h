@@ -5,6 +5,8 @@
 #ifndef RUNTIME_VM_PROFILER_SERVICE_H_
 #define RUNTIME_VM_PROFILER_SERVICE_H_
 
+#include "include/dart_tools_api.h"
+
 #include "vm/allocation.h"
 #include "vm/code_observers.h"
 #include "vm/globals.h"
@@ -479,6 +481,13 @@ class ProfilerService : public AllStatic {
                                         int64_t time_origin_micros,
                                         int64_t time_extent_micros);
 
+  // Prints the allocations sampled by --allocation_sample_period. The
+  // allocation counts of the trie nodes estimate the bytes allocated there.
+  static void PrintSampledAllocationJSON(JSONStream* stream,
+                                         Profile::TagOrder tag_order,
+                                         int64_t time_origin_micros,
+                                         int64_t time_extent_micros);
+
   static void PrintTimelineJSON(JSONStream* stream,
                                 Profile::TagOrder tag_order,
                                 int64_t time_origin_micros,
@@ -486,6 +495,28 @@ class ProfilerService : public AllStatic {
 
   static void ClearSamples();
 
+  enum PprofKind {
+    kCpuPprof,         // CPU time of the samples.
+    kAllocationPprof,  // Bytes estimated from --allocation_sample_period.
+  };
+
+  // Encodes the samples that pass [filter] as a pprof profile
+  // (https://github.com/google/pprof) of the given [kind]. Returns a
+  // malloc'ed buffer owned by the caller, or NULL if no samples pass the
+  // filter.
+  static uint8_t* WritePprof(Thread* thread,
+                             SampleFilter* filter,
+                             PprofKind kind,
+                             intptr_t* length);
+
+  static void SetPprofConsumer(Dart_StreamConsumer consumer, void* user_data);
+
+  // If --pprof_dir or a pprof consumer is set, and at least --pprof_period
+  // has passed or [force] is true, sends a pprof profile of the samples taken
+  // since the previous one to them. With --allocation_sample_period, a
+  // profile of the sampled allocations is also written to --pprof_dir.
+  static void DrainPprof(Thread* thread, bool force);
+
  private:
   static void PrintJSONImpl(Thread* thread,
                             JSONStream* stream,
@@ -494,6 +525,9 @@ class ProfilerService : public AllStatic {
                             SampleFilter* filter,
                             SampleBuffer* sample_buffer,
                             bool as_timline);
+
+  static Dart_StreamConsumer pprof_consumer_;
+  static void* pprof_consumer_data_;
 };
 
 }  // namespace dart
@@ -17,6 +17,7 @@ namespace dart {
 
 #ifndef PRODUCT
 
+DECLARE_FLAG(int, allocation_sample_period);
 DECLARE_FLAG(bool, profile_vm);
 DECLARE_FLAG(int, max_profile_depth);
 DECLARE_FLAG(bool, enable_inlining_annotations);
@@ -137,6 +138,98 @@ TEST_CASE(Profiler_SampleBufferIterateTest) {
   delete sample_buffer;
 }
 
+TEST_CASE(Profiler_SampleStackTable) {
+  SampleStackTable* table = new SampleStackTable(16);
+  const uword epoch = SampleStackTable::kFirstEpoch;
+  EXPECT_EQ(0, table->length());
+
+  // main -> a -> b and main -> a -> c share the entries for main and a.
+  intptr_t main = table->Intern(epoch, SampleStackTable::kRoot, 0x100);
+  intptr_t a = table->Intern(epoch, main, 0x200);
+  intptr_t b = table->Intern(epoch, a, 0x300);
+  intptr_t c = table->Intern(epoch, a, 0x400);
+  EXPECT_EQ(4, table->length());
+  EXPECT_EQ(main, table->Intern(epoch, SampleStackTable::kRoot, 0x100));
+  EXPECT_EQ(a, table->Intern(epoch, main, 0x200));
+  EXPECT_EQ(b, table->Intern(epoch, a, 0x300));
+  EXPECT_EQ(4, table->length());
+
+  // The same pc with another caller is a different entry.
+  intptr_t b2 = table->Intern(epoch, main, 0x300);
+  EXPECT_NE(b, b2);
+
+  EXPECT_EQ(0x400u, table->PcAt(c));
+  EXPECT_EQ(a, table->CallerAt(c));
+  EXPECT_EQ(0x200u, table->PcAt(a));
+  EXPECT_EQ(main, table->CallerAt(a));
+  EXPECT_EQ(SampleStackTable::kRoot, table->CallerAt(main));
+  EXPECT(!table->IsValid(SampleStackTable::kRoot));
+
+  // Once the table fills up, new frames are rejected.
+  bool full = false;
+  for (intptr_t i = 1; i <= 2 * table->capacity(); i++) {
+    if (table->Intern(epoch, b2, 0x1000 + i) == SampleStackTable::kFull) {
+      full = true;
+      break;
+    }
+  }
+  EXPECT(full);
+  EXPECT(table->length() <= table->capacity());
+
+  // Entries of the previous epoch are kept, older ones are reused.
+  EXPECT(SampleStackTable::IsLive(epoch, epoch + 1));
+  EXPECT(!SampleStackTable::IsLive(epoch, epoch + 2));
+  EXPECT_NE(SampleStackTable::kFull,
+            table->Intern(epoch + 2, SampleStackTable::kRoot, 0x5000));
+  EXPECT(table->length() <= table->capacity());
+  delete table;
+}
+
+TEST_CASE(Profiler_SampleStackTableWraps) {
+  const intptr_t kCapacity = 4;
+  const intptr_t kCallerFrames = 10;
+  SampleBuffer* sample_buffer = new SampleBuffer(kCapacity);
+  SampleStackTable* table = sample_buffer->stack_table();
+  uword pcs[kCallerFrames];
+
+  // Every sample has its own frames, so without reuse the table would fill
+  // up after a few laps around the buffer.
+  const intptr_t kSamples = 100 * table->capacity() / kCallerFrames;
+  for (intptr_t n = 0; n < kSamples; n++) {
+    Sample* sample = sample_buffer->ReserveSample();
+    sample->Init(ILLEGAL_PORT, 0, 0);
+    for (intptr_t i = 0; i < kCallerFrames; i++) {
+      pcs[i] = 0x1000 + n * kCallerFrames + i;
+    }
+    sample_buffer->InternCallerFrames(sample, pcs, kCallerFrames);
+    EXPECT(!sample->truncated_trace());
+
+    intptr_t entry = sample->stack_table_entry();
+    for (intptr_t i = 0; i < kCallerFrames; i++) {
+      EXPECT(table->IsValid(entry));
+      EXPECT_EQ(pcs[i], table->PcAt(entry));
+      entry = table->CallerAt(entry);
+    }
+    EXPECT_EQ(SampleStackTable::kRoot, entry);
+  }
+  EXPECT(sample_buffer->StackTableEpoch() > SampleStackTable::kFirstEpoch + 2);
+
+  // The samples still in the buffer are intact.
+  for (intptr_t n = kSamples - kCapacity; n < kSamples; n++) {
+    Sample* sample = sample_buffer->At(n % kCapacity);
+    EXPECT(SampleStackTable::IsLive(sample->stack_table_epoch(),
+                                    sample_buffer->StackTableEpoch()));
+    intptr_t entry = sample->stack_table_entry();
+    for (intptr_t i = 0; i < kCallerFrames; i++) {
+      EXPECT(table->IsValid(entry));
+      EXPECT_EQ(static_cast<uword>(0x1000 + n * kCallerFrames + i),
+                table->PcAt(entry));
+      entry = table->CallerAt(entry);
+    }
+  }
+  delete sample_buffer;
+}
+
 TEST_CASE(Profiler_AllocationSampleTest) {
   Isolate* isolate = Isolate::Current();
   SampleBuffer* sample_buffer = new SampleBuffer(3);
@@ -320,6 +413,175 @@ TEST_CASE(Profiler_TrivialRecordAllocation) {
   }
 }
 
+static bool ContainsBytes(const uint8_t* buffer,
+                          intptr_t length,
+                          const char* needle) {
+  const intptr_t needle_length = strlen(needle);
+  for (intptr_t i = 0; i + needle_length <= length; i++) {
+    if (memcmp(&buffer[i], needle, needle_length) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+TEST_CASE(Profiler_WritePprof) {
+  EnableProfiler();
+  DisableNativeProfileScope dnps;
+  const char* kScript =
+      "class A {\n"
+      "  var a;\n"
+      "  var b;\n"
+      "}\n"
+      "class B {\n"
+      "  static boo() {\n"
+      "    return new A();\n"
+      "  }\n"
+      "}\n"
+      "main() {\n"
+      "  return B.boo();\n"
+      "}\n";
+
+  Dart_Handle lib = TestCase::LoadTestScript(kScript, NULL);
+  EXPECT_VALID(lib);
+  Library& root_library = Library::Handle();
+  root_library ^= Api::UnwrapHandle(lib);
+
+  const int64_t before_allocations_micros = Dart_TimelineGetMicros();
+  const Class& class_a = Class::Handle(GetClass(root_library, "A"));
+  EXPECT(!class_a.IsNull());
+  class_a.SetTraceAllocation(true);
+
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+
+  const int64_t after_allocations_micros = Dart_TimelineGetMicros();
+  {
+    Thread* thread = Thread::Current();
+    Isolate* isolate = thread->isolate();
+    TransitionNativeToVM transition(thread);
+    AllocationFilter filter(isolate->main_port(), class_a.id(),
+                            before_allocations_micros,
+                            after_allocations_micros -
+                                before_allocations_micros);
+    intptr_t length = 0;
+    uint8_t* pprof = ProfilerService::WritePprof(
+        thread, &filter, ProfilerService::kCpuPprof, &length);
+    EXPECT(pprof != NULL);
+    // The profile starts with its first sample type.
+    EXPECT_EQ(0x0A, pprof[0]);
+    // Function names are in the string table.
+    EXPECT(ContainsBytes(pprof, length, "B.boo"));
+    EXPECT(ContainsBytes(pprof, length, "main"));
+    EXPECT(ContainsBytes(pprof, length, "nanoseconds"));
+    free(pprof);
+  }
+
+  // There is nothing to write for a time range without samples.
+  {
+    Thread* thread = Thread::Current();
+    Isolate* isolate = thread->isolate();
+    TransitionNativeToVM transition(thread);
+    AllocationFilter filter(isolate->main_port(), class_a.id(),
+                            Dart_TimelineGetMicros(), 16000);
+    intptr_t length = 0;
+    EXPECT(ProfilerService::WritePprof(thread, &filter,
+                                       ProfilerService::kCpuPprof,
+                                       &length) == NULL);
+  }
+}
+
+TEST_CASE(Profiler_SampledAllocation) {
+  EnableProfiler();
+  DisableNativeProfileScope dnps;
+  const char* kScript =
+      "class A {\n"
+      "  var a;\n"
+      "  var b;\n"
+      "  var c;\n"
+      "}\n"
+      "foo() {\n"
+      "  var list = new List(10000);\n"
+      "  for (var i = 0; i < 10000; i++) {\n"
+      "    list[i] = new A();\n"
+      "  }\n"
+      "  return list;\n"
+      "}\n"
+      "main() {\n"
+      "  return foo();\n"
+      "}\n";
+
+  Dart_Handle lib = TestCase::LoadTestScript(kScript, NULL);
+  EXPECT_VALID(lib);
+  Library& root_library = Library::Handle();
+  root_library ^= Api::UnwrapHandle(lib);
+  const Class& class_a = Class::Handle(GetClass(root_library, "A"));
+  EXPECT(!class_a.IsNull());
+
+  const int saved_period = FLAG_allocation_sample_period;
+  FLAG_allocation_sample_period = 1024;
+  {
+    Thread* thread = Thread::Current();
+    TransitionNativeToVM transition(thread);
+    thread->isolate()->heap()->SetThreadAllocationEnd(thread);
+  }
+
+  const int64_t before_allocations_micros = Dart_TimelineGetMicros();
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  const int64_t after_allocations_micros = Dart_TimelineGetMicros();
+
+  // The samples keep the period they were taken with.
+  FLAG_allocation_sample_period = saved_period;
+  {
+    Thread* thread = Thread::Current();
+    TransitionNativeToVM transition(thread);
+    thread->isolate()->heap()->SetThreadAllocationEnd(thread);
+  }
+
+  {
+    Thread* thread = Thread::Current();
+    Isolate* isolate = thread->isolate();
+    TransitionNativeToVM transition(thread);
+    StackZone zone(thread);
+    HANDLESCOPE(thread);
+    Profile profile(isolate);
+    // Only the sampled allocations of A are recorded, as A is not traced.
+    AllocationFilter filter(isolate->main_port(), class_a.id(),
+                            before_allocations_micros,
+                            after_allocations_micros -
+                                before_allocations_micros);
+    profile.Build(thread, &filter, Profiler::sample_buffer(), Profile::kNoTags);
+    // About 10000 * 32 / 1024 samples are expected on 64-bit targets.
+    EXPECT_LT(0, profile.sample_count());
+
+    // The root sums up the bytes estimated from every sample, which should be
+    // in the range of the bytes actually allocated.
+    const intptr_t allocated = 10000 * class_a.instance_size();
+    ProfileTrieWalker walker(&profile);
+    walker.Reset(Profile::kExclusiveFunction);
+    EXPECT_LT(allocated / 2, walker.CurrentInclusiveAllocations());
+    EXPECT_GT(allocated * 2, walker.CurrentInclusiveAllocations());
+  }
+
+  {
+    Thread* thread = Thread::Current();
+    Isolate* isolate = thread->isolate();
+    TransitionNativeToVM transition(thread);
+    AllocationFilter filter(isolate->main_port(), class_a.id(),
+                            before_allocations_micros,
+                            after_allocations_micros -
+                                before_allocations_micros);
+    intptr_t length = 0;
+    uint8_t* pprof = ProfilerService::WritePprof(
+        thread, &filter, ProfilerService::kAllocationPprof, &length);
+    EXPECT(pprof != NULL);
+    EXPECT(ContainsBytes(pprof, length, "foo"));
+    EXPECT(ContainsBytes(pprof, length, "bytes"));
+    free(pprof);
+  }
+}
+
 #if defined(DART_USE_TCMALLOC) && defined(HOST_OS_LINUX) && defined(DEBUG) &&  \
     defined(HOST_ARCH_x64)
 
@@ -16,6 +16,8 @@
 #include "vm/dart_entry.h"
 #include "vm/debugger.h"
 #include "vm/heap/safepoint.h"
+#include "vm/heap_snapshot_analyzer.h"
+#include "vm/interpreter.h"
 #include "vm/isolate.h"
 #include "vm/kernel_isolate.h"
 #include "vm/lockers.h"
@@ -63,6 +65,12 @@ DEFINE_FLAG(bool,
             "Print a message when an isolate is paused but there is no "
             "debugger attached.");
 
+DEFINE_FLAG(int,
+            heap_analysis_tasks,
+            4,
+            "Number of tasks used to compute the dominator tree of a heap "
+            "snapshot for _getRetainedSizes.");
+
 #ifndef PRODUCT
 // The name of this of this vm as reported by the VM service protocol.
 static char* vm_name = NULL;
@@ -3060,6 +3068,7 @@ static const char* const report_enum_names[] = {
     SourceReport::kCoverageStr,
     SourceReport::kPossibleBreakpointsStr,
     SourceReport::kProfileStr,
+    SourceReport::kBlockCoverageStr,
     NULL,
 };
 
@@ -3074,10 +3083,6 @@ static const MethodParameter* get_source_report_params[] = {
 };
 
 static bool GetSourceReport(Thread* thread, JSONStream* js) {
-  if (CheckCompilerDisabled(thread, js)) {
-    return true;
-  }
-
   const char* reports_str = js->LookupParam("reports");
   const EnumListParameter* reports_parameter =
       static_cast<const EnumListParameter*>(get_source_report_params[1]);
@@ -3092,6 +3097,8 @@ static bool GetSourceReport(Thread* thread, JSONStream* js) {
       report_set |= SourceReport::kPossibleBreakpoints;
     } else if (strcmp(*reports, SourceReport::kProfileStr) == 0) {
       report_set |= SourceReport::kProfile;
+    } else if (strcmp(*reports, SourceReport::kBlockCoverageStr) == 0) {
+      report_set |= SourceReport::kBlockCoverage;
     }
     reports++;
   }
@@ -3101,6 +3108,13 @@ static bool GetSourceReport(Thread* thread, JSONStream* js) {
     compile_mode = SourceReport::kForceCompile;
   }
 
+  // Block coverage alone can be reported from precompiled code.
+  if (((report_set != SourceReport::kBlockCoverage) ||
+       (compile_mode == SourceReport::kForceCompile)) &&
+      CheckCompilerDisabled(thread, js)) {
+    return true;
+  }
+
   Script& script = Script::Handle();
   intptr_t start_pos = UIntParameter::Parse(js->LookupParam("tokenPos"));
   intptr_t end_pos = UIntParameter::Parse(js->LookupParam("endTokenPos"));
@@ -3777,6 +3791,39 @@ static bool GetTagProfile(Thread* thread, JSONStream* js) {
   return true;
 }
 
+static const MethodParameter* get_interpreter_profile_params[] = {
+    RUNNABLE_ISOLATE_PARAMETER,
+    new UIntParameter("limit", false),
+    new BoolParameter("reset", false),
+    NULL,
+};
+
+static bool GetInterpreterProfile(Thread* thread, JSONStream* js) {
+#if !defined(DART_PRECOMPILED_RUNTIME)
+  const intptr_t kDefaultLimit = 100;
+  const char* limit_param = js->LookupParam("limit");
+  const intptr_t limit = (limit_param != NULL)
+                             ? UIntParameter::Parse(limit_param)
+                             : kDefaultLimit;
+  Interpreter* interpreter = thread->isolate()->interpreter();
+  InterpreterProfile* profile =
+      (interpreter != NULL) ? interpreter->profile() : NULL;
+  if (profile == NULL) {
+    js->PrintError(kFeatureDisabled,
+                   "Interpreter profile is disabled, "
+                   "run with --interpreter_profile.");
+    return true;
+  }
+  profile->PrintJSON(js, limit);
+  if (BoolParameter::Parse(js->LookupParam("reset"), false)) {
+    profile->Reset();
+  }
+#else
+  js->PrintError(kFeatureDisabled, "Interpreter is not supported.");
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
+  return true;
+}
+
 static const char* const tags_enum_names[] = {
     "None", "UserVM", "UserOnly", "VMUser", "VMOnly", NULL,
 };
@@ -3850,6 +3897,13 @@ static bool GetAllocationSamples(Thread* thread, JSONStream* js) {
   int64_t time_extent_micros =
       Int64Parameter::Parse(js->LookupParam("timeExtentMicros"));
   const char* class_id = js->LookupParam("classId");
+  if (class_id == NULL) {
+    // Without a class, report the allocations sampled by
+    // --allocation_sample_period.
+    ProfilerService::PrintSampledAllocationJSON(
+        js, tag_order, time_origin_micros, time_extent_micros);
+    return true;
+  }
   intptr_t cid = -1;
   GetPrefixedIntegerId(class_id, "classes/", &cid);
   Isolate* isolate = thread->isolate();
@@ -3995,50 +4049,139 @@ static bool RequestHeapSnapshot(Thread* thread, JSONStream* js) {
   return true;
 }
 
+static const MethodParameter* get_retained_sizes_params[] = {
+    RUNNABLE_ISOLATE_PARAMETER,
+    new EnumParameter("roots", false /* not required */, snapshot_roots_names),
+    new BoolParameter("collectGarbage", false /* not required */), NULL,
+};
+
+// Computes the retained size of every class from the dominator tree of a
+// heap snapshot, instead of one traversal of the heap per class.
+static bool GetRetainedSizes(Thread* thread, JSONStream* js) {
+  ObjectGraph::SnapshotRoots roots = ObjectGraph::kVM;
+  const char* roots_arg = js->LookupParam("roots");
+  if (roots_arg != NULL) {
+    roots = EnumMapper(roots_arg, snapshot_roots_names, snapshot_roots_values);
+  }
+  const bool collect_garbage =
+      BoolParameter::Parse(js->LookupParam("collectGarbage"), true);
+
+  uint8_t* buffer = NULL;
+  WriteStream stream(&buffer, &allocator, 1 * MB);
+  {
+    ObjectGraph graph(thread);
+    graph.Serialize(&stream, roots, collect_garbage);
+  }
+  HeapSnapshotAnalyzer analyzer;
+  const char* error = NULL;
+  bool parsed = analyzer.Parse(buffer, stream.bytes_written(), &error);
+  free(buffer);
+  if (!parsed) {
+    js->PrintError(kInternalError, "%s", error);
+    return true;
+  }
+  analyzer.Analyze(Dart::thread_pool(), FLAG_heap_analysis_tasks);
+
+  ClassTable* class_table = thread->isolate()->class_table();
+  JSONObject jsobj(js);
+  jsobj.AddProperty("type", "_RetainedSizes");
+  jsobj.AddProperty("nodeCount", analyzer.node_count());
+  jsobj.AddProperty("edgeCount", analyzer.edge_count());
+  jsobj.AddProperty("totalSize", analyzer.RetainedSizeOf(0));
+  {
+    JSONArray members(&jsobj, "members");
+    Class& cls = Class::Handle(thread->zone());
+    const intptr_t num_cids =
+        Utils::Minimum(analyzer.num_cids(), class_table->NumCids());
+    for (intptr_t cid = 1; cid < num_cids; cid++) {
+      if ((analyzer.InstanceCountOfClass(cid) == 0) ||
+          !class_table->HasValidClassAt(cid)) {
+        continue;
+      }
+      cls = class_table->At(cid);
+      JSONObject member(&members);
+      member.AddProperty("type", "_ClassRetainedSize");
+      member.AddProperty("class", cls);
+      member.AddProperty("instances", analyzer.InstanceCountOfClass(cid));
+      member.AddProperty("shallowSize", analyzer.ShallowSizeOfClass(cid));
+      member.AddProperty("retainedSize", analyzer.RetainedSizeOfClass(cid));
+    }
+  }
+  return true;
+}
+
+// Sends each chunk of a heap snapshot as soon as it has been written.
+class GraphChunkSender : public ObjectGraph::SnapshotConsumer {
+ public:
+  explicit GraphChunkSender(Thread* thread) : thread_(thread), count_(0) {}
+
+  virtual void Consume(const uint8_t* data, intptr_t length) {
+    Service::SendGraphChunk(thread_, data, length, count_, -1, -1);
+    count_++;
+  }
+
+  intptr_t count() const { return count_; }
+
+ private:
+  Thread* thread_;
+  intptr_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(GraphChunkSender);
+};
+
 void Service::SendGraphEvent(Thread* thread,
                              ObjectGraph::SnapshotRoots roots,
                              bool collect_garbage) {
+  // Chrome crashes receiving a single tens-of-megabytes blob, so send the
+  // snapshot in megabyte-sized chunks instead. They are sent while the
+  // snapshot is written, so the whole snapshot is never held in memory. The
+  // number of chunks is only known once it is done, so only the last chunk
+  // carries the chunk and node counts.
+  const intptr_t kChunkSize = 1 * MB;
   uint8_t* buffer = NULL;
-  WriteStream stream(&buffer, &allocator, 1 * MB);
+  WriteStream stream(&buffer, &allocator, kChunkSize + KB);
+  GraphChunkSender sender(thread);
   ObjectGraph graph(thread);
-  intptr_t node_count = graph.Serialize(&stream, roots, collect_garbage);
+  intptr_t node_count =
+      graph.Serialize(&stream, &sender, kChunkSize, roots, collect_garbage);
+  const intptr_t chunk_count = sender.count() + 1;
+  SendGraphChunk(thread, buffer, stream.bytes_written(), chunk_count - 1,
+                 chunk_count, node_count);
+  free(buffer);
+}
 
-  // Chrome crashes receiving a single tens-of-megabytes blob, so send the
-  // snapshot in megabyte-sized chunks instead.
-  const intptr_t kChunkSize = 1 * MB;
-  intptr_t num_chunks =
-      (stream.bytes_written() + (kChunkSize - 1)) / kChunkSize;
-  for (intptr_t i = 0; i < num_chunks; i++) {
-    JSONStream js;
+void Service::SendGraphChunk(Thread* thread,
+                             const uint8_t* data,
+                             intptr_t length,
+                             intptr_t chunk_index,
+                             intptr_t chunk_count,
+                             intptr_t node_count) {
+  JSONStream js;
+  {
+    JSONObject jsobj(&js);
+    jsobj.AddProperty("jsonrpc", "2.0");
+    jsobj.AddProperty("method", "streamNotify");
     {
-      JSONObject jsobj(&js);
-      jsobj.AddProperty("jsonrpc", "2.0");
-      jsobj.AddProperty("method", "streamNotify");
+      JSONObject params(&jsobj, "params");
+      params.AddProperty("streamId", graph_stream.id());
       {
-        JSONObject params(&jsobj, "params");
-        params.AddProperty("streamId", graph_stream.id());
-        {
-          JSONObject event(&params, "event");
-          event.AddProperty("type", "Event");
-          event.AddProperty("kind", "_Graph");
-          event.AddProperty("isolate", thread->isolate());
-          event.AddPropertyTimeMillis("timestamp", OS::GetCurrentTimeMillis());
-
-          event.AddProperty("chunkIndex", i);
-          event.AddProperty("chunkCount", num_chunks);
+        JSONObject event(&params, "event");
+        event.AddProperty("type", "Event");
+        event.AddProperty("kind", "_Graph");
+        event.AddProperty("isolate", thread->isolate());
+        event.AddPropertyTimeMillis("timestamp", OS::GetCurrentTimeMillis());
+
+        event.AddProperty("chunkIndex", chunk_index);
+        if (chunk_count >= 0) {
+          event.AddProperty("chunkCount", chunk_count);
           event.AddProperty("nodeCount", node_count);
         }
       }
     }
-
-    uint8_t* chunk_start = buffer + (i * kChunkSize);
-    intptr_t chunk_size = (i + 1 == num_chunks)
-                              ? stream.bytes_written() - (i * kChunkSize)
-                              : kChunkSize;
-
-    SendEventWithData(graph_stream.id(), "_Graph", js.buffer()->buf(),
-                      js.buffer()->length(), chunk_start, chunk_size);
   }
+
+  SendEventWithData(graph_stream.id(), "_Graph", js.buffer()->buf(),
+                    js.buffer()->length(), data, length);
 }
 
 void Service::SendInspectEvent(Isolate* isolate, const Object& inspectee) {
@@ -4809,6 +4952,8 @@ static const ServiceMethodDescriptor service_methods_[] = {
     get_inbound_references_params },
   { "_getInstances", GetInstances,
     get_instances_params },
+  { "_getInterpreterProfile", GetInterpreterProfile,
+    get_interpreter_profile_params },
   { "getIsolate", GetIsolate,
     get_isolate_params },
   { "_getIsolateMetric", GetIsolateMetric,
@@ -4829,6 +4974,8 @@ static const ServiceMethodDescriptor service_methods_[] = {
     get_reachable_size_params },
   { "_getRetainedSize", GetRetainedSize,
     get_retained_size_params },
+  { "_getRetainedSizes", GetRetainedSizes,
+    get_retained_sizes_params },
   { "_getRetainingPath", GetRetainingPath,
     get_retaining_path_params },
   { "getSourceReport", GetSourceReport,
@@ -210,6 +210,16 @@ class Service : public AllStatic {
                         const char* kind,
                         JSONStream* event);
 
+  // Sends one chunk of a heap snapshot. 'chunk_count' and 'node_count' are
+  // only known for the last chunk and are omitted (-1) for the others.
+  static void SendGraphChunk(Thread* thread,
+                             const uint8_t* data,
+                             intptr_t length,
+                             intptr_t chunk_index,
+                             intptr_t chunk_count,
+                             intptr_t node_count);
+  friend class GraphChunkSender;
+
   static RawError* MaybePause(Isolate* isolate, const Error& error);
 
   static EmbedderServiceHandler* isolate_service_handler_head_;
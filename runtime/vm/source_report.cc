@@ -4,6 +4,7 @@
 #ifndef PRODUCT
 #include "vm/source_report.h"
 
+#include "vm/compiler/backend/block_coverage.h"
 #include "vm/compiler/jit/compiler.h"
 #include "vm/isolate.h"
 #include "vm/object.h"
@@ -17,6 +18,11 @@ const char* SourceReport::kCallSitesStr = "_CallSites";
 const char* SourceReport::kCoverageStr = "Coverage";
 const char* SourceReport::kPossibleBreakpointsStr = "PossibleBreakpoints";
 const char* SourceReport::kProfileStr = "_Profile";
+const char* SourceReport::kBlockCoverageStr = "_BlockCoverage";
+
+static const char kCoverageNone = 0;
+static const char kCoverageMiss = 1;
+static const char kCoverageHit = 2;
 
 SourceReport::SourceReport(intptr_t report_set, CompileMode compile_mode)
     : report_set_(report_set),
@@ -58,6 +64,32 @@ void SourceReport::Init(Thread* thread,
     profile_.Build(thread, &samplesForIsolate, Profiler::sample_buffer(),
                    Profile::kNoTags);
   }
+  if (IsReportRequested(kBlockCoverage)) {
+    BuildBlockCoverageTable();
+  }
+}
+
+void SourceReport::BuildBlockCoverageTable() {
+  block_coverage_table_.Clear();
+  const GrowableObjectArray& registry = GrowableObjectArray::Handle(
+      zone(), isolate()->object_store()->block_coverage_arrays());
+  if (registry.IsNull()) {
+    return;
+  }
+  Array& counters = Array::Handle(zone());
+  for (intptr_t i = 0; i < registry.Length(); i++) {
+    counters ^= registry.At(i);
+    Function& func = Function::Handle(zone());
+    func ^= counters.At(BlockCoverage::kFunctionIndex);
+    BlockCoverageEntry* entry = block_coverage_table_.LookupValue(&func);
+    if (entry == NULL) {
+      entry = new (zone()) BlockCoverageEntry();
+      entry->key = &func;
+      entry->arrays = new (zone()) ZoneGrowableArray<const Array*>();
+      block_coverage_table_.Insert(entry);
+    }
+    entry->arrays->Add(&Array::Handle(zone(), counters.raw()));
+  }
 }
 
 bool SourceReport::IsReportRequested(ReportKind report_kind) {
@@ -195,6 +227,33 @@ void SourceReport::PrintCallSitesData(JSONObject* jsobj,
   }
 }
 
+// Prints the hits and misses in 'coverage', which has an entry for every
+// token position of a function starting at 'begin_pos'.
+static void PrintHitsAndMisses(JSONObject* jsobj,
+                               const char* name,
+                               TokenPosition begin_pos,
+                               const GrowableArray<char>& coverage) {
+  JSONObject cov(jsobj, name);
+  {
+    JSONArray hits(&cov, "hits");
+    for (int i = 0; i < coverage.length(); i++) {
+      if (coverage[i] == kCoverageHit) {
+        // Add the token position of the hit.
+        hits.AddValue(begin_pos.Pos() + i);
+      }
+    }
+  }
+  {
+    JSONArray misses(&cov, "misses");
+    for (int i = 0; i < coverage.length(); i++) {
+      if (coverage[i] == kCoverageMiss) {
+        // Add the token position of the miss.
+        misses.AddValue(begin_pos.Pos() + i);
+      }
+    }
+  }
+}
+
 void SourceReport::PrintCoverageData(JSONObject* jsobj,
                                      const Function& function,
                                      const Code& code) {
@@ -207,10 +266,6 @@ void SourceReport::PrintCoverageData(JSONObject* jsobj,
   const PcDescriptors& descriptors =
       PcDescriptors::Handle(zone(), code.pc_descriptors());
 
-  const int kCoverageNone = 0;
-  const int kCoverageMiss = 1;
-  const int kCoverageHit = 2;
-
   intptr_t func_length = (end_pos.Pos() - begin_pos.Pos()) + 1;
   GrowableArray<char> coverage(func_length);
   coverage.SetLength(func_length);
@@ -256,25 +311,7 @@ void SourceReport::PrintCoverageData(JSONObject* jsobj,
     }
   }
 
-  JSONObject cov(jsobj, "coverage");
-  {
-    JSONArray hits(&cov, "hits");
-    for (int i = 0; i < func_length; i++) {
-      if (coverage[i] == kCoverageHit) {
-        // Add the token position of the hit.
-        hits.AddValue(begin_pos.Pos() + i);
-      }
-    }
-  }
-  {
-    JSONArray misses(&cov, "misses");
-    for (int i = 0; i < func_length; i++) {
-      if (coverage[i] == kCoverageMiss) {
-        // Add the token position of the miss.
-        misses.AddValue(begin_pos.Pos() + i);
-      }
-    }
-  }
+  PrintHitsAndMisses(jsobj, "coverage", begin_pos, coverage);
 }
 
 void SourceReport::PrintPossibleBreakpointsData(JSONObject* jsobj,
@@ -366,6 +403,52 @@ void SourceReport::PrintProfileData(JSONObject* jsobj,
   }
 }
 
+void SourceReport::PrintBlockCoverageData(JSONObject* jsobj,
+                                          const Function& func) {
+  const TokenPosition begin_pos = func.token_pos();
+  const TokenPosition end_pos = func.end_token_pos();
+
+  intptr_t func_length = (end_pos.Pos() - begin_pos.Pos()) + 1;
+  GrowableArray<char> coverage(func_length);
+  coverage.SetLength(func_length);
+  for (int i = 0; i < func_length; i++) {
+    coverage[i] = kCoverageNone;
+  }
+
+  // A position is hit if any compilation of the function, or any inlined
+  // copy of it, entered a block starting there.
+  BlockCoverageEntry* entry = block_coverage_table_.LookupValue(&func);
+  if (entry != NULL) {
+    Object& count = Object::Handle(zone());
+    for (intptr_t i = 0; i < entry->arrays->length(); i++) {
+      const Array& counters = *(*entry->arrays)[i];
+      const intptr_t block_count = BlockCoverage::BlockCount(counters.Length());
+      for (intptr_t block = 0; block < block_count; block++) {
+        count = counters.At(BlockCoverage::CountIndex(block));
+        if (count.IsNull()) {
+          // The block was removed before code generation.
+          continue;
+        }
+        const intptr_t pos = Smi::Value(
+            Smi::RawCast(counters.At(BlockCoverage::PositionIndex(block))));
+        if ((pos < begin_pos.Pos()) || (pos > end_pos.Pos())) {
+          continue;
+        }
+        // Counters are not checked for overflow, so any non-zero count is a
+        // hit.
+        const intptr_t token_offset = pos - begin_pos.Pos();
+        if (Smi::Cast(count).Value() != 0) {
+          coverage[token_offset] = kCoverageHit;
+        } else if (coverage[token_offset] == kCoverageNone) {
+          coverage[token_offset] = kCoverageMiss;
+        }
+      }
+    }
+  }
+
+  PrintHitsAndMisses(jsobj, "blockCoverage", begin_pos, coverage);
+}
+
 void SourceReport::PrintScriptTable(JSONArray* scripts) {
   for (intptr_t i = 0; i < script_table_entries_.length(); i++) {
     const Script* script = script_table_entries_[i]->script;
@@ -382,6 +465,10 @@ void SourceReport::VisitFunction(JSONArray* jsarr, const Function& func) {
   const TokenPosition begin_pos = func.token_pos();
   const TokenPosition end_pos = func.end_token_pos();
 
+  // Block coverage is read from counters, which optimized and precompiled code
+  // maintain as well, so it does not need unoptimized code.
+  const bool block_coverage_only = (report_set_ == kBlockCoverage);
+
   Code& code = Code::Handle(zone(), func.unoptimized_code());
 #if !defined(DART_PRECOMPILED_RUNTIME)
   if (FLAG_enable_interpreter && code.IsNull() && func.HasBytecode()) {
@@ -389,7 +476,12 @@ void SourceReport::VisitFunction(JSONArray* jsarr, const Function& func) {
   }
 #endif  // !defined(DART_PRECOMPILED_RUNTIME)
   if (code.IsNull()) {
-    if (func.HasCode() || (compile_mode_ == kForceCompile)) {
+    if (block_coverage_only &&
+        (func.HasCode() ||
+         (block_coverage_table_.LookupValue(&func) != NULL))) {
+      // Report the counters without compiling. A function that was inlined
+      // everywhere has counters but no code of its own.
+    } else if (func.HasCode() || (compile_mode_ == kForceCompile)) {
       const Error& err =
           Error::Handle(Compiler::EnsureUnoptimizedCode(thread(), func));
       if (!err.IsNull()) {
@@ -418,7 +510,7 @@ void SourceReport::VisitFunction(JSONArray* jsarr, const Function& func) {
       return;
     }
   }
-  ASSERT(!code.IsNull());
+  ASSERT(!code.IsNull() || block_coverage_only);
 
   // We skip compiled async functions.  Once an async function has
   // been compiled, there is another function with the same range which
@@ -450,6 +542,9 @@ void SourceReport::VisitFunction(JSONArray* jsarr, const Function& func) {
       PrintProfileData(&range, profile_function);
     }
   }
+  if (IsReportRequested(kBlockCoverage)) {
+    PrintBlockCoverageData(&range, func);
+  }
 }
 
 void SourceReport::VisitLibrary(JSONArray* jsarr, const Library& lib) {
@@ -24,12 +24,14 @@ class SourceReport {
     kCoverage = 0x2,
     kPossibleBreakpoints = 0x4,
     kProfile = 0x8,
+    kBlockCoverage = 0x10,
   };
 
   static const char* kCallSitesStr;
   static const char* kCoverageStr;
   static const char* kPossibleBreakpointsStr;
   static const char* kProfileStr;
+  static const char* kBlockCoverageStr;
 
   enum CompileMode { kNoCompile, kForceCompile };
 
@@ -49,6 +51,7 @@ class SourceReport {
 
  private:
   void ClearScriptTable();
+  void BuildBlockCoverageTable();
   void Init(Thread* thread,
             const Script* script,
             TokenPosition start_pos,
@@ -73,6 +76,7 @@ class SourceReport {
                                     const Function& func,
                                     const Code& code);
   void PrintProfileData(JSONObject* jsobj, ProfileFunction* profile_function);
+  void PrintBlockCoverageData(JSONObject* jsobj, const Function& func);
 #if defined(DEBUG)
   void VerifyScriptTable();
 #endif
@@ -108,6 +112,31 @@ class SourceReport {
     }
   };
 
+  // The block coverage counter arrays of a function, see BlockCoverage.
+  struct BlockCoverageEntry : public ZoneAllocated {
+    BlockCoverageEntry() : key(NULL), arrays(NULL) {}
+
+    const Function* key;
+    ZoneGrowableArray<const Array*>* arrays;
+  };
+
+  // Needed for DirectChainedHashMap.
+  struct BlockCoverageTrait {
+    typedef BlockCoverageEntry* Value;
+    typedef const Function* Key;
+    typedef BlockCoverageEntry* Pair;
+
+    static Key KeyOf(Pair kv) { return kv->key; }
+
+    static Value ValueOf(Pair kv) { return kv; }
+
+    static inline intptr_t Hashcode(Key key) { return key->Hash(); }
+
+    static inline bool IsKeyEqual(Pair kv, Key key) {
+      return kv->key->raw() == key->raw();
+    }
+  };
+
   intptr_t report_set_;
   CompileMode compile_mode_;
   Thread* thread_;
@@ -118,6 +147,7 @@ class SourceReport {
   GrowableArray<ScriptTableEntry*> script_table_entries_;
   DirectChainedHashMap<ScriptTableTrait> script_table_;
   intptr_t next_script_index_;
+  DirectChainedHashMap<BlockCoverageTrait> block_coverage_table_;
 };
 
 }  // namespace dart
@@ -3,13 +3,19 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "vm/source_report.h"
+#include "vm/compiler/backend/block_coverage.h"
+#include "vm/compiler/jit/compiler.h"
 #include "vm/dart_api_impl.h"
+#include "vm/object_store.h"
+#include "vm/symbols.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
 #ifndef PRODUCT
 
+DECLARE_FLAG(bool, enable_inlining_annotations);
+
 static RawObject* ExecuteScript(const char* script) {
   TransitionVMToNative transition(Thread::Current());
   Dart_Handle h_lib = TestCase::LoadTestScript(script, NULL);
@@ -667,6 +673,176 @@ ISOLATE_UNIT_TEST_CASE(SourceReport_PossibleBreakpoints_Simple) {
       buffer);
 }
 
+#if !defined(TARGET_ARCH_DBC)
+ISOLATE_UNIT_TEST_CASE(SourceReport_BlockCoverage) {
+  SetFlagScope<bool> sfs(&FLAG_block_coverage, true);
+  char buffer[1024];
+  const char* kScript =
+      "helper0() {}\n"
+      "helper1() {}\n"
+      "main() {\n"
+      "  if (true) {\n"
+      "    helper0();\n"
+      "  } else {\n"
+      "    helper1();\n"
+      "  }\n"
+      "}";
+
+  Library& lib = Library::Handle();
+  lib ^= ExecuteScript(kScript);
+  ASSERT(!lib.IsNull());
+  const Script& script =
+      Script::Handle(lib.LookupScript(String::Handle(String::New("test-lib"))));
+
+  SourceReport report(SourceReport::kBlockCoverage);
+  JSONStream js;
+  report.PrintJSON(&js, script);
+  ElideJSONSubstring("classes", js.ToCString(), buffer);
+  ElideJSONSubstring("libraries", buffer, buffer);
+
+  // One range not compiled (helper1).
+  EXPECT_SUBSTRING(
+      "{\"scriptIndex\":0,\"startPos\":6,\"endPos\":10,\"compiled\":false}",
+      buffer);
+  // The call to helper0 was counted, the block calling helper1 was not (main).
+  EXPECT_SUBSTRING(
+      "{\"scriptIndex\":0,\"startPos\":12,\"endPos\":39,\"compiled\":true,"
+      "\"blockCoverage\":{\"hits\":[",
+      buffer);
+  EXPECT_SUBSTRING("\"misses\":[32]}}", buffer);
+}
+
+ISOLATE_UNIT_TEST_CASE(SourceReport_BlockCoverageRecompile) {
+  SetFlagScope<bool> sfs(&FLAG_block_coverage, true);
+  char buffer[1024];
+  const char* kScript =
+      "helper0() {}\n"
+      "helper1() {}\n"
+      "main() {\n"
+      "  if (true) {\n"
+      "    helper0();\n"
+      "  } else {\n"
+      "    helper1();\n"
+      "  }\n"
+      "}";
+
+  Library& lib = Library::Handle();
+  lib ^= ExecuteScript(kScript);
+  ASSERT(!lib.IsNull());
+  const Script& script =
+      Script::Handle(lib.LookupScript(String::Handle(String::New("test-lib"))));
+  const Function& main = Function::Handle(
+      lib.LookupLocalFunction(String::Handle(Symbols::New(thread, "main"))));
+  ASSERT(!main.IsNull());
+
+  // Every recompilation replaces the counters of the previous code instead of
+  // adding to the registry, and keeps their counts.
+  const GrowableObjectArray& registry = GrowableObjectArray::Handle(
+      thread->isolate()->object_store()->block_coverage_arrays());
+  ASSERT(!registry.IsNull());
+  const intptr_t registered = registry.Length();
+  for (intptr_t i = 0; i < 3; i++) {
+    main.ClearCode();
+    EXPECT(Compiler::EnsureUnoptimizedCode(thread, main) == Error::null());
+    EXPECT_EQ(registered, registry.Length());
+  }
+
+  SourceReport report(SourceReport::kBlockCoverage);
+  JSONStream js;
+  report.PrintJSON(&js, script);
+  ElideJSONSubstring("classes", js.ToCString(), buffer);
+  ElideJSONSubstring("libraries", buffer, buffer);
+
+  EXPECT_SUBSTRING(
+      "{\"scriptIndex\":0,\"startPos\":12,\"endPos\":39,\"compiled\":true,"
+      "\"blockCoverage\":{\"hits\":[",
+      buffer);
+  EXPECT(strstr(buffer, "\"hits\":[]") == NULL);
+  EXPECT_SUBSTRING("\"misses\":[32]}}", buffer);
+}
+
+ISOLATE_UNIT_TEST_CASE(SourceReport_BlockCoverageOptimized) {
+  SetFlagScope<bool> sfs(&FLAG_block_coverage, true);
+  SetFlagScope<bool> sfs2(&FLAG_background_compilation, false);
+  SetFlagScope<bool> sfs3(&FLAG_enable_inlining_annotations, true);
+  // Optimize quickly.
+  SetFlagScope<int> sfs4(&FLAG_optimization_counter_threshold, 100);
+  char buffer[4096];
+  const char* kScript =
+      "const AlwaysInline = 'AlwaysInline';\n"
+      "@AlwaysInline\n"
+      "helper(int i) {\n"
+      "  if (i < 0) {\n"
+      "    return -i;\n"
+      "  }\n"
+      "  return i;\n"
+      "}\n"
+      "loop(int n) {\n"
+      "  var sum = 0;\n"
+      "  for (var i = 0; i < n; i++) {\n"
+      "    sum += helper(i);\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n"
+      "main() {\n"
+      "  for (var i = 0; i < 1000; i++) {\n"
+      "    loop(10);\n"
+      "  }\n"
+      "}";
+
+  Library& lib = Library::Handle();
+  lib ^= ExecuteScript(kScript);
+  ASSERT(!lib.IsNull());
+  const Script& script =
+      Script::Handle(lib.LookupScript(String::Handle(String::New("test-lib"))));
+  const Function& loop = Function::Handle(
+      lib.LookupLocalFunction(String::Handle(Symbols::New(thread, "loop"))));
+  const Function& helper = Function::Handle(
+      lib.LookupLocalFunction(String::Handle(Symbols::New(thread, "helper"))));
+  ASSERT(!loop.IsNull() && !helper.IsNull());
+  EXPECT(loop.HasOptimizedCode());
+
+  // The counters of helper that were inlined into optimized code were
+  // incremented by that code.
+  const GrowableObjectArray& registry = GrowableObjectArray::Handle(
+      thread->isolate()->object_store()->block_coverage_arrays());
+  ASSERT(!registry.IsNull());
+  const Smi& unoptimized =
+      Smi::Handle(Smi::New(BlockCoverage::kUnoptimizedCode));
+  Array& counters = Array::Handle();
+  Object& count = Object::Handle();
+  bool inlined_hit = false;
+  for (intptr_t i = 0; i < registry.Length(); i++) {
+    counters ^= registry.At(i);
+    if ((counters.At(BlockCoverage::kFunctionIndex) != helper.raw()) ||
+        (counters.At(BlockCoverage::kOwnerIndex) == helper.raw()) ||
+        (counters.At(BlockCoverage::kCodeKindIndex) == unoptimized.raw())) {
+      continue;
+    }
+    const intptr_t block_count = BlockCoverage::BlockCount(counters.Length());
+    for (intptr_t block = 0; block < block_count; block++) {
+      count = counters.At(BlockCoverage::CountIndex(block));
+      if (!count.IsNull() && (Smi::Cast(count).Value() > 0)) {
+        inlined_hit = true;
+      }
+    }
+  }
+  EXPECT(inlined_hit);
+
+  // Without code of its own, helper is still reported from its counters.
+  helper.ClearCode();
+  SourceReport report(SourceReport::kBlockCoverage);
+  JSONStream js;
+  report.PrintJSON(&js, script);
+  ElideJSONSubstring("classes", js.ToCString(), buffer);
+  ElideJSONSubstring("libraries", buffer, buffer);
+
+  EXPECT(strstr(buffer, "\"compiled\":false") == NULL);
+  EXPECT(strstr(buffer, "\"hits\":[]") == NULL);
+  EXPECT_SUBSTRING("\"blockCoverage\":{\"hits\":[", buffer);
+}
+#endif  // !defined(TARGET_ARCH_DBC)
+
 #endif  // !PRODUCT
 
 }  // namespace dart
@@ -53,7 +53,12 @@ DEFINE_FLAG(charp,
             timeline_recorder,
             "ring",
             "Select the timeline recorder used. "
-            "Valid values: ring, endless, startup, and systrace.")
+            "Valid values: ring, endless, startup, systrace, and file.")
+DEFINE_FLAG(charp,
+            timeline_file,
+            NULL,
+            "File the file timeline recorder writes to. Defaults to "
+            "dart-timeline-<pid>.dtl in the current directory.");
 
 // Implementation notes:
 //
@@ -66,6 +71,12 @@ DEFINE_FLAG(charp,
 // when operating on the |TimelineEventBlock|. This lock will only ever be
 // busy if blocks are being reclaimed by the reporting system.
 //
+// When its block is full, a |Thread| finishes it and claims a new one without
+// taking any shared lock: a block is claimed by atomically moving it from
+// |kIdle| to |kWriting|. The fixed buffer recorders advance an atomic cursor
+// and skip blocks that are being written or read; the endless recorder pushes
+// newly allocated blocks onto its list with a compare-and-swap.
+//
 // Reporting:
 // When requested, the timeline is serialized in the trace-event format
 // (https://goo.gl/hDZw5M). The request can be for a VM-wide timeline or an
@@ -82,10 +93,15 @@ DEFINE_FLAG(charp,
 // |TimelineEventBlock| from each thread. This is safe because we hold the
 // |Thread|'s |timeline_block_lock_| meaning the block can't be being modified.
 //
+// Reading blocks:
+// The reporting system claims each block it reads by moving it from |kIdle| to
+// |kReading|, and releases it afterwards. Blocks that are being written are
+// skipped. While a block is being read it is not handed out to writers.
+//
 // Locking notes:
 // The following locks are used by the timeline system:
-// - |TimelineEventRecorder::lock_| This lock is held whenever a
-// |TimelineEventBlock| is being requested or reclaimed.
+// - |TimelineEventRecorder::lock_| This lock is held whenever blocks are
+// being reported or cleared. It is never taken when writing events.
 // - |Thread::timeline_block_lock_| This lock is held whenever a |Thread|'s
 // cached block is being operated on.
 // - |Thread::thread_list_lock_| This lock is held when iterating over
@@ -126,6 +142,20 @@ static TimelineEventRecorder* CreateTimelineRecorder() {
     }
   }
 
+  if ((flag != NULL) && (strcmp("file", flag) == 0)) {
+    if (FLAG_trace_timeline) {
+      THR_Print("Using the file timeline recorder.\n");
+    }
+    if (FLAG_timeline_file != NULL) {
+      return new TimelineEventFileRecorder(FLAG_timeline_file);
+    }
+    char* path = OS::SCreate(NULL, "dart-timeline-%" Pd ".dtl",
+                             static_cast<intptr_t>(OS::ProcessId()));
+    TimelineEventRecorder* recorder = new TimelineEventFileRecorder(path);
+    free(path);
+    return recorder;
+  }
+
   if (use_endless_recorder || (flag != NULL)) {
     if (use_endless_recorder || (strcmp("endless", flag) == 0)) {
       if (FLAG_trace_timeline) {
@@ -1029,17 +1059,15 @@ TimelineEvent* TimelineEventRecorder::ThreadBlockStartEvent() {
   TimelineEventBlock* thread_block = thread->timeline_block();
 
   if ((thread_block != NULL) && thread_block->IsFull()) {
-    MutexLocker ml(&lock_);
     // Thread has a block and it is full:
     // 1) Mark it as finished.
     thread_block->Finish();
     // 2) Allocate a new block.
-    thread_block = GetNewBlockLocked();
+    thread_block = AcquireNewBlock();
     thread->set_timeline_block(thread_block);
   } else if (thread_block == NULL) {
-    MutexLocker ml(&lock_);
     // Thread has no block. Attempt to allocate one.
-    thread_block = GetNewBlockLocked();
+    thread_block = AcquireNewBlock();
     thread->set_timeline_block(thread_block);
   }
   if (thread_block != NULL) {
@@ -1105,6 +1133,56 @@ void TimelineEventRecorder::ThreadBlockCompleteEvent(TimelineEvent* event) {
   thread_block_lock->Unlock();
 }
 
+static int TimelineEventBlockCompare(TimelineEventBlock* const* a,
+                                     TimelineEventBlock* const* b) {
+  const int64_t a_time = (*a)->LowerTimeBound();
+  const int64_t b_time = (*b)->LowerTimeBound();
+  if (a_time < b_time) {
+    return -1;
+  }
+  if (a_time > b_time) {
+    return 1;
+  }
+  return 0;
+}
+
+void TimelineEventRecorder::PrintJSONBlocks(
+    JSONArray* events,
+    TimelineEventFilter* filter,
+    MallocGrowableArray<TimelineEventBlock*>* blocks) {
+  // Release the empty blocks, which have no time bounds to sort by.
+  intptr_t length = 0;
+  for (intptr_t block_idx = 0; block_idx < blocks->length(); block_idx++) {
+    TimelineEventBlock* block = blocks->At(block_idx);
+    if (block->IsEmpty()) {
+      block->TryTransition(TimelineEventBlock::kReading,
+                           TimelineEventBlock::kIdle);
+    } else {
+      (*blocks)[length++] = block;
+    }
+  }
+  blocks->TruncateTo(length);
+  // Sort the blocks so that blocks with earlier events are outputted first.
+  blocks->Sort(TimelineEventBlockCompare);
+  for (intptr_t block_idx = 0; block_idx < blocks->length(); block_idx++) {
+    TimelineEventBlock* block = blocks->At(block_idx);
+    if (filter->IncludeBlock(block)) {
+      for (intptr_t i = 0; i < block->length(); i++) {
+        TimelineEvent* event = block->At(i);
+        if (filter->IncludeEvent(event) &&
+            event->Within(filter->time_origin_micros(),
+                          filter->time_extent_micros())) {
+          ReportTime(event->LowTime());
+          ReportTime(event->HighTime());
+          events->AddValue(event);
+        }
+      }
+    }
+    block->TryTransition(TimelineEventBlock::kReading,
+                         TimelineEventBlock::kIdle);
+  }
+}
+
 void TimelineEventRecorder::WriteTo(const char* directory) {
   if (!FLAG_support_service) {
     return;
@@ -1156,13 +1234,11 @@ void TimelineEventRecorder::FinishBlock(TimelineEventBlock* block) {
   if (block == NULL) {
     return;
   }
-  MutexLocker ml(&lock_);
   block->Finish();
 }
 
 TimelineEventBlock* TimelineEventRecorder::GetNewBlock() {
-  MutexLocker ml(&lock_);
-  return GetNewBlockLocked();
+  return AcquireNewBlock();
 }
 
 TimelineEventFixedBufferRecorder::TimelineEventFixedBufferRecorder(
@@ -1203,28 +1279,16 @@ void TimelineEventFixedBufferRecorder::PrintJSONEvents(
   }
   MutexLocker ml(&lock_);
   ResetTimeTracking();
-  intptr_t block_offset = FindOldestBlockIndex();
-  if (block_offset == -1) {
-    // All blocks are empty.
-    return;
-  }
+  // Claim every block that is not being written.
+  MallocGrowableArray<TimelineEventBlock*> blocks(num_blocks_);
   for (intptr_t block_idx = 0; block_idx < num_blocks_; block_idx++) {
-    TimelineEventBlock* block =
-        &blocks_[(block_idx + block_offset) % num_blocks_];
-    if (!filter->IncludeBlock(block)) {
-      continue;
-    }
-    for (intptr_t event_idx = 0; event_idx < block->length(); event_idx++) {
-      TimelineEvent* event = block->At(event_idx);
-      if (filter->IncludeEvent(event) &&
-          event->Within(filter->time_origin_micros(),
-                        filter->time_extent_micros())) {
-        ReportTime(event->LowTime());
-        ReportTime(event->HighTime());
-        events->AddValue(event);
-      }
+    TimelineEventBlock* block = &blocks_[block_idx];
+    if (block->TryTransition(TimelineEventBlock::kIdle,
+                             TimelineEventBlock::kReading)) {
+      blocks.Add(block);
     }
   }
+  PrintJSONBlocks(events, filter, &blocks);
 }
 
 void TimelineEventFixedBufferRecorder::PrintJSON(JSONStream* js,
@@ -1262,25 +1326,14 @@ void TimelineEventFixedBufferRecorder::Clear() {
   MutexLocker ml(&lock_);
   for (intptr_t i = 0; i < num_blocks_; i++) {
     TimelineEventBlock* block = &blocks_[i];
-    block->Reset();
-  }
-}
-
-intptr_t TimelineEventFixedBufferRecorder::FindOldestBlockIndex() const {
-  int64_t earliest_time = kMaxInt64;
-  intptr_t earliest_index = -1;
-  for (intptr_t block_idx = 0; block_idx < num_blocks_; block_idx++) {
-    TimelineEventBlock* block = &blocks_[block_idx];
-    if (block->IsEmpty()) {
-      // Skip empty blocks.
-      continue;
-    }
-    if (block->LowerTimeBound() < earliest_time) {
-      earliest_time = block->LowerTimeBound();
-      earliest_index = block_idx;
+    // Blocks that are being written are left to their threads.
+    if (block->TryTransition(TimelineEventBlock::kIdle,
+                             TimelineEventBlock::kReading)) {
+      block->Reset();
+      block->TryTransition(TimelineEventBlock::kReading,
+                           TimelineEventBlock::kIdle);
     }
   }
-  return earliest_index;
 }
 
 TimelineEvent* TimelineEventFixedBufferRecorder::StartEvent() {
@@ -1294,26 +1347,38 @@ void TimelineEventFixedBufferRecorder::CompleteEvent(TimelineEvent* event) {
   ThreadBlockCompleteEvent(event);
 }
 
-TimelineEventBlock* TimelineEventRingRecorder::GetNewBlockLocked() {
-  // TODO(johnmccutchan): This function should only hand out blocks
-  // which have been marked as finished.
-  if (block_cursor_ == num_blocks_) {
-    block_cursor_ = 0;
+TimelineEventBlock* TimelineEventRingRecorder::AcquireNewBlock() {
+  // Only hand out blocks which have been marked as finished. If every block
+  // is being written or read, the event is dropped.
+  for (intptr_t attempt = 0; attempt < num_blocks_; attempt++) {
+    uintptr_t cursor = AtomicOperations::FetchAndIncrement(&block_cursor_);
+    TimelineEventBlock* block = &blocks_[cursor % num_blocks_];
+    if (block->TryTransition(TimelineEventBlock::kIdle,
+                             TimelineEventBlock::kWriting)) {
+      block->Reset();
+      block->Open();
+      return block;
+    }
   }
-  TimelineEventBlock* block = &blocks_[block_cursor_++];
-  block->Reset();
-  block->Open();
-  return block;
+  return NULL;
 }
 
-TimelineEventBlock* TimelineEventStartupRecorder::GetNewBlockLocked() {
-  if (block_cursor_ == num_blocks_) {
-    return NULL;
+TimelineEventBlock* TimelineEventStartupRecorder::AcquireNewBlock() {
+  while (true) {
+    uintptr_t cursor = AtomicOperations::FetchAndIncrement(&block_cursor_);
+    if (cursor >= static_cast<uintptr_t>(num_blocks_)) {
+      return NULL;
+    }
+    // The block can only be claimed by the exporter, which only ever reads
+    // it while it is empty. Move on to the next one.
+    TimelineEventBlock* block = &blocks_[cursor];
+    if (block->TryTransition(TimelineEventBlock::kIdle,
+                             TimelineEventBlock::kWriting)) {
+      block->Reset();
+      block->Open();
+      return block;
+    }
   }
-  TimelineEventBlock* block = &blocks_[block_cursor_++];
-  block->Reset();
-  block->Open();
-  return block;
 }
 
 TimelineEventCallbackRecorder::TimelineEventCallbackRecorder() {}
@@ -1388,6 +1453,214 @@ void TimelineEventPlatformRecorder::CompleteEvent(TimelineEvent* event) {
   delete event;
 }
 
+intptr_t TimelineEventBinaryEncoder::InternedStringTrait::Hashcode(Key key) {
+  // FNV-1a.
+  uint32_t hash = 2166136261u;
+  for (const char* c = key; *c != '\0'; c++) {
+    hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+  }
+  return static_cast<intptr_t>(hash);
+}
+
+bool TimelineEventBinaryEncoder::InternedStringTrait::IsKeyEqual(Pair kv,
+                                                                 Key key) {
+  return strcmp(kv.key, key) == 0;
+}
+
+TimelineEventBinaryEncoder::TimelineEventBinaryEncoder()
+    : buffer_(NULL), length_(0), capacity_(0), last_timestamp_(0) {
+  WriteBytes("DTLB", 4);
+  WriteUnsigned(kVersion);
+  WriteUnsigned(static_cast<uint64_t>(OS::ProcessId()));
+}
+
+TimelineEventBinaryEncoder::~TimelineEventBinaryEncoder() {
+  MallocDirectChainedHashMap<InternedStringTrait>::Iterator it =
+      strings_.GetIterator();
+  InternedStringTrait::Pair* pair;
+  while ((pair = it.Next()) != NULL) {
+    free(const_cast<char*>(pair->key));
+  }
+  free(buffer_);
+}
+
+void TimelineEventBinaryEncoder::EnsureCapacity(intptr_t needed) {
+  if (length_ + needed <= capacity_) {
+    return;
+  }
+  intptr_t new_capacity = Utils::Maximum(capacity_ * 2, length_ + needed);
+  new_capacity = Utils::Maximum(new_capacity, static_cast<intptr_t>(KB));
+  buffer_ = reinterpret_cast<uint8_t*>(realloc(buffer_, new_capacity));
+  capacity_ = new_capacity;
+}
+
+void TimelineEventBinaryEncoder::WriteBytes(const void* bytes,
+                                            intptr_t length) {
+  EnsureCapacity(length);
+  memmove(buffer_ + length_, bytes, length);
+  length_ += length;
+}
+
+void TimelineEventBinaryEncoder::WriteUnsigned(uint64_t value) {
+  EnsureCapacity(10);
+  do {
+    uint8_t byte = value & 0x7F;
+    value >>= 7;
+    if (value != 0) {
+      byte |= 0x80;
+    }
+    buffer_[length_++] = byte;
+  } while (value != 0);
+}
+
+void TimelineEventBinaryEncoder::WriteSigned(int64_t value) {
+  // Zigzag encoding, so small negative values stay small.
+  WriteUnsigned((static_cast<uint64_t>(value) << 1) ^
+                static_cast<uint64_t>(value >> 63));
+}
+
+intptr_t TimelineEventBinaryEncoder::Intern(const char* string) {
+  if (string == NULL) {
+    return 0;
+  }
+  intptr_t id = strings_.LookupValue(string);
+  if (id != 0) {
+    return id;
+  }
+  const intptr_t length = strlen(string);
+  if ((strings_.Size() >= kMaxInternedStrings) ||
+      (length > kMaxInternedStringLength)) {
+    return 0;
+  }
+  id = strings_.Size() + 1;
+  strings_.Insert(InternedStringTrait::Pair(strdup(string), id));
+  WriteUnsigned(kStringTag);
+  WriteUnsigned(id);
+  WriteUnsigned(length);
+  WriteBytes(string, length);
+  return id;
+}
+
+void TimelineEventBinaryEncoder::WriteStringRef(const char* string) {
+  const intptr_t id = (string == NULL) ? 0 : strings_.LookupValue(string);
+  WriteUnsigned(id);
+  if (id == 0) {
+    const intptr_t length = (string == NULL) ? 0 : strlen(string);
+    WriteUnsigned(length);
+    WriteBytes(string, length);
+  }
+}
+
+void TimelineEventBinaryEncoder::Encode(TimelineEvent* event) {
+  const bool pre_serialized_args = event->pre_serialized_args();
+  const intptr_t num_arguments = event->arguments_length();
+
+  // Define new strings before the event refers to them.
+  Intern(event->label());
+  Intern(event->category());
+  if (!pre_serialized_args) {
+    for (intptr_t i = 0; i < num_arguments; i++) {
+      Intern(event->arguments()[i].name);
+    }
+  }
+
+  intptr_t flags = 0;
+  if (event->HasThreadCPUTime()) {
+    flags |= kHasThreadCPUTimeFlag;
+  }
+  if (event->isolate_id() != ILLEGAL_PORT) {
+    flags |= kHasIsolateFlag;
+  }
+  if (pre_serialized_args) {
+    flags |= kPreSerializedArgsFlag;
+  }
+  const TimelineEvent::EventType type = event->event_type();
+  WriteUnsigned(kEventTag);
+  WriteUnsigned(type);
+  WriteUnsigned(flags);
+  WriteStringRef(event->label());
+  WriteStringRef(event->category());
+  WriteUnsigned(
+      static_cast<uint64_t>(OSThread::ThreadIdToIntPtr(event->thread())));
+  WriteSigned(event->TimeOrigin() - last_timestamp_);
+  last_timestamp_ = event->TimeOrigin();
+  switch (type) {
+    case TimelineEvent::kDuration:
+      WriteUnsigned(event->TimeDuration());
+      break;
+    case TimelineEvent::kAsyncBegin:
+    case TimelineEvent::kAsyncInstant:
+    case TimelineEvent::kAsyncEnd:
+    case TimelineEvent::kFlowBegin:
+    case TimelineEvent::kFlowStep:
+    case TimelineEvent::kFlowEnd:
+      WriteUnsigned(static_cast<uint64_t>(event->AsyncId()));
+      break;
+    default:
+      break;
+  }
+  if ((flags & kHasThreadCPUTimeFlag) != 0) {
+    WriteSigned(event->ThreadCPUTimeOrigin());
+    if (type == TimelineEvent::kDuration) {
+      WriteUnsigned(event->ThreadCPUTimeDuration());
+    }
+  }
+  if ((flags & kHasIsolateFlag) != 0) {
+    WriteUnsigned(static_cast<uint64_t>(event->isolate_id()));
+  }
+  WriteUnsigned(num_arguments);
+  for (intptr_t i = 0; i < num_arguments; i++) {
+    const TimelineEventArgument& argument = event->arguments()[i];
+    WriteStringRef(pre_serialized_args ? NULL : argument.name);
+    const intptr_t length = strlen(argument.value);
+    WriteUnsigned(length);
+    WriteBytes(argument.value, length);
+  }
+}
+
+TimelineEventFileRecorder::TimelineEventFileRecorder(const char* path)
+    : file_(NULL) {
+  Dart_FileOpenCallback file_open = Dart::file_open_callback();
+  if ((file_open == NULL) || (Dart::file_write_callback() == NULL) ||
+      (Dart::file_close_callback() == NULL)) {
+    OS::PrintErr("Failed to open timeline file: %s\n", path);
+    return;
+  }
+  file_ = (*file_open)(path, true);
+  if (file_ == NULL) {
+    OS::PrintErr("Failed to open timeline file: %s\n", path);
+  }
+}
+
+TimelineEventFileRecorder::~TimelineEventFileRecorder() {
+  MutexLocker ml(&encoder_lock_);
+  if (file_ != NULL) {
+    FlushLocked();
+    (*Dart::file_close_callback())(file_);
+    file_ = NULL;
+  }
+}
+
+void TimelineEventFileRecorder::OnEvent(TimelineEvent* event) {
+  if (event == NULL) {
+    return;
+  }
+  MutexLocker ml(&encoder_lock_);
+  if (file_ == NULL) {
+    return;
+  }
+  encoder_.Encode(event);
+  if (encoder_.length() >= kFlushThreshold) {
+    FlushLocked();
+  }
+}
+
+void TimelineEventFileRecorder::FlushLocked() {
+  ASSERT(encoder_lock_.IsOwnedByCurrentThread());
+  (*Dart::file_write_callback())(encoder_.buffer(), encoder_.length(), file_);
+  encoder_.Clear();
+}
+
 TimelineEventEndlessRecorder::TimelineEventEndlessRecorder()
     : head_(NULL), block_index_(0) {}
 
@@ -1430,7 +1703,7 @@ void TimelineEventEndlessRecorder::PrintTraceEvent(
 }
 
 TimelineEventBlock* TimelineEventEndlessRecorder::GetHeadBlockLocked() {
-  return head_;
+  return AtomicOperations::LoadAcquire(&head_);
 }
 
 TimelineEvent* TimelineEventEndlessRecorder::StartEvent() {
@@ -1444,20 +1717,26 @@ void TimelineEventEndlessRecorder::CompleteEvent(TimelineEvent* event) {
   ThreadBlockCompleteEvent(event);
 }
 
-TimelineEventBlock* TimelineEventEndlessRecorder::GetNewBlockLocked() {
-  TimelineEventBlock* block = new TimelineEventBlock(block_index_++);
-  block->set_next(head_);
+TimelineEventBlock* TimelineEventEndlessRecorder::AcquireNewBlock() {
+  TimelineEventBlock* block = new TimelineEventBlock(
+      AtomicOperations::FetchAndIncrement(&block_index_));
+  // Not yet visible to other threads.
+  block->state_ = TimelineEventBlock::kWriting;
   block->Open();
-  head_ = block;
+  PushBlock(block);
   if (FLAG_trace_timeline) {
     OS::PrintErr("Created new block %p\n", block);
   }
-  return head_;
+  return block;
 }
 
-static int TimelineEventBlockCompare(TimelineEventBlock* const* a,
-                                     TimelineEventBlock* const* b) {
-  return (*a)->LowerTimeBound() - (*b)->LowerTimeBound();
+void TimelineEventEndlessRecorder::PushBlock(TimelineEventBlock* block) {
+  TimelineEventBlock* head;
+  do {
+    head = AtomicOperations::LoadRelaxed(&head_);
+    block->set_next(head);
+  } while (AtomicOperations::CompareAndSwapPointer(&head_, head, block) !=
+           head);
 }
 
 void TimelineEventEndlessRecorder::PrintJSONEvents(
@@ -1468,50 +1747,39 @@ void TimelineEventEndlessRecorder::PrintJSONEvents(
   }
   MutexLocker ml(&lock_);
   ResetTimeTracking();
-  // Collect all interesting blocks.
+  // Claim all blocks that are not being written. Blocks pushed after this
+  // point are not reported.
   MallocGrowableArray<TimelineEventBlock*> blocks(8);
-  TimelineEventBlock* current = head_;
+  TimelineEventBlock* current = AtomicOperations::LoadAcquire(&head_);
   while (current != NULL) {
-    if (filter->IncludeBlock(current)) {
+    if (current->TryTransition(TimelineEventBlock::kIdle,
+                               TimelineEventBlock::kReading)) {
       blocks.Add(current);
     }
     current = current->next();
   }
-  // Bail early.
-  if (blocks.length() == 0) {
-    return;
-  }
-  // Sort the interesting blocks so that blocks with earlier events are
-  // outputted first.
-  blocks.Sort(TimelineEventBlockCompare);
-  // Output blocks in sorted order.
-  for (intptr_t block_idx = 0; block_idx < blocks.length(); block_idx++) {
-    current = blocks[block_idx];
-    intptr_t length = current->length();
-    for (intptr_t i = 0; i < length; i++) {
-      TimelineEvent* event = current->At(i);
-      if (filter->IncludeEvent(event) &&
-          event->Within(filter->time_origin_micros(),
-                        filter->time_extent_micros())) {
-        ReportTime(event->LowTime());
-        ReportTime(event->HighTime());
-        events->AddValue(event);
-      }
-    }
-  }
+  PrintJSONBlocks(events, filter, &blocks);
 }
 
 void TimelineEventEndlessRecorder::Clear() {
-  TimelineEventBlock* current = head_;
+  MutexLocker ml(&lock_);
+  // Detach the list. Threads may keep pushing new blocks meanwhile.
+  TimelineEventBlock* current;
+  do {
+    current = AtomicOperations::LoadRelaxed(&head_);
+  } while (AtomicOperations::CompareAndSwapPointer<TimelineEventBlock>(
+               &head_, current, NULL) != current);
   while (current != NULL) {
     TimelineEventBlock* next = current->next();
-    delete current;
+    if (current->TryTransition(TimelineEventBlock::kIdle,
+                               TimelineEventBlock::kReading)) {
+      delete current;
+    } else {
+      // Still owned by the thread writing to it.
+      PushBlock(current);
+    }
     current = next;
   }
-  head_ = NULL;
-  block_index_ = 0;
-  OSThread* thread = OSThread::Current();
-  thread->set_timeline_block(NULL);
 }
 
 TimelineEventBlock::TimelineEventBlock(intptr_t block_index)
@@ -1519,7 +1787,7 @@ TimelineEventBlock::TimelineEventBlock(intptr_t block_index)
       length_(0),
       block_index_(block_index),
       thread_id_(OSThread::kInvalidThreadId),
-      in_use_(false) {}
+      state_(kIdle) {}
 
 TimelineEventBlock::~TimelineEventBlock() {
   Reset();
@@ -1583,25 +1851,28 @@ void TimelineEventBlock::Reset() {
   }
   length_ = 0;
   thread_id_ = OSThread::kInvalidThreadId;
-  in_use_ = false;
 }
 
 void TimelineEventBlock::Open() {
+  ASSERT(in_use());
   OSThread* os_thread = OSThread::Current();
   ASSERT(os_thread != NULL);
   thread_id_ = os_thread->trace_id();
-  in_use_ = true;
 }
 
 void TimelineEventBlock::Finish() {
   if (FLAG_trace_timeline) {
     OS::PrintErr("Finish block %p\n", this);
   }
-  in_use_ = false;
   if (Service::timeline_stream.enabled()) {
+    // Keep the block from being reused while it is being sent.
+    TryTransition(kWriting, kReading);
     ServiceEvent service_event(NULL, ServiceEvent::kTimelineEvents);
     service_event.set_timeline_event_block(this);
     Service::HandleEvent(&service_event);
+    TryTransition(kReading, kIdle);
+  } else {
+    TryTransition(kWriting, kIdle);
   }
 }
 
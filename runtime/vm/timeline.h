@@ -7,9 +7,11 @@
 
 #include "include/dart_tools_api.h"
 
+#include "platform/atomic.h"
 #include "vm/allocation.h"
 #include "vm/bitfield.h"
 #include "vm/growable_array.h"
+#include "vm/hash_map.h"
 #include "vm/os.h"
 #include "vm/os_thread.h"
 
@@ -321,6 +323,8 @@ class TimelineEvent {
 
   const char* label() const { return label_; }
 
+  const char* category() const { return category_; }
+
   // Does this duration end before |micros| ?
   bool DurationFinishedBefore(int64_t micros) const {
     return TimeEnd() <= micros;
@@ -442,6 +446,7 @@ class TimelineEvent {
   friend class TimelineEventStartupRecorder;
   friend class TimelineEventPlatformRecorder;
   friend class TimelineEventFuchsiaRecorder;
+  friend class TimelineEventBinaryEncoder;
   friend class TimelineStream;
   friend class TimelineTestHelper;
   DISALLOW_COPY_AND_ASSIGN(TimelineEvent);
@@ -549,11 +554,23 @@ class TimelineBeginEndScope : public TimelineEventScope {
   DISALLOW_COPY_AND_ASSIGN(TimelineBeginEndScope);
 };
 
-// A block of |TimelineEvent|s. Not thread safe.
+// A block of |TimelineEvent|s. A block is written by at most one thread at a
+// time. Writers and readers claim a block by atomically moving it out of
+// |kIdle|, so neither needs to take the recorder's lock.
 class TimelineEventBlock {
  public:
   static const intptr_t kBlockSize = 64;
 
+  enum State {
+    // Empty or finished. May be claimed by a writer or a reader. Zero, so
+    // that blocks in zeroed memory start out idle.
+    kIdle = 0,
+    // Owned by the thread appending events to it.
+    kWriting,
+    // Being read by the exporter.
+    kReading,
+  };
+
   explicit TimelineEventBlock(intptr_t index);
   ~TimelineEventBlock();
 
@@ -591,8 +608,9 @@ class TimelineEventBlock {
   // Call Reset on all events and set length to 0.
   void Reset();
 
-  // Only safe to access under the recorder's lock.
-  bool in_use() const { return in_use_; }
+  bool in_use() const {
+    return AtomicOperations::LoadRelaxed(&state_) == kWriting;
+  }
 
   // Only safe to access under the recorder's lock.
   ThreadId thread_id() const { return thread_id_; }
@@ -607,9 +625,15 @@ class TimelineEventBlock {
   intptr_t length_;
   intptr_t block_index_;
 
-  // Only accessed under the recorder's lock.
+  // Only accessed by the thread that has claimed the block.
   ThreadId thread_id_;
-  bool in_use_;
+  uword state_;
+
+  // Atomically moves the block from state [from] to [to]. Returns false if
+  // the block was not in state [from].
+  bool TryTransition(State from, State to) {
+    return AtomicOperations::CompareAndSwapWord(&state_, from, to) == from;
+  }
 
   void Open();
   void Finish();
@@ -617,6 +641,7 @@ class TimelineEventBlock {
   friend class Thread;
   friend class TimelineEventRecorder;
   friend class TimelineEventEndlessRecorder;
+  friend class TimelineEventFixedBufferRecorder;
   friend class TimelineEventRingRecorder;
   friend class TimelineEventStartupRecorder;
   friend class TimelineEventPlatformRecorder;
@@ -703,13 +728,20 @@ class TimelineEventRecorder {
   virtual TimelineEvent* StartEvent() = 0;
   virtual void CompleteEvent(TimelineEvent* event) = 0;
   virtual TimelineEventBlock* GetHeadBlockLocked() = 0;
-  virtual TimelineEventBlock* GetNewBlockLocked() = 0;
+  // Returns a block claimed for writing by the current thread, or NULL.
+  // Must not take |lock_|.
+  virtual TimelineEventBlock* AcquireNewBlock() = 0;
   virtual void Clear() = 0;
 
   // Utility method(s).
   void PrintJSONMeta(JSONArray* array) const;
   TimelineEvent* ThreadBlockStartEvent();
   void ThreadBlockCompleteEvent(TimelineEvent* event);
+  // Prints the events of [blocks], which the caller has claimed for reading,
+  // oldest block first, and then releases the blocks.
+  void PrintJSONBlocks(JSONArray* events,
+                       TimelineEventFilter* filter,
+                       MallocGrowableArray<TimelineEventBlock*>* blocks);
 
   void ResetTimeTracking();
   void ReportTime(int64_t micros);
@@ -746,7 +778,6 @@ class TimelineEventFixedBufferRecorder : public TimelineEventRecorder {
   TimelineEvent* StartEvent();
   void CompleteEvent(TimelineEvent* event);
   TimelineEventBlock* GetHeadBlockLocked();
-  intptr_t FindOldestBlockIndex() const;
   void Clear();
 
   void PrintJSONEvents(JSONArray* array, TimelineEventFilter* filter);
@@ -755,7 +786,7 @@ class TimelineEventFixedBufferRecorder : public TimelineEventRecorder {
   TimelineEventBlock* blocks_;
   intptr_t capacity_;
   intptr_t num_blocks_;
-  intptr_t block_cursor_;
+  uintptr_t block_cursor_;
 };
 
 // A recorder that stores events in a buffer of fixed capacity. When the buffer
@@ -769,7 +800,7 @@ class TimelineEventRingRecorder : public TimelineEventFixedBufferRecorder {
   const char* name() const { return "Ring"; }
 
  protected:
-  TimelineEventBlock* GetNewBlockLocked();
+  TimelineEventBlock* AcquireNewBlock();
 };
 
 // A recorder that stores events in a buffer of fixed capacity. When the buffer
@@ -783,7 +814,7 @@ class TimelineEventStartupRecorder : public TimelineEventFixedBufferRecorder {
   const char* name() const { return "Startup"; }
 
  protected:
-  TimelineEventBlock* GetNewBlockLocked();
+  TimelineEventBlock* AcquireNewBlock();
 };
 
 // An abstract recorder that calls |OnEvent| whenever an event is complete.
@@ -803,7 +834,7 @@ class TimelineEventCallbackRecorder : public TimelineEventRecorder {
   const char* name() const { return "Callback"; }
 
  protected:
-  TimelineEventBlock* GetNewBlockLocked() { return NULL; }
+  TimelineEventBlock* AcquireNewBlock() { return NULL; }
   TimelineEventBlock* GetHeadBlockLocked() { return NULL; }
   void Clear() {}
   TimelineEvent* StartEvent();
@@ -826,14 +857,17 @@ class TimelineEventEndlessRecorder : public TimelineEventRecorder {
  protected:
   TimelineEvent* StartEvent();
   void CompleteEvent(TimelineEvent* event);
-  TimelineEventBlock* GetNewBlockLocked();
+  TimelineEventBlock* AcquireNewBlock();
   TimelineEventBlock* GetHeadBlockLocked();
   void Clear();
 
   void PrintJSONEvents(JSONArray* array, TimelineEventFilter* filter);
+  void PushBlock(TimelineEventBlock* block);
 
+  // Blocks are only ever pushed onto this list without a lock; they are
+  // removed by |Clear| and the destructor.
   TimelineEventBlock* head_;
-  intptr_t block_index_;
+  uintptr_t block_index_;
 
   friend class TimelineTestHelper;
 };
@@ -875,7 +909,7 @@ class TimelineEventPlatformRecorder : public TimelineEventRecorder {
   virtual const char* name() const = 0;
 
  protected:
-  TimelineEventBlock* GetNewBlockLocked() { return NULL; }
+  TimelineEventBlock* AcquireNewBlock() { return NULL; }
   TimelineEventBlock* GetHeadBlockLocked() { return NULL; }
   void Clear() {}
   TimelineEvent* StartEvent();
@@ -919,6 +953,113 @@ class TimelineEventSystraceRecorder : public TimelineEventPlatformRecorder {
 };
 #endif  // defined(HOST_OS_ANDROID) || defined(HOST_OS_LINUX)
 
+// Encodes timeline events in a compact binary format, with LEB128 varints,
+// timestamps as deltas from the previous event, and names, categories and
+// argument names interned. runtime/tools/timeline_binary_to_json.py converts
+// encoded events to the trace event format.
+//
+// The encoding starts with the header written by the constructor:
+//   "DTLB", version, process id.
+// It is followed by records, each starting with a tag byte:
+//   kStringTag: id, length, bytes. Defines an interned string, before the
+//     first event that refers to it.
+//   kEventTag: event type, flags, name, category, thread id, time delta,
+//     [duration], [async id], [thread time, [thread duration]], [isolate id],
+//     number of arguments, (argument name, value length, value bytes)*.
+// Strings in events are an id, or 0 followed by an inline length and bytes.
+class TimelineEventBinaryEncoder {
+ public:
+  enum {
+    kStringTag = 1,
+    kEventTag = 2,
+  };
+
+  enum {
+    kHasThreadCPUTimeFlag = 1 << 0,
+    kHasIsolateFlag = 1 << 1,
+    kPreSerializedArgsFlag = 1 << 2,
+  };
+
+  static const intptr_t kVersion = 1;
+
+  TimelineEventBinaryEncoder();
+  ~TimelineEventBinaryEncoder();
+
+  // Appends |event|, preceded by definitions of the strings it uses that
+  // were not interned yet.
+  void Encode(TimelineEvent* event);
+
+  const uint8_t* buffer() const { return buffer_; }
+  intptr_t length() const { return length_; }
+
+  // Discards the encoded bytes. Interned strings stay defined.
+  void Clear() { length_ = 0; }
+
+ private:
+  // Caps on the interned strings, so that labels built at runtime cannot
+  // grow the table without bound. Other strings are written inline.
+  static const intptr_t kMaxInternedStrings = 4 * KB;
+  static const intptr_t kMaxInternedStringLength = 256;
+
+  class InternedStringTrait {
+   public:
+    typedef const char* Key;
+    typedef intptr_t Value;
+
+    struct Pair {
+      Key key;
+      Value value;
+      Pair() : key(NULL), value(0) {}
+      Pair(const Key key, const Value& value) : key(key), value(value) {}
+      Pair(const Pair& other) : key(other.key), value(other.value) {}
+    };
+
+    static Key KeyOf(Pair kv) { return kv.key; }
+    static Value ValueOf(Pair kv) { return kv.value; }
+    static intptr_t Hashcode(Key key);
+    static bool IsKeyEqual(Pair kv, Key key);
+  };
+
+  // Returns the id of |string|, interning it if possible, or 0.
+  intptr_t Intern(const char* string);
+
+  void WriteStringRef(const char* string);
+  void WriteBytes(const void* bytes, intptr_t length);
+  void WriteUnsigned(uint64_t value);
+  void WriteSigned(int64_t value);
+  void EnsureCapacity(intptr_t needed);
+
+  uint8_t* buffer_;
+  intptr_t length_;
+  intptr_t capacity_;
+  int64_t last_timestamp_;
+  MallocDirectChainedHashMap<InternedStringTrait> strings_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimelineEventBinaryEncoder);
+};
+
+// A recorder that streams events to a file, encoded by a
+// TimelineEventBinaryEncoder. Only a small buffer of encoded events is kept
+// in memory, so the recorder can stay enabled for long running processes.
+class TimelineEventFileRecorder : public TimelineEventPlatformRecorder {
+ public:
+  explicit TimelineEventFileRecorder(const char* path);
+  virtual ~TimelineEventFileRecorder();
+
+  const char* name() const { return "File"; }
+
+ private:
+  // Encoded events are written out once the buffer reaches this size.
+  static const intptr_t kFlushThreshold = 64 * KB;
+
+  void OnEvent(TimelineEvent* event);
+  void FlushLocked();
+
+  Mutex encoder_lock_;
+  TimelineEventBinaryEncoder encoder_;
+  void* file_;
+};
+
 class DartTimelineEventHelpers : public AllStatic {
  public:
   static void ReportTaskEvent(Thread* thread,
@@ -210,6 +210,262 @@ TEST_CASE(TimelineEventPrintSystrace) {
 }
 #endif  // defined(HOST_OS_ANDROID) || defined(HOST_OS_LINUX)
 
+TEST_CASE(TimelineEventBinaryEncoder) {
+  TimelineStream stream;
+  stream.Init("testStream", true);
+
+  TimelineEvent event;
+  TimelineTestHelper::SetStream(&event, &stream);
+
+  TimelineEventBinaryEncoder encoder;
+  EXPECT(encoder.length() > 4);
+  EXPECT(memcmp(encoder.buffer(), "DTLB", 4) == 0);
+
+  // The first event defines the label and the category.
+  encoder.Clear();
+  event.Duration("interned-label", 10, 20);
+  encoder.Encode(&event);
+  const intptr_t first_length = encoder.length();
+  EXPECT(first_length > static_cast<intptr_t>(strlen("interned-label")));
+
+  // A second event with the same label and category refers to them by id.
+  encoder.Clear();
+  event.Duration("interned-label", 30, 40);
+  encoder.Encode(&event);
+  const intptr_t second_length = encoder.length();
+  EXPECT(second_length < first_length);
+  EXPECT(second_length < static_cast<intptr_t>(strlen("interned-label")));
+
+  // Arguments are written inline.
+  encoder.Clear();
+  event.Instant("interned-label", 50);
+  event.SetNumArguments(1);
+  event.CopyArgument(0, "arg", "argument-value");
+  encoder.Encode(&event);
+  EXPECT(encoder.length() > static_cast<intptr_t>(strlen("argument-value")));
+}
+
+// Decodes the output of TimelineEventBinaryEncoder, following the format
+// described next to it in timeline.h.
+class TimelineBinaryDecoder : public ValueObject {
+ public:
+  static const intptr_t kMaxArguments = 4;
+
+  struct Event {
+    intptr_t type;
+    intptr_t flags;
+    const char* label;
+    const char* category;
+    intptr_t thread_id;
+    int64_t timestamp;
+    int64_t duration;
+    int64_t async_id;
+    Dart_Port isolate_id;
+    intptr_t num_arguments;
+    const char* argument_names[kMaxArguments];
+    const char* argument_values[kMaxArguments];
+  };
+
+  TimelineBinaryDecoder(Zone* zone, const uint8_t* data, intptr_t length)
+      : zone_(zone),
+        data_(data),
+        length_(length),
+        position_(0),
+        last_timestamp_(0),
+        strings_(zone, 16) {}
+
+  bool AtEnd() const { return position_ >= length_; }
+  intptr_t interned_strings() const { return strings_.length(); }
+
+  // Reads the header. Returns the process id.
+  intptr_t ReadHeader() {
+    EXPECT(length_ >= 4);
+    EXPECT(memcmp(data_, "DTLB", 4) == 0);
+    position_ = 4;
+    EXPECT_EQ(TimelineEventBinaryEncoder::kVersion,
+              static_cast<intptr_t>(ReadUnsigned()));
+    return ReadUnsigned();
+  }
+
+  // Reads string definitions up to and including the next event.
+  void ReadEvent(Event* event) {
+    intptr_t tag = ReadUnsigned();
+    while (tag == TimelineEventBinaryEncoder::kStringTag) {
+      const intptr_t id = ReadUnsigned();
+      EXPECT_EQ(strings_.length() + 1, id);
+      strings_.Add(ReadString());
+      tag = ReadUnsigned();
+    }
+    EXPECT_EQ(TimelineEventBinaryEncoder::kEventTag, tag);
+    event->type = ReadUnsigned();
+    event->flags = ReadUnsigned();
+    event->label = ReadStringRef();
+    event->category = ReadStringRef();
+    event->thread_id = ReadUnsigned();
+    last_timestamp_ += ReadSigned();
+    event->timestamp = last_timestamp_;
+    event->duration = -1;
+    event->async_id = -1;
+    if (event->type == TimelineEvent::kDuration) {
+      event->duration = ReadUnsigned();
+    } else if ((event->type >= TimelineEvent::kAsyncBegin &&
+                event->type <= TimelineEvent::kAsyncEnd) ||
+               (event->type >= TimelineEvent::kFlowBegin &&
+                event->type <= TimelineEvent::kFlowEnd)) {
+      event->async_id = ReadUnsigned();
+    }
+    if ((event->flags & TimelineEventBinaryEncoder::kHasThreadCPUTimeFlag) !=
+        0) {
+      ReadSigned();
+      if (event->type == TimelineEvent::kDuration) {
+        ReadUnsigned();
+      }
+    }
+    event->isolate_id = ILLEGAL_PORT;
+    if ((event->flags & TimelineEventBinaryEncoder::kHasIsolateFlag) != 0) {
+      event->isolate_id = ReadUnsigned();
+    }
+    event->num_arguments = ReadUnsigned();
+    EXPECT(event->num_arguments <= kMaxArguments);
+    for (intptr_t i = 0; i < event->num_arguments; i++) {
+      event->argument_names[i] = ReadStringRef();
+      event->argument_values[i] = ReadString();
+    }
+  }
+
+ private:
+  uint64_t ReadUnsigned() {
+    uint64_t result = 0;
+    intptr_t shift = 0;
+    uint8_t byte;
+    do {
+      EXPECT(position_ < length_);
+      byte = data_[position_++];
+      result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      shift += 7;
+    } while ((byte & 0x80) != 0);
+    return result;
+  }
+
+  int64_t ReadSigned() {
+    const uint64_t value = ReadUnsigned();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  const char* ReadString() {
+    const intptr_t length = ReadUnsigned();
+    EXPECT(position_ + length <= length_);
+    const char* result = zone_->MakeCopyOfStringN(
+        reinterpret_cast<const char*>(data_ + position_), length);
+    position_ += length;
+    return result;
+  }
+
+  const char* ReadStringRef() {
+    const intptr_t id = ReadUnsigned();
+    if (id == 0) {
+      return ReadString();
+    }
+    EXPECT(id <= strings_.length());
+    return strings_[id - 1];
+  }
+
+  Zone* zone_;
+  const uint8_t* data_;
+  intptr_t length_;
+  intptr_t position_;
+  int64_t last_timestamp_;
+  GrowableArray<const char*> strings_;
+};
+
+TEST_CASE(TimelineEventBinaryEncoderDecode) {
+  TimelineStream stream;
+  stream.Init("testStream", true);
+
+  TimelineEventBinaryEncoder encoder;
+  TimelineEvent event;
+
+  TimelineTestHelper::SetStream(&event, &stream);
+  event.Duration("first", 1000, 1250);
+  event.SetNumArguments(2);
+  event.CopyArgument(0, "name", "value");
+  event.CopyArgument(1, "empty", "");
+  encoder.Encode(&event);
+
+  // Timestamps go back as well as forward.
+  event.Reset();
+  TimelineTestHelper::SetStream(&event, &stream);
+  event.Instant("second", 900);
+  encoder.Encode(&event);
+
+  event.Reset();
+  TimelineTestHelper::SetStream(&event, &stream);
+  event.AsyncBegin("first", 1234567890123LL, 5000);
+  event.SetNumArguments(1);
+  event.CopyArgument(0, "name", "other value");
+  encoder.Encode(&event);
+
+  // Labels that are too long to intern are written inline.
+  char long_label[300];
+  memset(long_label, 'x', sizeof(long_label) - 1);
+  long_label[sizeof(long_label) - 1] = '\0';
+  event.Reset();
+  TimelineTestHelper::SetStream(&event, &stream);
+  event.Instant(long_label, 5001);
+  encoder.Encode(&event);
+
+  TimelineBinaryDecoder decoder(thread->zone(), encoder.buffer(),
+                                encoder.length());
+  EXPECT_EQ(OS::ProcessId(), decoder.ReadHeader());
+  const Dart_Port isolate_id = Isolate::Current()->main_port();
+  const intptr_t thread_id =
+      OSThread::ThreadIdToIntPtr(OSThread::Current()->trace_id());
+  TimelineBinaryDecoder::Event decoded;
+
+  decoder.ReadEvent(&decoded);
+  EXPECT_EQ(TimelineEvent::kDuration, decoded.type);
+  EXPECT_STREQ("first", decoded.label);
+  EXPECT_STREQ("testStream", decoded.category);
+  EXPECT_EQ(thread_id, decoded.thread_id);
+  EXPECT_EQ(1000, decoded.timestamp);
+  EXPECT_EQ(250, decoded.duration);
+  EXPECT_EQ(isolate_id, decoded.isolate_id);
+  EXPECT_EQ(2, decoded.num_arguments);
+  EXPECT_STREQ("name", decoded.argument_names[0]);
+  EXPECT_STREQ("value", decoded.argument_values[0]);
+  EXPECT_STREQ("empty", decoded.argument_names[1]);
+  EXPECT_STREQ("", decoded.argument_values[1]);
+  // The label, the category and both argument names.
+  EXPECT_EQ(4, decoder.interned_strings());
+
+  decoder.ReadEvent(&decoded);
+  EXPECT_EQ(TimelineEvent::kInstant, decoded.type);
+  EXPECT_STREQ("second", decoded.label);
+  EXPECT_STREQ("testStream", decoded.category);
+  EXPECT_EQ(900, decoded.timestamp);
+  EXPECT_EQ(0, decoded.num_arguments);
+  EXPECT_EQ(5, decoder.interned_strings());
+
+  decoder.ReadEvent(&decoded);
+  EXPECT_EQ(TimelineEvent::kAsyncBegin, decoded.type);
+  EXPECT_STREQ("first", decoded.label);
+  EXPECT_EQ(5000, decoded.timestamp);
+  EXPECT_EQ(1234567890123LL, decoded.async_id);
+  EXPECT_EQ(1, decoded.num_arguments);
+  EXPECT_STREQ("name", decoded.argument_names[0]);
+  EXPECT_STREQ("other value", decoded.argument_values[0]);
+  // Everything was interned before.
+  EXPECT_EQ(5, decoder.interned_strings());
+
+  decoder.ReadEvent(&decoded);
+  EXPECT_EQ(TimelineEvent::kInstant, decoded.type);
+  EXPECT_STREQ(long_label, decoded.label);
+  EXPECT_EQ(5001, decoded.timestamp);
+  EXPECT_EQ(5, decoder.interned_strings());
+
+  EXPECT(decoder.AtEnd());
+}
+
 TEST_CASE(TimelineEventArguments) {
   // Create a test stream.
   TimelineStream stream;
@@ -479,6 +735,7 @@ TEST_CASE(TimelineRingRecorderJSONOrder) {
   TimelineEventBlock* block_1 = recorder->GetNewBlock();
   EXPECT(block_1 != NULL);
   // Test that we wrapped.
+  TimelineTestHelper::FinishBlock(block_0);
   EXPECT(block_0 == recorder->GetNewBlock());
 
   // Emit the earlier event into block_1.
@@ -505,6 +762,38 @@ TEST_CASE(TimelineRingRecorderJSONOrder) {
   delete recorder;
 }
 
+TEST_CASE(TimelineRingRecorderDropsWhenBusy) {
+  TimelineStream stream;
+  stream.Init("testStream", true);
+
+  TimelineEventRingRecorder* recorder =
+      new TimelineEventRingRecorder(TimelineEventBlock::kBlockSize * 2);
+
+  TimelineEventBlock* block_0 = recorder->GetNewBlock();
+  EXPECT(block_0 != NULL);
+  TimelineTestHelper::FakeThreadEvent(block_0, 1, "Alpha", &stream);
+  TimelineEventBlock* block_1 = recorder->GetNewBlock();
+  EXPECT(block_1 != NULL);
+
+  // Blocks that are being written are not taken from their writers. With
+  // every block busy there is none to hand out, so the events are dropped.
+  EXPECT(recorder->GetNewBlock() == NULL);
+  EXPECT_EQ(1, block_0->length());
+
+  // Finished blocks are handed out again.
+  TimelineTestHelper::FinishBlock(block_1);
+  EXPECT(block_1 == recorder->GetNewBlock());
+  EXPECT(recorder->GetNewBlock() == NULL);
+  TimelineTestHelper::FinishBlock(block_0);
+  EXPECT(block_0 == recorder->GetNewBlock());
+  EXPECT_EQ(0, block_0->length());
+
+  TimelineTestHelper::FinishBlock(block_0);
+  TimelineTestHelper::FinishBlock(block_1);
+  TimelineTestHelper::Clear(recorder);
+  delete recorder;
+}
+
 TEST_CASE(TimelinePauses_Basic) {
   TimelineEventEndlessRecorder* recorder = new TimelineEventEndlessRecorder();
   ASSERT(recorder != NULL);
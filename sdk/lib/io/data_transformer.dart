@@ -574,7 +574,8 @@ class _ZLibEncoderSink extends _FilterSink {
       : super(
             sink,
             RawZLibFilter._makeZLibDeflateFilter(
-                gzip, level, windowBits, memLevel, strategy, dictionary, raw));
+                gzip, level, windowBits, memLevel, strategy, dictionary, raw),
+            coalesceInput: true);
 }
 
 class _ZLibDecoderSink extends _FilterSink {
@@ -584,13 +585,38 @@ class _ZLibDecoderSink extends _FilterSink {
             RawZLibFilter._makeZLibInflateFilter(windowBits, dictionary, raw));
 }
 
+// Implemented by the native filters. Lets [_FilterSink] pass several input
+// chunks in one call and have the output written directly into its buffers.
+abstract class _NativeZLibFilter implements RawZLibFilter {
+  void _processChunks(List<List<int>> chunks);
+
+  // Writes processed data to [buffer] between [start] and [end]. Returns the
+  // number of bytes written, which is 0 when no more data is available.
+  int _processedInto(
+      Uint8List buffer, int start, int end, bool flush, bool finish);
+}
+
 class _FilterSink extends ByteConversionSink {
+  // Size of the buffers the output of a native filter is written to.
+  static const int _outputBufferSize = 64 * 1024;
+  // When coalescing input, slices shorter than this are copied and passed to
+  // the filter together once [_maxPendingInputLength] bytes are pending.
+  static const int _smallInputLength = 1024;
+  static const int _maxPendingInputLength = 16 * 1024;
+
   final RawZLibFilter _filter;
   final ByteConversionSink _sink;
+  final bool _coalesceInput;
   bool _closed = false;
   bool _empty = true;
+  List<List<int>> _pendingInput;
+  int _pendingInputLength = 0;
+  Uint8List _output;
+  int _outputLength = 0;
 
-  _FilterSink(this._sink, this._filter);
+  _FilterSink(this._sink, RawZLibFilter filter, {bool coalesceInput: false})
+      : _filter = filter,
+        _coalesceInput = coalesceInput && filter is _NativeZLibFilter;
 
   void add(List<int> data) {
     addSlice(data, 0, data.length, false);
@@ -602,13 +628,30 @@ class _FilterSink extends ByteConversionSink {
     RangeError.checkValidRange(start, end, data.length);
     try {
       _empty = false;
-      _BufferAndStart bufferAndStart =
-          _ensureFastAndSerializableByteData(data, start, end);
-      _filter.process(bufferAndStart.buffer, bufferAndStart.start,
-          end - (start - bufferAndStart.start));
-      List<int> out;
-      while ((out = _filter.processed(flush: false)) != null) {
-        _sink.add(out);
+      if (_coalesceInput && end - start < _smallInputLength) {
+        int length = end - start;
+        _pendingInput ??= <List<int>>[];
+        _pendingInput
+            .add(new Uint8List(length)..setRange(0, length, data, start));
+        _pendingInputLength += length;
+        if (_pendingInputLength >= _maxPendingInputLength) {
+          _processPendingInput(null);
+          _addProcessed(false);
+        }
+      } else {
+        _BufferAndStart bufferAndStart =
+            _ensureFastAndSerializableByteData(data, start, end);
+        if (_pendingInput != null) {
+          TypedData buffer = bufferAndStart.buffer;
+          _processPendingInput(new Uint8List.view(
+              buffer.buffer,
+              buffer.offsetInBytes + bufferAndStart.start,
+              end - start));
+        } else {
+          _filter.process(bufferAndStart.buffer, bufferAndStart.start,
+              end - (start - bufferAndStart.start));
+        }
+        _addProcessed(false);
       }
     } catch (e) {
       _closed = true;
@@ -620,14 +663,15 @@ class _FilterSink extends ByteConversionSink {
 
   void close() {
     if (_closed) return;
-    // Be sure to send process an empty chunk of data. Without this, the empty
-    // message would not have a GZip frame (if compressed with GZip).
-    if (_empty) _filter.process(const [], 0, 0);
     try {
-      List<int> out;
-      while ((out = _filter.processed(end: true)) != null) {
-        _sink.add(out);
+      if (_pendingInput != null) {
+        _processPendingInput(null);
+      } else if (_empty) {
+        // Be sure to send process an empty chunk of data. Without this, the
+        // empty message would not have a GZip frame (if compressed with GZip).
+        _filter.process(const [], 0, 0);
       }
+      _addProcessed(true);
     } catch (e) {
       _closed = true;
       throw e;
@@ -635,6 +679,45 @@ class _FilterSink extends ByteConversionSink {
     _closed = true;
     _sink.close();
   }
+
+  // Passes the pending input, followed by [last] if not null, to the filter.
+  void _processPendingInput(List<int> last) {
+    List<List<int>> chunks = _pendingInput;
+    if (last != null) chunks.add(last);
+    _pendingInput = null;
+    _pendingInputLength = 0;
+    _NativeZLibFilter filter = _filter;
+    filter._processChunks(chunks);
+  }
+
+  // Adds all data available from the filter to the sink.
+  void _addProcessed(bool end) {
+    if (_filter is! _NativeZLibFilter) {
+      List<int> out;
+      while ((out = _filter.processed(flush: end, end: end)) != null) {
+        _sink.add(out);
+      }
+      return;
+    }
+    _NativeZLibFilter filter = _filter;
+    while (true) {
+      _output ??= new Uint8List(_outputBufferSize);
+      int written = filter._processedInto(
+          _output, _outputLength, _output.length, end, end);
+      if (written == 0) break;
+      _outputLength += written;
+      if (_outputLength == _output.length) {
+        // Hand over full buffers without copying.
+        _sink.add(_output);
+        _output = null;
+        _outputLength = 0;
+      }
+    }
+    if (_outputLength > 0) {
+      _sink.add(_output.sublist(0, _outputLength));
+      _outputLength = 0;
+    }
+  }
 }
 
 void _validateZLibWindowBits(int windowBits) {
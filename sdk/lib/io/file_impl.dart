@@ -7,7 +7,22 @@ part of dart.io;
 // Read the file in blocks of size 64k.
 const int _blockSize = 64 * 1024;
 
+// A block read ahead by a [_FileStream].
+class _ReadAheadBlock {
+  final int length;
+  bool isDone = false;
+  List<int> data;
+  Object error;
+  StackTrace stackTrace;
+
+  _ReadAheadBlock(this.length);
+}
+
 class _FileStream extends Stream<List<int>> {
+  // Number of block reads kept in flight when streaming a file, so that the
+  // next blocks are read while earlier ones are delivered.
+  static const int _maxReadsInFlight = 4;
+
   // Stream controller.
   StreamController<List<int>> _controller;
 
@@ -27,6 +42,16 @@ class _FileStream extends Stream<List<int>> {
 
   bool _atEnd = false;
 
+  // Blocks read ahead of [_position], in file order. Reading ahead is only
+  // done for files, not for stdin.
+  final Queue<_ReadAheadBlock> _readAhead = new Queue<_ReadAheadBlock>();
+  int _readAheadPosition;
+  int _readsInFlight = 0;
+  // Starts at one, so small files are read with a single request, and grows
+  // to [_maxReadsInFlight] as full blocks are delivered.
+  int _readAheadLimit = 1;
+  bool _readAheadDone = false;
+
   _FileStream(this._path, this._position, this._end) {
     if (_position == null) _position = 0;
   }
@@ -52,7 +77,7 @@ class _FileStream extends Stream<List<int>> {
   }
 
   Future _closeFile() {
-    if (_readInProgress || _closed) {
+    if (_readInProgress || _readsInFlight > 0 || _closed) {
       return _closeCompleter.future;
     }
     _closed = true;
@@ -69,6 +94,10 @@ class _FileStream extends Stream<List<int>> {
   void _readBlock() {
     // Don't start a new read if one is already in progress.
     if (_readInProgress) return;
+    if (_path != null) {
+      _readBlocksAhead();
+      return;
+    }
     if (_atEnd) {
       _closeFile();
       return;
@@ -113,6 +142,85 @@ class _FileStream extends Stream<List<int>> {
     });
   }
 
+  // Delivers the blocks read so far, in order, and keeps up to
+  // [_maxReadsInFlight] reads of the following blocks in flight.
+  void _readBlocksAhead() {
+    _deliverBlocksReadAhead();
+    _readAheadPosition ??= _position;
+    while (!_readAheadDone &&
+        !_unsubscribed &&
+        !_controller.isPaused &&
+        _readAhead.length < _readAheadLimit) {
+      int readBytes = _blockSize;
+      if (_end != null) {
+        readBytes = min(readBytes, _end - _readAheadPosition);
+        if (readBytes < 0) {
+          _controller.addError(new RangeError("Bad end position: $_end"));
+          _closeFile();
+          _unsubscribed = true;
+          return;
+        }
+        if (readBytes < _blockSize) _readAheadDone = true;
+      }
+      _readBlockAhead(_readAheadPosition, readBytes);
+      _readAheadPosition += readBytes;
+    }
+  }
+
+  void _readBlockAhead(int position, int length) {
+    var block = new _ReadAheadBlock(length);
+    _readAhead.add(block);
+    _readsInFlight++;
+    _RandomAccessFile file = _openedFile;
+    void done() {
+      block.isDone = true;
+      _readsInFlight--;
+      if (_unsubscribed || _atEnd) {
+        _closeFile();
+        return;
+      }
+      _readBlocksAhead();
+    }
+
+    file._readAt(position, length).then((data) {
+      block.data = data;
+      done();
+    }, onError: (e, s) {
+      block.error = e;
+      block.stackTrace = s;
+      done();
+    });
+  }
+
+  void _deliverBlocksReadAhead() {
+    while (_readAhead.isNotEmpty &&
+        _readAhead.first.isDone &&
+        !_atEnd &&
+        !_unsubscribed &&
+        !_controller.isPaused) {
+      _ReadAheadBlock block = _readAhead.removeFirst();
+      if (block.error != null) {
+        _controller.addError(block.error, block.stackTrace);
+        _closeFile();
+        _unsubscribed = true;
+        return;
+      }
+      List<int> data = block.data;
+      _position += data.length;
+      if (data.length < block.length || (_end != null && _position == _end)) {
+        // Blocks read beyond the end are dropped.
+        _atEnd = true;
+        _readAheadDone = true;
+      } else if (_readAheadLimit < _maxReadsInFlight) {
+        _readAheadLimit *= 2;
+      }
+      _controller.add(data);
+    }
+    if (_atEnd) {
+      _closeFile();
+    }
+  }
+
   void _start() {
     if (_position < 0) {
       _controller.addError(new RangeError("Bad start position: $_position"));
@@ -128,7 +236,8 @@ class _FileStream extends Stream<List<int>> {
     }
 
     void onOpenFile(RandomAccessFile file) {
-      if (_position > 0) {
+      // Files are read at explicit positions.
+      if (_position > 0 && _path == null) {
         file.setPosition(_position).then(onReady, onError: (e, s) {
           _controller.addError(e, s);
           _readInProgress = false;
@@ -759,6 +868,25 @@ class _RandomAccessFile implements RandomAccessFile {
     });
   }
 
+  // Reads up to [bytes] bytes at [position] without using or changing the
+  // file position. Unlike other asynchronous operations, any number of these
+  // reads may be pending at the same time. The caller must not close the
+  // file before they have completed.
+  Future<List<int>> _readAt(int position, int bytes) {
+    if (closed) {
+      return new Future.error(new FileSystemException("File closed", path));
+    }
+    return _IOService._dispatch(
+        _IOService.fileReadAt, [_pointer(), position, bytes]).then((response) {
+      if (_isErrorResponse(response)) {
+        throw _exceptionFromResponse(response, "read failed", path);
+      }
+      _resourceInfo.addRead(response[1].length);
+      List<int> result = response[1];
+      return result;
+    });
+  }
+
   List<int> readSync(int bytes) {
     _checkAvailable();
     if (bytes is! int) {
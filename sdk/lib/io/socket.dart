@@ -517,6 +517,15 @@ abstract class RawSocket implements Stream<RawSocketEvent> {
    */
   List<int> read([int len]);
 
+  /**
+   * Read up to [count] bytes from the socket into [buffer] starting at
+   * [offset]. If [count] is omitted, up to `buffer.length - offset` bytes
+   * are read. Like [read], this function is non-blocking, but it does not
+   * allocate, so a single buffer can be reused for every read. Returns the
+   * number of bytes read, or [:null:] if no data is available.
+   */
+  int readInto(Uint8List buffer, [int offset = 0, int count]);
+
   /**
    * Writes up to [count] bytes of the buffer from [offset] buffer offset to
    * the socket. The number of successfully written bytes is returned. This
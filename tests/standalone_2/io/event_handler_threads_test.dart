@@ -0,0 +1,100 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Test that sockets spread over several event handler threads on Linux all
+// get their events, including when sockets are closed and their descriptors
+// reused while other sockets are busy.
+//
+// VMOptions=--event-handler-threads=1
+// VMOptions=--event-handler-threads=3
+// VMOptions=--event-handler-threads=8
+
+import "dart:async";
+import "dart:io";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+// Enough sockets that every thread gets several of them.
+const int connectionCount = 32;
+const int rounds = 4;
+const int messageLength = 10000;
+
+List<int> makeMessage(int connection) =>
+    new List<int>.generate(messageLength, (i) => (connection + i) & 0xff);
+
+Future<ServerSocket> startEchoServer() async {
+  var server = await ServerSocket.bind(InternetAddress.loopbackIPv4, 0);
+  server.listen((socket) {
+    socket.listen(socket.add, onDone: socket.close);
+  });
+  return server;
+}
+
+Future echo(int port, int connection) async {
+  var socket = await Socket.connect(InternetAddress.loopbackIPv4, port);
+  var message = makeMessage(connection);
+  var received = <int>[];
+  var done = socket.listen(received.addAll).asFuture();
+  socket.add(message);
+  await socket.flush();
+  await socket.close();
+  await done;
+  Expect.listEquals(message, received);
+}
+
+Future testEcho() async {
+  var server = await startEchoServer();
+  // Every round closes all sockets, so that the next round reuses their
+  // descriptors for new sockets.
+  for (int round = 0; round < rounds; round++) {
+    var futures = <Future>[];
+    for (int i = 0; i < connectionCount; i++) {
+      futures.add(echo(server.port, round * connectionCount + i));
+    }
+    await Future.wait(futures);
+  }
+  await server.close();
+}
+
+Future testDatagrams() async {
+  var address = InternetAddress.loopbackIPv4;
+  var receivers = <RawDatagramSocket>[];
+  var futures = <Future>[];
+  for (int i = 0; i < connectionCount; i++) {
+    var receiver = await RawDatagramSocket.bind(address, 0);
+    var completer = new Completer();
+    receiver.listen((event) {
+      if (event != RawSocketEvent.read) return;
+      var datagram = receiver.receive();
+      if (datagram == null) return;
+      Expect.listEquals([i], datagram.data);
+      receiver.close();
+      completer.complete();
+    });
+    receivers.add(receiver);
+    futures.add(completer.future);
+  }
+  var sender = await RawDatagramSocket.bind(address, 0);
+  for (int i = 0; i < connectionCount; i++) {
+    Expect.equals(1, sender.send([i], address, receivers[i].port));
+  }
+  await Future.wait(futures);
+  sender.close();
+}
+
+Future testTimers() {
+  // Timers stay on the first thread while the others handle sockets.
+  var futures = <Future>[];
+  for (int i = 0; i < 10; i++) {
+    futures.add(new Future.delayed(new Duration(milliseconds: i * 5)));
+  }
+  return Future.wait(futures);
+}
+
+main() {
+  asyncTest(() async {
+    await Future.wait([testEcho(), testDatagrams(), testTimers()]);
+  });
+}
@@ -7,6 +7,7 @@
 // OtherResources=readline_test1.dat
 // OtherResources=readline_test2.dat
 
+import "dart:async";
 import "dart:convert";
 import "dart:io";
 
@@ -184,6 +185,35 @@ void testInputStreamOffset() {
   test(20, null, -20);
 }
 
+void testInputStreamContent() {
+  // Several blocks are read ahead; they must be delivered in order, also
+  // when the subscription is paused.
+  void test(int start, int end) {
+    asyncStart();
+    var temp = Directory.systemTemp.createTempSync('file_input_stream_test');
+    var file = new File('${temp.path}/input_stream_content.dat');
+    var data = new List<int>.generate(1000000, (i) => (i * 7) % 256);
+    file.writeAsBytesSync(data);
+    var expected = data.sublist(start ?? 0, end ?? data.length);
+    var streamed = <int>[];
+    var subscription;
+    subscription = file.openRead(start, end).listen((d) {
+      streamed.addAll(d);
+      subscription.pause(new Future.delayed(const Duration(milliseconds: 1)));
+    }, onDone: () {
+      Expect.listEquals(expected, streamed);
+      temp.delete(recursive: true).then((_) => asyncEnd());
+    }, onError: (e) {
+      Expect.fail("Unexpected error");
+    });
+  }
+
+  test(null, null);
+  test(1000, null);
+  test(null, 65536 * 3);
+  test(12345, 654321);
+}
+
 void testInputStreamBadOffset() {
   void test(int start, int end) {
     asyncStart();
@@ -234,6 +264,7 @@ main() {
   testInputStreamDelete();
   testInputStreamAppend();
   testInputStreamOffset();
+  testInputStreamContent();
   testInputStreamBadOffset();
   // Check the length of these files as both are text files where one
   // is without a terminating line separator which can easily be added
@@ -0,0 +1,117 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// With --enable-io-uring, asynchronous file reads and writes are submitted
+// to io_uring on Linux kernels that support it. They are handled on IOService
+// threads otherwise.
+//
+// VMOptions=
+// VMOptions=--enable-io-uring
+
+import 'dart:async';
+import 'dart:io';
+import 'dart:typed_data';
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+// Larger than a single write or read-ahead block.
+const int kLength = 3 * 1024 * 1024 + 17;
+
+Uint8List makeData() {
+  var data = new Uint8List(kLength);
+  for (int i = 0; i < kLength; i++) {
+    data[i] = (i * 31 + (i >> 8)) & 0xff;
+  }
+  return data;
+}
+
+void expectRange(List<int> expected, int start, List<int> actual) {
+  for (int i = 0; i < actual.length; i++) {
+    if (expected[start + i] != actual[i]) {
+      Expect.fail("Byte ${start + i}: expected ${expected[start + i]}, "
+          "got ${actual[i]}");
+    }
+  }
+}
+
+Future testWriteFromAndRead(File file, Uint8List data) async {
+  // Write in a few chunks, including one from the middle of the list.
+  var raf = await file.open(mode: FileMode.write);
+  await raf.writeFrom(data, 0, 1000);
+  await raf.writeFrom(data, 1000, kLength ~/ 2);
+  await raf.writeFrom(data, kLength ~/ 2);
+  Expect.equals(kLength, await raf.position());
+  Expect.equals(kLength, await raf.length());
+  await raf.close();
+
+  raf = await file.open();
+  var head = await raf.read(4096);
+  Expect.equals(4096, head.length);
+  expectRange(data, 0, head);
+  // Reads continue at the file position.
+  var next = await raf.read(100);
+  Expect.equals(100, next.length);
+  expectRange(data, 4096, next);
+  await raf.setPosition(kLength - 10);
+  var tail = await raf.read(100);
+  Expect.equals(10, tail.length);
+  expectRange(data, kLength - 10, tail);
+  Expect.equals(0, (await raf.read(100)).length);
+  await raf.close();
+}
+
+Future testReadInto(File file, Uint8List data) async {
+  var raf = await file.open();
+  var buffer = new Uint8List(5000);
+  await raf.setPosition(12345);
+  Expect.equals(4000, await raf.readInto(buffer, 1000));
+  expectRange(data, 12345, buffer.sublist(1000));
+  Expect.equals(1000, await raf.readInto(buffer, 0, 1000));
+  expectRange(data, 12345 + 4000, buffer.sublist(0, 1000));
+  Expect.equals(12345 + 5000, await raf.position());
+  await raf.close();
+}
+
+Future testReadAt(File file, Uint8List data) async {
+  // File.openRead reads ahead with concurrent positional reads.
+  var builder = new BytesBuilder(copy: false);
+  await for (var chunk in file.openRead()) {
+    builder.add(chunk);
+  }
+  var all = builder.takeBytes();
+  Expect.equals(kLength, all.length);
+  expectRange(data, 0, all);
+
+  var start = 65536 - 3;
+  var end = kLength - 65536 + 5;
+  await for (var chunk in file.openRead(start, end)) {
+    builder.add(chunk);
+  }
+  var range = builder.takeBytes();
+  Expect.equals(end - start, range.length);
+  expectRange(data, start, range);
+}
+
+Future testReadAsBytes(File file, Uint8List data) async {
+  var all = await file.readAsBytes();
+  Expect.equals(kLength, all.length);
+  expectRange(data, 0, all);
+}
+
+main() {
+  asyncTest(() async {
+    var directory = await Directory.systemTemp.createTemp('dart_io_uring');
+    var file = new File('${directory.path}/data');
+    var data = makeData();
+    try {
+      await testWriteFromAndRead(file, data);
+      await testReadInto(file, data);
+      await testReadAt(file, data);
+      await testReadAsBytes(file, data);
+    } finally {
+      await directory.delete(recursive: true);
+    }
+  });
+}
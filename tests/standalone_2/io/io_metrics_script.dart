@@ -0,0 +1,16 @@
+// Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Script used by the io_metrics_test.dart test. Reads the file args[0] and
+// writes its contents to args[1], both asynchronously.
+
+import "dart:io";
+
+main(List<String> args) async {
+  var data = await new File(args[0]).readAsBytes();
+  var raf = await new File(args[1]).open(mode: FileMode.write);
+  await raf.writeFrom(data);
+  await raf.close();
+  print(data.length);
+}
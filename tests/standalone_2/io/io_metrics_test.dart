@@ -0,0 +1,67 @@
+// Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Checks the file byte counters written by --write-metrics, both when the
+// asynchronous file operations go through io_uring and when they do not.
+//
+// OtherResources=io_metrics_script.dart
+
+import 'dart:async';
+import 'dart:io';
+import 'dart:typed_data';
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+const int kLength = 1024 * 1024 + 3;
+
+int readCounter(String metrics, String name) {
+  for (var line in metrics.split('\n')) {
+    if (line.startsWith('$name ')) {
+      return int.parse(line.substring(name.length + 1));
+    }
+  }
+  Expect.fail('No $name in:\n$metrics');
+  return null;
+}
+
+Future testCounters(Directory directory, List<String> options) async {
+  var input = '${directory.path}/input';
+  var output = '${directory.path}/output';
+  var metrics = '${directory.path}/metrics';
+  var arguments = <String>[]
+    ..addAll(Platform.executableArguments)
+    ..add('--write-metrics=$metrics')
+    ..addAll(options)
+    ..add(Platform.script.resolve('io_metrics_script.dart').toFilePath())
+    ..add(input)
+    ..add(output);
+  var result = await Process.run(Platform.executable, arguments);
+  if (result.exitCode != 0) {
+    print("stdout:\n${result.stdout}");
+    print("stderr:\n${result.stderr}");
+    Expect.fail('Script failed with exit code ${result.exitCode}');
+  }
+  Expect.equals('$kLength', result.stdout.trim());
+  Expect.equals(kLength, new File(output).lengthSync());
+
+  // Loading the script also reads files, so the counters may be larger.
+  var text = new File(metrics).readAsStringSync();
+  Expect.isTrue(readCounter(text, 'dart_io_file_read_bytes') >= kLength);
+  Expect.isTrue(readCounter(text, 'dart_io_file_written_bytes') >= kLength);
+}
+
+main() {
+  asyncTest(() async {
+    var directory = await Directory.systemTemp.createTemp('dart_io_metrics');
+    try {
+      new File('${directory.path}/input')
+          .writeAsBytesSync(new Uint8List(kLength));
+      await testCounters(directory, []);
+      await testCounters(directory, ['--enable-io-uring']);
+    } finally {
+      await directory.delete(recursive: true);
+    }
+  });
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Test that datagrams sent in a burst, which the receiver reads several at a
+// time with recvmmsg on Linux, are all delivered intact and with the right
+// sender.
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+// More than _NativeSocket.maxDatagramBatch, so that a burst takes several
+// batches, the last of them partial.
+const int burstLength = 11;
+const int burstCount = 8;
+
+// Datagram [index] of a burst. Its first byte is the index, and every burst
+// has one large datagram so that the slots of the receive buffer are
+// exercised with lengths other than the data of the neighbouring slot.
+Uint8List makeDatagram(int index) {
+  int length = (index % burstLength == 3) ? 40000 + index : index + 1;
+  var data = new Uint8List(length);
+  data[0] = index;
+  for (int i = 1; i < length; i++) {
+    data[i] = (index + i) & 0xff;
+  }
+  return data;
+}
+
+void checkDatagram(Datagram datagram, RawDatagramSocket producer,
+    InternetAddress address) {
+  Expect.equals(producer.port, datagram.port);
+  Expect.equals(address, datagram.address);
+  var expected = makeDatagram(datagram.data[0]);
+  Expect.listEquals(expected, datagram.data);
+}
+
+Future testBursts(InternetAddress address) async {
+  var producer = await RawDatagramSocket.bind(address, 0);
+  var receiver = await RawDatagramSocket.bind(address, 0);
+  var received = new Set<int>();
+  var burstReceived = new Completer();
+  var subscription = receiver.listen((event) {
+    if (event != RawSocketEvent.read) return;
+    var datagram = receiver.receive();
+    if (datagram == null) return;
+    checkDatagram(datagram, producer, address);
+    Expect.isTrue(received.add(datagram.data[0]));
+    if (received.length % burstLength == 0) {
+      burstReceived.complete();
+    }
+  });
+  // Send each burst before the receiver gets a chance to run, and wait for
+  // it to arrive so that the socket buffers are not overrun.
+  for (int burst = 0; burst < burstCount; burst++) {
+    burstReceived = new Completer();
+    for (int i = 0; i < burstLength; i++) {
+      var data = makeDatagram(burst * burstLength + i);
+      Expect.equals(data.length, producer.send(data, address, receiver.port));
+    }
+    await burstReceived.future;
+  }
+  Expect.equals(burstLength * burstCount, received.length);
+  await subscription.cancel();
+  producer.close();
+  receiver.close();
+}
+
+main() {
+  asyncTest(() async {
+    await testBursts(InternetAddress.loopbackIPv4);
+    await testBursts(InternetAddress.loopbackIPv6);
+  });
+}
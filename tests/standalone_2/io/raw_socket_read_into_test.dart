@@ -0,0 +1,124 @@
+// Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Checks that RawSocket.readInto and RawSecureSocket.readInto fill the given
+// range of a buffer that is reused for every read, and leave the rest of
+// the buffer alone.
+//
+// VMOptions=
+// VMOptions=--short_socket_read
+// VMOptions=--short_socket_write
+// VMOptions=--short_socket_read --short_socket_write
+// OtherResources=certificates/server_chain.pem
+// OtherResources=certificates/server_key.pem
+// OtherResources=certificates/trusted_certs.pem
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+String localFile(path) => Platform.script.resolve(path).toFilePath();
+
+final SecurityContext serverContext = new SecurityContext()
+  ..useCertificateChain(localFile('certificates/server_chain.pem'))
+  ..usePrivateKey(localFile('certificates/server_key.pem'),
+      password: 'dartdart');
+
+final SecurityContext clientContext = new SecurityContext()
+  ..setTrustedCertificates(localFile('certificates/trusted_certs.pem'));
+
+const int kLength = 300 * 1024 + 7;
+const int kGuard = 0xaa;
+
+int byteAt(int i) => (i * 7 + (i >> 10)) & 0xff;
+
+void serve(RawSocket client, Uint8List data) {
+  int offset = 0;
+  client.listen((event) {
+    switch (event) {
+      case RawSocketEvent.write:
+        offset += client.write(data, offset);
+        if (offset < kLength) {
+          client.writeEventsEnabled = true;
+        } else {
+          client.shutdown(SocketDirection.send);
+        }
+        break;
+      case RawSocketEvent.readClosed:
+        client.close();
+        break;
+    }
+  });
+}
+
+Future testReadInto(bool secure, int offset, int count) async {
+  var data = new Uint8List(kLength);
+  for (int i = 0; i < kLength; i++) {
+    data[i] = byteAt(i);
+  }
+  var server;
+  var socket;
+  if (secure) {
+    server = await RawSecureServerSocket.bind("localhost", 0, serverContext);
+    server.listen((client) => serve(client, data));
+    socket = await RawSecureSocket.connect("localhost", server.port,
+        context: clientContext);
+  } else {
+    server = await RawServerSocket.bind(InternetAddress.loopbackIPv4, 0);
+    server.listen((client) => serve(client, data));
+    socket = await RawSocket.connect(InternetAddress.loopbackIPv4, server.port);
+  }
+
+  // A single buffer, with guard bytes around the range that is read into.
+  var buffer = new Uint8List(offset + (count ?? 4096) + 16);
+  buffer.fillRange(0, buffer.length, kGuard);
+  int end = (count == null) ? buffer.length : offset + count;
+  var completer = new Completer();
+  int received = 0;
+  socket.listen((event) {
+    switch (event) {
+      case RawSocketEvent.read:
+        int bytes;
+        while ((bytes = socket.readInto(buffer, offset, count)) != null) {
+          Expect.isTrue(bytes > 0);
+          Expect.isTrue(offset + bytes <= end);
+          for (int i = 0; i < bytes; i++) {
+            if (buffer[offset + i] != byteAt(received + i)) {
+              Expect.fail("Byte ${received + i}: expected "
+                  "${byteAt(received + i)}, got ${buffer[offset + i]}");
+            }
+          }
+          for (int i = 0; i < offset; i++) {
+            Expect.equals(kGuard, buffer[i]);
+          }
+          for (int i = end; i < buffer.length; i++) {
+            Expect.equals(kGuard, buffer[i]);
+          }
+          received += bytes;
+        }
+        break;
+      case RawSocketEvent.readClosed:
+        socket.close();
+        server.close();
+        completer.complete();
+        break;
+    }
+  });
+  await completer.future;
+  Expect.equals(kLength, received);
+}
+
+main() {
+  asyncTest(() async {
+    for (bool secure in [false, true]) {
+      await testReadInto(secure, 0, null);
+      await testReadInto(secure, 10, 1);
+      await testReadInto(secure, 10, 1000);
+      await testReadInto(secure, 3, 64 * 1024);
+    }
+  });
+}
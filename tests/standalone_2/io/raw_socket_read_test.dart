@@ -0,0 +1,93 @@
+// Copyright (c) 2019, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Checks RawSocket.read for reads that go straight into the returned list
+// and for reads larger than that.
+//
+// VMOptions=
+// VMOptions=--short_socket_read
+// VMOptions=--short_socket_write
+// VMOptions=--short_socket_read --short_socket_write
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+// More than a single read into the returned list, which is limited to 64KB.
+const int kLength = 300 * 1024 + 7;
+
+int byteAt(int i) => (i * 7 + (i >> 10)) & 0xff;
+
+Future testRead(int readLength) async {
+  var data = new Uint8List(kLength);
+  for (int i = 0; i < kLength; i++) {
+    data[i] = byteAt(i);
+  }
+  var server = await RawServerSocket.bind(InternetAddress.loopbackIPv4, 0);
+  server.listen((client) {
+    int offset = 0;
+    client.listen((event) {
+      switch (event) {
+        case RawSocketEvent.write:
+          offset += client.write(data, offset);
+          if (offset < kLength) {
+            client.writeEventsEnabled = true;
+          } else {
+            client.shutdown(SocketDirection.send);
+          }
+          break;
+        case RawSocketEvent.readClosed:
+          client.close();
+          server.close();
+          break;
+      }
+    });
+  });
+
+  var socket =
+      await RawSocket.connect(InternetAddress.loopbackIPv4, server.port);
+  var completer = new Completer();
+  int received = 0;
+  socket.listen((event) {
+    switch (event) {
+      case RawSocketEvent.read:
+        var bytes;
+        while ((bytes = socket.read(readLength)) != null) {
+          Expect.isTrue(bytes is Uint8List);
+          Expect.isTrue(bytes.length > 0);
+          // A short read does not keep a larger buffer alive.
+          Expect.equals(bytes.length, bytes.buffer.lengthInBytes);
+          if (readLength != null) Expect.isTrue(bytes.length <= readLength);
+          for (int i = 0; i < bytes.length; i++) {
+            if (bytes[i] != byteAt(received + i)) {
+              Expect.fail("Byte ${received + i}: expected "
+                  "${byteAt(received + i)}, got ${bytes[i]}");
+            }
+          }
+          received += bytes.length;
+        }
+        break;
+      case RawSocketEvent.readClosed:
+        socket.close();
+        completer.complete();
+        break;
+    }
+  });
+  await completer.future;
+  Expect.equals(kLength, received);
+}
+
+main() {
+  asyncTest(() async {
+    // All available bytes, which may be more than 64KB.
+    await testRead(null);
+    await testRead(1);
+    await testRead(1000);
+    await testRead(64 * 1024);
+    await testRead(64 * 1024 + 1);
+  });
+}
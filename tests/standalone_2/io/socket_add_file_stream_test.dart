@@ -0,0 +1,50 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Tests adding a stream from File.openRead to a socket, which sends the file
+// without reading it into the heap.
+//
+// VMOptions=
+// VMOptions=--short_socket_write
+
+import 'dart:async';
+import 'dart:io';
+
+import 'package:async_helper/async_helper.dart';
+import 'package:expect/expect.dart';
+
+Future testAddFileStream(List<int> content, int start, int end) async {
+  var tempDir = Directory.systemTemp.createTempSync('dart_socket_add_file');
+  var file = new File('${tempDir.path}/data');
+  file.writeAsBytesSync(content);
+
+  var server = await ServerSocket.bind(InternetAddress.loopbackIPv4, 0);
+  var received = new Completer<List<int>>();
+  server.listen((socket) {
+    var data = <int>[];
+    socket.listen(data.addAll, onDone: () {
+      socket.destroy();
+      received.complete(data);
+    });
+  });
+
+  var client = await Socket.connect(InternetAddress.loopbackIPv4, server.port);
+  await client.addStream(file.openRead(start, end));
+  await client.close();
+
+  var expected = content.sublist(start ?? 0, end ?? content.length);
+  Expect.listEquals(expected, await received.future);
+  await server.close();
+  tempDir.deleteSync(recursive: true);
+}
+
+main() async {
+  asyncStart();
+  var content = new List<int>.generate(1024 * 1024, (i) => i & 0xff);
+  await testAddFileStream(content, null, null);
+  await testAddFileStream(content, 1000, 100000);
+  await testAddFileStream(content, 1000, null);
+  await testAddFileStream(<int>[], null, null);
+  asyncEnd();
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Tests shared listening sockets which each get their own SO_REUSEPORT
+// socket.
+//
+// VMOptions=
+// VMOptions=--reuse_port_for_shared
+
+import 'dart:async';
+import 'dart:io';
+
+import 'package:async_helper/async_helper.dart';
+import 'package:expect/expect.dart';
+
+const int connectionCount = 20;
+
+Future testBindSharedAccept(String host) async {
+  var server1 = await ServerSocket.bind(host, 0, shared: true);
+  var server2 = await ServerSocket.bind(host, server1.port, shared: true);
+  Expect.equals(server1.port, server2.port);
+
+  int accepted = 0;
+  var allAccepted = new Completer();
+  void onConnection(Socket socket) {
+    socket.destroy();
+    if (++accepted == connectionCount) allAccepted.complete();
+  }
+
+  server1.listen(onConnection);
+  server2.listen(onConnection);
+
+  // Every connection is accepted by one of the two sockets.
+  var clients = <Socket>[];
+  for (int i = 0; i < connectionCount; i++) {
+    clients.add(await Socket.connect(host, server1.port));
+  }
+  await allAccepted.future;
+  clients.forEach((client) => client.destroy());
+
+  // Closing one of the sockets leaves the other one listening.
+  await server1.close();
+  var client = await Socket.connect(host, server2.port);
+  client.destroy();
+  await server2.close();
+}
+
+main() async {
+  asyncStart();
+  for (var host in ['127.0.0.1', '::1']) {
+    await testBindSharedAccept(host);
+  }
+  asyncEnd();
+}
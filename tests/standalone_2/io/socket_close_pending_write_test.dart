@@ -0,0 +1,69 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Test that closing a socket right after adding more data than the socket
+// send buffer holds still delivers all of the data before the socket is
+// shut down.
+//
+// VMOptions=
+// VMOptions=--short_socket_write
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+// Well above the send and receive buffers of a loopback socket.
+const int totalLength = 8 * 1024 * 1024;
+
+// Chunk sizes that stay below and go above the limit at which the socket
+// stops taking more data from the stream.
+const List<int> chunkLengths = const <int>[100, 4000, 30000, 200000];
+
+List<Uint8List> makeChunks() {
+  var chunks = <Uint8List>[];
+  int position = 0;
+  for (int i = 0; position < totalLength; i++) {
+    int length = chunkLengths[i % chunkLengths.length];
+    if (position + length > totalLength) length = totalLength - position;
+    var chunk = new Uint8List(length);
+    for (int j = 0; j < length; j++) {
+      chunk[j] = (position + j) & 0xff;
+    }
+    chunks.add(chunk);
+    position += length;
+  }
+  return chunks;
+}
+
+main() {
+  asyncTest(() async {
+    var server = await ServerSocket.bind(InternetAddress.loopbackIPv4, 0);
+    var accepted = server.first;
+    var client =
+        await Socket.connect(InternetAddress.loopbackIPv4, server.port);
+    var serverSocket = await accepted;
+
+    makeChunks().forEach(client.add);
+    var closed = client.close();
+
+    // Let the writes block before anything is read.
+    await new Future.delayed(const Duration(milliseconds: 50));
+    int received = 0;
+    await serverSocket.listen((data) {
+      for (int i = 0; i < data.length; i++) {
+        if (data[i] != ((received + i) & 0xff)) {
+          Expect.fail("Byte ${received + i}: got ${data[i]}");
+        }
+      }
+      received += data.length;
+    }).asFuture();
+    await closed;
+    Expect.equals(totalLength, received);
+    serverSocket.destroy();
+    await server.close();
+  });
+}
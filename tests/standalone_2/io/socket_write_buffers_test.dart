@@ -0,0 +1,75 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Test that chunks queued on a socket while its writes are blocked are
+// flushed in order by the vectored write, including when the write stops
+// in the middle of a chunk and when more chunks are queued than a single
+// write takes.
+//
+// VMOptions=
+// VMOptions=--short_socket_write
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+// More chunks than _NativeSocket.maxWriteBuffers, and enough data to fill
+// the socket buffers before the reader starts.
+const int chunkCount = 1000;
+
+// Chunk [index] in one of the forms the socket accepts: a plain list, a
+// Uint8List and a view into the middle of a larger Uint8List.
+List<int> makeChunk(int index) {
+  int length = 1 + (index * 37) % 5000;
+  var bytes = new List<int>.generate(length, (i) => (index + i) & 0xff);
+  switch (index % 3) {
+    case 0:
+      return bytes;
+    case 1:
+      return new Uint8List.fromList(bytes);
+    default:
+      var backing = new Uint8List(length + 20);
+      backing.setRange(10, 10 + length, bytes);
+      return new Uint8List.view(backing.buffer, 10, length);
+  }
+}
+
+main() {
+  asyncTest(() async {
+    var expected = new BytesBuilder();
+    for (int i = 0; i < chunkCount; i++) {
+      expected.add(makeChunk(i));
+    }
+    var expectedBytes = expected.takeBytes();
+
+    var server = await ServerSocket.bind(InternetAddress.loopbackIPv4, 0);
+    var accepted = server.first;
+    var client = await Socket.connect(InternetAddress.loopbackIPv4, server.port);
+    var serverSocket = await accepted;
+
+    // Queue everything before the other end reads anything.
+    for (int i = 0; i < chunkCount; i++) {
+      client.add(makeChunk(i));
+    }
+    var flushed = client.close();
+
+    await new Future.delayed(const Duration(milliseconds: 50));
+    var received = new BytesBuilder(copy: false);
+    await serverSocket.listen(received.add).asFuture();
+    await flushed;
+    var receivedBytes = received.takeBytes();
+    Expect.equals(expectedBytes.length, receivedBytes.length);
+    for (int i = 0; i < expectedBytes.length; i++) {
+      if (expectedBytes[i] != receivedBytes[i]) {
+        Expect.fail("Byte $i: expected ${expectedBytes[i]}, "
+            "got ${receivedBytes[i]}");
+      }
+    }
+    serverSocket.destroy();
+    await server.close();
+  });
+}
@@ -3,6 +3,7 @@
 // BSD-style license that can be found in the LICENSE file.
 
 import 'dart:async';
+import 'dart:convert';
 import 'dart:io';
 import 'dart:typed_data';
 
@@ -263,6 +264,44 @@ var generateViewTypes = [
   (list) => new Int32List.view((new Int32List.fromList(list)).buffer, 4, 4),
 ];
 
+void testZLibChunkedRoundTrip() {
+  var data = new Uint8List(300 * 1024);
+  for (int i = 0; i < data.length; i++) {
+    data[i] = (i * 31) ~/ 7 % 251;
+  }
+  for (bool gzip in [false, true]) {
+    var encoded = <int>[];
+    var sink = new ZLibEncoder(gzip: gzip)
+        .startChunkedConversion(new ChunkedConversionSink.withCallback(
+            (chunks) => chunks.forEach(encoded.addAll)));
+    // Mix small chunks, which are coalesced, with large ones.
+    int offset = 0;
+    int chunk = 0;
+    while (offset < data.length) {
+      int length = (chunk++ % 8 == 7) ? 70000 : chunk % 100;
+      if (offset + length > data.length) length = data.length - offset;
+      sink.addSlice(data, offset, offset + length, false);
+      offset += length;
+    }
+    sink.close();
+    Expect.listEquals(data, new ZLibDecoder().convert(encoded));
+  }
+}
+
+void testZLibFilterReuse() {
+  // Filters with the same parameters may reuse zlib state; each must still
+  // produce the same output as a fresh one.
+  var data = new List<int>.generate(10000, (i) => i % 17);
+  for (int level in [1, 6, 9]) {
+    var first = new ZLibEncoder(level: level).convert(data);
+    for (int i = 0; i < 10; i++) {
+      var encoded = new ZLibEncoder(level: level).convert(data);
+      Expect.listEquals(first, encoded);
+      Expect.listEquals(data, new ZLibDecoder().convert(encoded));
+    }
+  }
+}
+
 void main() {
   asyncStart();
   testZLibDeflateEmpty();
@@ -286,5 +325,7 @@ void main() {
   testZlibInflateThrowsWithSmallerWindow();
   testZlibInflateWithLargerWindow();
   testZlibWithDictionary();
+  testZLibChunkedRoundTrip();
+  testZLibFilterReuse();
   asyncEnd();
 }